@@ -187,4 +187,32 @@ if(YLT_ENABLE_STRUCT_PACK_OPTIMIZE)
         target_compile_definitions(${ylt_target_name} INTERFACE YLT_ENABLE_STRUCT_PACK_OPTIMIZE)
     endif ()
 endif()
+set(ENABLE_SIMD "" CACHE STRING "Enable simd for coro_http parser: SSE42, AVX2 or AARCH64")
+message(STATUS "ENABLE_SIMD: ${ENABLE_SIMD}")
+if (ENABLE_SIMD)
+    if (ENABLE_SIMD STREQUAL "SSE42")
+        set(YLT_SIMD_DEFINITION CINATRA_SSE)
+        if (NOT MSVC)
+            set(YLT_SIMD_OPTION -msse4.2)
+        endif ()
+    elseif (ENABLE_SIMD STREQUAL "AVX2")
+        set(YLT_SIMD_DEFINITION CINATRA_AVX2)
+        if (MSVC)
+            set(YLT_SIMD_OPTION /arch:AVX2)
+        else ()
+            set(YLT_SIMD_OPTION -mavx2)
+        endif ()
+    elseif (ENABLE_SIMD STREQUAL "AARCH64")
+        set(YLT_SIMD_DEFINITION CINATRA_ARM_OPT)
+    else ()
+        message(FATAL_ERROR "ENABLE_SIMD should be SSE42, AVX2 or AARCH64")
+    endif ()
+    if(CMAKE_PROJECT_NAME STREQUAL "yaLanTingLibs")
+        add_compile_definitions(${YLT_SIMD_DEFINITION})
+        add_compile_options(${YLT_SIMD_OPTION})
+    else ()
+        target_compile_definitions(${ylt_target_name} INTERFACE ${YLT_SIMD_DEFINITION})
+        target_compile_options(${ylt_target_name} INTERFACE ${YLT_SIMD_OPTION})
+    endif ()
+endif ()
 message(STATUS "--------------------------------------------")
@@ -12,13 +12,16 @@
 
 #include "asio/dispatch.hpp"
 #include "asio/streambuf.hpp"
+#include "async_simple/coro/Collect.h"
 #include "async_simple/coro/Lazy.h"
+#include "async_simple/coro/Mutex.h"
 #include "cinatra/cinatra_log_wrapper.hpp"
 #include "cinatra/response_cv.hpp"
 #include "cookie.hpp"
 #include "coro_http_request.hpp"
 #include "coro_http_router.hpp"
 #include "define.h"
+#include "http2.hpp"
 #include "http_parser.hpp"
 #include "multipart.hpp"
 #include "session_manager.hpp"
@@ -66,38 +69,12 @@ class coro_http_connection
     }
     return false;
   }
-  bool init_ssl(const std::string &cert_file, const std::string &key_file,
-                std::string passwd) {
-    unsigned long ssl_options = asio::ssl::context::default_workarounds |
-                                asio::ssl::context::no_sslv2 |
-                                asio::ssl::context::single_dh_use;
+  bool init_ssl(std::shared_ptr<asio::ssl::context> ssl_ctx) {
+    if (!ssl_ctx) {
+      return false;
+    }
     try {
-      ssl_ctx_ =
-          std::make_unique<asio::ssl::context>(asio::ssl::context::sslv23);
-
-      ssl_ctx_->set_options(ssl_options);
-      // Set lower security level for test certificates (OpenSSL 3.0
-      // compatibility)
-#if OPENSSL_VERSION_NUMBER >= 0x10100000L
-      SSL_CTX_set_security_level(ssl_ctx_->native_handle(), 0);
-#endif
-
-      if (!passwd.empty()) {
-        ssl_ctx_->set_password_callback([pwd = std::move(passwd)](auto, auto) {
-          return pwd;
-        });
-      }
-
-      std::error_code ec;
-      if (fs::exists(cert_file, ec)) {
-        ssl_ctx_->use_certificate_chain_file(std::move(cert_file));
-      }
-
-      if (fs::exists(key_file, ec)) {
-        ssl_ctx_->use_private_key_file(std::move(key_file),
-                                       asio::ssl::context::pem);
-      }
-
+      ssl_ctx_ = std::move(ssl_ctx);
       socket_wrapper_.ssl_stream() =
           std::make_unique<asio::ssl::stream<asio::ip::tcp::socket &>>(
               *socket_wrapper_.socket(), *ssl_ctx_);
@@ -108,6 +85,12 @@ class coro_http_connection
     return true;
   }
 
+  bool init_ssl(const std::string &cert_file, const std::string &key_file,
+                std::string passwd) {
+    return init_ssl(make_ssl_context(cert_file, key_file, "", false,
+                                     std::move(passwd), enable_http2_));
+  }
+
   /*!
    * Initialize SSL with mutual authentication support
    * @param cert_file Server certificate file path
@@ -117,52 +100,67 @@ class coro_http_connection
    * @param passwd Server private key password (optional)
    * @return true if initialization successful
    */
-  bool init_ssl(const std::string& cert_file, const std::string& key_file,
-                const std::string& ca_cert_file, bool enable_client_verify,
+  bool init_ssl(const std::string &cert_file, const std::string &key_file,
+                const std::string &ca_cert_file, bool enable_client_verify,
                 std::string passwd = "") {
+    return init_ssl(make_ssl_context(cert_file, key_file, ca_cert_file,
+                                     enable_client_verify, std::move(passwd),
+                                     enable_http2_,
+                                     /*set_verify_mode=*/true));
+  }
+
+  /*!
+   * Create the SSL context of a server, it can be shared by the connections.
+   * The ALPN callback is registered on it if enable_http2 is set.
+   * @return nullptr if the context can't be initialized
+   */
+  static std::shared_ptr<asio::ssl::context> make_ssl_context(
+      const std::string &cert_file, const std::string &key_file,
+      const std::string &ca_cert_file, bool enable_client_verify,
+      std::string passwd, bool enable_http2, bool set_verify_mode = false) {
     unsigned long ssl_options = asio::ssl::context::default_workarounds |
                                 asio::ssl::context::no_sslv2 |
                                 asio::ssl::context::single_dh_use;
     try {
-      ssl_ctx_ =
-          std::make_unique<asio::ssl::context>(asio::ssl::context::sslv23);
+      auto ssl_ctx =
+          std::make_shared<asio::ssl::context>(asio::ssl::context::sslv23);
 
-      ssl_ctx_->set_options(ssl_options);
+      ssl_ctx->set_options(ssl_options);
       // Set lower security level for test certificates (OpenSSL 3.0
       // compatibility)
 #if OPENSSL_VERSION_NUMBER >= 0x10100000L
-      SSL_CTX_set_security_level(ssl_ctx_->native_handle(), 0);
+      SSL_CTX_set_security_level(ssl_ctx->native_handle(), 0);
 #endif
 
       if (!passwd.empty()) {
-        ssl_ctx_->set_password_callback([pwd = std::move(passwd)](auto, auto) {
+        ssl_ctx->set_password_callback([pwd = std::move(passwd)](auto, auto) {
           return pwd;
         });
       }
 
       std::error_code ec;
       if (fs::exists(cert_file, ec)) {
-        ssl_ctx_->use_certificate_chain_file(cert_file);
+        ssl_ctx->use_certificate_chain_file(cert_file);
       }
 
       if (fs::exists(key_file, ec)) {
-        ssl_ctx_->use_private_key_file(key_file, asio::ssl::context::pem);
+        ssl_ctx->use_private_key_file(key_file, asio::ssl::context::pem);
       }
 
       // Load CA certificate for client verification if provided
       if (!ca_cert_file.empty() && fs::exists(ca_cert_file, ec)) {
-        ssl_ctx_->load_verify_file(ca_cert_file, ec);
+        ssl_ctx->load_verify_file(ca_cert_file, ec);
         if (ec) {
           CINATRA_LOG_ERROR << "failed to load CA certificate: " << ca_cert_file
                             << ", error: " << ec.message();
-          return false;
+          return nullptr;
         }
         CINATRA_LOG_INFO << "loaded CA certificate: " << ca_cert_file;
       }
 
       // Set verification mode based on client verification configuration
       if (enable_client_verify) {
-        ssl_ctx_->set_verify_mode(
+        ssl_ctx->set_verify_mode(
             asio::ssl::verify_peer | asio::ssl::verify_fail_if_no_peer_cert,
             ec);
         if (ec) {
@@ -173,21 +171,22 @@ class coro_http_connection
               << "client certificate verification enabled (mandatory)";
         }
       }
-      else {
-        ssl_ctx_->set_verify_mode(asio::ssl::verify_none, ec);
+      else if (set_verify_mode) {
+        ssl_ctx->set_verify_mode(asio::ssl::verify_none, ec);
         if (ec) {
           CINATRA_LOG_WARNING << "failed to set verify mode: " << ec.message();
         }
       }
 
-      socket_wrapper_.ssl_stream() =
-          std::make_unique<asio::ssl::stream<asio::ip::tcp::socket&>>(
-              *socket_wrapper_.socket(), *ssl_ctx_);
-    } catch (const std::exception& e) {
+      if (enable_http2) {
+        SSL_CTX_set_alpn_select_cb(ssl_ctx->native_handle(), select_alpn,
+                                   nullptr);
+      }
+      return ssl_ctx;
+    } catch (const std::exception &e) {
       CINATRA_LOG_ERROR << "init ssl failed, reason: " << e.what();
-      return false;
+      return nullptr;
     }
-    return true;
   }
 
 #ifdef YLT_ENABLE_NTLS
@@ -526,9 +525,13 @@ class coro_http_connection
         }
 
         has_shake = true;
+        if (enable_http2_ && is_alpn_h2()) {
+          co_await start_http2();
+          break;
+        }
       }
 #endif
-      auto [ec, size] = co_await async_read_until(head_buf_, TWO_CRCF);
+      auto [ec, head_len] = co_await read_request_head();
       if (ec) {
         if (ec != asio::error::eof) {
           CINATRA_LOG_WARNING << "read http header error: " << ec.message();
@@ -538,9 +541,13 @@ class coro_http_connection
         break;
       }
 
-      const char *data_ptr = asio::buffer_cast<const char *>(head_buf_.data());
-      int head_len = parser_.parse_request(data_ptr, size, 0);
-      if (head_len <= 0) {
+      if (head_len == 0) {
+        // h2c with prior knowledge.
+        co_await start_http2();
+        break;
+      }
+
+      if (head_len < 0) {
         CINATRA_LOG_ERROR << "parse http header error";
         response_.set_status_and_content(status_type::bad_request,
                                          "invalid http protocol");
@@ -549,7 +556,9 @@ class coro_http_connection
         break;
       }
 
-      if (parser_.body_len() > max_http_body_len_ || parser_.body_len() < 0)
+      bool stream_body = is_stream_body_request();
+      if (parser_.body_len() < 0 ||
+          (!stream_body && parser_.body_len() > max_http_body_len_))
           [[unlikely]] {
         CINATRA_LOG_ERROR << "invalid http content length: "
                           << parser_.body_len();
@@ -560,12 +569,17 @@ class coro_http_connection
         break;
       }
 
-      head_buf_.consume(size);
+      head_buf_.consume(head_len);
       keep_alive_ = check_keep_alive();
 
       auto type = request_.get_content_type();
 
-      if (type != content_type::chunked && type != content_type::multipart) {
+      if (stream_body) {
+        init_stream_body();
+        request_.set_stream_body(true);
+      }
+      else if (type != content_type::chunked &&
+               type != content_type::multipart) {
         size_t body_len = (size_t)parser_.body_len();
         if (body_len == 0) {
           if (parser_.method() == "GET"sv) {
@@ -616,115 +630,20 @@ class coro_http_connection
         }
       }
 
-      std::string_view key = {
-          parser_.method().data(),
-          parser_.method().length() + 1 + parser_.url().length()};
-
-      std::string decode_key;
-      if (parser_.url().find('%') != std::string_view::npos) {
-        decode_key = code_utils::url_decode(key);
-        key = decode_key;
-      }
-
       if (!body_.empty()) {
         request_.set_body(body_);
       }
 
-      if (auto handler = router_.get_handler(key); handler) {
-        router_.route(handler, request_, response_, key);
-      }
-      else {
-        if (auto coro_handler = router_.get_coro_handler(key); coro_handler) {
-          co_await router_.route_coro(coro_handler, request_, response_, key);
-        }
-        else {
-          bool is_exist = false;
-          bool is_coro_exist = false;
-          bool is_matched_regex_router = false;
-          std::function<void(coro_http_request & req,
-                             coro_http_response & resp)>
-              handler;
-          std::string method_str{parser_.method()};
-          std::string url_path = method_str;
-          url_path.append(" ").append(parser_.url());
-          std::tie(is_exist, handler, request_.params_) =
-              router_.get_router_tree()->get(url_path, method_str);
-          if (is_exist) {
-            if (handler) {
-              (handler)(request_, response_);
-            }
-            else {
-              response_.set_status(status_type::not_found);
-            }
-          }
-          else {
-            std::function<async_simple::coro::Lazy<void>(
-                coro_http_request & req, coro_http_response & resp)>
-                coro_handler;
-
-            std::tie(is_coro_exist, coro_handler, request_.params_) =
-                router_.get_coro_router_tree()->get_coro(url_path, method_str);
-
-            if (is_coro_exist) {
-              if (coro_handler) {
-                co_await coro_handler(request_, response_);
-              }
-              else {
-                response_.set_status(status_type::not_found);
-              }
-            }
-            else {
-              // coro regex router
-              auto coro_regex_handlers = router_.get_coro_regex_handlers();
-              if (coro_regex_handlers.size() != 0) {
-                for (auto &pair : coro_regex_handlers) {
-                  std::string coro_regex_key{key};
+      co_await handle_request(request_, response_, parser_);
 
-                  if (std::regex_match(coro_regex_key, request_.matches_,
-                                       std::get<0>(pair))) {
-                    auto coro_handler = std::get<1>(pair);
-                    if (coro_handler) {
-                      co_await coro_handler(request_, response_);
-                      is_matched_regex_router = true;
-                    }
-                  }
-                }
-              }
-              // regex router
-              if (!is_matched_regex_router) {
-                auto regex_handlers = router_.get_regex_handlers();
-                if (regex_handlers.size() != 0) {
-                  for (auto &pair : regex_handlers) {
-                    std::string regex_key{key};
-                    if (std::regex_match(regex_key, request_.matches_,
-                                         std::get<0>(pair))) {
-                      auto handler = std::get<1>(pair);
-                      if (handler) {
-                        (handler)(request_, response_);
-                        is_matched_regex_router = true;
-                      }
-                    }
-                  }
-                }
-              }
-              // radix route -> radix coro route -> regex coro -> regex ->
-              // default -> not found
-              if (!is_matched_regex_router) {
-                if (default_handler_) {
-                  co_await default_handler_(request_, response_);
-                }
-                else {
-                  // not found
-                  response_.set_status(status_type::not_found);
-                }
-              }
-            }
-          }
-        }
+      if (stream_body && !body_eof_) {
+        // the rest of the body is unread, the connection can't be reused.
+        keep_alive_ = false;
+        response_.set_keepalive(false);
       }
 
       if (!response_.get_delay()) {
-        if (head_buf_.size()) {
+        if (head_buf_.size() && !stream_body) {
           if (type == content_type::multipart ||
               type == content_type::chunked) {
             if (response_.content().empty())
@@ -752,13 +671,11 @@ class coro_http_connection
               size_t left_size = head_buf_.size();
               auto next_data_ptr =
                   asio::buffer_cast<const char *>(head_buf_.data());
-              std::string_view left_content{next_data_ptr, left_size};
-              size_t pos = left_content.find(TWO_CRCF);
-              if (pos == std::string_view::npos) {
-                break;
-              }
               http_parser parser;
               int head_len = parser.parse_request(next_data_ptr, left_size, 0);
+              if (head_len == -2) {
+                break;
+              }
               if (head_len <= 0) {
                 CINATRA_LOG_ERROR << "parse http header error";
                 response_.set_status_and_content(status_type::bad_request,
@@ -768,7 +685,7 @@ class coro_http_connection
                 break;
               }
 
-              head_buf_.consume(pos + TWO_CRCF.length());
+              head_buf_.consume(head_len);
 
               std::string_view next_key = {
                   parser.method().data(),
@@ -778,12 +695,13 @@ class coro_http_connection
               coro_http_response resp(this);
               resp.need_date_head(response_.need_date());
               if (auto handler = router_.get_handler(next_key); handler) {
-                router_.route(handler, req, resp, key);
+                router_.route(handler, req, resp, next_key);
               }
               else {
                 if (auto coro_handler = router_.get_coro_handler(next_key);
                     coro_handler) {
-                  co_await router_.route_coro(coro_handler, req, resp, key);
+                  co_await router_.route_coro(coro_handler, req, resp,
+                                               next_key);
                 }
                 else {
                   resp.set_status(status_type::not_found);
@@ -825,7 +743,225 @@ class coro_http_connection
     }
   }
 
+  // Dispatch a request to the handler matched by the router, it is shared by
+  // http1 and the streams of http2.
+  async_simple::coro::Lazy<void> handle_request(coro_http_request &req,
+                                                coro_http_response &resp,
+                                                http_parser &parser) {
+    std::string_view key = {
+        parser.method().data(),
+        parser.method().length() + 1 + parser.url().length()};
+
+    std::string decode_key;
+    if (parser.url().find('%') != std::string_view::npos) {
+      decode_key = code_utils::url_decode(key);
+      key = decode_key;
+    }
+
+    if (auto handler = router_.get_handler(key); handler) {
+      router_.route(handler, req, resp, key);
+    }
+    else {
+      if (auto coro_handler = router_.get_coro_handler(key); coro_handler) {
+        co_await router_.route_coro(coro_handler, req, resp, key);
+      }
+      else {
+        bool is_exist = false;
+        bool is_coro_exist = false;
+        bool is_matched_regex_router = false;
+        std::function<void(coro_http_request & req,
+                           coro_http_response & resp)>
+            handler;
+        std::string method_str{parser.method()};
+        std::string url_path = method_str;
+        url_path.append(" ").append(parser.url());
+        std::tie(is_exist, handler, req.params_) =
+            router_.get_router_tree()->get(url_path, method_str);
+        if (is_exist) {
+          if (handler) {
+            (handler)(req, resp);
+          }
+          else {
+            resp.set_status(status_type::not_found);
+          }
+        }
+        else {
+          std::function<async_simple::coro::Lazy<void>(
+              coro_http_request & req, coro_http_response & resp)>
+              coro_handler;
+
+          std::tie(is_coro_exist, coro_handler, req.params_) =
+              router_.get_coro_router_tree()->get_coro(url_path, method_str);
+
+          if (is_coro_exist) {
+            if (coro_handler) {
+              co_await coro_handler(req, resp);
+            }
+            else {
+              resp.set_status(status_type::not_found);
+            }
+          }
+          else {
+            // coro regex router
+            auto coro_regex_handlers = router_.get_coro_regex_handlers();
+            if (coro_regex_handlers.size() != 0) {
+              for (auto &pair : coro_regex_handlers) {
+                std::string coro_regex_key{key};
+
+                if (std::regex_match(coro_regex_key, req.matches_,
+                                     std::get<0>(pair))) {
+                  auto coro_handler = std::get<1>(pair);
+                  if (coro_handler) {
+                    co_await coro_handler(req, resp);
+                    is_matched_regex_router = true;
+                  }
+                }
+              }
+            }
+            // regex router
+            if (!is_matched_regex_router) {
+              auto regex_handlers = router_.get_regex_handlers();
+              if (regex_handlers.size() != 0) {
+                for (auto &pair : regex_handlers) {
+                  std::string regex_key{key};
+                  if (std::regex_match(regex_key, req.matches_,
+                                       std::get<0>(pair))) {
+                    auto handler = std::get<1>(pair);
+                    if (handler) {
+                      (handler)(req, resp);
+                      is_matched_regex_router = true;
+                    }
+                  }
+                }
+              }
+            }
+            // radix route -> radix coro route -> regex coro -> regex ->
+            // default -> not found
+            if (!is_matched_regex_router) {
+              if (default_handler_) {
+                co_await default_handler_(req, resp);
+              }
+              else {
+                // not found
+                resp.set_status(status_type::not_found);
+              }
+            }
+          }
+        }
+      }
+    }
+  }
+
+  // Serve the connection as http2, after h2c prior knowledge or "h2" is
+  // negotiated by ALPN. Every stream is dispatched to the handlers in its own
+  // coroutine, so the requests of one connection are handled concurrently.
+  async_simple::coro::Lazy<void> start_http2() {
+    is_http2_ = true;
+    if (auto ec = co_await read_http2(HTTP2_PREFACE.size()); ec) {
+      close();
+      co_return;
+    }
+    const char *data_ptr = asio::buffer_cast<const char *>(head_buf_.data());
+    if (std::string_view(data_ptr, HTTP2_PREFACE.size()) != HTTP2_PREFACE) {
+      CINATRA_LOG_ERROR << "invalid http2 connection preface";
+      close();
+      co_return;
+    }
+    head_buf_.consume(HTTP2_PREFACE.size());
+
+    h2_session_ = std::make_unique<http2_session>(this, max_http_body_len_);
+    h2_session_->start();
+    co_await flush_http2();
+
+    while (!has_closed_) {
+      if (auto ec = co_await read_http2(HTTP2_FRAME_HEADER_LEN); ec) {
+        if (ec != asio::error::eof) {
+          CINATRA_LOG_WARNING << "read http2 frame error: " << ec.message();
+        }
+        close();
+        break;
+      }
+
+      data_ptr = asio::buffer_cast<const char *>(head_buf_.data());
+      auto header = parse_http2_frame_header(data_ptr);
+      auto err = http2_error_code::no_error;
+      if (header.length > h2_session_->max_frame_size()) {
+        err = http2_error_code::frame_size_error;
+      }
+      else {
+        size_t frame_len = HTTP2_FRAME_HEADER_LEN + header.length;
+        if (auto ec = co_await read_http2(frame_len); ec) {
+          close();
+          break;
+        }
+        data_ptr = asio::buffer_cast<const char *>(head_buf_.data());
+        err = h2_session_->on_frame(
+            header, {data_ptr + HTTP2_FRAME_HEADER_LEN, header.length});
+        head_buf_.consume(frame_len);
+      }
+
+      if (err != http2_error_code::no_error) {
+        CINATRA_LOG_ERROR << "http2 connection error: "
+                          << static_cast<uint32_t>(err);
+        h2_session_->goaway(err);
+        co_await flush_http2();
+        close();
+        break;
+      }
+
+      for (auto stream : h2_session_->ready_streams()) {
+        handle_http2_stream(shared_from_this(), stream)
+            .via(executor_)
+            .detach();
+      }
+      h2_session_->ready_streams().clear();
+      co_await flush_http2();
+    }
+  }
+
+  async_simple::coro::Lazy<void> handle_http2_stream(
+      std::shared_ptr<coro_http_connection> self, http2_stream *stream) {
+    auto &req = stream->request;
+    auto &resp = stream->response;
+    if (!stream->body.empty()) {
+      req.set_body(stream->body);
+    }
+    co_await handle_request(req, resp, stream->parser);
+    handle_session_for_response(req, resp);
+    h2_session_->submit_response(*stream);
+    co_await flush_http2();
+  }
+
+  // Write the pending frames, only one coroutine writes at a time and the
+  // frames appended during the write are sent by the next round.
+  async_simple::coro::Lazy<void> flush_http2() {
+    if (h2_writing_) {
+      co_return;
+    }
+    h2_writing_ = true;
+    while (!h2_session_->output().empty() && !has_closed_) {
+      h2_write_buf_.swap(h2_session_->output());
+      auto [ec, _] = co_await async_write(asio::buffer(h2_write_buf_));
+      h2_write_buf_.clear();
+      if (ec) {
+        CINATRA_LOG_WARNING << "http2 async_write error: " << ec.message();
+        close();
+        break;
+      }
+    }
+    h2_writing_ = false;
+  }
+
+  bool is_http2() const { return is_http2_; }
+
+  void enable_http2(bool r) { enable_http2_ = r; }
+
   async_simple::coro::Lazy<bool> reply(bool need_to_bufffer = true) {
+    if (is_http2_) [[unlikely]] {
+      CINATRA_LOG_ERROR << "write to the connection directly is not supported "
+                           "by http2, set the response instead";
+      co_return false;
+    }
     std::error_code ec;
     size_t size;
     if (multi_buf_) {
@@ -888,6 +1024,9 @@ class coro_http_connection
 #endif
 
   async_simple::coro::Lazy<bool> write_data(std::string_view message) {
+    if (is_http2_) [[unlikely]] {
+      co_return co_await reply();
+    }
     std::vector<asio::const_buffer> buffers;
     buffers.push_back(asio::buffer(message));
     auto [ec, _] = co_await async_write(buffers);
@@ -964,6 +1103,58 @@ class coro_http_connection
     co_return !ec;
   }
 
+  // Read the body of a request to a stream handler on demand, see
+  // coro_http_request::read_body_some.
+  async_simple::coro::Lazy<std::pair<std::error_code, size_t>> read_body_some(
+      std::span<char> buf) {
+    if (body_eof_ || buf.empty()) {
+      co_return std::pair{std::error_code{}, size_t(0)};
+    }
+
+    if (need_continue_) {
+      // tell the client to send the body only when the handler wants it.
+      need_continue_ = false;
+      auto [ec, _] = co_await async_write(asio::buffer(CONTINUE_RESP_SV));
+      if (ec) {
+        close();
+        co_return std::pair{ec, size_t(0)};
+      }
+    }
+
+    if (body_chunked_ && body_left_ == 0) {
+      if (auto ec = co_await read_chunk_size(); ec) {
+        close();
+        co_return std::pair{ec, size_t(0)};
+      }
+      if (body_eof_) {
+        co_return std::pair{std::error_code{}, size_t(0)};
+      }
+    }
+
+    size_t size = (std::min)(static_cast<uint64_t>(buf.size()), body_left_);
+    if (head_buf_.size() > 0) {
+      size = (std::min)(size, head_buf_.size());
+      memcpy(buf.data(), asio::buffer_cast<const char *>(head_buf_.data()),
+             size);
+      head_buf_.consume(size);
+    }
+    else {
+      auto [ec, read_size] =
+          co_await async_read_some(asio::buffer(buf.data(), size));
+      if (ec) {
+        close();
+        co_return std::pair{ec, size_t(0)};
+      }
+      size = read_size;
+    }
+
+    body_left_ -= size;
+    if (!body_chunked_ && body_left_ == 0) {
+      body_eof_ = true;
+    }
+    co_return std::pair{std::error_code{}, size};
+  }
+
   async_simple::coro::Lazy<chunked_result> read_chunked() {
     if (head_buf_.size() > 0) {
       const char *data_ptr = asio::buffer_cast<const char *>(head_buf_.data());
@@ -1024,6 +1215,8 @@ class coro_http_connection
 
   async_simple::coro::Lazy<std::error_code> write_websocket(
       std::string_view msg, opcode op = opcode::text, bool eof = true) {
+    // the header is encoded into ws_, so it's under the lock too.
+    auto lock = co_await ws_write_mtx_.coScopedLock();
     std::vector<asio::const_buffer> buffers;
     std::string_view header;
 #ifdef CINATRA_ENABLE_GZIP
@@ -1050,6 +1243,16 @@ class coro_http_connection
     co_return ec;
   }
 
+  // Write a frame made by websocket::encode_server_frame as is, the frame is
+  // neither copied nor compressed. It's queued after the websocket writes in
+  // flight, so the frames don't interleave.
+  async_simple::coro::Lazy<std::error_code> write_websocket_frame(
+      std::shared_ptr<const std::string> frame) {
+    auto lock = co_await ws_write_mtx_.coScopedLock();
+    auto [ec, sz] = co_await async_write(asio::buffer(*frame));
+    co_return ec;
+  }
+
   async_simple::coro::Lazy<websocket_result> read_websocket() {
     auto [ec, ws_hd_size] = co_await async_read(head_buf_, SHORT_HEADER);
     websocket_result result{ec};
@@ -1277,6 +1480,27 @@ class coro_http_connection
 #endif
   }
 
+  template <typename AsioBuffer>
+  async_simple::coro::Lazy<std::pair<std::error_code, size_t>> async_read_some(
+      AsioBuffer &&buffer) noexcept {
+#ifdef INJECT_FOR_HTTP_SEVER_TEST
+    if (read_failed_forever_) {
+      return async_read_failed();
+    }
+#endif
+    set_last_time();
+#ifdef CINATRA_ENABLE_SSL
+    if (socket_wrapper_.use_ssl()) {
+      return coro_io::async_read_some(*socket_wrapper_.ssl_stream(), buffer);
+    }
+    else {
+#endif
+      return coro_io::async_read_some(*socket_wrapper_.socket(), buffer);
+#ifdef CINATRA_ENABLE_SSL
+    }
+#endif
+  }
+
   void set_last_time() {
     if (checkout_timeout_) {
       last_rwtime_ = std::chrono::system_clock::now();
@@ -1311,17 +1535,175 @@ class coro_http_connection
   void set_check_timeout(bool r) { checkout_timeout_ = r; }
 
   void handle_session_for_response() {
-    if (request_.has_session()) {
+    handle_session_for_response(request_, response_);
+  }
+
+  void handle_session_for_response(coro_http_request &req,
+                                   coro_http_response &resp) {
+    if (req.has_session()) {
       auto session =
-          session_manager::get().get_session(request_.get_cached_session_id());
+          session_manager::get().get_session(req.get_cached_session_id());
       if (session != nullptr && session->get_need_set_to_client()) {
-        response_.add_cookie(session->get_session_cookie());
+        resp.add_cookie(session->get_session_cookie());
         session->set_need_set_to_client(false);
       }
     }
   }
 
  private:
+  // Read until the request head is complete and parse it. The parser runs on
+  // the read buffer directly and checks only the new bytes for the end of the
+  // head, so the head isn't scanned for "\r\n\r\n" before being parsed.
+  // Returns the head length, -1 for a bad request, or 0 for the h2c preface.
+  async_simple::coro::Lazy<std::pair<std::error_code, int>>
+  read_request_head() {
+    size_t last_len = 0;
+    while (true) {
+      size_t size = head_buf_.size();
+      if (size > last_len) {
+        const char *data_ptr =
+            asio::buffer_cast<const char *>(head_buf_.data());
+        if (enable_http2_ && data_ptr[0] == HTTP2_PREFACE_HEAD[0]) {
+          std::string_view data(data_ptr,
+                                (std::min)(size, HTTP2_PREFACE_HEAD.size()));
+          if (data == HTTP2_PREFACE_HEAD) {
+            co_return std::pair{std::error_code{}, 0};
+          }
+          if (HTTP2_PREFACE_HEAD.starts_with(data)) {
+            last_len = 0;
+            size = 0;
+          }
+        }
+
+        if (size > 0) {
+          int head_len = parser_.parse_request(data_ptr, size, last_len);
+          if (head_len != -2) {
+            co_return std::pair{std::error_code{}, head_len};
+          }
+          last_len = size;
+        }
+      }
+
+      auto [ec, read_size] = co_await async_read_some(
+          head_buf_.prepare((std::max)(head_buf_.size(), size_t(1024))));
+      if (ec) {
+        co_return std::pair{ec, -1};
+      }
+      head_buf_.commit(read_size);
+    }
+  }
+
+  // Make sure head_buf_ holds at least size bytes, read as much as the socket
+  // has to save syscalls for the small frames.
+  async_simple::coro::Lazy<std::error_code> read_http2(size_t size) {
+    while (head_buf_.size() < size) {
+      size_t need = size - head_buf_.size();
+      auto [ec, read_size] = co_await async_read_some(
+          head_buf_.prepare((std::max)(need, size_t(16 * 1024))));
+      if (ec) {
+        co_return ec;
+      }
+      head_buf_.commit(read_size);
+    }
+    co_return std::error_code{};
+  }
+
+#ifdef CINATRA_ENABLE_SSL
+  bool is_alpn_h2() {
+    const unsigned char *proto = nullptr;
+    unsigned int len = 0;
+    SSL_get0_alpn_selected(socket_wrapper_.ssl_stream()->native_handle(),
+                           &proto, &len);
+    return std::string_view(reinterpret_cast<const char *>(proto), len) ==
+           HTTP2_ALPN;
+  }
+
+  static int select_alpn(::SSL *, const unsigned char **out,
+                         unsigned char *outlen, const unsigned char *in,
+                         unsigned int inlen, void *) {
+    static constexpr unsigned char protos[] = "\x02h2\x08http/1.1";
+    if (SSL_select_next_proto(const_cast<unsigned char **>(out), outlen,
+                              protos, sizeof(protos) - 1, in,
+                              inlen) != OPENSSL_NPN_NEGOTIATED) {
+      return SSL_TLSEXT_ERR_NOACK;
+    }
+    return SSL_TLSEXT_ERR_OK;
+  }
+#endif
+
+  bool is_stream_body_request() {
+    if (!router_.has_stream_body()) {
+      return false;
+    }
+
+    std::string_view key = {
+        parser_.method().data(),
+        parser_.method().length() + 1 + parser_.url().length()};
+    std::string decode_key;
+    if (parser_.url().find('%') != std::string_view::npos) {
+      decode_key = code_utils::url_decode(key);
+      key = decode_key;
+    }
+    return router_.is_stream_body(key);
+  }
+
+  void init_stream_body() {
+    body_chunked_ = parser_.is_chunked();
+    body_left_ = body_chunked_ ? 0 : parser_.body_len();
+    body_eof_ = !body_chunked_ && body_left_ == 0;
+    chunk_crlf_ = false;
+    need_continue_ = !body_eof_ && iequal0(request_.get_header_value("expect"),
+                                           "100-continue");
+  }
+
+  // Read "chunk-size[;ext]\r\n", the CRLF after the previous chunk data and
+  // the trailers after the last chunk are consumed too.
+  async_simple::coro::Lazy<std::error_code> read_chunk_size() {
+    std::error_code ec{};
+    size_t size = 0;
+    if (chunk_crlf_) {
+      if (std::tie(ec, size) = co_await async_read_until(head_buf_, CRCF);
+          ec) {
+        co_return ec;
+      }
+      head_buf_.consume(size);
+      if (size != CRCF.size()) {
+        co_return std::make_error_code(std::errc::protocol_error);
+      }
+      chunk_crlf_ = false;
+    }
+
+    if (std::tie(ec, size) = co_await async_read_until(head_buf_, CRCF); ec) {
+      co_return ec;
+    }
+    const char *data_ptr = asio::buffer_cast<const char *>(head_buf_.data());
+    const char *end = data_ptr + size - CRCF.size();
+    uint64_t chunk_size = 0;
+    auto [ptr, err] = std::from_chars(data_ptr, end, chunk_size, 16);
+    if (err != std::errc{} || (ptr != end && *ptr != ';' && *ptr != ' ')) {
+      CINATRA_LOG_ERROR << "bad chunked size";
+      co_return std::make_error_code(std::errc::invalid_argument);
+    }
+    head_buf_.consume(size);
+
+    if (chunk_size > 0) {
+      body_left_ = chunk_size;
+      chunk_crlf_ = true;
+      co_return ec;
+    }
+
+    // the last chunk, skip the trailers until the empty line.
+    do {
+      if (std::tie(ec, size) = co_await async_read_until(head_buf_, CRCF);
+          ec) {
+        co_return ec;
+      }
+      head_buf_.consume(size);
+    } while (size != CRCF.size());
+    body_eof_ = true;
+    co_return ec;
+  }
+
   bool check_keep_alive() {
     if (parser_.has_close()) {
       return false;
@@ -1407,7 +1789,7 @@ class coro_http_connection
 
   websocket ws_;
 #ifdef CINATRA_ENABLE_SSL
-  std::unique_ptr<asio::ssl::context> ssl_ctx_ = nullptr;
+  std::shared_ptr<asio::ssl::context> ssl_ctx_ = nullptr;
 #endif
   bool need_shrink_every_time_ = false;
   bool multi_buf_ = true;
@@ -1417,9 +1799,67 @@ class coro_http_connection
   std::string chunk_size_str_;
   std::string remote_addr_;
   int64_t max_http_body_len_ = 0;
+  bool enable_http2_ = false;
+  bool is_http2_ = false;
+  bool h2_writing_ = false;
+  std::unique_ptr<http2_session> h2_session_;
+  std::string h2_write_buf_;
+  async_simple::coro::Mutex ws_write_mtx_;
+  // state of the streaming request body.
+  uint64_t body_left_ = 0;
+  bool body_chunked_ = false;
+  bool body_eof_ = true;
+  bool chunk_crlf_ = false;
+  bool need_continue_ = false;
 #ifdef INJECT_FOR_HTTP_SEVER_TEST
   bool write_failed_forever_ = false;
   bool read_failed_forever_ = false;
 #endif
 };
+
+inline async_simple::coro::Lazy<std::pair<std::error_code, size_t>>
+coro_http_request::read_body_some(std::span<char> buf) {
+  if (is_stream_body_) {
+    co_return co_await conn_->read_body_some(buf);
+  }
+
+  size_t size = (std::min)(buf.size(), body_.size() - body_read_pos_);
+  if (size > 0) {
+    memcpy(buf.data(), body_.data() + body_read_pos_, size);
+    body_read_pos_ += size;
+  }
+  co_return std::pair{std::error_code{}, size};
+}
+
+// Encode msg once and write the same frame to all the websocket connections
+// concurrently, each write runs in the executor of its connection. The frame
+// isn't compressed. The connections are kept alive until their writes are
+// done. The result is in the order of conns.
+inline async_simple::coro::Lazy<std::vector<std::error_code>>
+broadcast_websocket(
+    std::span<const std::shared_ptr<coro_http_connection>> conns,
+    std::string_view msg, opcode op = opcode::text) {
+  auto frame = websocket::encode_server_frame(msg, op);
+  std::vector<async_simple::coro::RescheduleLazy<std::error_code>> writes;
+  writes.reserve(conns.size());
+  for (auto &conn : conns) {
+    writes.push_back(
+        [](std::shared_ptr<coro_http_connection> conn,
+           std::shared_ptr<const std::string> frame)
+            -> async_simple::coro::Lazy<std::error_code> {
+          co_return co_await conn->write_websocket_frame(std::move(frame));
+        }(conn, frame)
+                    .via(conn->get_executor()));
+  }
+
+  auto results = co_await async_simple::coro::collectAll(std::move(writes));
+  std::vector<std::error_code> ecs;
+  ecs.reserve(results.size());
+  for (auto &r : results) {
+    ecs.push_back(r.hasError()
+                      ? std::make_error_code(std::errc::io_error)
+                      : r.value());
+  }
+  co_return ecs;
+}
 }  // namespace cinatra
@@ -6,6 +6,7 @@
 #include <optional>
 #include <regex>
 #include <string>
+#include <system_error>
 
 #include "async_simple/coro/Lazy.h"
 #include "define.h"
@@ -139,6 +140,17 @@ class coro_http_request {
 
   std::string_view get_body() const { return body_; }
 
+  // Read the next part of the body into buf, the size is 0 when the whole
+  // body has been read. The body of a handler set by set_http_stream_handler
+  // is read from the socket on demand, otherwise it is copied from
+  // get_body(). Defined in coro_http_connection.hpp.
+  async_simple::coro::Lazy<std::pair<std::error_code, size_t>> read_body_some(
+      std::span<char> buf);
+
+  void set_stream_body(bool r) { is_stream_body_ = r; }
+
+  bool is_stream_body() const { return is_stream_body_; }
+
   bool is_chunked() { return parser_.is_chunked(); }
 
   std::string_view get_accept_encoding() {
@@ -289,6 +301,8 @@ class coro_http_request {
   bool has_session() { return !cached_session_id_.empty(); }
   void clear() {
     body_ = {};
+    body_read_pos_ = 0;
+    is_stream_body_ = false;
     if (!aspect_data_.empty()) {
       aspect_data_.clear();
     }
@@ -303,6 +317,8 @@ class coro_http_request {
  private:
   http_parser &parser_;
   std::string_view body_;
+  size_t body_read_pos_ = 0;
+  bool is_stream_body_ = false;
   coro_http_connection *conn_;
   bool is_websocket_ = false;
   std::vector<std::string> aspect_data_;
@@ -163,6 +163,7 @@ class coro_http_response {
   template <size_t N>
   void set_content_type() {
     content_type_ = get_content_type<N>();
+    content_type_index_ = N > 43 ? 44 : N;
   }
 
   status_type status() { return status_; }
@@ -186,9 +187,10 @@ class coro_http_response {
 
   std::string_view get_boundary() { return boundary_; }
 
+  // The head is built into one buffer and the content is referenced, not
+  // copied, so a normal response is written by one writev with two buffers.
   void to_buffers(std::vector<asio::const_buffer> &buffers,
                   std::string &size_str) {
-    buffers.push_back(asio::buffer(to_http_status_string(status_)));
     build_resp_head(buffers);
     if (!content_.empty()) {
       handle_content(buffers, size_str, content_);
@@ -199,60 +201,7 @@ class coro_http_response {
   }
 
   void build_resp_str(std::string &resp_str) {
-    resp_str.append(to_http_status_string(status_));
-    bool has_len = false;
-    bool has_host = false;
-    check_header(resp_headers_, has_len, has_host);
-    if (!resp_header_span_.empty()) {
-      check_header(resp_header_span_, has_len, has_host);
-    }
-
-    if (!has_host) {
-      resp_str.append(CINATRA_HOST_SV);
-    }
-
-    if (content_.empty() && !has_set_content_ &&
-        fmt_type_ != format_type::chunked) {
-      content_.append(default_status_content(status_));
-    }
-
-    if (fmt_type_ == format_type::chunked) {
-      resp_str.append(TRANSFER_ENCODING_SV);
-    }
-    else {
-      if (!content_.empty() || !content_view_.empty()) {
-        size_t content_size =
-            content_.empty() ? content_view_.size() : content_.size();
-        auto [ptr, ec] = std::to_chars(buf_, buf_ + 32, content_size);
-        resp_str.append(CONTENT_LENGTH_SV);
-        resp_str.append(std::string_view(buf_, std::distance(buf_, ptr)));
-        resp_str.append(CRCF);
-      }
-      else {
-        if (!has_len && boundary_.empty())
-          resp_str.append(ZERO_LENGTH_SV);
-      }
-    }
-
-    if (need_date_) {
-      resp_str.append(DATE_SV);
-      resp_str.append(get_gmt_time_str());
-      resp_str.append(CRCF);
-    }
-
-    if (keepalive_.has_value()) {
-      bool keepalive = keepalive_.value();
-      keepalive ? resp_str.append(CONN_KEEP_SV)
-                : resp_str.append(CONN_CLOSE_SV);
-    }
-
-    append_header_str(resp_str, resp_headers_);
-
-    if (!resp_header_span_.empty()) {
-      append_header_str(resp_str, resp_header_span_);
-    }
-
-    resp_str.append(CRCF);
+    append_resp_head(resp_str);
     if (content_view_.empty()) {
       resp_str.append(content_);
     }
@@ -261,6 +210,12 @@ class coro_http_response {
     }
   }
 
+  void build_resp_head(std::vector<asio::const_buffer> &buffers) {
+    head_.clear();
+    append_resp_head(head_);
+    buffers.emplace_back(asio::buffer(head_));
+  }
+
   void append_header_str(auto &resp_str, auto &resp_headers) {
     for (auto &[k, v] : resp_headers) {
       resp_str.append(k);
@@ -284,7 +239,10 @@ class coro_http_response {
     }
   }
 
-  void build_resp_head(std::vector<asio::const_buffer> &buffers) {
+  // Build the header list of a http2 response, ":status" is the first field.
+  // The content is owned by the response after this call, so it can be sent
+  // later under http2 flow control.
+  void build_http2_head(std::vector<resp_header_sv> &headers) {
     bool has_len = false;
     bool has_host = false;
     check_header(resp_headers_, has_len, has_host);
@@ -292,71 +250,45 @@ class coro_http_response {
       check_header(resp_header_span_, has_len, has_host);
     }
 
-    if (!has_host) {
-      buffers.emplace_back(asio::buffer(CINATRA_HOST_SV));
-    }
-
-    if (content_.empty() && !has_set_content_ &&
-        fmt_type_ != format_type::chunked) {
+    if (content_.empty() && !has_set_content_) {
       content_.append(default_status_content(status_));
     }
-
-    if (fmt_type_ == format_type::chunked) {
-      buffers.emplace_back(asio::buffer(TRANSFER_ENCODING_SV));
+    if (content_.empty() && !content_view_.empty()) {
+      content_.assign(content_view_);
     }
-    else {
-      if (!cookies_.empty()) {
-        for (auto &[_, cookie] : cookies_) {
-          resp_headers_.emplace_back(
-              resp_header{"Set-Cookie", cookie.to_string()});
-        }
-      }
+    content_view_ = {};
 
-      if (!content_.empty()) {
-        if (!has_len)
-          handle_content_len(buffers, content_);
-      }
-      else if (!content_view_.empty()) {
-        if (!has_len)
-          handle_content_len(buffers, content_view_);
-      }
-      else {
-        if (!has_len && boundary_.empty())
-          buffers.emplace_back(asio::buffer(ZERO_LENGTH_SV));
-      }
+    for (auto &[_, cookie] : cookies_) {
+      resp_headers_.emplace_back(resp_header{"Set-Cookie", cookie.to_string()});
     }
 
-    if (need_date_) {
-      buffers.emplace_back(asio::buffer(DATE_SV));
-      buffers.emplace_back(asio::buffer(get_gmt_time_str()));
-      buffers.emplace_back(asio::buffer(CRCF));
+    headers.push_back({":status", to_http_status_string(status_).substr(9, 3)});
+    if (!has_host) {
+      headers.push_back({"server", "cinatra"});
     }
-
-    if (keepalive_.has_value()) {
-      bool keepalive = keepalive_.value();
-      keepalive ? buffers.emplace_back(asio::buffer(CONN_KEEP_SV))
-                : buffers.emplace_back(asio::buffer(CONN_CLOSE_SV));
+    if (!has_len) {
+      auto [ptr, ec] = std::to_chars(buf_, buf_ + 32, content_.size());
+      headers.push_back(
+          {"content-length", std::string_view(buf_, std::distance(buf_, ptr))});
+    }
+    if (need_date_) {
+      headers.push_back({"date", get_gmt_time_str()});
     }
-
     if (!content_type_.empty()) {
-      buffers.emplace_back(asio::buffer(content_type_));
+      // "Content-Type: xxx\r\n"
+      auto pos = content_type_.find(COLON_SV);
+      headers.push_back(
+          {"content-type",
+           content_type_.substr(pos + COLON_SV.size(),
+                                content_type_.size() - pos - COLON_SV.size() -
+                                    CRCF.size())});
     }
 
-    append_header(buffers, resp_headers_);
-
-    if (!resp_header_span_.empty()) {
-      append_header(buffers, resp_header_span_);
+    for (auto &[k, v] : resp_headers_) {
+      headers.push_back({k, v});
     }
-
-    buffers.emplace_back(asio::buffer(CRCF));
-  }
-
-  void append_header(auto &buffers, auto &resp_headers) {
-    for (auto &[k, v] : resp_headers) {
-      buffers.emplace_back(asio::buffer(k));
-      buffers.emplace_back(asio::buffer(COLON_SV));
-      buffers.emplace_back(asio::buffer(v));
-      buffers.emplace_back(asio::buffer(CRCF));
+    for (auto &[k, v] : resp_header_span_) {
+      headers.push_back({k, v});
     }
   }
 
@@ -377,6 +309,8 @@ class coro_http_response {
     has_set_content_ = false;
     cookies_.clear();
     need_date_ = true;
+    content_type_ = {};
+    content_type_index_ = -1;
   }
 
   void set_shrink_to_fit(bool r) { need_shrink_every_time_ = r; }
@@ -403,13 +337,73 @@ class coro_http_response {
     }
   }
 
-  void handle_content_len(std::vector<asio::const_buffer> &buffers,
-                          std::string_view content) {
-    auto [ptr, ec] = std::to_chars(buf_, buf_ + 32, content.size());
-    buffers.emplace_back(asio::buffer(CONTENT_LENGTH_SV));
-    buffers.emplace_back(
-        asio::buffer(std::string_view(buf_, std::distance(buf_, ptr))));
-    buffers.emplace_back(asio::buffer(CRCF));
+  void append_resp_head(std::string &head) {
+    bool has_len = false;
+    bool has_host = false;
+    check_header(resp_headers_, has_len, has_host);
+    if (!resp_header_span_.empty()) {
+      check_header(resp_header_span_, has_len, has_host);
+    }
+
+    std::string_view head_template;
+    if (!has_host) {
+      head_template = get_resp_head_template(status_, content_type_index_);
+    }
+    if (!head_template.empty()) {
+      head.append(head_template);
+    }
+    else {
+      head.append(to_http_status_string(status_));
+      if (!has_host) {
+        head.append(CINATRA_HOST_SV);
+      }
+      head.append(content_type_);
+    }
+
+    if (content_.empty() && !has_set_content_ &&
+        fmt_type_ != format_type::chunked) {
+      content_.append(default_status_content(status_));
+    }
+
+    if (fmt_type_ == format_type::chunked) {
+      head.append(TRANSFER_ENCODING_SV);
+    }
+    else if (!has_len) {
+      if (!content_.empty() || !content_view_.empty()) {
+        size_t content_size =
+            content_.empty() ? content_view_.size() : content_.size();
+        auto [ptr, ec] = std::to_chars(buf_, buf_ + 32, content_size);
+        head.append(CONTENT_LENGTH_SV);
+        head.append(std::string_view(buf_, std::distance(buf_, ptr)));
+        head.append(CRCF);
+      }
+      else if (boundary_.empty()) {
+        head.append(ZERO_LENGTH_SV);
+      }
+    }
+
+    if (need_date_) {
+      head.append(get_date_header_str());
+    }
+
+    if (keepalive_.has_value()) {
+      bool keepalive = keepalive_.value();
+      keepalive ? head.append(CONN_KEEP_SV) : head.append(CONN_CLOSE_SV);
+    }
+
+    append_header_str(head, resp_headers_);
+
+    if (!resp_header_span_.empty()) {
+      append_header_str(head, resp_header_span_);
+    }
+
+    for (auto &[_, cookie] : cookies_) {
+      head.append("Set-Cookie: ");
+      head.append(cookie.to_string());
+      head.append(CRCF);
+    }
+
+    head.append(CRCF);
   }
 
   status_type status_;
@@ -427,6 +421,8 @@ class coro_http_response {
   bool need_date_ = true;
   std::unordered_map<std::string, cookie> cookies_;
   std::string_view content_type_;
+  int content_type_index_ = -1;
   std::string_view content_view_;
+  std::string head_;
 };
 }  // namespace cinatra
@@ -148,6 +148,58 @@ class coro_http_router {
     }
   }
 
+  // The body of the requests matched by key isn't read before calling the
+  // handler, the handler reads it by coro_http_request::read_body_some.
+  template <http_method method>
+  void set_stream_body(std::string key) {
+    constexpr auto method_name = cinatra::method_name(method);
+    std::string whole_str;
+    whole_str.append(method_name).append(" ").append(key);
+
+    if (whole_str.find(':') != std::string::npos) {
+      std::string method_str(method_name);
+      stream_body_tree_->insert(
+          whole_str, [](coro_http_request&, coro_http_response&) {},
+          method_str);
+    }
+    else if (whole_str.find("{") != std::string::npos ||
+             whole_str.find(")") != std::string::npos) {
+      if (whole_str.find("{}") != std::string::npos) {
+        replace_all(whole_str, "{}", "([^/]+)");
+      }
+      stream_body_regexs_.emplace_back(whole_str);
+    }
+    else {
+      stream_body_keys_.emplace(std::move(whole_str));
+    }
+    has_stream_body_ = true;
+  }
+
+  bool has_stream_body() const { return has_stream_body_; }
+
+  bool is_stream_body(std::string_view key) {
+    if (!has_stream_body_) {
+      return false;
+    }
+
+    if (stream_body_keys_.find(key) != stream_body_keys_.end()) {
+      return true;
+    }
+
+    std::string whole_str(key);
+    std::string method_str(key.substr(0, key.find(' ')));
+    if (std::get<0>(stream_body_tree_->get(whole_str, method_str))) {
+      return true;
+    }
+
+    for (auto& regex : stream_body_regexs_) {
+      if (std::regex_match(whole_str, regex)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
   template <typename T>
   void do_before(T& aspect, coro_http_request& req, coro_http_response& resp,
                  bool& ok) {
@@ -256,5 +308,11 @@ class coro_http_router {
       std::regex, std::function<async_simple::coro::Lazy<void>(
                       coro_http_request& req, coro_http_response& resp)>>>
       coro_regex_handles_;
+
+  bool has_stream_body_ = false;
+  std::set<std::string, std::less<>> stream_body_keys_;
+  std::shared_ptr<radix_tree> stream_body_tree_ =
+      std::make_shared<radix_tree>(radix_tree());
+  std::vector<std::regex> stream_body_regexs_;
 };
 }  // namespace cinatra
\ No newline at end of file
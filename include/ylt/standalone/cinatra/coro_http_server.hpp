@@ -70,6 +70,15 @@ class coro_http_server {
     max_http_body_len_ = max_size;
   }
 
+  // Serve http2 for h2c with prior knowledge, and for "h2" negotiated by ALPN
+  // when ssl is enabled. The handlers are shared with http1.
+  void enable_http2(bool r = true) {
+    enable_http2_ = r;
+#ifdef CINATRA_ENABLE_SSL
+    ssl_ctx_ = nullptr;
+#endif
+  }
+
 #ifdef CINATRA_ENABLE_SSL
   void init_ssl(const std::string& cert_file, const std::string& key_file,
                 const std::string& passwd) {
@@ -77,6 +86,7 @@ class coro_http_server {
     key_file_ = key_file;
     passwd_ = passwd;
     use_ssl_ = true;
+    ssl_ctx_ = nullptr;
   }
 
   /*!
@@ -97,6 +107,7 @@ class coro_http_server {
     enable_client_verify_ = enable_client_verify;
     passwd_ = passwd;
     use_ssl_ = true;
+    ssl_ctx_ = nullptr;
   }
 
 #ifdef YLT_ENABLE_NTLS
@@ -322,6 +333,21 @@ class coro_http_server {
     }
   }
 
+  // The request body isn't read into memory before calling the handler, the
+  // handler reads it with co_await req.read_body_some(buf), so large uploads
+  // can be piped to a file or a downstream client with bounded memory.
+  // max_http_body_size doesn't limit these requests on http/1.1.
+  template <http_method... method, typename Func, typename... Aspects>
+  void set_http_stream_handler(std::string key, Func handler,
+                               Aspects&&... asps) {
+    using return_type = typename util::function_traits<Func>::return_type;
+    static_assert(coro_io::is_lazy_v<return_type>,
+                  "the stream handler must be a coroutine");
+    (router_.set_stream_body<method>(key), ...);
+    set_http_handler<method...>(std::move(key), std::move(handler),
+                                std::forward<Aspects>(asps)...);
+  }
+
   template <http_method... method, typename... Aspects>
   void set_http_proxy_handler(std::string url_path,
                               std::vector<std::string_view> hosts,
@@ -820,6 +846,7 @@ class coro_http_server {
       conn->tcp_socket().set_option(asio::ip::tcp::no_delay(true));
     }
     conn->set_max_http_body_size(max_http_body_len_);
+    conn->enable_http2(enable_http2_);
     if (need_shrink_every_time_) {
       conn->set_shrink_to_fit(true);
     }
@@ -841,13 +868,15 @@ class coro_http_server {
 
 #ifdef CINATRA_ENABLE_SSL
     if (!is_transfer_connect && use_ssl_) {
-      if (!ca_cert_file_.empty() || enable_client_verify_) {
-        conn->init_ssl(cert_file_, key_file_, ca_cert_file_,
-                       enable_client_verify_, passwd_);
-      }
-      else {
-        conn->init_ssl(cert_file_, key_file_, passwd_);
+      // the context and its ALPN callback are set up once, on the first
+      // connection, and shared by the following ones.
+      if (!ssl_ctx_) {
+        ssl_ctx_ = coro_http_connection::make_ssl_context(
+            cert_file_, key_file_, ca_cert_file_, enable_client_verify_,
+            passwd_, enable_http2_,
+            !ca_cert_file_.empty() || enable_client_verify_);
       }
+      conn->init_ssl(ssl_ctx_);
     }
 #ifdef YLT_ENABLE_NTLS
     else if (!is_transfer_connect && use_ntls_) {
@@ -1201,6 +1230,7 @@ class coro_http_server {
   std::string ca_cert_file_;
   bool enable_client_verify_ = false;
   bool use_ssl_ = false;
+  std::shared_ptr<asio::ssl::context> ssl_ctx_;
 #ifdef YLT_ENABLE_NTLS
   bool use_ntls_ = false;
   // NTLS configuration
@@ -1233,6 +1263,7 @@ class coro_http_server {
                                                coro_http_response&)>
       default_handler_ = nullptr;
   int64_t max_http_body_len_ = INT64_MAX;
+  bool enable_http2_ = false;
 #ifdef INJECT_FOR_HTTP_SEVER_TEST
   bool write_failed_forever_ = false;
   bool read_failed_forever_ = false;
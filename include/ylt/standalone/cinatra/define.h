@@ -113,6 +113,7 @@ constexpr std::string_view DATE_SV = "Date: ";
 constexpr std::string_view CONN_KEEP_SV = "Connection: keep-alive\r\n";
 constexpr std::string_view CONN_CLOSE_SV = "Connection: close\r\n";
 constexpr std::string_view COLON_SV = ": ";
+constexpr std::string_view CONTINUE_RESP_SV = "HTTP/1.1 100 Continue\r\n\r\n";
 
 struct chunked_result {
   std::error_code ec;
@@ -0,0 +1,573 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "http2_define.h"
+
+// HPACK: Header Compression for HTTP/2, see RFC 7541.
+namespace cinatra {
+struct hpack_header {
+  std::string name;
+  std::string value;
+};
+
+namespace detail {
+struct hpack_huffman_code {
+  uint32_t code;
+  uint8_t len;
+};
+
+// RFC 7541 Appendix B, index 256 is EOS.
+inline constexpr std::array<hpack_huffman_code, 257> hpack_huffman_codes{{
+    {0x1ff8, 13}, {0x7fffd8, 23}, {0xfffffe2, 28}, {0xfffffe3, 28},
+    {0xfffffe4, 28}, {0xfffffe5, 28}, {0xfffffe6, 28}, {0xfffffe7, 28},
+    {0xfffffe8, 28}, {0xffffea, 24}, {0x3ffffffc, 30}, {0xfffffe9, 28},
+    {0xfffffea, 28}, {0x3ffffffd, 30}, {0xfffffeb, 28}, {0xfffffec, 28},
+    {0xfffffed, 28}, {0xfffffee, 28}, {0xfffffef, 28}, {0xffffff0, 28},
+    {0xffffff1, 28}, {0xffffff2, 28}, {0x3ffffffe, 30}, {0xffffff3, 28},
+    {0xffffff4, 28}, {0xffffff5, 28}, {0xffffff6, 28}, {0xffffff7, 28},
+    {0xffffff8, 28}, {0xffffff9, 28}, {0xffffffa, 28}, {0xffffffb, 28},
+    {0x14, 6}, {0x3f8, 10}, {0x3f9, 10}, {0xffa, 12}, {0x1ff9, 13}, {0x15, 6},
+    {0xf8, 8}, {0x7fa, 11}, {0x3fa, 10}, {0x3fb, 10}, {0xf9, 8}, {0x7fb, 11},
+    {0xfa, 8}, {0x16, 6}, {0x17, 6}, {0x18, 6}, {0x0, 5}, {0x1, 5}, {0x2, 5},
+    {0x19, 6}, {0x1a, 6}, {0x1b, 6}, {0x1c, 6}, {0x1d, 6}, {0x1e, 6},
+    {0x1f, 6}, {0x5c, 7}, {0xfb, 8}, {0x7ffc, 15}, {0x20, 6}, {0xffb, 12},
+    {0x3fc, 10}, {0x1ffa, 13}, {0x21, 6}, {0x5d, 7}, {0x5e, 7}, {0x5f, 7},
+    {0x60, 7}, {0x61, 7}, {0x62, 7}, {0x63, 7}, {0x64, 7}, {0x65, 7},
+    {0x66, 7}, {0x67, 7}, {0x68, 7}, {0x69, 7}, {0x6a, 7}, {0x6b, 7},
+    {0x6c, 7}, {0x6d, 7}, {0x6e, 7}, {0x6f, 7}, {0x70, 7}, {0x71, 7},
+    {0x72, 7}, {0xfc, 8}, {0x73, 7}, {0xfd, 8}, {0x1ffb, 13}, {0x7fff0, 19},
+    {0x1ffc, 13}, {0x3ffc, 14}, {0x22, 6}, {0x7ffd, 15}, {0x3, 5}, {0x23, 6},
+    {0x4, 5}, {0x24, 6}, {0x5, 5}, {0x25, 6}, {0x26, 6}, {0x27, 6}, {0x6, 5},
+    {0x74, 7}, {0x75, 7}, {0x28, 6}, {0x29, 6}, {0x2a, 6}, {0x7, 5}, {0x2b, 6},
+    {0x76, 7}, {0x2c, 6}, {0x8, 5}, {0x9, 5}, {0x2d, 6}, {0x77, 7}, {0x78, 7},
+    {0x79, 7}, {0x7a, 7}, {0x7b, 7}, {0x7ffe, 15}, {0x7fc, 11}, {0x3ffd, 14},
+    {0x1ffd, 13}, {0xffffffc, 28}, {0xfffe6, 20}, {0x3fffd2, 22},
+    {0xfffe7, 20}, {0xfffe8, 20}, {0x3fffd3, 22}, {0x3fffd4, 22},
+    {0x3fffd5, 22}, {0x7fffd9, 23}, {0x3fffd6, 22}, {0x7fffda, 23},
+    {0x7fffdb, 23}, {0x7fffdc, 23}, {0x7fffdd, 23}, {0x7fffde, 23},
+    {0xffffeb, 24}, {0x7fffdf, 23}, {0xffffec, 24}, {0xffffed, 24},
+    {0x3fffd7, 22}, {0x7fffe0, 23}, {0xffffee, 24}, {0x7fffe1, 23},
+    {0x7fffe2, 23}, {0x7fffe3, 23}, {0x7fffe4, 23}, {0x1fffdc, 21},
+    {0x3fffd8, 22}, {0x7fffe5, 23}, {0x3fffd9, 22}, {0x7fffe6, 23},
+    {0x7fffe7, 23}, {0xffffef, 24}, {0x3fffda, 22}, {0x1fffdd, 21},
+    {0xfffe9, 20}, {0x3fffdb, 22}, {0x3fffdc, 22}, {0x7fffe8, 23},
+    {0x7fffe9, 23}, {0x1fffde, 21}, {0x7fffea, 23}, {0x3fffdd, 22},
+    {0x3fffde, 22}, {0xfffff0, 24}, {0x1fffdf, 21}, {0x3fffdf, 22},
+    {0x7fffeb, 23}, {0x7fffec, 23}, {0x1fffe0, 21}, {0x1fffe1, 21},
+    {0x3fffe0, 22}, {0x1fffe2, 21}, {0x7fffed, 23}, {0x3fffe1, 22},
+    {0x7fffee, 23}, {0x7fffef, 23}, {0xfffea, 20}, {0x3fffe2, 22},
+    {0x3fffe3, 22}, {0x3fffe4, 22}, {0x7ffff0, 23}, {0x3fffe5, 22},
+    {0x3fffe6, 22}, {0x7ffff1, 23}, {0x3ffffe0, 26}, {0x3ffffe1, 26},
+    {0xfffeb, 20}, {0x7fff1, 19}, {0x3fffe7, 22}, {0x7ffff2, 23},
+    {0x3fffe8, 22}, {0x1ffffec, 25}, {0x3ffffe2, 26}, {0x3ffffe3, 26},
+    {0x3ffffe4, 26}, {0x7ffffde, 27}, {0x7ffffdf, 27}, {0x3ffffe5, 26},
+    {0xfffff1, 24}, {0x1ffffed, 25}, {0x7fff2, 19}, {0x1fffe3, 21},
+    {0x3ffffe6, 26}, {0x7ffffe0, 27}, {0x7ffffe1, 27}, {0x3ffffe7, 26},
+    {0x7ffffe2, 27}, {0xfffff2, 24}, {0x1fffe4, 21}, {0x1fffe5, 21},
+    {0x3ffffe8, 26}, {0x3ffffe9, 26}, {0xffffffd, 28}, {0x7ffffe3, 27},
+    {0x7ffffe4, 27}, {0x7ffffe5, 27}, {0xfffec, 20}, {0xfffff3, 24},
+    {0xfffed, 20}, {0x1fffe6, 21}, {0x3fffe9, 22}, {0x1fffe7, 21},
+    {0x1fffe8, 21}, {0x7ffff3, 23}, {0x3fffea, 22}, {0x3fffeb, 22},
+    {0x1ffffee, 25}, {0x1ffffef, 25}, {0xfffff4, 24}, {0xfffff5, 24},
+    {0x3ffffea, 26}, {0x7ffff4, 23}, {0x3ffffeb, 26}, {0x7ffffe6, 27},
+    {0x3ffffec, 26}, {0x3ffffed, 26}, {0x7ffffe7, 27}, {0x7ffffe8, 27},
+    {0x7ffffe9, 27}, {0x7ffffea, 27}, {0x7ffffeb, 27}, {0xffffffe, 28},
+    {0x7ffffec, 27}, {0x7ffffed, 27}, {0x7ffffee, 27}, {0x7ffffef, 27},
+    {0x7fffff0, 27}, {0x3ffffee, 26}, {0x3fffffff, 30}
+}};
+
+// The HPACK huffman code is canonical and the symbols of the same code length
+// are sorted, so a symbol can be decoded by checking the code ranges of each
+// length instead of walking a bit tree.
+struct hpack_huffman_decode_table {
+  std::array<uint32_t, 31> first_code{};
+  std::array<uint16_t, 31> count{};
+  std::array<uint16_t, 31> offset{};
+  std::array<uint16_t, 257> symbols{};
+};
+
+inline constexpr hpack_huffman_decode_table make_hpack_huffman_decode_table() {
+  hpack_huffman_decode_table table{};
+  for (auto &code : table.first_code) {
+    code = UINT32_MAX;
+  }
+  for (const auto &[code, len] : hpack_huffman_codes) {
+    table.count[len]++;
+    if (code < table.first_code[len]) {
+      table.first_code[len] = code;
+    }
+  }
+  uint16_t offset = 0;
+  for (size_t len = 0; len < table.offset.size(); ++len) {
+    table.offset[len] = offset;
+    offset += table.count[len];
+  }
+  std::array<uint16_t, 31> filled{};
+  for (uint16_t sym = 0; sym < hpack_huffman_codes.size(); ++sym) {
+    auto len = hpack_huffman_codes[sym].len;
+    table.symbols[table.offset[len] + filled[len]++] = sym;
+  }
+  return table;
+}
+
+inline constexpr hpack_huffman_decode_table hpack_huffman_table =
+    make_hpack_huffman_decode_table();
+
+inline constexpr char hpack_to_lower(char c) {
+  return (c >= 'A' && c <= 'Z') ? char(c + ('a' - 'A')) : c;
+}
+
+inline constexpr bool hpack_iequal(std::string_view a, std::string_view b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.size(); ++i) {
+    if (hpack_to_lower(a[i]) != b[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+}  // namespace detail
+
+// RFC 7541 Appendix A.
+inline constexpr std::array<std::pair<std::string_view, std::string_view>, 61>
+    hpack_static_table{{{":authority", ""},
+                        {":method", "GET"},
+                        {":method", "POST"},
+                        {":path", "/"},
+                        {":path", "/index.html"},
+                        {":scheme", "http"},
+                        {":scheme", "https"},
+                        {":status", "200"},
+                        {":status", "204"},
+                        {":status", "206"},
+                        {":status", "304"},
+                        {":status", "400"},
+                        {":status", "404"},
+                        {":status", "500"},
+                        {"accept-charset", ""},
+                        {"accept-encoding", "gzip, deflate"},
+                        {"accept-language", ""},
+                        {"accept-ranges", ""},
+                        {"accept", ""},
+                        {"access-control-allow-origin", ""},
+                        {"age", ""},
+                        {"allow", ""},
+                        {"authorization", ""},
+                        {"cache-control", ""},
+                        {"content-disposition", ""},
+                        {"content-encoding", ""},
+                        {"content-language", ""},
+                        {"content-length", ""},
+                        {"content-location", ""},
+                        {"content-range", ""},
+                        {"content-type", ""},
+                        {"cookie", ""},
+                        {"date", ""},
+                        {"etag", ""},
+                        {"expect", ""},
+                        {"expires", ""},
+                        {"from", ""},
+                        {"host", ""},
+                        {"if-match", ""},
+                        {"if-modified-since", ""},
+                        {"if-none-match", ""},
+                        {"if-range", ""},
+                        {"if-unmodified-since", ""},
+                        {"last-modified", ""},
+                        {"link", ""},
+                        {"location", ""},
+                        {"max-forwards", ""},
+                        {"proxy-authenticate", ""},
+                        {"proxy-authorization", ""},
+                        {"range", ""},
+                        {"referer", ""},
+                        {"refresh", ""},
+                        {"retry-after", ""},
+                        {"server", ""},
+                        {"set-cookie", ""},
+                        {"strict-transport-security", ""},
+                        {"transfer-encoding", ""},
+                        {"user-agent", ""},
+                        {"vary", ""},
+                        {"via", ""},
+                        {"www-authenticate", ""}}};
+
+inline size_t hpack_huffman_encoded_size(std::string_view str,
+                                         bool to_lower = false) {
+  size_t bits = 0;
+  for (char ch : str) {
+    auto c = static_cast<unsigned char>(to_lower ? detail::hpack_to_lower(ch)
+                                                 : ch);
+    bits += detail::hpack_huffman_codes[c].len;
+  }
+  return (bits + 7) / 8;
+}
+
+inline void hpack_huffman_encode(std::string_view str, std::string &out,
+                                 bool to_lower = false) {
+  uint64_t acc = 0;
+  uint32_t bits = 0;
+  for (char ch : str) {
+    auto c = static_cast<unsigned char>(to_lower ? detail::hpack_to_lower(ch)
+                                                 : ch);
+    const auto &[code, len] = detail::hpack_huffman_codes[c];
+    acc = (acc << len) | code;
+    bits += len;
+    while (bits >= 8) {
+      bits -= 8;
+      out.push_back(static_cast<char>(acc >> bits));
+    }
+  }
+  if (bits > 0) {
+    // pad with the most significant bits of EOS.
+    out.push_back(static_cast<char>((acc << (8 - bits)) | (0xff >> bits)));
+  }
+}
+
+inline bool hpack_huffman_decode(std::string_view str, std::string &out) {
+  const auto &table = detail::hpack_huffman_table;
+  uint64_t acc = 0;
+  uint32_t bits = 0;
+  size_t pos = 0;
+  while (true) {
+    while (bits <= 56 && pos < str.size()) {
+      acc = (acc << 8) | static_cast<unsigned char>(str[pos++]);
+      bits += 8;
+    }
+
+    bool found = false;
+    for (uint32_t len = 5; len <= 30 && len <= bits; ++len) {
+      auto code =
+          static_cast<uint32_t>(acc >> (bits - len)) & ((1u << len) - 1);
+      if (code - table.first_code[len] < table.count[len]) {
+        auto sym = table.symbols[table.offset[len] + code -
+                                 table.first_code[len]];
+        if (sym == 256) {
+          // EOS must not appear in a string literal.
+          return false;
+        }
+        out.push_back(static_cast<char>(sym));
+        bits -= len;
+        found = true;
+        break;
+      }
+    }
+
+    if (!found) {
+      // the rest must be padding: less than 8 bits and all ones.
+      if (pos < str.size() || bits > 7) {
+        return false;
+      }
+      uint64_t mask = (uint64_t(1) << bits) - 1;
+      return (acc & mask) == mask;
+    }
+  }
+}
+
+inline void hpack_encode_integer(std::string &out, uint64_t value,
+                                 uint8_t prefix_bits, uint8_t flags) {
+  uint64_t max_prefix = (uint64_t(1) << prefix_bits) - 1;
+  if (value < max_prefix) {
+    out.push_back(static_cast<char>(flags | value));
+    return;
+  }
+
+  out.push_back(static_cast<char>(flags | max_prefix));
+  value -= max_prefix;
+  while (value >= 128) {
+    out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+    value >>= 7;
+  }
+  out.push_back(static_cast<char>(value));
+}
+
+inline bool hpack_decode_integer(const uint8_t *&p, const uint8_t *end,
+                                 uint8_t prefix_bits, uint64_t &value) {
+  if (p == end) {
+    return false;
+  }
+
+  uint64_t max_prefix = (uint64_t(1) << prefix_bits) - 1;
+  value = *p++ & max_prefix;
+  if (value < max_prefix) {
+    return true;
+  }
+
+  uint32_t shift = 0;
+  while (p != end) {
+    uint8_t b = *p++;
+    value += uint64_t(b & 0x7f) << shift;
+    if ((b & 0x80) == 0) {
+      return true;
+    }
+    shift += 7;
+    if (shift > 28) {
+      // no sane header block needs an integer beyond 2^35.
+      return false;
+    }
+  }
+  return false;
+}
+
+class hpack_dynamic_table {
+ public:
+  explicit hpack_dynamic_table(size_t max_size = HTTP2_DEFAULT_HEADER_TABLE_SIZE)
+      : max_size_(max_size) {}
+
+  // RFC 7541 4.1, the size of an entry is name + value + 32.
+  static size_t entry_size(const hpack_header &header) {
+    return header.name.size() + header.value.size() + 32;
+  }
+
+  void set_max_size(size_t max_size) {
+    max_size_ = max_size;
+    evict(0);
+  }
+
+  void insert(hpack_header header) {
+    size_t size = entry_size(header);
+    if (size > max_size_) {
+      entries_.clear();
+      size_ = 0;
+      return;
+    }
+
+    evict(size);
+    size_ += size;
+    entries_.push_front(std::move(header));
+  }
+
+  // index 0 is the newest entry.
+  const hpack_header *get(size_t index) const {
+    if (index >= entries_.size()) {
+      return nullptr;
+    }
+    return &entries_[index];
+  }
+
+  size_t count() const { return entries_.size(); }
+
+  size_t size() const { return size_; }
+
+  size_t max_size() const { return max_size_; }
+
+ private:
+  void evict(size_t need) {
+    while (!entries_.empty() && size_ + need > max_size_) {
+      size_ -= entry_size(entries_.back());
+      entries_.pop_back();
+    }
+  }
+
+  std::deque<hpack_header> entries_;
+  size_t size_ = 0;
+  size_t max_size_;
+};
+
+class hpack_decoder {
+ public:
+  explicit hpack_decoder(
+      size_t max_table_size = HTTP2_DEFAULT_HEADER_TABLE_SIZE)
+      : table_(max_table_size), max_table_size_(max_table_size) {}
+
+  // Bound the decoded header list of a block: the size, the sum of the name
+  // and value lengths plus 32 of every field as RFC 9113 6.5.2 counts it, and
+  // the count of the fields. A small block can reference a large dynamic table
+  // entry many times, so the block size alone doesn't bound it.
+  void set_max_header_list(size_t max_size, size_t max_count) {
+    max_list_size_ = max_size;
+    max_list_count_ = max_count;
+  }
+
+  // Decode a complete header block, the fields are appended to headers.
+  bool decode(std::string_view block, std::vector<hpack_header> &headers) {
+    auto p = reinterpret_cast<const uint8_t *>(block.data());
+    auto end = p + block.size();
+    bool allow_size_update = true;
+    size_t list_size = 0;
+    size_t list_count = 0;
+    too_large_ = false;
+    while (p != end) {
+      uint8_t b = *p;
+      uint64_t index = 0;
+      if ((b & 0xe0) != 0x20 && ++list_count > max_list_count_) {
+        too_large_ = true;
+        return false;
+      }
+      if (b & 0x80) {
+        // indexed header field
+        if (!hpack_decode_integer(p, end, 7, index) || index == 0) {
+          return false;
+        }
+        auto &header = headers.emplace_back();
+        if (!get_indexed(index, header.name, header.value) ||
+            !add_list_size(header, list_size)) {
+          return false;
+        }
+        allow_size_update = false;
+        continue;
+      }
+
+      if ((b & 0xe0) == 0x20) {
+        // dynamic table size update, only at the beginning of a block.
+        if (!allow_size_update || !hpack_decode_integer(p, end, 5, index) ||
+            index > max_table_size_) {
+          return false;
+        }
+        table_.set_max_size(index);
+        continue;
+      }
+
+      allow_size_update = false;
+      bool need_index = (b & 0xc0) == 0x40;
+      if (!hpack_decode_integer(p, end, need_index ? 6 : 4, index)) {
+        return false;
+      }
+
+      auto &header = headers.emplace_back();
+      if (index == 0) {
+        if (!read_string(p, end, header.name)) {
+          return false;
+        }
+      }
+      else {
+        std::string value;
+        if (!get_indexed(index, header.name, value)) {
+          return false;
+        }
+      }
+
+      if (!read_string(p, end, header.value) ||
+          !add_list_size(header, list_size)) {
+        return false;
+      }
+
+      if (need_index) {
+        table_.insert(header);
+      }
+    }
+    return true;
+  }
+
+  const hpack_dynamic_table &table() const { return table_; }
+
+  // The last decode failed since the header list exceeds the bound.
+  bool too_large() const { return too_large_; }
+
+ private:
+  bool add_list_size(const hpack_header &header, size_t &list_size) {
+    list_size += header.name.size() + header.value.size() + 32;
+    if (list_size > max_list_size_) {
+      too_large_ = true;
+      return false;
+    }
+    return true;
+  }
+
+  bool get_indexed(uint64_t index, std::string &name, std::string &value) {
+    if (index <= hpack_static_table.size()) {
+      auto &[k, v] = hpack_static_table[index - 1];
+      name = k;
+      value = v;
+      return true;
+    }
+
+    auto header = table_.get(index - hpack_static_table.size() - 1);
+    if (header == nullptr) {
+      return false;
+    }
+    name = header->name;
+    value = header->value;
+    return true;
+  }
+
+  bool read_string(const uint8_t *&p, const uint8_t *end, std::string &out) {
+    if (p == end) {
+      return false;
+    }
+
+    bool huffman = (*p & 0x80) != 0;
+    uint64_t len = 0;
+    if (!hpack_decode_integer(p, end, 7, len) ||
+        len > static_cast<uint64_t>(end - p)) {
+      return false;
+    }
+
+    std::string_view str(reinterpret_cast<const char *>(p), len);
+    p += len;
+    if (huffman) {
+      out.clear();
+      return hpack_huffman_decode(str, out);
+    }
+    out.assign(str);
+    return true;
+  }
+
+  hpack_dynamic_table table_;
+  size_t max_table_size_;
+  size_t max_list_size_ = SIZE_MAX;
+  size_t max_list_count_ = SIZE_MAX;
+  bool too_large_ = false;
+};
+
+// The encoder doesn't use the dynamic table, every field is either an exact
+// static table match or a literal without indexing, so it keeps no state
+// which needs to be synchronized with the peer.
+class hpack_encoder {
+ public:
+  void encode(std::string_view name, std::string_view value,
+              std::string &out) {
+    size_t name_index = 0;
+    for (size_t i = 0; i < hpack_static_table.size(); ++i) {
+      auto &[k, v] = hpack_static_table[i];
+      if (!detail::hpack_iequal(name, k)) {
+        continue;
+      }
+      if (v == value && !v.empty()) {
+        hpack_encode_integer(out, i + 1, 7, 0x80);
+        return;
+      }
+      if (name_index == 0) {
+        name_index = i + 1;
+      }
+    }
+
+    if (name_index != 0) {
+      hpack_encode_integer(out, name_index, 4, 0x00);
+    }
+    else {
+      out.push_back(0x00);
+      write_string(name, out, true);
+    }
+    write_string(value, out, false);
+  }
+
+ private:
+  void write_string(std::string_view str, std::string &out, bool to_lower) {
+    size_t huffman_len = hpack_huffman_encoded_size(str, to_lower);
+    if (huffman_len < str.size()) {
+      hpack_encode_integer(out, huffman_len, 7, 0x80);
+      hpack_huffman_encode(str, out, to_lower);
+      return;
+    }
+
+    hpack_encode_integer(out, str.size(), 7, 0x00);
+    if (to_lower) {
+      for (char c : str) {
+        out.push_back(detail::hpack_to_lower(c));
+      }
+    }
+    else {
+      out.append(str);
+    }
+  }
+};
+}  // namespace cinatra
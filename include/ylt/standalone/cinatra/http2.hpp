@@ -0,0 +1,715 @@
+#pragma once
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "cinatra_log_wrapper.hpp"
+#include "coro_http_request.hpp"
+#include "coro_http_response.hpp"
+#include "hpack.hpp"
+#include "http2_define.h"
+#include "http_parser.hpp"
+
+namespace cinatra {
+inline http2_frame_header parse_http2_frame_header(const char *data) {
+  auto p = reinterpret_cast<const uint8_t *>(data);
+  http2_frame_header header;
+  header.length = (uint32_t(p[0]) << 16) | (uint32_t(p[1]) << 8) | p[2];
+  header.type = static_cast<http2_frame_type>(p[3]);
+  header.flags = p[4];
+  header.stream_id = ((uint32_t(p[5]) << 24) | (uint32_t(p[6]) << 16) |
+                      (uint32_t(p[7]) << 8) | p[8]) &
+                     0x7fffffff;
+  return header;
+}
+
+inline uint32_t read_http2_uint32(const char *data) {
+  auto p = reinterpret_cast<const uint8_t *>(data);
+  return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) |
+         (uint32_t(p[2]) << 8) | p[3];
+}
+
+inline void append_http2_uint32(std::string &out, uint32_t value) {
+  out.push_back(static_cast<char>(value >> 24));
+  out.push_back(static_cast<char>(value >> 16));
+  out.push_back(static_cast<char>(value >> 8));
+  out.push_back(static_cast<char>(value));
+}
+
+inline void append_http2_frame_header(std::string &out, uint32_t length,
+                                      http2_frame_type type, uint8_t flags,
+                                      uint32_t stream_id) {
+  out.push_back(static_cast<char>(length >> 16));
+  out.push_back(static_cast<char>(length >> 8));
+  out.push_back(static_cast<char>(length));
+  out.push_back(static_cast<char>(type));
+  out.push_back(static_cast<char>(flags));
+  append_http2_uint32(out, stream_id & 0x7fffffff);
+}
+
+enum class http2_stream_state {
+  open,
+  half_closed_remote,
+  closed,
+};
+
+struct http2_stream {
+  http2_stream(uint32_t stream_id, coro_http_connection *conn,
+               int64_t send_window_size, int64_t recv_window_size)
+      : id(stream_id),
+        request(parser, conn),
+        response(conn),
+        send_window(send_window_size),
+        recv_window(recv_window_size) {}
+
+  uint32_t id;
+  http2_stream_state state = http2_stream_state::open;
+  // "method path", the parser refers to it.
+  std::string request_line;
+  std::vector<hpack_header> headers;
+  std::vector<http_header> header_views;
+  std::string body;
+  http_parser parser;
+  coro_http_request request;
+  coro_http_response response;
+  int64_t send_window;
+  int64_t recv_window;
+  uint32_t recv_unacked = 0;
+  // the handler is running, the stream can't be released.
+  bool handling = false;
+  bool response_submitted = false;
+  std::string_view pending_data;
+};
+
+// The protocol state of a server side http2 connection. It only consumes
+// frames and produces the bytes to write, the io is done by
+// coro_http_connection.
+class http2_session {
+ public:
+  http2_session(coro_http_connection *conn, int64_t max_http_body_len)
+      : conn_(conn), max_http_body_len_(max_http_body_len) {
+    local_settings_.enable_push = 0;
+    local_settings_.max_concurrent_streams = 128;
+    local_settings_.initial_window_size = 1024 * 1024;
+    local_settings_.max_header_list_size = CINATRA_HTTP2_MAX_HEADER_LIST_SIZE;
+    // the regular fields and the 4 pseudo-header fields of a request.
+    decoder_.set_max_header_list(local_settings_.max_header_list_size,
+                                 CINATRA_MAX_HTTP_HEADER_FIELD_SIZE + 4);
+  }
+
+  // The server connection preface.
+  void start() {
+    std::string payload;
+    append_setting(payload, http2_settings_id::enable_push,
+                   local_settings_.enable_push);
+    append_setting(payload, http2_settings_id::max_concurrent_streams,
+                   local_settings_.max_concurrent_streams);
+    append_setting(payload, http2_settings_id::initial_window_size,
+                   local_settings_.initial_window_size);
+    append_setting(payload, http2_settings_id::max_header_list_size,
+                   local_settings_.max_header_list_size);
+    append_http2_frame_header(output_, payload.size(),
+                              http2_frame_type::settings, 0, 0);
+    output_.append(payload);
+
+    conn_recv_window_ = local_conn_window_;
+    send_window_update(0, local_conn_window_ - HTTP2_DEFAULT_WINDOW_SIZE);
+  }
+
+  // Handle one complete frame, returns a connection error or no_error.
+  http2_error_code on_frame(const http2_frame_header &header,
+                            std::string_view payload) {
+    if (continuation_stream_ != 0 &&
+        (header.type != http2_frame_type::continuation ||
+         header.stream_id != continuation_stream_)) {
+      return http2_error_code::protocol_error;
+    }
+
+    switch (header.type) {
+      case http2_frame_type::data:
+        return on_data(header, payload);
+      case http2_frame_type::headers:
+        return on_headers(header, payload);
+      case http2_frame_type::priority:
+        if (header.stream_id == 0) {
+          return http2_error_code::protocol_error;
+        }
+        if (payload.size() != 5) {
+          reset_stream(header.stream_id, http2_error_code::frame_size_error);
+        }
+        return http2_error_code::no_error;
+      case http2_frame_type::rst_stream:
+        return on_rst_stream(header, payload);
+      case http2_frame_type::settings:
+        return on_settings(header, payload);
+      case http2_frame_type::push_promise:
+        // a client can't push.
+        return http2_error_code::protocol_error;
+      case http2_frame_type::ping:
+        return on_ping(header, payload);
+      case http2_frame_type::goaway:
+        if (header.stream_id != 0) {
+          return http2_error_code::protocol_error;
+        }
+        goaway_received_ = true;
+        return http2_error_code::no_error;
+      case http2_frame_type::window_update:
+        return on_window_update(header, payload);
+      case http2_frame_type::continuation:
+        return on_continuation(header, payload);
+      default:
+        // unknown frame types must be ignored.
+        return http2_error_code::no_error;
+    }
+  }
+
+  // The streams whose request is complete and waits for a handler.
+  std::vector<http2_stream *> &ready_streams() { return ready_streams_; }
+
+  // Encode the response of a finished handler, the body is sent as far as
+  // flow control allows, the rest is sent on WINDOW_UPDATE.
+  void submit_response(http2_stream &stream) {
+    stream.handling = false;
+    if (stream.state == http2_stream_state::closed) {
+      streams_.erase(stream.id);
+      return;
+    }
+
+    resp_headers_.clear();
+    stream.response.build_http2_head(resp_headers_);
+    resp_block_.clear();
+    for (auto &[k, v] : resp_headers_) {
+      if (is_connection_header(k)) {
+        continue;
+      }
+      encoder_.encode(k, v, resp_block_);
+    }
+
+    if (stream.parser.method() != "HEAD"sv) {
+      stream.pending_data = stream.response.content();
+    }
+    append_header_block(stream.id, resp_block_, stream.pending_data.empty());
+    stream.response_submitted = true;
+    if (flush_data(stream)) {
+      streams_.erase(stream.id);
+    }
+  }
+
+  void goaway(http2_error_code code) {
+    append_http2_frame_header(output_, 8, http2_frame_type::goaway, 0, 0);
+    append_http2_uint32(output_, last_stream_id_);
+    append_http2_uint32(output_, static_cast<uint32_t>(code));
+  }
+
+  std::string &output() { return output_; }
+
+  uint32_t max_frame_size() const { return local_settings_.max_frame_size; }
+
+  const http2_settings &peer_settings() const { return peer_settings_; }
+
+  size_t stream_count() const { return streams_.size(); }
+
+  bool goaway_received() const { return goaway_received_; }
+
+ private:
+  static void append_setting(std::string &out, http2_settings_id id,
+                             uint32_t value) {
+    auto v = static_cast<uint16_t>(id);
+    out.push_back(static_cast<char>(v >> 8));
+    out.push_back(static_cast<char>(v));
+    append_http2_uint32(out, value);
+  }
+
+  static bool is_connection_header(std::string_view name) {
+    return iequal0(name, "connection") || iequal0(name, "keep-alive") ||
+           iequal0(name, "proxy-connection") ||
+           iequal0(name, "transfer-encoding") || iequal0(name, "upgrade");
+  }
+
+  http2_stream *find_stream(uint32_t id) {
+    if (auto it = streams_.find(id); it != streams_.end()) {
+      return it->second.get();
+    }
+    return nullptr;
+  }
+
+  // Strip the padding of DATA and HEADERS.
+  static bool remove_padding(const http2_frame_header &header,
+                             std::string_view &payload) {
+    if (!header.has_flag(http2_flags::padded)) {
+      return true;
+    }
+    if (payload.empty()) {
+      return false;
+    }
+    size_t pad_len = static_cast<uint8_t>(payload[0]);
+    if (pad_len >= payload.size()) {
+      return false;
+    }
+    payload = payload.substr(1, payload.size() - 1 - pad_len);
+    return true;
+  }
+
+  http2_error_code on_headers(const http2_frame_header &header,
+                              std::string_view payload) {
+    uint32_t id = header.stream_id;
+    if (id == 0 || (id & 1) == 0) {
+      return http2_error_code::protocol_error;
+    }
+    if (!remove_padding(header, payload)) {
+      return http2_error_code::protocol_error;
+    }
+    if (header.has_flag(http2_flags::priority)) {
+      if (payload.size() < 5) {
+        return http2_error_code::frame_size_error;
+      }
+      payload.remove_prefix(5);
+    }
+
+    auto stream = find_stream(id);
+    header_new_stream_ = stream == nullptr && id > last_stream_id_;
+    if (header_new_stream_) {
+      last_stream_id_ = id;
+    }
+
+    header_block_.assign(payload);
+    header_end_stream_ = header.has_flag(http2_flags::end_stream);
+    if (!header.has_flag(http2_flags::end_headers)) {
+      continuation_stream_ = id;
+      return http2_error_code::no_error;
+    }
+    return on_header_block(id);
+  }
+
+  http2_error_code on_continuation(const http2_frame_header &header,
+                                   std::string_view payload) {
+    if (continuation_stream_ == 0) {
+      return http2_error_code::protocol_error;
+    }
+    header_block_.append(payload);
+    if (header_block_.size() > max_header_block_size_) {
+      return http2_error_code::enhance_your_calm;
+    }
+    if (!header.has_flag(http2_flags::end_headers)) {
+      return http2_error_code::no_error;
+    }
+    continuation_stream_ = 0;
+    return on_header_block(header.stream_id);
+  }
+
+  http2_error_code on_header_block(uint32_t id) {
+    // the block must be decoded even if the stream is refused, to keep the
+    // hpack state in sync with the peer.
+    decoded_headers_.clear();
+    if (!decoder_.decode(header_block_, decoded_headers_)) {
+      // the rest of the block isn't decoded, the hpack state is lost.
+      return decoder_.too_large() ? http2_error_code::enhance_your_calm
+                                  : http2_error_code::compression_error;
+    }
+
+    auto stream = find_stream(id);
+    if (stream != nullptr) {
+      if (stream->state != http2_stream_state::open) {
+        reset_stream(id, http2_error_code::stream_closed);
+        return http2_error_code::no_error;
+      }
+      // trailers, they are not exposed to the handler.
+      if (!header_end_stream_) {
+        reset_stream(id, http2_error_code::protocol_error);
+        return http2_error_code::no_error;
+      }
+      set_ready(*stream);
+      return http2_error_code::no_error;
+    }
+    if (!header_new_stream_) {
+      // the stream has been closed.
+      return http2_error_code::stream_closed;
+    }
+
+    if (streams_.size() >= local_settings_.max_concurrent_streams ||
+        goaway_received_) {
+      reset_stream(id, http2_error_code::refused_stream);
+      return http2_error_code::no_error;
+    }
+
+    auto new_stream = std::make_unique<http2_stream>(
+        id, conn_, peer_settings_.initial_window_size,
+        local_settings_.initial_window_size);
+    new_stream->headers = std::move(decoded_headers_);
+    if (!build_request(*new_stream)) {
+      reset_stream(id, http2_error_code::protocol_error);
+      return http2_error_code::no_error;
+    }
+
+    if (new_stream->parser.body_len() > max_http_body_len_ ||
+        new_stream->parser.body_len() < 0) [[unlikely]] {
+      CINATRA_LOG_ERROR << "invalid http content length: "
+                        << new_stream->parser.body_len();
+      reset_stream(id, http2_error_code::cancel);
+      return http2_error_code::no_error;
+    }
+
+    stream = new_stream.get();
+    streams_.emplace(id, std::move(new_stream));
+    if (header_end_stream_) {
+      set_ready(*stream);
+    }
+    return http2_error_code::no_error;
+  }
+
+  void set_ready(http2_stream &stream) {
+    stream.state = http2_stream_state::half_closed_remote;
+    stream.handling = true;
+    ready_streams_.push_back(&stream);
+  }
+
+  bool build_request(http2_stream &stream) {
+    std::string_view method;
+    std::string_view path;
+    std::string_view authority;
+    bool has_host = false;
+    bool pseudo_end = false;
+    for (auto &[name, value] : stream.headers) {
+      if (!name.empty() && name[0] == ':') {
+        // pseudo-header fields must precede the regular fields.
+        if (pseudo_end) {
+          return false;
+        }
+        if (name == ":method") {
+          method = value;
+        }
+        else if (name == ":path") {
+          path = value;
+        }
+        else if (name == ":authority") {
+          authority = value;
+        }
+        else if (name != ":scheme") {
+          return false;
+        }
+        continue;
+      }
+
+      pseudo_end = true;
+      if (name == "host") {
+        has_host = true;
+      }
+      stream.header_views.push_back({name, value});
+    }
+
+    if (method.empty() || path.empty()) {
+      return false;
+    }
+    if (!has_host && !authority.empty()) {
+      stream.header_views.push_back({"host", authority});
+    }
+
+    stream.request_line.reserve(method.size() + 1 + path.size());
+    stream.request_line.append(method).append(" ").append(path);
+    return stream.parser.parse_http2_request(stream.request_line,
+                                             stream.header_views) == 0;
+  }
+
+  http2_error_code on_data(const http2_frame_header &header,
+                           std::string_view payload) {
+    uint32_t id = header.stream_id;
+    if (id == 0) {
+      return http2_error_code::protocol_error;
+    }
+
+    // the whole frame, include padding, is subject to flow control.
+    if (header.length > conn_recv_window_) {
+      return http2_error_code::flow_control_error;
+    }
+    conn_recv_window_ -= header.length;
+    conn_recv_unacked_ += header.length;
+    if (conn_recv_unacked_ >= local_conn_window_ / 2) {
+      send_window_update(0, conn_recv_unacked_);
+      conn_recv_window_ += conn_recv_unacked_;
+      conn_recv_unacked_ = 0;
+    }
+
+    if (!remove_padding(header, payload)) {
+      return http2_error_code::protocol_error;
+    }
+
+    auto stream = find_stream(id);
+    if (stream == nullptr) {
+      if (id > last_stream_id_) {
+        return http2_error_code::protocol_error;
+      }
+      // the stream has been reset, drop the data in flight.
+      return http2_error_code::no_error;
+    }
+    if (stream->state != http2_stream_state::open) {
+      reset_stream(id, http2_error_code::stream_closed);
+      return http2_error_code::no_error;
+    }
+
+    if (header.length > stream->recv_window) {
+      reset_stream(id, http2_error_code::flow_control_error);
+      return http2_error_code::no_error;
+    }
+    stream->recv_window -= header.length;
+
+    if (stream->body.size() + payload.size() >
+        static_cast<uint64_t>(max_http_body_len_)) [[unlikely]] {
+      CINATRA_LOG_ERROR << "http2 request body is too large, max size: "
+                        << max_http_body_len_;
+      reset_stream(id, http2_error_code::cancel);
+      return http2_error_code::no_error;
+    }
+    stream->body.append(payload);
+
+    if (header.has_flag(http2_flags::end_stream)) {
+      set_ready(*stream);
+      return http2_error_code::no_error;
+    }
+
+    stream->recv_unacked += header.length;
+    if (stream->recv_unacked >= local_settings_.initial_window_size / 2) {
+      send_window_update(id, stream->recv_unacked);
+      stream->recv_window += stream->recv_unacked;
+      stream->recv_unacked = 0;
+    }
+    return http2_error_code::no_error;
+  }
+
+  http2_error_code on_rst_stream(const http2_frame_header &header,
+                                 std::string_view payload) {
+    if (header.stream_id == 0 || header.stream_id > last_stream_id_) {
+      return http2_error_code::protocol_error;
+    }
+    if (payload.size() != 4) {
+      return http2_error_code::frame_size_error;
+    }
+    close_stream(header.stream_id);
+    return http2_error_code::no_error;
+  }
+
+  http2_error_code on_settings(const http2_frame_header &header,
+                               std::string_view payload) {
+    if (header.stream_id != 0) {
+      return http2_error_code::protocol_error;
+    }
+    if (header.has_flag(http2_flags::ack)) {
+      return payload.empty() ? http2_error_code::no_error
+                             : http2_error_code::frame_size_error;
+    }
+    if (payload.size() % 6 != 0) {
+      return http2_error_code::frame_size_error;
+    }
+
+    for (size_t i = 0; i < payload.size(); i += 6) {
+      auto id = static_cast<http2_settings_id>(
+          (uint16_t(uint8_t(payload[i])) << 8) | uint8_t(payload[i + 1]));
+      uint32_t value = read_http2_uint32(payload.data() + i + 2);
+      switch (id) {
+        case http2_settings_id::header_table_size:
+          // the encoder doesn't use the dynamic table.
+          peer_settings_.header_table_size = value;
+          break;
+        case http2_settings_id::enable_push:
+          if (value > 1) {
+            return http2_error_code::protocol_error;
+          }
+          peer_settings_.enable_push = value;
+          break;
+        case http2_settings_id::max_concurrent_streams:
+          peer_settings_.max_concurrent_streams = value;
+          break;
+        case http2_settings_id::initial_window_size: {
+          if (value > HTTP2_MAX_WINDOW_SIZE) {
+            return http2_error_code::flow_control_error;
+          }
+          int64_t delta = int64_t(value) - peer_settings_.initial_window_size;
+          for (auto &[_, stream] : streams_) {
+            stream->send_window += delta;
+            if (stream->send_window > HTTP2_MAX_WINDOW_SIZE) {
+              return http2_error_code::flow_control_error;
+            }
+          }
+          peer_settings_.initial_window_size = value;
+        } break;
+        case http2_settings_id::max_frame_size:
+          if (value < HTTP2_DEFAULT_FRAME_SIZE ||
+              value > HTTP2_MAX_FRAME_SIZE) {
+            return http2_error_code::protocol_error;
+          }
+          peer_settings_.max_frame_size = value;
+          break;
+        case http2_settings_id::max_header_list_size:
+          peer_settings_.max_header_list_size = value;
+          break;
+        default:
+          // unknown settings must be ignored.
+          break;
+      }
+    }
+
+    append_http2_frame_header(output_, 0, http2_frame_type::settings,
+                              http2_flags::ack, 0);
+    flush_pending_streams();
+    return http2_error_code::no_error;
+  }
+
+  http2_error_code on_ping(const http2_frame_header &header,
+                           std::string_view payload) {
+    if (header.stream_id != 0) {
+      return http2_error_code::protocol_error;
+    }
+    if (payload.size() != 8) {
+      return http2_error_code::frame_size_error;
+    }
+    if (!header.has_flag(http2_flags::ack)) {
+      append_http2_frame_header(output_, 8, http2_frame_type::ping,
+                                http2_flags::ack, 0);
+      output_.append(payload);
+    }
+    return http2_error_code::no_error;
+  }
+
+  http2_error_code on_window_update(const http2_frame_header &header,
+                                    std::string_view payload) {
+    if (payload.size() != 4) {
+      return http2_error_code::frame_size_error;
+    }
+    uint32_t increment = read_http2_uint32(payload.data()) & 0x7fffffff;
+    if (header.stream_id == 0) {
+      if (increment == 0) {
+        return http2_error_code::protocol_error;
+      }
+      conn_send_window_ += increment;
+      if (conn_send_window_ > HTTP2_MAX_WINDOW_SIZE) {
+        return http2_error_code::flow_control_error;
+      }
+      flush_pending_streams();
+      return http2_error_code::no_error;
+    }
+
+    auto stream = find_stream(header.stream_id);
+    if (stream == nullptr) {
+      return http2_error_code::no_error;
+    }
+    if (increment == 0) {
+      reset_stream(header.stream_id, http2_error_code::protocol_error);
+      return http2_error_code::no_error;
+    }
+    stream->send_window += increment;
+    if (stream->send_window > HTTP2_MAX_WINDOW_SIZE) {
+      reset_stream(header.stream_id, http2_error_code::flow_control_error);
+      return http2_error_code::no_error;
+    }
+    if (stream->response_submitted && flush_data(*stream)) {
+      streams_.erase(header.stream_id);
+    }
+    return http2_error_code::no_error;
+  }
+
+  void append_header_block(uint32_t id, std::string_view block,
+                           bool end_stream) {
+    size_t max_size = peer_settings_.max_frame_size;
+    auto type = http2_frame_type::headers;
+    uint8_t flags = end_stream ? http2_flags::end_stream : 0;
+    do {
+      auto fragment = block.substr(0, max_size);
+      block.remove_prefix(fragment.size());
+      append_http2_frame_header(
+          output_, fragment.size(), type,
+          block.empty() ? flags | http2_flags::end_headers : flags, id);
+      output_.append(fragment);
+      type = http2_frame_type::continuation;
+      flags = 0;
+    } while (!block.empty());
+  }
+
+  // Returns true if the whole body has been sent.
+  bool flush_data(http2_stream &stream) {
+    while (!stream.pending_data.empty()) {
+      int64_t window = (std::min)(conn_send_window_, stream.send_window);
+      if (window <= 0) {
+        return false;
+      }
+      size_t len = (std::min)({stream.pending_data.size(), size_t(window),
+                               size_t(peer_settings_.max_frame_size)});
+      bool last = len == stream.pending_data.size();
+      append_http2_frame_header(output_, len, http2_frame_type::data,
+                                last ? http2_flags::end_stream : 0,
+                                stream.id);
+      output_.append(stream.pending_data.substr(0, len));
+      stream.pending_data.remove_prefix(len);
+      conn_send_window_ -= len;
+      stream.send_window -= len;
+    }
+    return true;
+  }
+
+  void flush_pending_streams() {
+    for (auto it = streams_.begin(); it != streams_.end();) {
+      auto &stream = *it->second;
+      if (stream.response_submitted && flush_data(stream)) {
+        it = streams_.erase(it);
+      }
+      else {
+        ++it;
+      }
+    }
+  }
+
+  void close_stream(uint32_t id) {
+    auto it = streams_.find(id);
+    if (it == streams_.end()) {
+      return;
+    }
+    if (it->second->handling) {
+      // released when the handler submits the response.
+      it->second->state = http2_stream_state::closed;
+      it->second->pending_data = {};
+      return;
+    }
+    streams_.erase(it);
+  }
+
+  void reset_stream(uint32_t id, http2_error_code code) {
+    append_http2_frame_header(output_, 4, http2_frame_type::rst_stream, 0, id);
+    append_http2_uint32(output_, static_cast<uint32_t>(code));
+    close_stream(id);
+  }
+
+  void send_window_update(uint32_t id, uint32_t increment) {
+    append_http2_frame_header(output_, 4, http2_frame_type::window_update, 0,
+                              id);
+    append_http2_uint32(output_, increment);
+  }
+
+  coro_http_connection *conn_;
+  int64_t max_http_body_len_;
+  http2_settings local_settings_;
+  http2_settings peer_settings_;
+  int64_t local_conn_window_ = 16 * 1024 * 1024;
+  int64_t conn_recv_window_ = HTTP2_DEFAULT_WINDOW_SIZE;
+  uint32_t conn_recv_unacked_ = 0;
+  int64_t conn_send_window_ = HTTP2_DEFAULT_WINDOW_SIZE;
+  uint32_t last_stream_id_ = 0;
+  bool goaway_received_ = false;
+
+  uint32_t continuation_stream_ = 0;
+  bool header_end_stream_ = false;
+  bool header_new_stream_ = false;
+  std::string header_block_;
+  size_t max_header_block_size_ = 256 * 1024;
+
+  hpack_decoder decoder_;
+  hpack_encoder encoder_;
+  std::vector<hpack_header> decoded_headers_;
+  std::vector<resp_header_sv> resp_headers_;
+  std::string resp_block_;
+
+  std::unordered_map<uint32_t, std::unique_ptr<http2_stream>> streams_;
+  std::vector<http2_stream *> ready_streams_;
+  std::string output_;
+};
+}  // namespace cinatra
@@ -0,0 +1,105 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace cinatra {
+using namespace std::string_view_literals;
+
+// RFC 9113 3.4, the client connection preface.
+inline constexpr std::string_view HTTP2_PREFACE =
+    "PRI * HTTP/2.0\r\n\r\nSM\r\n\r\n"sv;
+// The part of the preface which is returned by async_read_until(TWO_CRCF).
+inline constexpr std::string_view HTTP2_PREFACE_HEAD =
+    "PRI * HTTP/2.0\r\n\r\n"sv;
+inline constexpr std::string_view HTTP2_ALPN = "h2"sv;
+
+inline constexpr size_t HTTP2_FRAME_HEADER_LEN = 9;
+inline constexpr uint32_t HTTP2_DEFAULT_WINDOW_SIZE = 65535;
+inline constexpr uint32_t HTTP2_MAX_WINDOW_SIZE = 0x7fffffff;
+inline constexpr uint32_t HTTP2_DEFAULT_FRAME_SIZE = 16384;
+inline constexpr uint32_t HTTP2_MAX_FRAME_SIZE = 16777215;
+inline constexpr uint32_t HTTP2_DEFAULT_HEADER_TABLE_SIZE = 4096;
+
+#ifndef CINATRA_HTTP2_MAX_HEADER_LIST_SIZE
+// The SETTINGS_MAX_HEADER_LIST_SIZE of the server, a request whose decoded
+// header list is larger is a connection error.
+#define CINATRA_HTTP2_MAX_HEADER_LIST_SIZE (64 * 1024)
+#endif
+
+enum class http2_frame_type : uint8_t {
+  data = 0x0,
+  headers = 0x1,
+  priority = 0x2,
+  rst_stream = 0x3,
+  settings = 0x4,
+  push_promise = 0x5,
+  ping = 0x6,
+  goaway = 0x7,
+  window_update = 0x8,
+  continuation = 0x9,
+};
+
+namespace http2_flags {
+inline constexpr uint8_t end_stream = 0x1;
+inline constexpr uint8_t ack = 0x1;
+inline constexpr uint8_t end_headers = 0x4;
+inline constexpr uint8_t padded = 0x8;
+inline constexpr uint8_t priority = 0x20;
+}  // namespace http2_flags
+
+enum class http2_error_code : uint32_t {
+  no_error = 0x0,
+  protocol_error = 0x1,
+  internal_error = 0x2,
+  flow_control_error = 0x3,
+  settings_timeout = 0x4,
+  stream_closed = 0x5,
+  frame_size_error = 0x6,
+  refused_stream = 0x7,
+  cancel = 0x8,
+  compression_error = 0x9,
+  connect_error = 0xa,
+  enhance_your_calm = 0xb,
+  inadequate_security = 0xc,
+  http_1_1_required = 0xd,
+};
+
+enum class http2_settings_id : uint16_t {
+  header_table_size = 0x1,
+  enable_push = 0x2,
+  max_concurrent_streams = 0x3,
+  initial_window_size = 0x4,
+  max_frame_size = 0x5,
+  max_header_list_size = 0x6,
+};
+
+struct http2_settings {
+  uint32_t header_table_size = HTTP2_DEFAULT_HEADER_TABLE_SIZE;
+  uint32_t enable_push = 1;
+  uint32_t max_concurrent_streams = UINT32_MAX;
+  uint32_t initial_window_size = HTTP2_DEFAULT_WINDOW_SIZE;
+  uint32_t max_frame_size = HTTP2_DEFAULT_FRAME_SIZE;
+  uint32_t max_header_list_size = UINT32_MAX;
+};
+
+/*
+  +-----------------------------------------------+
+  |                 Length (24)                   |
+  +---------------+---------------+---------------+
+  |   Type (8)    |   Flags (8)   |
+  +-+-------------+---------------+-------------------------------+
+  |R|                 Stream Identifier (31)                      |
+  +=+=============================================================+
+  |                   Frame Payload (0...)                      ...
+  +---------------------------------------------------------------+
+*/
+struct http2_frame_header {
+  uint32_t length = 0;
+  http2_frame_type type = http2_frame_type::data;
+  uint8_t flags = 0;
+  uint32_t stream_id = 0;
+
+  bool has_flag(uint8_t flag) const { return (flags & flag) != 0; }
+};
+}  // namespace cinatra
@@ -29,7 +29,7 @@ inline bool iequal0(std::string_view a, std::string_view b) {
 class http_parser {
  public:
   void parse_body_len() {
-    auto header_value = this->get_header_value("content-length"sv);
+    auto header_value = known_.content_length;
     if (header_value.empty()) {
       body_len_ = 0;
     }
@@ -51,7 +51,7 @@ class http_parser {
     size_t msg_len;
     header_len_ = cinatra::detail::phr_parse_response(
         data, size, &minor_version, &status_, &msg, &msg_len, headers_.data(),
-        &num_headers_, last_len);
+        &num_headers_, last_len, known_);
     msg_ = {msg, msg_len};
     parse_body_len();
     if (header_len_ < 0) [[unlikely]] {
@@ -76,10 +76,13 @@ class http_parser {
     bool has_query{};
     header_len_ = detail::phr_parse_request(
         data, size, &method, &method_len, &url, &url_len, &minor_version,
-        headers_.data(), &num_headers_, last_len, has_connection_, has_close_,
-        has_upgrade_, has_query);
+        headers_.data(), &num_headers_, last_len, known_, has_query);
 
     if (header_len_ < 0) [[unlikely]] {
+      if (header_len_ == -2) {
+        // not complete, parse again with last_len = size after reading more.
+        return header_len_;
+      }
       CINATRA_LOG_WARNING << "parse http head failed";
       if (num_headers_ == CINATRA_MAX_HTTP_HEADER_FIELD_SIZE) {
         output_error();
@@ -111,11 +114,62 @@ class http_parser {
     return header_len_;
   }
 
-  bool has_connection() { return has_connection_; }
+  // Fill the parser from a http2 request, request_line is "method path" and
+  // must outlive the parser like the buffer of parse_request.
+  int parse_http2_request(std::string_view request_line,
+                          std::span<const http_header> headers) {
+    if (headers.size() > CINATRA_MAX_HTTP_HEADER_FIELD_SIZE) [[unlikely]] {
+      output_error();
+      return -1;
+    }
+
+    size_t pos = request_line.find(' ');
+    if (pos == std::string_view::npos || pos == 0) {
+      return -1;
+    }
 
-  bool has_close() { return has_close_; }
+    std::copy(headers.begin(), headers.end(), headers_.begin());
+    num_headers_ = headers.size();
+    known_ = {};
+    for (auto &[name, value] : headers) {
+      detail::check_known_header(name.data(), name.size(), value.data(),
+                                 value.size(), known_);
+    }
+    // connection specific headers are meaningless in http2.
+    known_.has_connection = false;
+    known_.has_close = false;
+    known_.has_upgrade = false;
+    header_len_ = 0;
 
-  bool has_upgrade() { return has_upgrade_; }
+    method_ = request_line.substr(0, pos);
+    url_ = request_line.substr(pos + 1);
+
+    auto methd_type = method_type(method_);
+    if (methd_type == http_method::GET || methd_type == http_method::HEAD) {
+      body_len_ = 0;
+    }
+    else {
+      parse_body_len();
+    }
+
+    full_url_ = url_;
+    if (!queries_.empty()) {
+      queries_.clear();
+    }
+    if (size_t query_pos = url_.find('?');
+        query_pos != std::string_view::npos) {
+      parse_query(url_.substr(query_pos + 1));
+      url_ = url_.substr(0, query_pos);
+    }
+
+    return 0;
+  }
+
+  bool has_connection() { return known_.has_connection; }
+
+  bool has_close() { return known_.has_close; }
+
+  bool has_upgrade() { return known_.has_upgrade; }
 
   std::string_view get_header_value(std::string_view key) const {
     for (size_t i = 0; i < num_headers_; i++) {
@@ -138,14 +192,7 @@ class http_parser {
     }
   }
 
-  bool is_chunked() const {
-    auto transfer_encoding = this->get_header_value("transfer-encoding"sv);
-    if (transfer_encoding == "chunked"sv) {
-      return true;
-    }
-
-    return false;
-  }
+  bool is_chunked() const { return known_.is_chunked; }
 
   bool is_multipart() {
     auto content_type = get_header_value("Content-Type");
@@ -176,7 +223,7 @@ class http_parser {
   }
 
   bool is_websocket() const {
-    auto upgrade = this->get_header_value("Upgrade"sv);
+    auto upgrade = known_.upgrade;
     return upgrade == "WebSocket"sv || upgrade == "websocket"sv;
   }
 
@@ -184,7 +231,7 @@ class http_parser {
     if (is_websocket()) {
       return true;
     }
-    auto val = this->get_header_value("connection"sv);
+    auto val = known_.connection;
     if (val.empty() || iequal0(val, "keep-alive"sv)) {
       return true;
     }
@@ -254,9 +301,7 @@ class http_parser {
   size_t num_headers_ = 0;
   int header_len_ = 0;
   int64_t body_len_ = 0;
-  bool has_connection_{};
-  bool has_close_{};
-  bool has_upgrade_{};
+  http_known_headers known_;
   std::array<http_header, CINATRA_MAX_HTTP_HEADER_FIELD_SIZE> headers_;
   std::string_view method_;
   std::string_view url_;
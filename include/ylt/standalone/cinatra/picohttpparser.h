@@ -32,6 +32,19 @@
 
 #include <string_view>
 
+#include <bit>
+
+/* use the widest simd the target is compiled for, unless one of them is chosen
+ * explicitly (cmake -DENABLE_SIMD=SSE42/AVX2/AARCH64). */
+#if !defined(CINATRA_SSE) && !defined(CINATRA_AVX2) && \
+    !defined(CINATRA_ARM_OPT)
+#if defined(__AVX2__)
+#define CINATRA_AVX2
+#elif defined(__SSE4_2__)
+#define CINATRA_SSE
+#endif
+#endif
+
 #ifdef CINATRA_SSE
 #ifdef _MSC_VER
 #include <nmmintrin.h>
@@ -59,6 +72,19 @@ struct http_header {
   std::string_view name;
   std::string_view value;
 };
+
+/* the headers which are checked for every message, they are recognized while
+ * tokenizing so they needn't be searched again after parsing. */
+struct http_known_headers {
+  bool has_connection = false;
+  bool has_close = false;
+  bool has_upgrade = false;
+  bool is_chunked = false;
+  std::string_view connection;
+  std::string_view content_length;
+  std::string_view upgrade;
+};
+
 namespace detail {
 
 /* contains name and value of a header (name == NULL if is a continuing line
@@ -205,7 +231,32 @@ static const char *findchar_fast(const char *buf, const char *buf_end,
                                  const char *ranges, int ranges_size,
                                  int *found) {
   *found = 0;
-#ifdef CINATRA_SSE
+#if defined(CINATRA_AVX2)
+  if (likely(buf_end - buf >= 32)) {
+    size_t left = (buf_end - buf) & ~31;
+    do {
+      __m256i b32 = _mm256_loadu_si256((const __m256i *)buf);
+      __m256i match = _mm256_setzero_si256();
+      for (int i = 0; i < ranges_size; i += 2) {
+        /* lo <= b && b <= hi, unsigned */
+        __m256i lo = _mm256_set1_epi8(ranges[i]);
+        __m256i hi = _mm256_set1_epi8(ranges[i + 1]);
+        __m256i in_range =
+            _mm256_and_si256(_mm256_cmpeq_epi8(_mm256_max_epu8(b32, lo), b32),
+                             _mm256_cmpeq_epi8(_mm256_min_epu8(b32, hi), b32));
+        match = _mm256_or_si256(match, in_range);
+      }
+      unsigned int mask = (unsigned int)_mm256_movemask_epi8(match);
+      if (unlikely(mask != 0)) {
+        buf += std::countr_zero(mask);
+        *found = 1;
+        break;
+      }
+      buf += 32;
+      left -= 32;
+    } while (likely(left != 0));
+  }
+#elif defined(CINATRA_SSE)
   if (likely(buf_end - buf >= 16)) {
     __m128i ranges16 = _mm_loadu_si128((const __m128i *)ranges);
 
@@ -233,11 +284,39 @@ static const char *findchar_fast(const char *buf, const char *buf_end,
   return buf;
 }
 
+#ifdef CINATRA_ARM_OPT
+/* find the first char which is not printable or is SP */
+static const char *findchar_nonprintable_fast(const char *buf,
+                                              const char *buf_end, int *found) {
+  *found = 0;
+  const size_t block_size = sizeof(uint8x16_t) - 1;
+  const char *const end =
+      (size_t)(buf_end - buf) >= block_size ? buf_end - block_size : buf;
+
+  for (; buf < end; buf += sizeof(uint8x16_t)) {
+    uint8x16_t v = vld1q_u8((const uint8_t *)buf);
+    v = vorrq_u8(vcltq_u8(v, vmovq_n_u8('\041')),
+                 vceqq_u8(v, vmovq_n_u8('\177')));
+    /* Pack the comparison result into 64 bits. */
+    const uint8x8_t rv = vshrn_n_u16(vreinterpretq_u16_u8(v), 4);
+    uint64_t offset = vget_lane_u64(vreinterpret_u64_u8(rv), 0);
+    if (offset) {
+      *found = 1;
+      __asm__("rbit %x0, %x0" : "+r"(offset));
+      /* offset uses 4 bits per byte of input. */
+      buf += __builtin_clzll(offset) / 4;
+      break;
+    }
+  }
+  return buf;
+}
+#endif
+
 static const char *get_token_to_eol(const char *buf, const char *buf_end,
                                     const char **token, size_t *token_len,
                                     int *ret) {
   const char *token_start = buf;
-#ifdef CINATRA_SSE
+#if defined(CINATRA_SSE) || defined(CINATRA_AVX2)
   static const char ranges1[] =
       "\0\010"
       /* allow HT */
@@ -426,353 +505,71 @@ static const char *parse_http_version(const char *buf, const char *buf_end,
   return buf;
 }
 
-#ifdef CINATRA_AVX2
-static unsigned long TZCNT(unsigned long long in) {
-  unsigned long res;
-  asm("tzcnt %1, %0\n\t" : "=r"(res) : "r"(in));
-  return res;
-}
-/* Parse only 32 bytes */
-static void find_ranges32(__m256i b0, unsigned long *range0,
-                          unsigned long *range1) {
-  const __m256i rr0 = _mm256_set1_epi8(0x00 - 1);
-  const __m256i rr1 = _mm256_set1_epi8(0x1f + 1);
-  const __m256i rr2 = _mm256_set1_epi8(0x3a);
-  const __m256i rr4 = _mm256_set1_epi8(0x7f);
-  const __m256i rr7 = _mm256_set1_epi8(0x09);
-
-  /* 0<=x */
-  __m256i gz0 = _mm256_cmpgt_epi8(b0, rr0);
-  /* 0=<x<=1f */
-  __m256i z_1f_0 = _mm256_and_si256(_mm256_cmpgt_epi8(rr1, b0), gz0);
-  /* 0<=x<=1f || x==3a */
-  __m256i range0_0 = _mm256_or_si256(_mm256_cmpeq_epi8(rr2, b0), z_1f_0);
-  /* 0<=x<9 || 9<x<=1f || x==7f */
-  __m256i range1_0 =
-      _mm256_or_si256(_mm256_cmpeq_epi8(rr4, b0),
-                      _mm256_andnot_si256(_mm256_cmpeq_epi8(b0, rr7), z_1f_0));
-  /* Generate bit masks */
-  unsigned int r0 = _mm256_movemask_epi8(range0_0);
-  /* Combine 32bit masks into a single 64bit mask */
-  *range0 = r0;
-  r0 = _mm256_movemask_epi8(range1_0);
-  *range1 = r0;
-}
-
-/* Parse only 64 bytes */
-static void find_ranges64(__m256i b0, __m256i b1, unsigned long *range0,
-                          unsigned long *range1) {
-  const __m256i rr0 = _mm256_set1_epi8(0x00 - 1);
-  const __m256i rr1 = _mm256_set1_epi8(0x1f + 1);
-  const __m256i rr2 = _mm256_set1_epi8(0x3a);
-  const __m256i rr4 = _mm256_set1_epi8(0x7f);
-  const __m256i rr7 = _mm256_set1_epi8(0x09);
-
-  /* 0<=x */
-  __m256i gz0 = _mm256_cmpgt_epi8(b0, rr0);
-  __m256i gz1 = _mm256_cmpgt_epi8(b1, rr0);
-  /* 0=<x<=1f */
-  __m256i z_1f_0 = _mm256_and_si256(_mm256_cmpgt_epi8(rr1, b0), gz0);
-  __m256i z_1f_1 = _mm256_and_si256(_mm256_cmpgt_epi8(rr1, b1), gz1);
-  /* 0<=x<=1f || x==3a */
-  __m256i range0_0 = _mm256_or_si256(_mm256_cmpeq_epi8(rr2, b0), z_1f_0);
-  __m256i range0_1 = _mm256_or_si256(_mm256_cmpeq_epi8(rr2, b1), z_1f_1);
-  /* 0<=x<9 || 9<x<=1f || x==7f */
-  __m256i range1_0 =
-      _mm256_or_si256(_mm256_cmpeq_epi8(rr4, b0),
-                      _mm256_andnot_si256(_mm256_cmpeq_epi8(b0, rr7), z_1f_0));
-  __m256i range1_1 =
-      _mm256_or_si256(_mm256_cmpeq_epi8(rr4, b1),
-                      _mm256_andnot_si256(_mm256_cmpeq_epi8(b1, rr7), z_1f_1));
-  /* Generate bit masks */
-  unsigned int r0 = _mm256_movemask_epi8(range0_0);
-  unsigned int r1 = _mm256_movemask_epi8(range0_1);
-  /* Combine 32bit masks into a single 64bit mask */
-  *range0 = r0 ^ ((unsigned long)r1 << 32);
-  r0 = _mm256_movemask_epi8(range1_0);
-  r1 = _mm256_movemask_epi8(range1_1);
-  *range1 = r0 ^ ((unsigned long)r1 << 32);
-}
-
-/* This function parses 128 bytes at a time, creating bitmap of all interesting
- * tokens */
-static void find_ranges(const char *buf, const char *buf_end,
-                        unsigned long *range0, unsigned long *range1) {
-  const __m256i rr0 = _mm256_set1_epi8(0x00 - 1);
-  const __m256i rr1 = _mm256_set1_epi8(0x1f + 1);
-  const __m256i rr2 = _mm256_set1_epi8(0x3a);
-  const __m256i rr4 = _mm256_set1_epi8(0x7f);
-  const __m256i rr7 = _mm256_set1_epi8(0x09);
-
-  __m256i b0, b1, b2, b3;
-  unsigned char tmpbuf[32];
-  int i;
-  int dist;
-
-  if ((dist = buf_end - buf) < 128) {
-    // memcpy(tmpbuf, buf + (dist & (-32)), dist & 31);
-    for (i = 0; i < (dist & 31); i++) tmpbuf[i] = buf[(dist & (-32)) + i];
-    if (dist >= 96) {
-      b0 = _mm256_loadu_si256((void *)buf + 32 * 0);
-      b1 = _mm256_loadu_si256((void *)buf + 32 * 1);
-      b2 = _mm256_loadu_si256((void *)buf + 32 * 2);
-      b3 = _mm256_loadu_si256((void *)tmpbuf);
+static inline bool is_lower_name(const char *name, std::string_view lower) {
+  /* header names are tokens, the only token char which becomes one of
+   * [a-z-] by setting the 0x20 bit is the matching upper case letter. */
+  for (size_t i = 0; i < lower.size(); ++i) {
+    if ((name[i] | 0x20) != lower[i]) {
+      return false;
     }
-    else if (dist >= 64) {
-      b0 = _mm256_loadu_si256((void *)buf + 32 * 0);
-      b1 = _mm256_loadu_si256((void *)buf + 32 * 1);
-      b2 = _mm256_loadu_si256((void *)tmpbuf);
-      b3 = _mm256_setzero_si256();
-    }
-    else {
-      if (dist < 32) {
-        b0 = _mm256_loadu_si256((void *)tmpbuf);
-        return find_ranges32(b0, range0, range1);
-      }
-      else {
-        b0 = _mm256_loadu_si256((void *)buf + 32 * 0);
-        b1 = _mm256_loadu_si256((void *)tmpbuf);
-        return find_ranges64(b0, b1, range0, range1);
-      }
-    }
-  }
-  else {
-    /* Load 128 bytes */
-    b0 = _mm256_loadu_si256((void *)buf + 32 * 0);
-    b1 = _mm256_loadu_si256((void *)buf + 32 * 1);
-    b2 = _mm256_loadu_si256((void *)buf + 32 * 2);
-    b3 = _mm256_loadu_si256((void *)buf + 32 * 3);
   }
-
-  /* 0<=x */
-  __m256i gz0 = _mm256_cmpgt_epi8(b0, rr0);
-  __m256i gz1 = _mm256_cmpgt_epi8(b1, rr0);
-  __m256i gz2 = _mm256_cmpgt_epi8(b2, rr0);
-  __m256i gz3 = _mm256_cmpgt_epi8(b3, rr0);
-  /* 0=<x<=1f */
-  __m256i z_1f_0 = _mm256_and_si256(_mm256_cmpgt_epi8(rr1, b0), gz0);
-  __m256i z_1f_1 = _mm256_and_si256(_mm256_cmpgt_epi8(rr1, b1), gz1);
-  __m256i z_1f_2 = _mm256_and_si256(_mm256_cmpgt_epi8(rr1, b2), gz2);
-  __m256i z_1f_3 = _mm256_and_si256(_mm256_cmpgt_epi8(rr1, b3), gz3);
-  /* 0<=x<=1f || x==3a */
-  __m256i range0_0 = _mm256_or_si256(_mm256_cmpeq_epi8(rr2, b0), z_1f_0);
-  __m256i range0_1 = _mm256_or_si256(_mm256_cmpeq_epi8(rr2, b1), z_1f_1);
-  __m256i range0_2 = _mm256_or_si256(_mm256_cmpeq_epi8(rr2, b2), z_1f_2);
-  __m256i range0_3 = _mm256_or_si256(_mm256_cmpeq_epi8(rr2, b3), z_1f_3);
-  /* 0<=x<9 || 9<x<=1f || x==7f */
-  __m256i range1_0 =
-      _mm256_or_si256(_mm256_cmpeq_epi8(rr4, b0),
-                      _mm256_andnot_si256(_mm256_cmpeq_epi8(b0, rr7), z_1f_0));
-  __m256i range1_1 =
-      _mm256_or_si256(_mm256_cmpeq_epi8(rr4, b1),
-                      _mm256_andnot_si256(_mm256_cmpeq_epi8(b1, rr7), z_1f_1));
-  __m256i range1_2 =
-      _mm256_or_si256(_mm256_cmpeq_epi8(rr4, b2),
-                      _mm256_andnot_si256(_mm256_cmpeq_epi8(b2, rr7), z_1f_2));
-  __m256i range1_3 =
-      _mm256_or_si256(_mm256_cmpeq_epi8(rr4, b3),
-                      _mm256_andnot_si256(_mm256_cmpeq_epi8(b3, rr7), z_1f_3));
-  /* Generate bit masks */
-  unsigned int r0 = _mm256_movemask_epi8(range0_0);
-  unsigned int r1 = _mm256_movemask_epi8(range0_1);
-  /* Combine 32bit masks into a single 64bit mask */
-  *range0 = r0 ^ ((unsigned long)r1 << 32);
-
-  r0 = _mm256_movemask_epi8(range0_2);
-  r1 = _mm256_movemask_epi8(range0_3);
-  range0[1] = r0 ^ ((unsigned long)r1 << 32);
-
-  r0 = _mm256_movemask_epi8(range1_0);
-  r1 = _mm256_movemask_epi8(range1_1);
-
-  *range1 = r0 ^ ((unsigned long)r1 << 32);
-  r0 = _mm256_movemask_epi8(range1_2);
-  r1 = _mm256_movemask_epi8(range1_3);
-
-  range1[1] = r0 ^ ((unsigned long)r1 << 32);
+  return true;
 }
 
-static const char *parse_headers(const char *buf, const char *buf_end,
-                                 http_header *headers, size_t *num_headers,
-                                 size_t max_headers, int *ret) {
-  /* Bitmap for the first type of tokens */
-  unsigned long rr0[2] = {0};
-  /* Bitmap for the second type of tokens */
-  unsigned long rr1[2] = {0};
-  /* Pointer to the start of the currently parsed block of 128 bytes */
-  const char *prep_start = NULL;
-  int found;
-  int n_headers = *num_headers;
-
-  for (;; ++n_headers) {
-    const char *name;
-    size_t name_len;
-    const char *value;
-    size_t value_len;
-    CHECK_EOF();
-    if (*buf == '\015') {
-      ++buf;
-      EXPECT_CHAR('\012');
-      break;
-    }
-    else if (*buf == '\012') {
-      ++buf;
-      break;
-    }
-    if (n_headers == max_headers) {
-      *ret = -1;
-      *num_headers = n_headers;
-      return NULL;
-    }
+static inline bool is_lower_value(std::string_view value,
+                                  std::string_view lower) {
+  return value.size() == lower.size() && is_lower_name(value.data(), lower);
+}
 
-    if (!(n_headers != 0 && (*buf == ' ' || *buf == '\t')) &&
-        !(*buf >= 65 && *buf <= 90)) {
-      if (!token_char_map[(unsigned char)*buf]) {
-        *ret = -1;
-        *num_headers = n_headers;
-        return NULL;
+/* dispatch on the length first, so most headers are skipped by one compare */
+inline void check_known_header(const char *name, size_t name_len,
+                               const char *value, size_t value_len,
+                               http_known_headers &known) {
+  switch (name_len) {
+    case 7:
+      if (is_lower_name(name, "upgrade") && known.upgrade.empty()) {
+        known.upgrade = {value, value_len};
       }
-      name = buf;
-
-      /* Attempt to find a match in the index */
-      found = 0;
-      do {
-        unsigned long distance = buf - prep_start;
-        /* Check if the bitmaps are still valid. An assumption I make is that
-           buf > 128 (i.e. the os will never allocate memory at address 0-128 */
-        if (unlikely(distance >=
-                     128)) { /* Bitmaps are too old, make new ones */
-          prep_start = buf;
-          distance = 0;
-          find_ranges(buf, buf_end, rr0, rr1);
-        }
-        else if (distance >= 64) { /* In the second half of the bitmap */
-          unsigned long index =
-              rr0[1] >> (distance - 64);     /* Correct offset of the bitmap */
-          unsigned long find = TZCNT(index); /* Fine next set bit */
-          if ((find < 64)) {                 /* Yey, we found a token */
-            buf += find;
-            found = 1;
-            break;
-          }
-          buf = prep_start + 128; /* No token was found in the current bitmap */
-          continue;
-        }
-        unsigned long index =
-            rr0[0] >> (distance);          /* In the first half of the bitmap */
-        unsigned long find = TZCNT(index); /* Find next set bit */
-        if ((find < 64)) {                 /* Token found */
-          buf += find;
-          found = 1;
-          break;
-        } /* Token not found, look at second half of bitmap */
-        index = rr0[1];
-        find = TZCNT(index);
-        if ((find < 64)) {
-          buf += 64 + find - distance;
-          found = 1;
-          break;
+      break;
+    case 10:
+      if (is_lower_name(name, "connection") && !known.has_connection) {
+        known.has_connection = true;
+        known.connection = {value, value_len};
+        char ch = value_len > 0 ? *value : 0;
+        if (ch == 'U' || ch == 'u') {
+          known.has_upgrade = true;
         }
-
-        buf = prep_start + 128;
-      } while (buf < buf_end);
-
-      if (!found)
-        if (buf >= buf_end) {
-          *ret = -2;
-          *num_headers = n_headers;
-          return NULL;
+        else if (ch == 'c' || ch == 'C') {
+          known.has_close = true;
         }
-      name_len = buf - name;
-      ++buf;
-      CHECK_EOF();
-      while ((*buf == ' ' || *buf == '\t')) {
-        ++buf;
-        CHECK_EOF();
-      }
-    }
-    else {
-      name = NULL;
-      name_len = 0;
-    }
-    const char *token_start = buf;
-
-    found = 0;
-
-    do {
-      /* Too far */
-      unsigned long distance = buf - prep_start; /* Same algorithm as above */
-      if (unlikely(distance >= 128)) {
-        prep_start = buf;
-        distance = 0;
-        find_ranges(buf, buf_end, rr0, rr1);
-      }
-      else if (distance >= 64) {
-        unsigned long index = rr1[1] >> (distance - 64);
-        unsigned long find = TZCNT(index);
-        if ((find < 64)) {
-          buf += find;
-          found = 1;
-          break;
+        else if (ch == 'k' || ch == 'K') {
+          std::string_view val_str{value, value_len};
+          if (val_str.find("pgrade") != std::string_view::npos) {
+            known.has_upgrade = true;
+          }
         }
-        buf = prep_start + 128;
-        continue;
-      }
-      unsigned long index = rr1[0] >> (distance);
-      unsigned long find = TZCNT(index);
-      if ((find < 64)) {
-        buf += find;
-        found = 1;
-        break;
       }
-      index = rr1[1];
-      find = TZCNT(index);
-      if ((find < 64)) {
-        buf += 64 + find - distance;
-        found = 1;
-        break;
+      break;
+    case 14:
+      if (is_lower_name(name, "content-length") &&
+          known.content_length.empty()) {
+        known.content_length = {value, value_len};
       }
-
-      buf = prep_start + 128;
-    } while (buf < buf_end);
-
-    if (!found)
-      if (buf >= buf_end) {
-        *ret = -2;
-        *num_headers = n_headers;
-        return NULL;
+      break;
+    case 17:
+      if (is_lower_name(name, "transfer-encoding")) {
+        known.is_chunked = is_lower_value({value, value_len}, "chunked");
       }
-
-    unsigned short two_char = *(unsigned short *)buf;
-
-    if (likely(two_char == 0x0a0d)) {
-      value_len = buf - token_start;
-      buf += 2;
-    }
-    else if (unlikely(two_char & 0x0a == 0x0a)) {
-      value_len = buf - token_start;
-      ++buf;
-    }
-    else {
-      *ret = -1;
-      *num_headers = n_headers;
-      return NULL;
-    }
-    value = token_start;
-    headers[*num_headers] = {std::string_view{name, name_len},
-                             std::string_view{value, value_len}};
+      break;
+    default:
+      break;
   }
-  *num_headers = n_headers;
-  return buf;
 }
 
-#else
-
 static const char *parse_headers(const char *buf, const char *buf_end,
                                  http_header *headers, size_t *num_headers,
                                  size_t max_headers, int *ret,
-                                 bool &has_connection, bool &has_close,
-                                 bool &has_upgrade) {
+                                 http_known_headers &known) {
   for (;; ++*num_headers) {
     const char *name;
     size_t name_len;
@@ -841,35 +638,13 @@ static const char *parse_headers(const char *buf, const char *buf_end,
         NULL) {
       return NULL;
     }
-    if (name_len == 10) {
-      if (memcmp(name + 1, "onnection", name_len - 1) == 0) {
-        // has connection
-        has_connection = true;
-        char ch = *value;
-        if (ch == 'U' || ch == 'u') {
-          // has upgrade
-          has_upgrade = true;
-        }
-        else if (ch == 'c' || ch == 'C') {
-          // has_close
-          has_close = true;
-        }
-        else if (ch == 'k' || ch == 'K') {
-          std::string_view val_str{value, value_len};
-          if (val_str.find("pgrade") != std::string_view::npos) {
-            has_upgrade = true;
-          }
-        }
-      }
-    }
+    check_known_header(name, name_len, value, value_len, known);
     headers[*num_headers] = {std::string_view{name, name_len},
                              std::string_view{value, value_len}};
   }
   return buf;
 }
 
-#endif
-
 #define ADVANCE_PATH(tok, toklen, has_query)                                  \
   do {                                                                        \
     const char *tok_start = buf;                                              \
@@ -889,21 +664,20 @@ static const char *parse_headers(const char *buf, const char *buf_end,
           return NULL;                                                        \
         }                                                                     \
       }                                                                       \
-      else if (unlikely(*buf == '?')) {                                       \
-        has_query = true;                                                     \
-      }                                                                       \
       ++buf;                                                                  \
       CHECK_EOF();                                                            \
     }                                                                         \
     tok = tok_start;                                                          \
     toklen = buf - tok_start;                                                 \
+    /* the simd scan skips '?', so look for it separately */                  \
+    has_query = memchr(tok, '?', toklen) != NULL;                             \
   } while (0)
 
 static const char *parse_request(
     const char *buf, const char *buf_end, const char **method,
     size_t *method_len, const char **path, size_t *path_len, int *minor_version,
     http_header *headers, size_t *num_headers, size_t max_headers, int *ret,
-    bool &has_connection, bool &has_close, bool &has_upgrade, bool &has_query) {
+    http_known_headers &known, bool &has_query) {
   /* skip first empty line (some clients add CRLF after POST content) */
   CHECK_EOF();
   if (*buf == '\015') {
@@ -935,7 +709,7 @@ static const char *parse_request(
   }
 
   return parse_headers(buf, buf_end, headers, num_headers, max_headers, ret,
-                       has_connection, has_close, has_upgrade);
+                       known);
 }
 
 inline int phr_parse_request(const char *buf_start, size_t len,
@@ -943,8 +717,7 @@ inline int phr_parse_request(const char *buf_start, size_t len,
                              const char **path, size_t *path_len,
                              int *minor_version, http_header *headers,
                              size_t *num_headers, size_t last_len,
-                             bool &has_connection, bool &has_close,
-                             bool &has_upgrade, bool &has_query) {
+                             http_known_headers &known, bool &has_query) {
   const char *buf = buf_start, *buf_end = buf_start + len;
   size_t max_headers = *num_headers;
   int r;
@@ -955,6 +728,8 @@ inline int phr_parse_request(const char *buf_start, size_t len,
   *path_len = 0;
   *minor_version = -1;
   *num_headers = 0;
+  known = {};
+  has_query = false;
 
   /* if last_len != 0, check if the request is complete (a fast countermeasure
   againt slowloris */
@@ -962,21 +737,21 @@ inline int phr_parse_request(const char *buf_start, size_t len,
     return r;
   }
 
-  if ((buf = parse_request(buf + last_len, buf_end, method, method_len, path,
-                           path_len, minor_version, headers, num_headers,
-                           max_headers, &r, has_connection, has_close,
-                           has_upgrade, has_query)) == NULL) {
+  if ((buf = parse_request(buf, buf_end, method, method_len, path, path_len,
+                           minor_version, headers, num_headers, max_headers,
+                           &r, known, has_query)) == NULL) {
     return r;
   }
 
-  return (int)(buf - buf_start - last_len);
+  return (int)(buf - buf_start);
 }
 
 inline const char *parse_response(const char *buf, const char *buf_end,
                                   int *minor_version, int *status,
                                   const char **msg, size_t *msg_len,
                                   http_header *headers, size_t *num_headers,
-                                  size_t max_headers, int *ret) {
+                                  size_t max_headers, int *ret,
+                                  http_known_headers &known) {
   /* parse "HTTP/1.x" */
   if ((buf = parse_http_version(buf, buf_end, minor_version, ret)) == NULL) {
     return NULL;
@@ -1004,16 +779,15 @@ inline const char *parse_response(const char *buf, const char *buf_end,
     return NULL;
   }
 
-  bool has_connection, has_close, has_upgrade;
-
   return parse_headers(buf, buf_end, headers, num_headers, max_headers, ret,
-                       has_connection, has_close, has_upgrade);
+                       known);
 }
 
 inline int phr_parse_response(const char *buf_start, size_t len,
                               int *minor_version, int *status, const char **msg,
                               size_t *msg_len, http_header *headers,
-                              size_t *num_headers, size_t last_len) {
+                              size_t *num_headers, size_t last_len,
+                              http_known_headers &known) {
   const char *buf = buf_start, *buf_end = buf + len;
   size_t max_headers = *num_headers;
   int r;
@@ -1023,6 +797,7 @@ inline int phr_parse_response(const char *buf_start, size_t len,
   *msg = NULL;
   *msg_len = 0;
   *num_headers = 0;
+  known = {};
 
   /* if last_len != 0, check if the response is complete (a fast countermeasure
   against slowloris */
@@ -1031,7 +806,8 @@ inline int phr_parse_response(const char *buf_start, size_t len,
   }
 
   if ((buf = parse_response(buf, buf_end, minor_version, status, msg, msg_len,
-                            headers, num_headers, max_headers, &r)) == NULL) {
+                            headers, num_headers, max_headers, &r, known)) ==
+      NULL) {
     return r;
   }
 
@@ -1053,9 +829,9 @@ inline int phr_parse_headers(const char *buf_start, size_t len,
     return r;
   }
 
-  bool has_connection, has_close, has_upgrade;
+  http_known_headers known;
   if ((buf = parse_headers(buf, buf_end, headers, num_headers, max_headers, &r,
-                           has_connection, has_close, has_upgrade)) == NULL) {
+                           known)) == NULL) {
     return r;
   }
 
@@ -1,5 +1,9 @@
 #pragma once
+#include <algorithm>
+#include <array>
+#include <iterator>
 #include <string_view>
+#include <utility>
 
 #include "define.h"
 
@@ -240,4 +244,92 @@ inline constexpr std::string_view default_status_content(status_type status) {
   return str.substr(9, str.size() - 11);
 }
 
+namespace detail {
+// "status line" + "Server: cinatra\r\n" + "Content-Type: xxx\r\n"
+template <status_type Status, int ContentType>
+constexpr auto make_resp_head_template() {
+  constexpr std::string_view status = to_http_status_string(Status);
+  constexpr std::string_view type = [] {
+    if constexpr (ContentType < 0) {
+      return std::string_view{};
+    }
+    else {
+      return content_type_arr[ContentType];
+    }
+  }();
+  std::array<char, status.size() + CINATRA_HOST_SV.size() + type.size()> arr{};
+  auto it = std::copy(status.begin(), status.end(), arr.begin());
+  it = std::copy(CINATRA_HOST_SV.begin(), CINATRA_HOST_SV.end(), it);
+  std::copy(type.begin(), type.end(), it);
+  return arr;
+}
+
+template <status_type Status, int ContentType>
+inline constexpr auto resp_head_template =
+    make_resp_head_template<Status, ContentType>();
+
+inline constexpr status_type template_status[] = {
+    status_type::ok,
+    status_type::created,
+    status_type::accepted,
+    status_type::no_content,
+    status_type::partial_content,
+    status_type::moved_permanently,
+    status_type::moved_temporarily,
+    status_type::not_modified,
+    status_type::bad_request,
+    status_type::unauthorized,
+    status_type::forbidden,
+    status_type::not_found,
+    status_type::method_not_allowed,
+    status_type::internal_server_error,
+    status_type::service_unavailable};
+
+// -1 means no Content-Type set by set_content_type.
+inline constexpr int template_content_type[] = {
+    -1,
+    resp_content_type::json,
+    resp_content_type::txt,
+    resp_content_type::html,
+    resp_content_type::js,
+    resp_content_type::css,
+    resp_content_type::xml};
+
+template <size_t... I>
+constexpr auto make_resp_head_templates(std::index_sequence<I...>) {
+  constexpr size_t n = std::size(template_content_type);
+  return std::array<std::string_view, sizeof...(I)>{std::string_view{
+      resp_head_template<template_status[I / n],
+                         template_content_type[I % n]>
+          .data(),
+      resp_head_template<template_status[I / n],
+                         template_content_type[I % n]>
+          .size()}...};
+}
+
+inline constexpr auto resp_head_templates = make_resp_head_templates(
+    std::make_index_sequence<std::size(template_status) *
+                             std::size(template_content_type)>{});
+}  // namespace detail
+
+// The head of the common responses starts with a block concatenated at compile
+// time, returns empty if the status or content type isn't a common one.
+inline std::string_view get_resp_head_template(status_type status,
+                                               int content_type) {
+  using namespace detail;
+  auto s = std::find(std::begin(template_status), std::end(template_status),
+                     status);
+  if (s == std::end(template_status)) {
+    return {};
+  }
+  auto t = std::find(std::begin(template_content_type),
+                     std::end(template_content_type), content_type);
+  if (t == std::end(template_content_type)) {
+    return {};
+  }
+  return resp_head_templates[(s - std::begin(template_status)) *
+                                 std::size(template_content_type) +
+                             (t - std::begin(template_content_type))];
+}
+
 }  // namespace cinatra
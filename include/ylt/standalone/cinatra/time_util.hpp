@@ -424,4 +424,29 @@ inline std::string_view get_gmt_time_str() {
   return get_gmt_time_str(std::chrono::system_clock::now());
 }
 
+// The whole "Date: xxx GMT\r\n" header line of a response, it's formatted at
+// most once per second by each thread, std::time is cheaper than
+// system_clock::now for that.
+inline std::string_view get_date_header_str() {
+  static thread_local char buf[64];
+  static thread_local std::time_t last_sec = -1;
+  static thread_local size_t last_size{};
+
+  std::time_t now = std::time(nullptr);
+  if (now == last_sec) {
+    return {buf, last_size};
+  }
+
+  char time_buf[32];
+  auto str = get_gmt_time_str(time_buf, now);
+  memcpy(buf, DATE_SV.data(), DATE_SV.size());
+  memcpy(buf + DATE_SV.size(), str.data(), str.size());
+  last_size = DATE_SV.size() + str.size();
+  memcpy(buf + last_size, CRCF.data(), CRCF.size());
+  last_size += CRCF.size();
+  last_sec = now;
+
+  return {buf, last_size};
+}
+
 }  // namespace cinatra
\ No newline at end of file
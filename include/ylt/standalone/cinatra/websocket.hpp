@@ -1,8 +1,54 @@
 #pragma once
+#include <memory>
+
 #include "utils.hpp"
 #include "ws_define.h"
 
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 namespace cinatra {
+// Xor data with the 4 bytes masking key, the first byte of data is at offset
+// 0 of the key. The key is repeated to 16 bytes so the bulk is done with one
+// vector(or two 64 bit words) xor per 16 bytes.
+inline void ws_mask(char *data, size_t size, const uint8_t (&key)[4]) {
+  uint8_t key16[16];
+  for (size_t i = 0; i < 16; i += 4) {
+    std::memcpy(key16 + i, key, 4);
+  }
+
+  size_t i = 0;
+#if defined(__SSE2__) || defined(_M_X64)
+  __m128i k = _mm_loadu_si128((const __m128i *)key16);
+  for (; i + 16 <= size; i += 16) {
+    __m128i v = _mm_loadu_si128((const __m128i *)(data + i));
+    _mm_storeu_si128((__m128i *)(data + i), _mm_xor_si128(v, k));
+  }
+#elif defined(__ARM_NEON)
+  uint8x16_t k = vld1q_u8(key16);
+  for (; i + 16 <= size; i += 16) {
+    uint8x16_t v = vld1q_u8((const uint8_t *)(data + i));
+    vst1q_u8((uint8_t *)(data + i), veorq_u8(v, k));
+  }
+#endif
+
+  uint64_t k64;
+  std::memcpy(&k64, key16, 8);
+  for (; i + 8 <= size; i += 8) {
+    uint64_t v;
+    std::memcpy(&v, data + i, 8);
+    v ^= k64;
+    std::memcpy(data + i, &v, 8);
+  }
+
+  for (; i < size; ++i) {
+    data[i] ^= key[i % 4];
+  }
+}
+
 enum ws_header_status {
   error = -1,
   complete = 0,
@@ -110,9 +156,7 @@ class websocket {
   ws_frame_type parse_payload(std::span<char> buf) {
     // unmask data:
     if (*(uint32_t *)mask_key_ != 0) {
-      for (size_t i = 0; i < payload_length_; i++) {
-        buf[i] = buf[i] ^ mask_key_[i % 4];
-      }
+      ws_mask(buf.data(), payload_length_, mask_key_);
     }
 
     if (msg_opcode_ == 0x0)
@@ -184,9 +228,7 @@ class websocket {
   }
 
   void encode_ws_payload(std::span<char> &data) {
-    for (size_t i = 0; i < data.size(); ++i) {
-      data[i] ^= mask_key_[i % 4];
-    }
+    ws_mask(data.data(), data.size(), mask_key_);
   }
 
   std::string_view encode_frame(std::span<char> &data, opcode op, bool eof,
@@ -198,6 +240,20 @@ class websocket {
     return ws_header;
   }
 
+  // A complete unmasked server frame, the header and the payload are in one
+  // buffer. It's encoded once and can be sent to any number of connections by
+  // coro_http_connection::write_websocket_frame.
+  static std::shared_ptr<const std::string> encode_server_frame(
+      std::string_view payload, opcode op = opcode::text, bool eof = true) {
+    websocket ws{};
+    auto header = ws.encode_ws_header(payload.size(), op, eof, false, false);
+    auto frame = std::make_shared<std::string>();
+    frame->reserve(header.size() + payload.size());
+    frame->append(header);
+    frame->append(payload);
+    return frame;
+  }
+
   close_frame parse_close_payload(char *src, size_t length) {
     close_frame cf = {};
     if (length >= 2) {
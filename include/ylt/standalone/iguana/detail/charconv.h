@@ -49,6 +49,27 @@ std::pair<const char *, std::errc> from_chars(const char *first,
   }
 }
 
+// the converter of itoa.hpp works up to 32 bits, the 64 bits integers are
+// written 8 digits at a time by it, instead of one digit per division.
+inline char *u64toa(uint64_t value, char *buffer) noexcept {
+  if (value <= UINT32_MAX) {
+    return itoa_fwd(static_cast<uint32_t>(value), buffer);
+  }
+  uint64_t high = value / 100000000;
+  auto low = static_cast<uint32_t>(value - high * 100000000);
+  buffer = u64toa(high, buffer);
+  return dec_::convert<dec_::Fwd>::tail(buffer, low);
+}
+
+inline char *i64toa(int64_t value, char *buffer) noexcept {
+  auto u = static_cast<uint64_t>(value);
+  if (value < 0) {
+    *buffer++ = '-';
+    u = 0 - u;
+  }
+  return u64toa(u, buffer);
+}
+
 // not support uint8 for now
 template <typename T>
 char *to_chars(char *buffer, T value) noexcept {
@@ -62,10 +83,10 @@ char *to_chars(char *buffer, T value) noexcept {
     }
   }
   else if constexpr (std::is_signed_v<U> && (sizeof(U) >= 8)) {
-    return xtoa(value, buffer, 10, 1);  // int64_t
+    return i64toa(value, buffer);
   }
   else if constexpr (std::is_unsigned_v<U> && (sizeof(U) >= 8)) {
-    return xtoa(value, buffer, 10, 0);  // uint64_t
+    return u64toa(value, buffer);
   }
   else if constexpr (std::is_integral_v<U> && (sizeof(U) > 1)) {
     return itoa_fwd(value, buffer);  // only support more than 2 bytes intergal
@@ -0,0 +1,370 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "../define.h"
+
+// The vectorized scanners of the json reader. The structural index of a 64
+// bytes block is built like simdjson's stage 1: the quotes, backslashes and
+// brackets are classified into 64 bits masks, the escaped characters and the
+// string ranges are computed from the masks without branches. The reader
+// uses it to skip the unknown values and to find the end of the strings.
+//
+// AVX2, SSE2 and NEON(aarch64) are picked by the compiler flags, define
+// IGUANA_DISABLE_SIMD to use the scalar code.
+#if !defined(IGUANA_DISABLE_SIMD)
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define IGUANA_SIMD_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define IGUANA_SIMD_SSE2
+#elif defined(__ARM_NEON) && (defined(__aarch64__) || defined(_M_ARM64))
+#include <arm_neon.h>
+#define IGUANA_SIMD_NEON
+#endif
+#endif
+
+namespace iguana::detail {
+
+// 64 bytes of json, each mask has one bit per byte and the lowest bit is the
+// first byte.
+class json_block {
+ public:
+  static constexpr std::size_t size = 64;
+
+  explicit json_block(const char *p) noexcept {
+#if defined(IGUANA_SIMD_AVX2)
+    v_[0] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+    v_[1] = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p + 32));
+#elif defined(IGUANA_SIMD_SSE2)
+    for (int i = 0; i < 4; ++i) {
+      v_[i] = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p + i * 16));
+    }
+#elif defined(IGUANA_SIMD_NEON)
+    for (int i = 0; i < 4; ++i) {
+      v_[i] = vld1q_u8(reinterpret_cast<const uint8_t *>(p + i * 16));
+    }
+#else
+    std::memcpy(v_, p, size);
+#endif
+  }
+
+  // the bytes equal to c.
+  uint64_t eq(char c) const noexcept {
+#if defined(IGUANA_SIMD_AVX2)
+    const __m256i s = _mm256_set1_epi8(c);
+    return to_mask(_mm256_cmpeq_epi8(v_[0], s), _mm256_cmpeq_epi8(v_[1], s));
+#elif defined(IGUANA_SIMD_SSE2)
+    const __m128i s = _mm_set1_epi8(c);
+    return to_mask(_mm_cmpeq_epi8(v_[0], s), _mm_cmpeq_epi8(v_[1], s),
+                   _mm_cmpeq_epi8(v_[2], s), _mm_cmpeq_epi8(v_[3], s));
+#elif defined(IGUANA_SIMD_NEON)
+    const uint8x16_t s = vdupq_n_u8(static_cast<uint8_t>(c));
+    return to_mask(vceqq_u8(v_[0], s), vceqq_u8(v_[1], s), vceqq_u8(v_[2], s),
+                   vceqq_u8(v_[3], s));
+#else
+    uint64_t ret = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+      ret |= static_cast<uint64_t>(v_[i] == c) << i;
+    }
+    return ret;
+#endif
+  }
+
+  // the bytes with the high bit set, the continuation bits of the varints.
+  uint64_t high_bits() const noexcept {
+#if defined(IGUANA_SIMD_AVX2)
+    return to_mask(v_[0], v_[1]);
+#elif defined(IGUANA_SIMD_SSE2)
+    return to_mask(v_[0], v_[1], v_[2], v_[3]);
+#elif defined(IGUANA_SIMD_NEON)
+    auto high = [](uint8x16_t v) {
+      return vreinterpretq_u8_s8(vshrq_n_s8(vreinterpretq_s8_u8(v), 7));
+    };
+    return to_mask(high(v_[0]), high(v_[1]), high(v_[2]), high(v_[3]));
+#else
+    uint64_t ret = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+      ret |= static_cast<uint64_t>(static_cast<uint8_t>(v_[i]) >> 7) << i;
+    }
+    return ret;
+#endif
+  }
+
+ private:
+#if defined(IGUANA_SIMD_AVX2)
+  static uint64_t to_mask(__m256i lo, __m256i hi) noexcept {
+    return static_cast<uint32_t>(_mm256_movemask_epi8(lo)) |
+           (static_cast<uint64_t>(
+                static_cast<uint32_t>(_mm256_movemask_epi8(hi)))
+            << 32);
+  }
+  __m256i v_[2];
+#elif defined(IGUANA_SIMD_SSE2)
+  static uint64_t to_mask(__m128i a, __m128i b, __m128i c,
+                          __m128i d) noexcept {
+    return static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(a))) |
+           (static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(b)))
+            << 16) |
+           (static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(c)))
+            << 32) |
+           (static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(d)))
+            << 48);
+  }
+  __m128i v_[4];
+#elif defined(IGUANA_SIMD_NEON)
+  static uint64_t to_mask(uint8x16_t a, uint8x16_t b, uint8x16_t c,
+                          uint8x16_t d) noexcept {
+    const uint8x16_t bits = {1, 2, 4, 8, 16, 32, 64, 128,
+                             1, 2, 4, 8, 16, 32, 64, 128};
+    uint8x16_t sum0 = vpaddq_u8(vandq_u8(a, bits), vandq_u8(b, bits));
+    uint8x16_t sum1 = vpaddq_u8(vandq_u8(c, bits), vandq_u8(d, bits));
+    sum0 = vpaddq_u8(sum0, sum1);
+    sum0 = vpaddq_u8(sum0, sum0);
+    return vgetq_lane_u64(vreinterpretq_u64_u8(sum0), 0);
+  }
+  uint8x16_t v_[4];
+#else
+  char v_[size];
+#endif
+};
+
+// bit i of the result is the xor of the bits [0, i] of x, it turns the quote
+// mask into the mask of the string ranges.
+IGUANA_INLINE uint64_t prefix_xor(uint64_t x) noexcept {
+  x ^= x << 1;
+  x ^= x << 2;
+  x ^= x << 4;
+  x ^= x << 8;
+  x ^= x << 16;
+  x ^= x << 32;
+  return x;
+}
+
+// The characters escaped by the backslashes, the escape of the last backslash
+// of the block is carried to the next block by prev_escaped.
+IGUANA_INLINE uint64_t find_escaped(uint64_t backslash,
+                                    uint64_t &prev_escaped) noexcept {
+  backslash &= ~prev_escaped;
+  uint64_t follows_escape = backslash << 1 | prev_escaped;
+  constexpr uint64_t even_bits = 0x5555555555555555ULL;
+  uint64_t odd_sequence_starts = backslash & ~even_bits & ~follows_escape;
+  uint64_t sequences_starting_on_even_bits = odd_sequence_starts + backslash;
+  prev_escaped = sequences_starting_on_even_bits < odd_sequence_starts;
+  uint64_t invert_mask = sequences_starting_on_even_bits << 1;
+  return (even_bits ^ invert_mask) & follows_escape;
+}
+
+// Skip the rest of a {...} or [...] value by the structural index, open_count
+// and close_count are the brackets met so far. It stops after the closing
+// bracket, or at a comment which is left to the scalar code, or at end.
+template <char open, char close>
+IGUANA_INLINE const char *skip_until_closed_by_blocks(
+    const char *p, const char *end, std::size_t &open_count,
+    std::size_t &close_count) noexcept {
+  uint64_t prev_escaped = 0;
+  uint64_t prev_in_string = 0;
+  char tail[json_block::size];
+  while (p < end) {
+    const char *data = p;
+    std::size_t len = json_block::size;
+    if (static_cast<std::size_t>(end - p) < json_block::size) {
+      len = static_cast<std::size_t>(end - p);
+      std::memset(tail, ' ', sizeof(tail));
+      std::memcpy(tail, p, len);
+      data = tail;
+    }
+    json_block block(data);
+    uint64_t escaped = find_escaped(block.eq('\\'), prev_escaped);
+    uint64_t quote = block.eq('"') & ~escaped;
+    uint64_t in_string = prefix_xor(quote) ^ prev_in_string;
+    prev_in_string = static_cast<uint64_t>(static_cast<int64_t>(in_string) >>
+                                           63);
+    // the opening quote is in the string mask, the closing one isn't, so the
+    // quotes never count as brackets.
+    uint64_t outside = ~(in_string | quote);
+    uint64_t comment = block.eq('/') & outside;
+    uint64_t opens = block.eq(open) & outside;
+    uint64_t closes = block.eq(close) & outside;
+    uint64_t brackets = opens | closes;
+    if (comment) {
+      // the brackets after the comment are counted by the scalar code.
+      brackets &= (comment & (0 - comment)) - 1;
+    }
+    while (brackets) {
+      int i = countr_zero(brackets);
+      if ((closes >> i) & 1) {
+        if (++close_count == open_count) {
+          return p + i + 1;
+        }
+      }
+      else {
+        ++open_count;
+      }
+      brackets &= brackets - 1;
+    }
+    if (comment) {
+      return p + countr_zero(comment);
+    }
+    p += len;
+  }
+  return end;
+}
+
+#if defined(IGUANA_SIMD_AVX2) || defined(IGUANA_SIMD_SSE2) || \
+    defined(IGUANA_SIMD_NEON)
+#define IGUANA_SIMD_SCAN
+// Find the first byte matching the predicate in [p, end) by vectors, the
+// tail shorter than a vector is left to the caller.
+#if defined(IGUANA_SIMD_AVX2)
+constexpr std::size_t simd_scan_width = 32;
+#else
+constexpr std::size_t simd_scan_width = 16;
+#endif
+
+#if defined(IGUANA_SIMD_AVX2)
+template <char C, char... Rest>
+IGUANA_INLINE __m256i simd_eq_any(__m256i v) noexcept {
+  __m256i m = _mm256_cmpeq_epi8(v, _mm256_set1_epi8(C));
+  if constexpr (sizeof...(Rest) > 0) {
+    return _mm256_or_si256(m, simd_eq_any<Rest...>(v));
+  }
+  else {
+    return m;
+  }
+}
+#elif defined(IGUANA_SIMD_SSE2)
+template <char C, char... Rest>
+IGUANA_INLINE __m128i simd_eq_any(__m128i v) noexcept {
+  __m128i m = _mm_cmpeq_epi8(v, _mm_set1_epi8(C));
+  if constexpr (sizeof...(Rest) > 0) {
+    return _mm_or_si128(m, simd_eq_any<Rest...>(v));
+  }
+  else {
+    return m;
+  }
+}
+#else
+template <char C, char... Rest>
+IGUANA_INLINE uint8x16_t simd_eq_any(uint8x16_t v) noexcept {
+  uint8x16_t m = vceqq_u8(v, vdupq_n_u8(static_cast<uint8_t>(C)));
+  if constexpr (sizeof...(Rest) > 0) {
+    return vorrq_u8(m, simd_eq_any<Rest...>(v));
+  }
+  else {
+    return m;
+  }
+}
+#endif
+
+template <char... C>
+IGUANA_INLINE const char *simd_find(const char *p, const char *end) noexcept {
+  for (; end - p >= static_cast<std::ptrdiff_t>(simd_scan_width);
+       p += simd_scan_width) {
+#if defined(IGUANA_SIMD_AVX2)
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+    uint32_t mask =
+        static_cast<uint32_t>(_mm256_movemask_epi8(simd_eq_any<C...>(v)));
+    if (mask) {
+      return p + countr_zero(mask);
+    }
+#elif defined(IGUANA_SIMD_SSE2)
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    uint32_t mask =
+        static_cast<uint32_t>(_mm_movemask_epi8(simd_eq_any<C...>(v)));
+    if (mask) {
+      return p + countr_zero(mask);
+    }
+#else
+    uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t *>(p));
+    uint8x16_t m = simd_eq_any<C...>(v);
+    // 4 bits per byte
+    uint64_t mask = vget_lane_u64(
+        vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(m), 4)), 0);
+    if (mask) {
+      return p + (countr_zero(mask) >> 2);
+    }
+#endif
+  }
+  return p;
+}
+
+// Find the first byte greater than ' ' in [p, end).
+IGUANA_INLINE const char *simd_find_non_ws(const char *p,
+                                           const char *end) noexcept {
+  for (; end - p >= static_cast<std::ptrdiff_t>(simd_scan_width);
+       p += simd_scan_width) {
+#if defined(IGUANA_SIMD_AVX2)
+    const __m256i s = _mm256_set1_epi8(' ');
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+    uint32_t mask = ~static_cast<uint32_t>(
+        _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_max_epu8(v, s), s)));
+    if (mask) {
+      return p + countr_zero(mask);
+    }
+#elif defined(IGUANA_SIMD_SSE2)
+    const __m128i s = _mm_set1_epi8(' ');
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    uint32_t mask =
+        ~static_cast<uint32_t>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_max_epu8(v, s), s))) &
+        0xffff;
+    if (mask) {
+      return p + countr_zero(mask);
+    }
+#else
+    uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t *>(p));
+    uint8x16_t m = vcgtq_u8(v, vdupq_n_u8(' '));
+    uint64_t mask = vget_lane_u64(
+        vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(m), 4)), 0);
+    if (mask) {
+      return p + (countr_zero(mask) >> 2);
+    }
+#endif
+  }
+  return p;
+}
+
+// Find the first byte written escaped by the json writer in [p, end): the
+// control characters, '"', '\\' and the bytes of the non ascii characters.
+// As signed bytes, the last ones are the negative ones, so one signed
+// comparison finds them with the control characters.
+IGUANA_INLINE const char *simd_find_escape(const char *p,
+                                           const char *end) noexcept {
+  for (; end - p >= static_cast<std::ptrdiff_t>(simd_scan_width);
+       p += simd_scan_width) {
+#if defined(IGUANA_SIMD_AVX2)
+    __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+    __m256i m = _mm256_or_si256(_mm256_cmpgt_epi8(_mm256_set1_epi8(' '), v),
+                                simd_eq_any<'"', '\\'>(v));
+    uint32_t mask = static_cast<uint32_t>(_mm256_movemask_epi8(m));
+    if (mask) {
+      return p + countr_zero(mask);
+    }
+#elif defined(IGUANA_SIMD_SSE2)
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    __m128i m = _mm_or_si128(_mm_cmplt_epi8(v, _mm_set1_epi8(' ')),
+                             simd_eq_any<'"', '\\'>(v));
+    uint32_t mask = static_cast<uint32_t>(_mm_movemask_epi8(m));
+    if (mask) {
+      return p + countr_zero(mask);
+    }
+#else
+    uint8x16_t v = vld1q_u8(reinterpret_cast<const uint8_t *>(p));
+    uint8x16_t m = vorrq_u8(
+        vcltq_s8(vreinterpretq_s8_u8(v), vdupq_n_s8(' ')),
+        simd_eq_any<'"', '\\'>(v));
+    uint64_t mask = vget_lane_u64(
+        vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(m), 4)), 0);
+    if (mask) {
+      return p + (countr_zero(mask) >> 2);
+    }
+#endif
+  }
+  return p;
+}
+#endif
+}  // namespace iguana::detail
@@ -0,0 +1,913 @@
+#pragma once
+#include <string>
+
+#include "iguana/detail/member_matcher.hpp"
+#include "iguana/detail/utf.hpp"
+#include "iguana/json_util.hpp"
+
+namespace iguana {
+
+// a struct alternative of a std::variant with a tag is picked by the value of
+// its tag member, instead of trying the alternatives in order. The tagged
+// alternatives of a variant share the same key, e.g.
+// template <>
+// struct variant_tag<click_event> {
+//   static constexpr std::string_view key = "type";
+//   static constexpr std::string_view value = "click";
+// };
+template <typename T>
+struct variant_tag {};
+
+namespace detail {
+
+template <typename T, typename = void>
+struct has_variant_tag : std::false_type {};
+
+template <typename T>
+struct has_variant_tag<T, std::void_t<decltype(variant_tag<T>::key),
+                                      decltype(variant_tag<T>::value)>>
+    : std::true_type {};
+
+template <typename T>
+constexpr inline bool has_variant_tag_v =
+    has_variant_tag<std::remove_cvref_t<T>>::value;
+
+// the error of the try_ reader, with the same messages from_json throws.
+class json_read_error {
+ public:
+  json_read_error() = default;
+  json_read_error(const json_read_error &) = delete;
+  json_read_error &operator=(const json_read_error &) = delete;
+
+  explicit operator bool() const noexcept { return what_ != nullptr; }
+  const char *what() const noexcept { return what_; }
+
+  // always returns false, so the readers can `return err.set(...)`.
+  bool set(const char *what) noexcept {
+    what_ = what;
+    return false;
+  }
+  bool set(std::string what) {
+    message_ = std::move(what);
+    what_ = message_.c_str();
+    return false;
+  }
+  void clear() noexcept { what_ = nullptr; }
+
+ private:
+  const char *what_ = nullptr;
+  std::string message_;
+};
+
+// the types read by the try_ reader, the others are read by their (possibly
+// user defined) from_json_impl which may throw.
+template <typename T>
+constexpr inline bool json_try_readable_v =
+    num_v<T> || numeric_str_v<T> || char_v<T> || bool_v<T> || string_v<T> ||
+    string_view_v<T> || enum_v<T> || fixed_array_v<T> ||
+    sequence_container_v<T> || map_container_v<T> || tuple_v<T> ||
+    optional_v<T> || smart_ptr_v<T> || variant_v<T> || ylt_refletable_v<T>;
+
+template <typename It>
+IGUANA_INLINE bool json_skip_ws(It &&it, It &&end,
+                                json_read_error &err) noexcept {
+  if (auto error = try_skip_ws(it, end))
+    IGUANA_UNLIKELY { return err.set(error); }
+  return true;
+}
+
+template <char... C, typename It>
+IGUANA_INLINE bool json_match(It &&it, It &&end,
+                              json_read_error &err) noexcept {
+  if (auto error = try_match<C...>(it, end))
+    IGUANA_UNLIKELY { return err.set(error); }
+  return true;
+}
+
+template <typename U, typename It, std::enable_if_t<optional_v<U>, int> = 0>
+IGUANA_INLINE bool try_from_json_impl(U &value, It &&it, It &&end,
+                                      json_read_error &err);
+
+template <typename U, typename It, std::enable_if_t<tuple_v<U>, int> = 0>
+IGUANA_INLINE bool try_from_json_impl(U &value, It &&it, It &&end,
+                                      json_read_error &err);
+
+template <typename U, typename It,
+          std::enable_if_t<map_container_v<U>, int> = 0>
+IGUANA_INLINE bool try_from_json_impl(U &value, It &&it, It &&end,
+                                      json_read_error &err);
+
+template <typename U, typename It,
+          std::enable_if_t<sequence_container_v<U>, int> = 0>
+IGUANA_INLINE bool try_from_json_impl(U &value, It &&it, It &&end,
+                                      json_read_error &err);
+
+template <typename U, typename It, std::enable_if_t<fixed_array_v<U>, int> = 0>
+IGUANA_INLINE bool try_from_json_impl(U &value, It &&it, It &&end,
+                                      json_read_error &err);
+
+template <typename U, typename It, std::enable_if_t<smart_ptr_v<U>, int> = 0>
+IGUANA_INLINE bool try_from_json_impl(U &value, It &&it, It &&end,
+                                      json_read_error &err);
+
+template <typename U, typename It, std::enable_if_t<variant_v<U>, int> = 0>
+IGUANA_INLINE bool try_from_json_impl(U &value, It &&it, It &&end,
+                                      json_read_error &err);
+
+template <typename U, typename It,
+          std::enable_if_t<ylt_refletable_v<U>, int> = 0>
+IGUANA_INLINE bool try_from_json_impl(U &value, It &&it, It &&end,
+                                      json_read_error &err);
+
+template <typename U, typename It,
+          std::enable_if_t<!json_try_readable_v<U>, int> = 0>
+IGUANA_INLINE bool try_from_json_impl(U &value, It &&it, It &&end,
+                                      json_read_error &err) {
+  try {
+    from_json_impl(value, it, end);
+    return true;
+  } catch (std::exception &e) {
+    return err.set(std::string(e.what()));
+  }
+}
+
+template <typename It>
+IGUANA_INLINE const char *try_skip_object_value(It &&it, It &&end) noexcept {
+  if (auto error = try_skip_ws(it, end))
+    IGUANA_UNLIKELY { return error; }
+  while (it != end) {
+    switch (*it) {
+      case '{':
+        return try_skip_until_closed<'{', '}'>(it, end);
+      case '[':
+        return try_skip_until_closed<'[', ']'>(it, end);
+      case '"':
+        skip_string(it, end);
+        return nullptr;
+      case '/':
+        if (auto error = try_skip_comment(it, end))
+          IGUANA_UNLIKELY { return error; }
+        continue;
+      case ',':
+      case '}':
+      case ']':
+        return nullptr;
+      default: {
+        ++it;
+        continue;
+      }
+    }
+  }
+  return nullptr;
+}
+
+template <typename U, typename It, std::enable_if_t<string_v<U>, int> = 0>
+IGUANA_INLINE bool try_parse_escape(U &value, It &&it, It &&end,
+                                    json_read_error &err) {
+  if (it == end)
+    IGUANA_UNLIKELY { return err.set(R"(Expected ")"); }
+  if (*it == 'u') {
+    ++it;
+    if (std::distance(it, end) <= 4)
+      IGUANA_UNLIKELY { return err.set(R"(Expected 4 hexadecimal digits)"); }
+    auto hex = it;
+    for (int i = 0; i < 4; ++i, ++hex) {
+      const char c = *hex;
+      if (!((c >= '0' && c <= '9') || (c >= 'A' && c <= 'F') ||
+            (c >= 'a' && c <= 'f')))
+        IGUANA_UNLIKELY { return err.set("Invalid Unicode Escape Hex"); }
+    }
+    encode_utf8(value, parse_unicode_hex4(it));
+    return true;
+  }
+  switch (*it) {
+    case 'n':
+      value.push_back('\n');
+      break;
+    case 't':
+      value.push_back('\t');
+      break;
+    case 'r':
+      value.push_back('\r');
+      break;
+    case 'b':
+      value.push_back('\b');
+      break;
+    case 'f':
+      value.push_back('\f');
+      break;
+    default:
+      value.push_back(*it);  // add the escaped character
+  }
+  ++it;
+  return true;
+}
+
+template <typename U, typename It, std::enable_if_t<num_v<U>, int> = 0>
+IGUANA_INLINE bool try_from_json_impl(U &value, It &&it, It &&end,
+                                      json_read_error &err) {
+  if (!json_skip_ws(it, end, err))
+    IGUANA_UNLIKELY { return false; }
+  if constexpr (contiguous_iterator<std::decay_t<It>>) {
+    const auto size = std::distance(it, end);
+    if (size == 0)
+      IGUANA_UNLIKELY { return err.set("Failed to parse number"); }
+    const auto start = &*it;
+    auto [p, ec] = detail::from_chars<false>(start, start + size, value);
+    if (ec != std::errc{} || !can_follow_number(*p))
+      IGUANA_UNLIKELY { return err.set("Failed to parse number"); }
+    it += (p - &*it);
+  }
+  else {
+    char buffer[256];
+    size_t i{};
+    while (it != end && is_numeric(*it)) {
+      if (i > 254)
+        IGUANA_UNLIKELY { return err.set("Number is too long"); }
+      buffer[i] = *it++;
+      ++i;
+    }
+    auto [p, ec] = detail::from_chars<false>(buffer, buffer + i, value);
+    if (ec != std::errc{})
+      IGUANA_UNLIKELY { return err.set("Failed to parse number"); }
+  }
+  return true;
+}
+
+template <typename U, typename It, std::enable_if_t<numeric_str_v<U>, int> = 0>
+IGUANA_INLINE bool try_from_json_impl(U &value, It &&it, It &&end,
+                                      json_read_error &err) {
+  if (!json_skip_ws(it, end, err))
+    IGUANA_UNLIKELY { return false; }
+  auto start = it;
+  while (it != end && is_numeric(*it)) {
+    ++it;
+  }
+  value.value() =
+      std::string_view(&*start, static_cast<size_t>(std::distance(start, it)));
+  return true;
+}
+
+template <bool skip = false, typename U, typename It,
+          std::enable_if_t<char_v<U>, int> = 0>
+IGUANA_INLINE bool try_from_json_impl(U &value, It &&it, It &&end,
+                                      json_read_error &err) {
+  if constexpr (!skip) {
+    if (!json_skip_ws(it, end, err) || !json_match<'"'>(it, end, err))
+      IGUANA_UNLIKELY { return false; }
+  }
+  if (it == end)
+    IGUANA_UNLIKELY { return err.set("Unxpected end of buffer"); }
+  if (*it == '\\')
+    IGUANA_UNLIKELY {
+      if (++it == end)
+        IGUANA_UNLIKELY { return err.set("Unxpected end of buffer"); }
+      switch (*it) {
+        case 'n':
+          value = '\n';
+          break;
+        case 't':
+          value = '\t';
+          break;
+        case 'r':
+          value = '\r';
+          break;
+        case 'b':
+          value = '\b';
+          break;
+        case 'f':
+          value = '\f';
+          break;
+        default:
+          value = *it;
+      }
+    }
+  else {
+    value = *it;
+  }
+  ++it;
+  if constexpr (!skip) {
+    return json_match<'"'>(it, end, err);
+  }
+  return true;
+}
+
+template <typename U, typename It, std::enable_if_t<bool_v<U>, int> = 0>
+IGUANA_INLINE bool try_from_json_impl(U &&value, It &&it, It &&end,
+                                      json_read_error &err) {
+  if (!json_skip_ws(it, end, err))
+    IGUANA_UNLIKELY { return false; }
+  if (it != end)
+    IGUANA_LIKELY {
+      switch (*it) {
+        case 't':
+          ++it;
+          value = true;
+          return json_match<'r', 'u', 'e'>(it, end, err);
+        case 'f':
+          ++it;
+          value = false;
+          return json_match<'a', 'l', 's', 'e'>(it, end, err);
+      }
+    }
+  return err.set("Expected true or false");
+}
+
+template <bool skip = false, typename U, typename It,
+          std::enable_if_t<string_v<U>, int> = 0>
+IGUANA_INLINE bool try_from_json_impl(U &value, It &&it, It &&end,
+                                      json_read_error &err) {
+  if constexpr (!skip) {
+    if (!json_skip_ws(it, end, err) || !json_match<'"'>(it, end, err))
+      IGUANA_UNLIKELY { return false; }
+  }
+  value.clear();
+  if constexpr (contiguous_iterator<std::decay_t<It>>) {
+    auto start = it;
+    while (it < end) {
+      if (auto error = try_skip_till_escape_or_qoute(it, end))
+        IGUANA_UNLIKELY { return err.set(error); }
+      value.append(&*start, static_cast<size_t>(std::distance(start, it)));
+      ++it;
+      if (*(it - 1) == '"') {
+        return true;
+      }
+      // Must be an escape
+      if (!try_parse_escape(value, it, end, err))
+        IGUANA_UNLIKELY { return false; }
+      start = it;
+    }
+  }
+  else {
+    while (it != end) {
+      switch (*it) {
+        IGUANA_UNLIKELY case '\\' : ++it;
+        if (!try_parse_escape(value, it, end, err))
+          IGUANA_UNLIKELY { return false; }
+        break;
+        IGUANA_UNLIKELY case '"' : ++it;
+        return true;
+        IGUANA_LIKELY default : value.push_back(*it);
+        ++it;
+      }
+    }
+  }
+  return err.set(R"(Expected ")");
+}
+
+template <bool skip = false, typename U, typename It,
+          std::enable_if_t<string_view_v<U>, int> = 0>
+IGUANA_INLINE bool try_from_json_impl(U &value, It &&it, It &&end,
+                                      json_read_error &err) {
+  static_assert(contiguous_iterator<std::decay_t<It>>, "must be contiguous");
+  if constexpr (!skip) {
+    if (!json_skip_ws(it, end, err) || !json_match<'"'>(it, end, err))
+      IGUANA_UNLIKELY { return false; }
+  }
+  using T = std::decay_t<U>;
+  auto start = it;
+  while (it != end) {
+    if (auto error = try_skip_till_qoute(it, end))
+      IGUANA_UNLIKELY { return err.set(error); }
+    if (*(it - 1) != '\\') {
+      value = T(&*start, static_cast<size_t>(std::distance(start, it)));
+      ++it;
+      return true;
+    }
+    ++it;
+  }
+  return err.set(R"(Expected ")");
+}
+
+template <typename U, typename It, std::enable_if_t<enum_v<U>, int> = 0>
+IGUANA_INLINE bool try_from_json_impl(U &value, It &&it, It &&end,
+                                      json_read_error &err) {
+  static constexpr auto str_to_enum = get_enum_map<true, std::decay_t<U>>();
+  if constexpr (bool_v<decltype(str_to_enum)>) {
+    // not defined a specialization template
+    using T = std::underlying_type_t<std::decay_t<U>>;
+    return try_from_json_impl(reinterpret_cast<T &>(value), it, end, err);
+  }
+  else {
+    std::string_view enum_names;
+    if (!try_from_json_impl(enum_names, it, end, err))
+      IGUANA_UNLIKELY { return false; }
+    auto enum_it = str_to_enum.find(enum_names);
+    if (enum_it == str_to_enum.end())
+      IGUANA_UNLIKELY {
+        return err.set(std::string(enum_names) +
+                       " missing corresponding value in enum_value");
+      }
+    value = enum_it->second;
+    return true;
+  }
+}
+
+template <typename U, typename It, std::enable_if_t<fixed_array_v<U>, int>>
+IGUANA_INLINE bool try_from_json_impl(U &value, It &&it, It &&end,
+                                      json_read_error &err) {
+  using T = std::remove_reference_t<U>;
+  size_t n = get_array_size(value);
+  if (!json_skip_ws(it, end, err))
+    IGUANA_UNLIKELY { return false; }
+
+  if constexpr (std::is_same_v<char, std::remove_reference_t<
+                                         decltype(std::declval<T>()[0])>>) {
+    if (it != end && *it == '"') {
+      ++it;
+      auto value_it = std::begin(value);
+      for (size_t i = 0; i < n; ++i) {
+        if (it != end && *it != '"')
+          IGUANA_LIKELY {
+            if (!try_from_json_impl<true>(*value_it++, it, end, err))
+              IGUANA_UNLIKELY { return false; }
+          }
+      }
+      return json_match<'"'>(it, end, err);
+    }
+  }
+  if (!json_match<'['>(it, end, err) || !json_skip_ws(it, end, err))
+    IGUANA_UNLIKELY { return false; }
+  if (it == end)
+    IGUANA_UNLIKELY { return err.set("Unexpected end"); }
+
+  if (*it == ']')
+    IGUANA_UNLIKELY {
+      ++it;
+      return true;
+    }
+  auto value_it = std::begin(value);
+  for (size_t i = 0; i < n; ++i) {
+    if (!try_from_json_impl(*value_it++, it, end, err) ||
+        !json_skip_ws(it, end, err))
+      IGUANA_UNLIKELY { return false; }
+    if (it == end)
+      IGUANA_UNLIKELY { return err.set("Unexpected end"); }
+    if (*it == ',')
+      IGUANA_LIKELY {
+        ++it;
+        if (!json_skip_ws(it, end, err))
+          IGUANA_UNLIKELY { return false; }
+      }
+    else if (*it == ']') {
+      ++it;
+      return true;
+    }
+    else
+      IGUANA_UNLIKELY { return err.set("Expected ]"); }
+  }
+  return true;
+}
+
+template <typename U, typename It,
+          std::enable_if_t<sequence_container_v<U>, int>>
+IGUANA_INLINE bool try_from_json_impl(U &value, It &&it, It &&end,
+                                      json_read_error &err) {
+  value.clear();
+  if (!json_skip_ws(it, end, err) || !json_match<'['>(it, end, err) ||
+      !json_skip_ws(it, end, err))
+    IGUANA_UNLIKELY { return false; }
+  for (size_t i = 0; it != end; ++i) {
+    if (*it == ']')
+      IGUANA_UNLIKELY {
+        ++it;
+        return true;
+      }
+    if (i > 0)
+      IGUANA_LIKELY {
+        if (!json_match<','>(it, end, err))
+          IGUANA_UNLIKELY { return false; }
+      }
+    if (!try_from_json_impl(value.emplace_back(), it, end, err) ||
+        !json_skip_ws(it, end, err))
+      IGUANA_UNLIKELY { return false; }
+  }
+  return err.set("Expected ]");
+}
+
+template <typename It>
+IGUANA_INLINE bool try_get_key(std::string_view &key, It &&it, It &&end,
+                               json_read_error &err) {
+  if (!json_skip_ws(it, end, err) || !json_match<'"'>(it, end, err))
+    IGUANA_UNLIKELY { return false; }
+  if constexpr (contiguous_iterator<std::decay_t<It>>) {
+    auto start = it;
+    if (auto error = try_skip_till_escape_or_qoute(it, end))
+      IGUANA_UNLIKELY { return err.set(error); }
+    if (*it == '\\')
+      IGUANA_UNLIKELY {
+        it = start;
+        static thread_local std::string static_key{};
+        if (!try_from_json_impl<true>(static_key, it, end, err))
+          IGUANA_UNLIKELY { return false; }
+        key = static_key;
+        return true;
+      }
+    key = std::string_view{&*start,
+                           static_cast<size_t>(std::distance(start, it))};
+    ++it;
+    if (!key.empty() && key[0] == '@')
+      IGUANA_UNLIKELY { key = key.substr(1); }
+    return true;
+  }
+  else {
+    static thread_local std::string static_key{};
+    if (!try_from_json_impl<true>(static_key, it, end, err))
+      IGUANA_UNLIKELY { return false; }
+    key = static_key;
+    return true;
+  }
+}
+
+template <typename U, typename It, std::enable_if_t<map_container_v<U>, int>>
+IGUANA_INLINE bool try_from_json_impl(U &value, It &&it, It &&end,
+                                      json_read_error &err) {
+  using T = std::remove_reference_t<U>;
+  using key_type = typename T::key_type;
+  if (!json_skip_ws(it, end, err) || !json_match<'{'>(it, end, err) ||
+      !json_skip_ws(it, end, err))
+    IGUANA_UNLIKELY { return false; }
+  bool first = true;
+  while (it != end) {
+    if (*it == '}')
+      IGUANA_UNLIKELY {
+        ++it;
+        return true;
+      }
+    else if (first)
+      IGUANA_UNLIKELY { first = false; }
+    else
+      IGUANA_LIKELY {
+        if (!json_match<','>(it, end, err))
+          IGUANA_UNLIKELY { return false; }
+      }
+
+    std::string_view key;
+    if (!try_get_key(key, it, end, err) || !json_skip_ws(it, end, err) ||
+        !json_match<':'>(it, end, err))
+      IGUANA_UNLIKELY { return false; }
+
+    if constexpr (string_v<key_type> || string_view_v<key_type>) {
+      if (!try_from_json_impl(value[key_type(key)], it, end, err))
+        IGUANA_UNLIKELY { return false; }
+    }
+    else {
+      static thread_local key_type key_value{};
+      if (!try_from_json_impl(key_value, key.begin(), key.end(), err) ||
+          !try_from_json_impl(value[key_value], it, end, err))
+        IGUANA_UNLIKELY { return false; }
+    }
+    if (!json_skip_ws(it, end, err))
+      IGUANA_UNLIKELY { return false; }
+  }
+  return err.set("Expected }");
+}
+
+template <typename U, typename It, std::enable_if_t<tuple_v<U>, int>>
+IGUANA_INLINE bool try_from_json_impl(U &value, It &&it, It &&end,
+                                      json_read_error &err) {
+  if (!json_skip_ws(it, end, err) || !json_match<'['>(it, end, err) ||
+      !json_skip_ws(it, end, err))
+    IGUANA_UNLIKELY { return false; }
+
+  bool ok = true;
+  foreach_tuple(
+      [&](auto &v, auto i) IGUANA__INLINE_LAMBDA {
+        constexpr auto I = decltype(i)::value;
+        if (!ok || it == end || *it == ']') {
+          return;
+        }
+        if constexpr (I != 0) {
+          ok = json_match<','>(it, end, err) && json_skip_ws(it, end, err);
+        }
+        ok = ok && try_from_json_impl(v, it, end, err) &&
+             json_skip_ws(it, end, err);
+      },
+      value);
+
+  return ok && json_match<']'>(it, end, err);
+}
+
+template <typename U, typename It, std::enable_if_t<optional_v<U>, int>>
+IGUANA_INLINE bool try_from_json_impl(U &value, It &&it, It &&end,
+                                      json_read_error &err) {
+  if (!json_skip_ws(it, end, err))
+    IGUANA_UNLIKELY { return false; }
+  using T = std::remove_reference_t<U>;
+  if (it == end)
+    IGUANA_UNLIKELY { return err.set("Unexexpected eof"); }
+  if (*it == 'n') {
+    ++it;
+    if (!json_match<'u', 'l', 'l'>(it, end, err))
+      IGUANA_UNLIKELY { return false; }
+    if constexpr (!std::is_pointer_v<T>) {
+      value.reset();
+      if (it != end && *it == '"') {
+        ++it;
+      }
+    }
+    return true;
+  }
+  using value_type = typename T::value_type;
+  value_type t;
+  if constexpr (string_v<value_type> || string_view_v<value_type>) {
+    if (it != end && *it == '"')
+      IGUANA_LIKELY { ++it; }
+    if (!try_from_json_impl<true>(t, it, end, err))
+      IGUANA_UNLIKELY { return false; }
+  }
+  else {
+    if (!try_from_json_impl(t, it, end, err))
+      IGUANA_UNLIKELY { return false; }
+  }
+  value = std::move(t);
+  return true;
+}
+
+template <typename U, typename It, std::enable_if_t<smart_ptr_v<U>, int>>
+IGUANA_INLINE bool try_from_json_impl(U &value, It &&it, It &&end,
+                                      json_read_error &err) {
+  if (!json_skip_ws(it, end, err))
+    IGUANA_UNLIKELY { return false; }
+  if (it == end)
+    IGUANA_UNLIKELY { return err.set("Unexexpected eof"); }
+  if (*it == 'n') {
+    ++it;
+    return json_match<'u', 'l', 'l'>(it, end, err);
+  }
+  using value_type = typename std::remove_reference_t<U>::element_type;
+  if constexpr (unique_ptr_v<U>) {
+    value = std::make_unique<value_type>();
+  }
+  else {
+    value = std::make_shared<value_type>();
+  }
+  return try_from_json_impl(*value, it, end, err);
+}
+
+template <typename T, size_t... Idx>
+IGUANA_INLINE bool variant_may_start_with(char c, std::index_sequence<Idx...>);
+
+// whether a json value starting with c may be read as a T, the variant only
+// tries the alternatives which may.
+template <typename T>
+IGUANA_INLINE bool json_may_start_with(char c) noexcept {
+  using U = std::remove_cvref_t<T>;
+  if constexpr (num_v<U>) {
+    if constexpr (std::is_floating_point_v<U>) {
+      if (c == 'i' || c == 'n' || c == 'I' || c == 'N') {
+        return true;
+      }
+    }
+    return is_numeric(c);
+  }
+  else if constexpr (numeric_str_v<U>) {
+    return is_numeric(c);
+  }
+  else if constexpr (bool_v<U>) {
+    return c == 't' || c == 'f';
+  }
+  else if constexpr (char_v<U> || string_v<U> || string_view_v<U>) {
+    return c == '"';
+  }
+  else if constexpr (enum_v<U>) {
+    constexpr auto str_to_enum = get_enum_map<true, U>();
+    if constexpr (bool_v<decltype(str_to_enum)>) {
+      return is_numeric(c);
+    }
+    else {
+      return c == '"';
+    }
+  }
+  else if constexpr (fixed_array_v<U>) {
+    using value_type = std::remove_reference_t<decltype(std::declval<U>()[0])>;
+    return c == '[' || (c == '"' && std::is_same_v<char, value_type>);
+  }
+  else if constexpr (sequence_container_v<U> || tuple_v<U>) {
+    return c == '[';
+  }
+  else if constexpr (map_container_v<U> || ylt_refletable_v<U>) {
+    return c == '{';
+  }
+  else if constexpr (optional_v<U>) {
+    return c == 'n' || json_may_start_with<typename U::value_type>(c);
+  }
+  else if constexpr (smart_ptr_v<U>) {
+    return c == 'n' || json_may_start_with<typename U::element_type>(c);
+  }
+  else if constexpr (variant_v<U>) {
+    return variant_may_start_with<U>(
+        c, std::make_index_sequence<std::variant_size_v<U>>{});
+  }
+  else {
+    return true;
+  }
+}
+
+template <typename T, size_t... Idx>
+IGUANA_INLINE bool variant_may_start_with(char c, std::index_sequence<Idx...>) {
+  return (json_may_start_with<variant_element_t<Idx, T>>(c) || ...);
+}
+
+template <typename T>
+constexpr std::string_view variant_tag_key() {
+  if constexpr (has_variant_tag_v<T>) {
+    return variant_tag<T>::key;
+  }
+  else {
+    return {};
+  }
+}
+
+// the tag key of the tagged alternatives of the variant T, empty if they
+// don't share one.
+template <typename T, size_t... Idx>
+constexpr std::string_view variant_tag_key(std::index_sequence<Idx...>) {
+  std::string_view keys[] = {variant_tag_key<variant_element_t<Idx, T>>()...};
+  std::string_view key;
+  for (auto k : keys) {
+    if (k.empty()) {
+      continue;
+    }
+    if (!key.empty() && k != key) {
+      return {};
+    }
+    key = k;
+  }
+  return key;
+}
+
+// finds the string value of the key in the object at it, without moving it.
+template <typename It>
+IGUANA_INLINE bool find_variant_tag(std::string_view key,
+                                    std::string_view &value, It it,
+                                    It end) noexcept {
+  json_read_error err;
+  if (!json_match<'{'>(it, end, err) || !json_skip_ws(it, end, err))
+    IGUANA_UNLIKELY { return false; }
+  while (it != end && *it != '}') {
+    std::string_view name;
+    if (!try_get_key(name, it, end, err) || !json_skip_ws(it, end, err) ||
+        !json_match<':'>(it, end, err) || !json_skip_ws(it, end, err))
+      IGUANA_UNLIKELY { return false; }
+    if (name == key) {
+      if constexpr (contiguous_iterator<std::decay_t<It>>) {
+        return try_from_json_impl(value, it, end, err);
+      }
+      else {
+        static thread_local std::string tag;
+        if (!try_from_json_impl(tag, it, end, err))
+          IGUANA_UNLIKELY { return false; }
+        value = tag;
+        return true;
+      }
+    }
+    if (try_skip_object_value(it, end) || !json_skip_ws(it, end, err))
+      IGUANA_UNLIKELY { return false; }
+    if (it != end && *it == ',') {
+      ++it;
+      if (!json_skip_ws(it, end, err))
+        IGUANA_UNLIKELY { return false; }
+    }
+  }
+  return false;
+}
+
+template <typename value_type, typename U, typename It>
+IGUANA_INLINE bool try_from_json_variant_impl(U &value, It &it, It &end,
+                                              json_read_error &err) {
+  auto start = it;
+  err.clear();
+  value_type val{};
+  if (try_from_json_impl(val, it, end, err))
+    IGUANA_LIKELY {
+      value = std::move(val);
+      return true;
+    }
+  it = start;
+  return false;
+}
+
+template <typename value_type, typename U, typename It>
+IGUANA_INLINE void try_from_json_tagged(U &value, It &it, It &end,
+                                        json_read_error &err,
+                                        std::string_view tag, bool &done,
+                                        bool &ok) {
+  if constexpr (has_variant_tag_v<value_type>) {
+    if (!done && variant_tag<value_type>::value == tag) {
+      done = true;
+      ok = try_from_json_variant_impl<value_type>(value, it, end, err);
+    }
+  }
+}
+
+template <typename U, typename It, size_t... Idx>
+IGUANA_INLINE bool try_from_json_variant(U &value, It &it, It &end,
+                                         json_read_error &err,
+                                         std::index_sequence<Idx...>) {
+  using T = std::remove_reference_t<U>;
+  static_assert(!has_duplicate_type_v<T>,
+                "don't allow same type in std::variant");
+  if (!json_skip_ws(it, end, err))
+    IGUANA_UNLIKELY { return false; }
+  if (it == end)
+    IGUANA_UNLIKELY { return err.set("Unexexpected eof"); }
+  const char c = *it;
+  bool done = false;
+  bool ok = false;
+  if constexpr ((has_variant_tag_v<variant_element_t<Idx, T>> || ...)) {
+    if (c == '{') {
+      constexpr std::string_view key =
+          variant_tag_key<T>(std::index_sequence<Idx...>{});
+      static_assert(!key.empty(),
+                    "the tagged alternatives of a variant must share the "
+                    "same variant_tag key");
+      std::string_view tag;
+      if (find_variant_tag(key, tag, it, end)) {
+        (try_from_json_tagged<variant_element_t<Idx, T>>(value, it, end, err,
+                                                         tag, done, ok),
+         ...);
+        if (done) {
+          return ok;
+        }
+      }
+    }
+  }
+  // the alternatives which may start with c are tried in order, a failed one
+  // costs the parsing until the error, never an exception.
+  ((void)(!ok && json_may_start_with<variant_element_t<Idx, T>>(c) &&
+          (done = true,
+           ok = try_from_json_variant_impl<variant_element_t<Idx, T>>(
+               value, it, end, err))),
+   ...);
+  if (!done)
+    IGUANA_UNLIKELY {
+      return err.set("No alternative of the variant matches the value");
+    }
+  return ok;
+}
+
+template <typename U, typename It, std::enable_if_t<variant_v<U>, int>>
+IGUANA_INLINE bool try_from_json_impl(U &value, It &&it, It &&end,
+                                      json_read_error &err) {
+  return try_from_json_variant(
+      value, it, end, err,
+      std::make_index_sequence<
+          std::variant_size_v<std::remove_reference_t<U>>>{});
+}
+
+template <typename U, typename It, std::enable_if_t<ylt_refletable_v<U>, int>>
+IGUANA_INLINE bool try_from_json_impl(U &value, It &&it, It &&end,
+                                      json_read_error &err) {
+  if (!json_skip_ws(it, end, err) || !json_match<'{'>(it, end, err) ||
+      !json_skip_ws(it, end, err))
+    IGUANA_UNLIKELY { return false; }
+  if (it != end && *it == '}')
+    IGUANA_UNLIKELY {
+      ++it;
+      return true;
+    }
+  using T = ylt::reflection::remove_cvref_t<U>;
+  constexpr auto Count = ylt::reflection::members_count_v<T>;
+  if constexpr (Count > 0) {
+    std::string_view key;
+    if (!try_get_key(key, it, end, err))
+      IGUANA_UNLIKELY { return false; }
+    size_t expected = 0;
+    for (;;) {
+      if (!json_skip_ws(it, end, err) || !json_match<':'>(it, end, err))
+        IGUANA_UNLIKELY { return false; }
+      bool ok = true;
+      bool found = visit_member(value, key, expected,
+                                [&](auto &member) IGUANA__INLINE_LAMBDA {
+                                  ok = try_from_json_impl(member, it, end, err);
+                                });
+      if (found)
+        IGUANA_LIKELY {
+          if (!ok)
+            IGUANA_UNLIKELY { return false; }
+        }
+      else
+        IGUANA_UNLIKELY {
+#ifdef THROW_UNKNOWN_KEY
+          return err.set("Unknown key: " + std::string(key));
+#else
+          if (auto error = try_skip_object_value(it, end))
+            IGUANA_UNLIKELY { return err.set(error); }
+#endif
+        }
+      if (!json_skip_ws(it, end, err))
+        IGUANA_UNLIKELY { return false; }
+      if (it != end && *it == '}')
+        IGUANA_UNLIKELY {
+          ++it;
+          return true;
+        }
+      if (!json_match<','>(it, end, err) || !try_get_key(key, it, end, err))
+        IGUANA_UNLIKELY { return false; }
+    }
+  }
+  return true;
+}
+}  // namespace detail
+}  // namespace iguana
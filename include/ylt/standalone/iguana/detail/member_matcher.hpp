@@ -0,0 +1,242 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <variant>
+
+#include "../util.hpp"
+
+namespace iguana::detail {
+
+// Match the keys of an object to the members of U without hashing. The key is
+// dispatched through a table indexed by its length to the members with names
+// of that length only. Among them a name is told from the others by the
+// character at positions[I], then compared whole as 8-byte words. The member
+// expected next, the one after the last matched, is tried before everything
+// else since the keys are usually in the order of the members.
+template <typename U>
+struct member_matcher {
+  static constexpr size_t count = ylt::reflection::members_count_v<U>;
+  static constexpr size_t npos = static_cast<size_t>(-1);
+
+  // the names as the keys of get_variant_map, without the "___" prefix.
+  static constexpr std::array<std::string_view, count> make_names() {
+    auto names = ylt::reflection::get_member_names<U>();
+    for (auto &name : names) {
+      if (name.size() > 3 && name[0] == '_' && name[1] == '_' &&
+          name[2] == '_') {
+        name.remove_prefix(3);
+      }
+    }
+    return names;
+  }
+  static constexpr auto names = make_names();
+
+  static constexpr size_t make_max_size() {
+    size_t max_size = 0;
+    for (auto name : names) {
+      max_size = name.size() > max_size ? name.size() : max_size;
+    }
+    return max_size;
+  }
+  static constexpr size_t max_size = make_max_size();
+
+  // the structs with long names keep the hash map, the table of lengths would
+  // be mostly empty.
+  static constexpr bool enabled = count > 0 && max_size <= 64;
+
+  // the first position where no other name of the same length has the same
+  // character, npos if there is none.
+  static constexpr std::array<size_t, count> make_positions() {
+    std::array<size_t, count> positions{};
+    for (size_t i = 0; i < count; ++i) {
+      positions[i] = npos;
+      for (size_t pos = 0; pos < names[i].size(); ++pos) {
+        bool unique = true;
+        for (size_t j = 0; j < count; ++j) {
+          if (j != i && names[j].size() == names[i].size() &&
+              names[j][pos] == names[i][pos]) {
+            unique = false;
+            break;
+          }
+        }
+        if (unique) {
+          positions[i] = pos;
+          break;
+        }
+      }
+    }
+    return positions;
+  }
+  static constexpr auto positions = make_positions();
+
+  // the indexes of the members with names of Size characters.
+  template <size_t Size>
+  static constexpr auto make_group() {
+    constexpr size_t n = [] {
+      size_t n = 0;
+      for (auto name : names) {
+        n += name.size() == Size;
+      }
+      return n;
+    }();
+    std::array<size_t, n> group{};
+    size_t k = 0;
+    for (size_t i = 0; i < count; ++i) {
+      if (names[i].size() == Size) {
+        group[k++] = i;
+      }
+    }
+    return group;
+  }
+
+  static constexpr uint64_t load_word(const char *data, size_t size) {
+    uint64_t word = 0;
+    for (size_t i = 0; i < size; ++i) {
+      word |= uint64_t(uint8_t(data[i])) << (8 * i);
+    }
+    return word;
+  }
+
+  IGUANA_INLINE static uint64_t load_key(const char *data, size_t size) {
+    uint64_t word = 0;
+    std::memcpy(&word, data, size);
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    word = __builtin_bswap64(word);
+#endif
+    return word;
+  }
+
+  // key must have the size of names[I].
+  template <size_t I>
+  IGUANA_INLINE static bool equal_same_size(const char *key) {
+    constexpr std::string_view name = names[I];
+    if constexpr (positions[I] != npos) {
+      if (key[positions[I]] != name[positions[I]])
+        IGUANA_LIKELY { return false; }
+    }
+    constexpr size_t head = name.size() < 8 ? name.size() : 8;
+    constexpr uint64_t word = load_word(name.data(), head);
+    if (load_key(key, head) != word) {
+      return false;
+    }
+    if constexpr (name.size() > 8) {
+      return std::memcmp(key + 8, name.data() + 8, name.size() - 8) == 0;
+    }
+    else {
+      return true;
+    }
+  }
+
+  template <size_t I>
+  IGUANA_INLINE static bool equal(std::string_view key) {
+    return key.size() == names[I].size() && equal_same_size<I>(key.data());
+  }
+
+  template <size_t Size, size_t... Ks>
+  IGUANA_INLINE static size_t find_same_size(const char *key,
+                                             std::index_sequence<Ks...>) {
+    if constexpr (sizeof...(Ks) == 0) {
+      // no name of this length.
+      (void)key;
+      return count;
+    }
+    else {
+      constexpr auto group = make_group<Size>();
+      size_t index = count;
+      (void)((equal_same_size<group[Ks]>(key) && (index = group[Ks], true)) ||
+             ...);
+      return index;
+    }
+  }
+
+  template <size_t Size>
+  static size_t find_size(const char *key) {
+    return find_same_size<Size>(
+        key, std::make_index_sequence<make_group<Size>().size()>{});
+  }
+
+  using find_fn = size_t (*)(const char *);
+  template <size_t... Sizes>
+  static constexpr std::array<find_fn, sizeof...(Sizes)> make_find_table(
+      std::index_sequence<Sizes...>) {
+    return {&find_size<Sizes>...};
+  }
+  static constexpr auto find_table =
+      make_find_table(std::make_index_sequence<max_size + 1>{});
+
+  using equal_fn = bool (*)(std::string_view);
+  template <size_t... Is>
+  static constexpr std::array<equal_fn, count> make_equal_table(
+      std::index_sequence<Is...>) {
+    return {&equal<Is>...};
+  }
+  static constexpr auto equal_table =
+      make_equal_table(std::make_index_sequence<count>{});
+
+  // the index of the member named key, count if there is none.
+  IGUANA_INLINE static size_t find(std::string_view key, size_t expected) {
+    if (expected < count && equal_table[expected](key))
+      IGUANA_LIKELY { return expected; }
+    if (key.size() > max_size)
+      IGUANA_UNLIKELY { return count; }
+    return find_table[key.size()](key.data());
+  }
+};
+
+// Call f with the member I of value.
+template <size_t I, typename U, typename F>
+IGUANA_INLINE void visit_member_at(U &value, F &f) {
+  using Tuple = decltype(ylt::reflection::object_to_tuple(std::declval<U>()));
+  using value_type =
+      ylt::reflection::remove_cvref_t<std::tuple_element_t<I, Tuple>>;
+  const auto &offsets = ylt::reflection::internal::get_member_offset_arr(
+      ylt::reflection::internal::wrapper<U>::value);
+  f(*(value_type *)((char *)(&value) + offsets[I]));
+}
+
+template <typename U, typename F, size_t... Is>
+IGUANA_INLINE void visit_member_at(U &value, size_t index, F &f,
+                                   std::index_sequence<Is...>) {
+  using visit_fn = void (*)(U &, F &);
+  static constexpr visit_fn table[] = {&visit_member_at<Is, U, F>...};
+  table[index](value, f);
+}
+
+// Call f with the member of value named key, returns false if there is none.
+// expected is the member tried first, it's moved after the matched one.
+template <typename U, typename F>
+IGUANA_INLINE bool visit_member(U &value, std::string_view key,
+                                size_t &expected, F &&f) {
+  using T = ylt::reflection::remove_cvref_t<U>;
+  if constexpr (member_matcher<T>::enabled) {
+    size_t index = member_matcher<T>::find(key, expected);
+    if (index == member_matcher<T>::count)
+      IGUANA_UNLIKELY { return false; }
+    expected = index + 1;
+    visit_member_at(value, index, f,
+                    std::make_index_sequence<member_matcher<T>::count>{});
+    return true;
+  }
+  else if constexpr (member_matcher<T>::count == 0) {
+    return false;
+  }
+  else {
+    static auto frozen_map = ylt::reflection::get_variant_map<T>();
+    const auto &member_it = frozen_map.find(key);
+    if (member_it == frozen_map.end())
+      IGUANA_UNLIKELY { return false; }
+    std::visit(
+        [&](auto offset) IGUANA__INLINE_LAMBDA {
+          using value_type = typename decltype(offset)::type;
+          f(*(value_type *)((char *)(&value) + offset.value));
+        },
+        member_it->second);
+    return true;
+  }
+}
+}  // namespace iguana::detail
@@ -0,0 +1,536 @@
+#pragma once
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "detail/json_try_reader.hpp"
+
+namespace iguana {
+
+enum class json_type : uint8_t {
+  null,
+  boolean,
+  integer,
+  floating,
+  string,
+  array,
+  object
+};
+
+namespace detail {
+// an entry of the tape, the values in the order of the document. An array is
+// followed by its elements, an object by its keys each followed by its value.
+struct json_tape_entry {
+  json_type type;
+  bool boolean;
+  // the length of a string, the number of elements of an array or an object
+  uint32_t size;
+  union {
+    int64_t integer;
+    double floating;
+    const char *string;
+    // the index after the last entry of an array or an object
+    size_t end;
+  };
+};
+static_assert(sizeof(json_tape_entry) == 16);
+
+struct json_arena_writer {
+  char *p;
+  void push_back(char c) { *p++ = c; }
+};
+}  // namespace detail
+
+class json_document;
+
+// a handle to a value of a json_document, cheap to copy and valid as long as
+// the document isn't parsed again or destroyed.
+class json_element {
+ public:
+  class iterator {
+   public:
+    using difference_type = std::ptrdiff_t;
+    using value_type = json_element;
+    using pointer = void;
+    using reference = json_element;
+    using iterator_category = std::forward_iterator_tag;
+
+    iterator() = default;
+    json_element operator*() const {
+      return json_element(document_, index_, is_member_);
+    }
+    iterator &operator++() {
+      index_ = json_element(document_, index_, false).next_index() + is_member_;
+      return *this;
+    }
+    iterator operator++(int) {
+      auto tmp = *this;
+      ++*this;
+      return tmp;
+    }
+    bool operator==(const iterator &other) const {
+      return index_ == other.index_;
+    }
+    bool operator!=(const iterator &other) const { return !(*this == other); }
+
+   private:
+    friend class json_element;
+    iterator(const json_document *document, size_t index, bool is_member)
+        : document_(document), index_(index), is_member_(is_member) {}
+
+    const json_document *document_ = nullptr;
+    size_t index_ = 0;
+    bool is_member_ = false;
+  };
+
+  json_element() = default;
+
+  json_type type() const { return entry().type; }
+  bool is_null() const { return type() == json_type::null; }
+  bool is_bool() const { return type() == json_type::boolean; }
+  bool is_int() const { return type() == json_type::integer; }
+  bool is_double() const { return type() == json_type::floating; }
+  bool is_number() const { return is_int() || is_double(); }
+  bool is_string() const { return type() == json_type::string; }
+  bool is_array() const { return type() == json_type::array; }
+  bool is_object() const { return type() == json_type::object; }
+
+  // the number of the elements of an array or an object, the length of a
+  // string.
+  size_t size() const { return entry().size; }
+
+  // the key of a value iterated or found in an object.
+  std::string_view key() const {
+    if (!is_member_)
+      IGUANA_UNLIKELY {
+        throw std::invalid_argument("not a member of an object");
+      }
+    return json_element(document_, index_ - 1, false).get<std::string_view>();
+  }
+
+  // bool, the arithmetic types, std::string_view and std::string. If the type
+  // doesn't match, throws std::invalid_argument, or sets the ec if passed.
+  template <typename T>
+  T get() const {
+    const auto &e = entry();
+    if constexpr (std::is_same_v<T, bool>) {
+      check_type(json_type::boolean);
+      return e.boolean;
+    }
+    else if constexpr (std::is_integral_v<T>) {
+      check_type(json_type::integer);
+      if (e.integer < static_cast<int64_t>(std::numeric_limits<T>::min()) ||
+          (e.integer > 0 && static_cast<uint64_t>(e.integer) >
+                                std::numeric_limits<T>::max()))
+        IGUANA_UNLIKELY { throw std::invalid_argument("int out of range"); }
+      return static_cast<T>(e.integer);
+    }
+    else if constexpr (std::is_floating_point_v<T>) {
+      if (e.type == json_type::integer) {
+        return static_cast<T>(e.integer);
+      }
+      check_type(json_type::floating);
+      return static_cast<T>(e.floating);
+    }
+    else if constexpr (std::is_same_v<T, std::string_view>) {
+      check_type(json_type::string);
+      return std::string_view(e.string, e.size);
+    }
+    else if constexpr (std::is_same_v<T, std::string>) {
+      return std::string(get<std::string_view>());
+    }
+    else {
+      static_assert(!sizeof(T), "not a json value type");
+    }
+  }
+
+  template <typename T>
+  T get(std::error_code &ec) const {
+    try {
+      return get<T>();
+    } catch (std::exception &e) {
+      ec = iguana::make_error_code(e.what());
+      return T{};
+    }
+  }
+
+  template <typename T>
+  std::error_code get_to(T &v) const {
+    std::error_code ec;
+    v = get<T>(ec);
+    return ec;
+  }
+
+  // the objects are searched linearly, in the order of the document.
+  std::optional<json_element> find(std::string_view key) const {
+    check_type(json_type::object);
+    for (auto value : *this) {
+      if (value.key() == key) {
+        return value;
+      }
+    }
+    return std::nullopt;
+  }
+
+  bool contains(std::string_view key) const { return find(key).has_value(); }
+
+  json_element at(std::string_view key) const {
+    auto value = find(key);
+    if (!value)
+      IGUANA_UNLIKELY { throw std::invalid_argument("the key is unknown"); }
+    return *value;
+  }
+
+  json_element at(size_t idx) const {
+    check_type(json_type::array);
+    if (idx >= size())
+      IGUANA_UNLIKELY { throw std::out_of_range("idx is out of range"); }
+    auto it = begin();
+    for (; idx > 0; --idx) {
+      ++it;
+    }
+    return *it;
+  }
+
+  json_element operator[](std::string_view key) const { return at(key); }
+  json_element operator[](size_t idx) const { return at(idx); }
+
+  // iterates the elements of an array or the values of an object.
+  iterator begin() const {
+    if (!is_array() && !is_object())
+      IGUANA_UNLIKELY {
+        throw std::invalid_argument("not an array or an object");
+      }
+    return iterator(document_, index_ + 1 + is_object(), is_object());
+  }
+  iterator end() const {
+    return iterator(document_, entry().end + is_object(), is_object());
+  }
+
+ private:
+  friend class json_document;
+  json_element(const json_document *document, size_t index, bool is_member)
+      : document_(document), index_(index), is_member_(is_member) {}
+
+  inline const detail::json_tape_entry &entry() const;
+
+  size_t next_index() const {
+    const auto &e = entry();
+    if (e.type == json_type::array || e.type == json_type::object) {
+      return e.end;
+    }
+    return index_ + 1;
+  }
+
+  void check_type(json_type type) const {
+    static constexpr std::string_view names[] = {
+        "null type",   "bool type",  "int type",   "double type",
+        "string type", "array type", "object type"};
+    if (entry().type != type)
+      IGUANA_UNLIKELY {
+        throw std::invalid_argument(
+            std::string(names[static_cast<size_t>(entry().type)]));
+      }
+  }
+
+  const json_document *document_ = nullptr;
+  size_t index_ = 0;
+  bool is_member_ = false;
+};
+
+// the dom of iguana::parse into a tape: all the values in one array, the
+// strings and the keys are views of the parsed buffer, only the escaped ones
+// are copied. The buffer must outlive the document. Parsing again reuses the
+// memory of the document.
+class json_document {
+ public:
+  json_document() = default;
+  json_document(json_document &&) = default;
+  json_document &operator=(json_document &&) = default;
+
+  bool empty() const { return tape_.empty(); }
+  void clear() { tape_.clear(); }
+
+  json_element root() const {
+    if (empty())
+      IGUANA_UNLIKELY { throw std::invalid_argument("empty document"); }
+    return json_element(this, 0, false);
+  }
+
+  // set parse_as_double == true, parse the number as double in any case
+  bool parse(const char *begin, const char *end, detail::json_read_error &err,
+             bool parse_as_double = false) {
+    tape_.clear();
+    tape_.reserve(static_cast<size_t>(end - begin) / 8 + 1);
+    buffer_size_ = static_cast<size_t>(end - begin);
+    strings_used_ = 0;
+    parse_as_double_ = parse_as_double;
+    if (!parse_value(begin, end, err) ||
+        !detail::json_skip_ws(begin, end, err) ||
+        (begin != end && !err.set("Unexpected content after the value")))
+      IGUANA_UNLIKELY {
+        tape_.clear();
+        return false;
+      }
+    return true;
+  }
+
+ private:
+  friend class json_element;
+
+  size_t push(json_type type) {
+    auto &e = tape_.emplace_back();
+    e.type = type;
+    e.boolean = false;
+    e.size = 0;
+    e.integer = 0;
+    return tape_.size() - 1;
+  }
+
+  bool parse_value(const char *&it, const char *end,
+                   detail::json_read_error &err) {
+    if (!detail::json_skip_ws(it, end, err))
+      IGUANA_UNLIKELY { return false; }
+    if (it == end)
+      IGUANA_UNLIKELY { return err.set("Unexpected end"); }
+    switch (*it) {
+      case 'n':
+        ++it;
+        push(json_type::null);
+        return detail::json_match<'u', 'l', 'l'>(it, end, err);
+      case 't':
+        ++it;
+        tape_[push(json_type::boolean)].boolean = true;
+        return detail::json_match<'r', 'u', 'e'>(it, end, err);
+      case 'f':
+        ++it;
+        push(json_type::boolean);
+        return detail::json_match<'a', 'l', 's', 'e'>(it, end, err);
+      case '"':
+        return parse_string(it, end, err);
+      case '[':
+        return parse_array(it, end, err);
+      case '{':
+        return parse_object(it, end, err);
+      default:
+        return parse_number(it, end, err);
+    }
+  }
+
+  bool parse_number(const char *&it, const char *end,
+                    detail::json_read_error &err) {
+    auto &e = tape_[push(json_type::integer)];
+    if (!parse_as_double_) {
+      auto [p, ec] = detail::from_chars<false>(it, end, e.integer);
+      if (ec == std::errc{} && (p == end || can_follow_number(*p)))
+        IGUANA_LIKELY {
+          it = p;
+          return true;
+        }
+    }
+    e.type = json_type::floating;
+    auto [p, ec] = detail::from_chars<false>(it, end, e.floating);
+    if (ec != std::errc{} || (p != end && !can_follow_number(*p)))
+      IGUANA_UNLIKELY { return err.set("Failed to parse number"); }
+    it = p;
+    return true;
+  }
+
+  bool parse_string(const char *&it, const char *end,
+                    detail::json_read_error &err) {
+    ++it;
+    auto index = push(json_type::string);
+    auto start = it;
+    if (auto error = try_skip_till_escape_or_qoute(it, end))
+      IGUANA_UNLIKELY { return err.set(error); }
+    if (*it == '"')
+      IGUANA_LIKELY {
+        return set_string(tape_[index], start, it++ - start, err);
+      }
+
+    // the unescaped strings are never longer than the escaped ones, so the
+    // arena of the size of the buffer is never full.
+    if (strings_capacity_ < buffer_size_) {
+      strings_.reset(new char[buffer_size_]);
+      strings_capacity_ = buffer_size_;
+      strings_used_ = 0;
+    }
+    detail::json_arena_writer out{strings_.get() + strings_used_};
+    for (;;) {
+      std::memcpy(out.p, start, static_cast<size_t>(it - start));
+      out.p += it - start;
+      if (*it++ == '"') {
+        break;
+      }
+      if (it == end)
+        IGUANA_UNLIKELY { return err.set(R"(Expected ")"); }
+      if (*it == 'u') {
+        ++it;
+        if (end - it < 4)
+          IGUANA_UNLIKELY {
+            return err.set(R"(Expected 4 hexadecimal digits)");
+          }
+        for (int i = 0; i < 4; ++i) {
+          const char c = it[i];
+          if (!((c >= '0' && c <= '9') || (c >= 'A' && c <= 'F') ||
+                (c >= 'a' && c <= 'f')))
+            IGUANA_UNLIKELY { return err.set("Invalid Unicode Escape Hex"); }
+        }
+        encode_utf8(out, parse_unicode_hex4(it));
+      }
+      else {
+        switch (*it) {
+          case 'n':
+            out.push_back('\n');
+            break;
+          case 't':
+            out.push_back('\t');
+            break;
+          case 'r':
+            out.push_back('\r');
+            break;
+          case 'b':
+            out.push_back('\b');
+            break;
+          case 'f':
+            out.push_back('\f');
+            break;
+          default:
+            out.push_back(*it);
+        }
+        ++it;
+      }
+      start = it;
+      if (auto error = try_skip_till_escape_or_qoute(it, end))
+        IGUANA_UNLIKELY { return err.set(error); }
+    }
+    const char *string = strings_.get() + strings_used_;
+    strings_used_ = static_cast<size_t>(out.p - strings_.get());
+    return set_string(tape_[index], string, out.p - string, err);
+  }
+
+  bool set_string(detail::json_tape_entry &e, const char *string,
+                  std::ptrdiff_t size, detail::json_read_error &err) {
+    if (static_cast<uint64_t>(size) > UINT32_MAX)
+      IGUANA_UNLIKELY { return err.set("String is too long"); }
+    e.string = string;
+    e.size = static_cast<uint32_t>(size);
+    return true;
+  }
+
+  bool parse_array(const char *&it, const char *end,
+                   detail::json_read_error &err) {
+    ++it;
+    auto index = push(json_type::array);
+    uint32_t size = 0;
+    if (!detail::json_skip_ws(it, end, err))
+      IGUANA_UNLIKELY { return false; }
+    if (it != end && *it == ']') {
+      ++it;
+    }
+    else {
+      for (;; ++size) {
+        if (!parse_value(it, end, err) || !detail::json_skip_ws(it, end, err))
+          IGUANA_UNLIKELY { return false; }
+        if (it != end && *it == ']') {
+          ++it;
+          ++size;
+          break;
+        }
+        if (!detail::json_match<','>(it, end, err))
+          IGUANA_UNLIKELY { return false; }
+      }
+    }
+    tape_[index].size = size;
+    tape_[index].end = tape_.size();
+    return true;
+  }
+
+  bool parse_object(const char *&it, const char *end,
+                    detail::json_read_error &err) {
+    ++it;
+    auto index = push(json_type::object);
+    uint32_t size = 0;
+    if (!detail::json_skip_ws(it, end, err))
+      IGUANA_UNLIKELY { return false; }
+    if (it != end && *it == '}') {
+      ++it;
+    }
+    else {
+      for (;; ++size) {
+        if (it == end || *it != '"')
+          IGUANA_UNLIKELY { return err.set(R"(Expected ")"); }
+        if (!parse_string(it, end, err) ||
+            !detail::json_skip_ws(it, end, err) ||
+            !detail::json_match<':'>(it, end, err) ||
+            !parse_value(it, end, err) || !detail::json_skip_ws(it, end, err))
+          IGUANA_UNLIKELY { return false; }
+        if (it != end && *it == '}') {
+          ++it;
+          ++size;
+          break;
+        }
+        if (!detail::json_match<','>(it, end, err) ||
+            !detail::json_skip_ws(it, end, err))
+          IGUANA_UNLIKELY { return false; }
+      }
+    }
+    tape_[index].size = size;
+    tape_[index].end = tape_.size();
+    return true;
+  }
+
+  std::vector<detail::json_tape_entry> tape_;
+  std::unique_ptr<char[]> strings_;
+  size_t strings_capacity_ = 0;
+  size_t strings_used_ = 0;
+  size_t buffer_size_ = 0;
+  bool parse_as_double_ = false;
+};
+
+inline const detail::json_tape_entry &json_element::entry() const {
+  return document_->tape_[index_];
+}
+
+template <typename It>
+inline void parse(json_document &result, It &&it, It &&end,
+                  bool parse_as_double = false) {
+  static_assert(contiguous_iterator<std::decay_t<It>>, "must be contiguous");
+  detail::json_read_error err;
+  const char *begin = it == end ? nullptr : &*it;
+  if (!result.parse(begin, begin + std::distance(it, end), err,
+                    parse_as_double))
+    IGUANA_UNLIKELY { throw std::runtime_error(err.what()); }
+}
+
+template <typename It>
+inline void parse(json_document &result, It &&it, It &&end,
+                  std::error_code &ec, bool parse_as_double = false) noexcept {
+  static_assert(contiguous_iterator<std::decay_t<It>>, "must be contiguous");
+  detail::json_read_error err;
+  const char *begin = it == end ? nullptr : &*it;
+  if (result.parse(begin, begin + std::distance(it, end), err,
+                   parse_as_double))
+    IGUANA_LIKELY { ec = {}; }
+  else {
+    ec = iguana::make_error_code(err.what());
+  }
+}
+
+template <typename View, std::enable_if_t<json_view_v<View>, int> = 0>
+inline void parse(json_document &result, const View &view,
+                  bool parse_as_double = false) {
+  parse(result, std::begin(view), std::end(view), parse_as_double);
+}
+
+template <typename View, std::enable_if_t<json_view_v<View>, int> = 0>
+inline void parse(json_document &result, const View &view, std::error_code &ec,
+                  bool parse_as_double = false) noexcept {
+  parse(result, std::begin(view), std::end(view), ec, parse_as_double);
+}
+}  // namespace iguana
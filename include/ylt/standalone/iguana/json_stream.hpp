@@ -0,0 +1,232 @@
+#pragma once
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+#include "json_reader.hpp"
+
+namespace iguana {
+
+// Read the elements of a top level json array given in chunks of any size,
+// e.g. a chunked http response or a file read piece by piece. Each element is
+// parsed into a T and passed to the callback as soon as its last byte is fed.
+// Only the bytes of an element split between chunks are copied, so the memory
+// is bounded by the largest element. The comments aren't supported between
+// the elements.
+//
+//   json_array_reader<person> reader;
+//   reader.feed(chunk1, [](person &&p) { ... });
+//   reader.feed(chunk2, [](person &&p) { ... });
+//   reader.finish();
+template <typename T>
+class json_array_reader {
+ public:
+  json_array_reader() = default;
+
+  // true after the closing bracket of the array.
+  bool done() const { return state_ == state::done; }
+
+  // the bytes of the unfinished element kept between the chunks.
+  size_t buffered_size() const { return buffer_.size(); }
+
+  template <typename F>
+  void feed(std::string_view chunk, F &&on_element) {
+    if (failed_)
+      IGUANA_UNLIKELY { throw std::runtime_error("the json array is broken"); }
+    failed_ = true;
+    feed_impl(chunk.data(), chunk.data() + chunk.size(), on_element);
+    failed_ = false;
+  }
+
+  // doesn't throw, the error of the json, or thrown by on_element, is set to
+  // ec and the reader stays failed.
+  template <typename F>
+  void feed(std::string_view chunk, F &&on_element,
+            std::error_code &ec) noexcept {
+    try {
+      feed(chunk, on_element);
+      ec = {};
+    } catch (std::exception &e) {
+      ec = iguana::make_error_code(e.what());
+    }
+  }
+
+  // call it after the last chunk, throws if the array isn't closed.
+  void finish() const {
+    if (!done())
+      IGUANA_UNLIKELY { throw std::runtime_error("Unexpected end of array"); }
+  }
+
+  void reset() {
+    buffer_.clear();
+    state_ = state::before_array;
+    depth_ = 0;
+    in_string_ = false;
+    escaped_ = false;
+    failed_ = false;
+  }
+
+ private:
+  enum class state : uint8_t {
+    before_array,
+    first_element,
+    before_element,
+    in_element,
+    after_element,
+    done
+  };
+
+  static const char *skip_ws(const char *p, const char *end) {
+    while (p != end && is_ws(*p)) {
+      ++p;
+    }
+    return p;
+  }
+
+  static bool is_ws(char c) {
+    return c == ' ' || c == '\n' || c == '\r' || c == '\t';
+  }
+
+  template <typename F>
+  void feed_impl(const char *p, const char *end, F &on_element) {
+    while (p != end) {
+      if (state_ != state::in_element) {
+        p = skip_ws(p, end);
+        if (p == end) {
+          break;
+        }
+      }
+      switch (state_) {
+        case state::before_array:
+          if (*p != '[')
+            IGUANA_UNLIKELY { throw std::runtime_error("Expected ["); }
+          ++p;
+          state_ = state::first_element;
+          break;
+        case state::first_element:
+          if (*p == ']') {
+            ++p;
+            state_ = state::done;
+            break;
+          }
+          [[fallthrough]];
+        case state::before_element:
+          state_ = state::in_element;
+          break;
+        case state::in_element: {
+          const char *start = p;
+          bool complete = scan_element(p, end);
+          if (!complete) {
+            buffer_.append(start, static_cast<size_t>(end - start));
+            return;
+          }
+          if (buffer_.empty()) {
+            // the whole element is in the chunk, parsed without a copy.
+            parse_element(start, p, on_element);
+          }
+          else {
+            buffer_.append(start, static_cast<size_t>(p - start));
+            parse_element(buffer_.data(), buffer_.data() + buffer_.size(),
+                          on_element);
+            buffer_.clear();
+          }
+          state_ = state::after_element;
+          break;
+        }
+        case state::after_element:
+          if (*p == ',') {
+            state_ = state::before_element;
+          }
+          else if (*p == ']') {
+            state_ = state::done;
+          }
+          else
+            IGUANA_UNLIKELY { throw std::runtime_error("Expected , or ]"); }
+          ++p;
+          break;
+        case state::done:
+          throw std::runtime_error("Unexpected content after the array");
+      }
+    }
+  }
+
+  // Move p to the end of the element, returns false if the element goes on
+  // in the next chunk. The strings and the brackets are tracked across the
+  // chunks, the scalars end at the first ',', ']' or whitespace.
+  bool scan_element(const char *&p, const char *end) {
+    bool scalar = depth_ == 0 && !in_string_ && buffer_.empty() &&
+                  *p != '"' && *p != '{' && *p != '[';
+    if (scalar || (buffer_.size() > 0 && depth_ == 0 && !in_string_)) {
+      while (p != end && *p != ',' && *p != ']' && !is_ws(*p)) {
+        ++p;
+      }
+      return p != end;
+    }
+    while (p != end) {
+      if (in_string_) {
+        if (escaped_) {
+          escaped_ = false;
+          ++p;
+          continue;
+        }
+#if defined(IGUANA_SIMD_SCAN)
+        p = detail::simd_find<'"', '\\'>(p, end);
+        if (p == end) {
+          break;
+        }
+#endif
+        if (*p == '\\') {
+          escaped_ = true;
+        }
+        else if (*p == '"') {
+          in_string_ = false;
+          if (depth_ == 0) {
+            ++p;
+            return true;
+          }
+        }
+        ++p;
+        continue;
+      }
+      switch (*p) {
+        case '"':
+          in_string_ = true;
+          break;
+        case '{':
+        case '[':
+          ++depth_;
+          break;
+        case '}':
+        case ']':
+          if (depth_ == 0)
+            IGUANA_UNLIKELY { throw std::runtime_error("Unexpected ]"); }
+          if (--depth_ == 0) {
+            ++p;
+            return true;
+          }
+          break;
+        default:
+          break;
+      }
+      ++p;
+    }
+    return false;
+  }
+
+  template <typename F>
+  static void parse_element(const char *begin, const char *end,
+                            F &on_element) {
+    T value{};
+    from_json(value, begin, end);
+    on_element(std::move(value));
+  }
+
+  std::string buffer_;
+  state state_ = state::before_array;
+  size_t depth_ = 0;
+  bool in_string_ = false;
+  bool escaped_ = false;
+  bool failed_ = false;
+};
+}  // namespace iguana
@@ -4,6 +4,7 @@
 #pragma once
 
 #include "common.hpp"
+#include "detail/json_simd.hpp"
 #include "detail/string_stream.hpp"
 #include "util.hpp"
 #include "value.hpp"
@@ -32,13 +33,12 @@ template <typename T>
 constexpr inline bool numeric_str_v =
     std::is_same_v<numeric_str, std::remove_cvref_t<T>>;
 
+// the try_ functions don't throw, they return the error message or nullptr.
 template <typename It>
-IGUANA_INLINE void skip_comment(It &&it, It &&end) {
+IGUANA_INLINE const char *try_skip_comment(It &&it, It &&end) noexcept {
   ++it;
   if (it == end)
-    IGUANA_UNLIKELY {
-      throw std::runtime_error("Unexpected end, expected comment");
-    }
+    IGUANA_UNLIKELY { return "Unexpected end, expected comment"; }
   else if (*it == '/') {
     while (++it != end && *it != '\n')
       ;
@@ -58,23 +58,47 @@ IGUANA_INLINE void skip_comment(It &&it, It &&end) {
     }
   }
   else
-    IGUANA_UNLIKELY throw std::runtime_error("Expected / or * after /");
+    IGUANA_UNLIKELY { return "Expected / or * after /"; }
+  return nullptr;
 }
 
 template <typename It>
-IGUANA_INLINE void skip_ws(It &&it, It &&end) {
+IGUANA_INLINE void skip_comment(It &&it, It &&end) {
+  if (auto error = try_skip_comment(it, end))
+    IGUANA_UNLIKELY { throw std::runtime_error(error); }
+}
+
+template <typename It>
+IGUANA_INLINE const char *try_skip_ws(It &&it, It &&end) noexcept {
   while (it != end) {
     // assuming ascii
     if (static_cast<uint8_t>(*it) < 33) {
       ++it;
+#ifdef IGUANA_SIMD_SCAN
+      if constexpr (contiguous_iterator<std::decay_t<It>>) {
+        // a run of spaces, e.g. the indentation of the pretty printed json.
+        if (it != end && static_cast<uint8_t>(*it) < 33) {
+          const char *p = &*it;
+          it += detail::simd_find_non_ws(p, p + std::distance(it, end)) - p;
+        }
+      }
+#endif
     }
     else if (*it == '/') {
-      skip_comment(it, end);
+      if (auto error = try_skip_comment(it, end))
+        IGUANA_UNLIKELY { return error; }
     }
     else {
       break;
     }
   }
+  return nullptr;
+}
+
+template <typename It>
+IGUANA_INLINE void skip_ws(It &&it, It &&end) {
+  if (auto error = try_skip_ws(it, end))
+    IGUANA_UNLIKELY { throw std::runtime_error(error); }
 }
 
 template <typename It>
@@ -96,8 +120,18 @@ inline constexpr auto has_escape = [](uint64_t chunk) IGUANA__INLINE_LAMBDA {
 };
 
 template <typename It>
-IGUANA_INLINE void skip_till_escape_or_qoute(It &&it, It &&end) {
+IGUANA_INLINE const char *try_skip_till_escape_or_qoute(It &&it,
+                                                        It &&end) noexcept {
   static_assert(contiguous_iterator<std::decay_t<decltype(it)>>);
+#ifdef IGUANA_SIMD_SCAN
+  if (it < end) {
+    const char *p = &*it;
+    it += detail::simd_find<'"', '\\'>(p, p + std::distance(it, end)) - p;
+    if (it < end && (*it == '"' || *it == '\\')) {
+      return nullptr;
+    }
+  }
+#endif
   if (std::distance(it, end) >= 7)
     IGUANA_LIKELY {
       const auto end_m7 = end - 7;
@@ -106,7 +140,7 @@ IGUANA_INLINE void skip_till_escape_or_qoute(It &&it, It &&end) {
         uint64_t test = has_qoute(chunk) | has_escape(chunk);
         if (test != 0) {
           it += (countr_zero(test) >> 3);
-          return;
+          return nullptr;
         }
       }
     }
@@ -116,16 +150,31 @@ IGUANA_INLINE void skip_till_escape_or_qoute(It &&it, It &&end) {
     switch (*it) {
       case '\\':
       case '"':
-        return;
+        return nullptr;
     }
     ++it;
   }
-  throw std::runtime_error("Expected \"");
+  return R"(Expected ")";
 }
 
 template <typename It>
-IGUANA_INLINE void skip_till_qoute(It &&it, It &&end) {
+IGUANA_INLINE void skip_till_escape_or_qoute(It &&it, It &&end) {
+  if (auto error = try_skip_till_escape_or_qoute(it, end))
+    IGUANA_UNLIKELY { throw std::runtime_error(error); }
+}
+
+template <typename It>
+IGUANA_INLINE const char *try_skip_till_qoute(It &&it, It &&end) noexcept {
   static_assert(contiguous_iterator<std::decay_t<decltype(it)>>);
+#ifdef IGUANA_SIMD_SCAN
+  if (it < end) {
+    const char *p = &*it;
+    it += detail::simd_find<'"'>(p, p + std::distance(it, end)) - p;
+    if (it < end && *it == '"') {
+      return nullptr;
+    }
+  }
+#endif
   if (std::distance(it, end) >= 7)
     IGUANA_LIKELY {
       const auto end_m7 = end - 7;
@@ -134,7 +183,7 @@ IGUANA_INLINE void skip_till_qoute(It &&it, It &&end) {
         uint64_t test = has_qoute(chunk);
         if (test != 0) {
           it += (countr_zero(test) >> 3);
-          return;
+          return nullptr;
         }
       }
     }
@@ -142,16 +191,31 @@ IGUANA_INLINE void skip_till_qoute(It &&it, It &&end) {
   // Tail end of buffer. Should be rare we even get here
   while (it < end) {
     if (*it == '"')
-      return;
+      return nullptr;
     ++it;
   }
-  throw std::runtime_error("Expected \"");
+  return R"(Expected ")";
+}
+
+template <typename It>
+IGUANA_INLINE void skip_till_qoute(It &&it, It &&end) {
+  if (auto error = try_skip_till_qoute(it, end))
+    IGUANA_UNLIKELY { throw std::runtime_error(error); }
 }
 
 template <typename It>
 IGUANA_INLINE void skip_string(It &&it, It &&end) noexcept {
   ++it;
   while (it < end) {
+#ifdef IGUANA_SIMD_SCAN
+    if constexpr (contiguous_iterator<std::decay_t<It>>) {
+      const char *p = &*it;
+      it += detail::simd_find<'"', '\\'>(p, p + std::distance(it, end)) - p;
+      if (it == end) {
+        break;
+      }
+    }
+#endif
     if (*it == '"') {
       ++it;
       break;
@@ -164,14 +228,25 @@ IGUANA_INLINE void skip_string(It &&it, It &&end) noexcept {
 }
 
 template <char open, char close, typename It>
-IGUANA_INLINE void skip_until_closed(It &&it, It &&end) {
+IGUANA_INLINE const char *try_skip_until_closed(It &&it, It &&end) noexcept {
   ++it;
   size_t open_count = 1;
   size_t close_count = 0;
+#ifdef IGUANA_SIMD_SCAN
+  if constexpr (contiguous_iterator<std::decay_t<It>>) {
+    if (it < end) {
+      const char *p = &*it;
+      it += detail::skip_until_closed_by_blocks<open, close>(
+                p, p + std::distance(it, end), open_count, close_count) -
+            p;
+    }
+  }
+#endif
   while (it < end && open_count > close_count) {
     switch (*it) {
       case '/':
-        skip_comment(it, end);
+        if (auto error = try_skip_comment(it, end))
+          IGUANA_UNLIKELY { return error; }
         break;
       case '"':
         skip_string(it, end);
@@ -188,8 +263,30 @@ IGUANA_INLINE void skip_until_closed(It &&it, It &&end) {
         ++it;
     }
   }
+  return nullptr;
+}
+
+template <char open, char close, typename It>
+IGUANA_INLINE void skip_until_closed(It &&it, It &&end) {
+  if (auto error = try_skip_until_closed<open, close>(it, end))
+    IGUANA_UNLIKELY { throw std::runtime_error(error); }
 }
 
+namespace detail {
+template <typename T>
+constexpr size_t get_array_size(const T &t) {
+#if __cplusplus > 201703L
+#if __has_include(<span>)
+  if constexpr (is_span<T>::value)
+    return t.size();
+  else
+#endif
+#endif
+    return sizeof(T) / sizeof(decltype(std::declval<T>()[0]));
+}
+
+}  // namespace detail
+
 IGUANA_INLINE bool is_numeric(char c) noexcept {
   static constexpr int is_num[256] = {
       // 0   1   2   3   4   5   6   7   8   9   A   B   C   D   E   F
@@ -4,6 +4,7 @@
 
 #ifndef SERIALIZE_JSON_HPP
 #define SERIALIZE_JSON_HPP
+#include "detail/string_resize.hpp"
 #include "json_util.hpp"
 
 namespace iguana {
@@ -12,6 +13,9 @@ template <bool Is_writing_escape = true, typename Stream, typename T,
           std::enable_if_t<ylt_refletable_v<T>, int> = 0>
 IGUANA_INLINE void to_json(T &&t, Stream &s);
 namespace detail {
+template <bool Is_writing_escape, typename Stream, typename T>
+IGUANA_INLINE void render_object(Stream &s, T &&t);
+
 template <bool Is_writing_escape = true, typename Stream, typename T,
           std::enable_if_t<optional_v<T>, int> = 0>
 IGUANA_INLINE void to_json_impl(Stream &ss, const T &val);
@@ -76,9 +80,20 @@ IGUANA_INLINE void to_json_impl(Stream &ss, char value) {
 template <bool Is_writing_escape, typename Stream, typename T,
           std::enable_if_t<num_v<T>, int> = 0>
 IGUANA_INLINE void to_json_impl(Stream &ss, T value) {
-  char temp[65];
-  auto p = detail::to_chars(temp, value);
-  ss.append(temp, p - temp);
+  if constexpr (std::is_same_v<Stream, std::string>) {
+    // write in place, the string is usually reserved by json_size_hint.
+    auto size = ss.size();
+    if (size + 32 > ss.capacity())
+      IGUANA_UNLIKELY { ss.reserve((std::max)(size + 32, ss.capacity() * 2)); }
+    detail::resize(ss, size + 32);
+    auto p = detail::to_chars(ss.data() + size, value);
+    detail::resize(ss, static_cast<size_t>(p - ss.data()));
+  }
+  else {
+    char temp[65];
+    auto p = detail::to_chars(temp, value);
+    ss.append(temp, p - temp);
+  }
 }
 
 // template <bool Is_writing_escape, typename Stream, typename T,
@@ -129,7 +144,7 @@ IGUANA_INLINE void render_key(Stream &ss, T &&t) {
 template <bool Is_writing_escape, typename Stream, typename T,
           std::enable_if_t<ylt_refletable_v<T>, int> = 0>
 IGUANA_INLINE void to_json_impl(Stream &ss, T &&t) {
-  to_json(std::forward<T>(t), ss);
+  render_object<Is_writing_escape>(ss, std::forward<T>(t));
 }
 
 template <bool Is_writing_escape, typename Stream, typename T,
@@ -280,11 +295,8 @@ IGUANA_INLINE void to_json_impl(Stream &s, T &&t) {
       },
       t);
 }
-}  // namespace detail
-template <bool Is_writing_escape, typename Stream, typename T,
-          std::enable_if_t<ylt_refletable_v<T>, int>>
-IGUANA_INLINE void to_json(T &&t, Stream &s) {
-  using namespace detail;
+template <bool Is_writing_escape, typename Stream, typename T>
+IGUANA_INLINE void render_object(Stream &s, T &&t) {
   s.push_back('{');
   using U = ylt::reflection::remove_cvref_t<T>;
   constexpr auto Count = ylt::reflection::members_count_v<U>;
@@ -304,10 +316,128 @@ IGUANA_INLINE void to_json(T &&t, Stream &s) {
   s.push_back('}');
 }
 
+// An upper bound of the size of the json of value, except the strings which
+// need escapes are counted without their escapes. It's used to reserve the
+// output once instead of growing it during the writing.
+template <typename T>
+IGUANA_INLINE size_t json_size_hint(const T &value) {
+  using U = ylt::reflection::remove_cvref_t<T>;
+  if constexpr (std::is_same_v<U, std::nullptr_t>) {
+    return 4;
+  }
+  else if constexpr (bool_v<U>) {
+    return 5;
+  }
+  else if constexpr (char_v<U>) {
+    return 3;
+  }
+  else if constexpr (num_v<U>) {
+    if constexpr (std::is_integral_v<U>) {
+      return std::numeric_limits<U>::digits10 + 2;
+    }
+    else {
+      return 25;
+    }
+  }
+  else if constexpr (numeric_str_v<U>) {
+    return value.value().size();
+  }
+  else if constexpr (string_container_v<U>) {
+    return value.size() + 2;
+  }
+  else if constexpr (enum_v<U>) {
+    static constexpr auto enum_to_str = get_enum_map<false, U>();
+    if constexpr (bool_v<decltype(enum_to_str)>) {
+      return json_size_hint(static_cast<std::underlying_type_t<U>>(value));
+    }
+    else {
+      auto it = enum_to_str.find(value);
+      return it == enum_to_str.end() ? 0 : it->second.size() + 2;
+    }
+  }
+  else if constexpr (optional_v<U> || smart_ptr_v<U>) {
+    return value ? json_size_hint(*value) : 4;
+  }
+  else if constexpr (map_container_v<U> || fixed_array_v<U> ||
+                     sequence_container_v<U>) {
+    if constexpr (fixed_array_v<U>) {
+      if constexpr (std::is_same_v<char, std::decay_t<decltype(value[0])>>) {
+        return sizeof(U) + 2;
+      }
+    }
+    size_t size = 2;
+    for (const auto &v : value) {
+      size += json_size_hint(v) + 1;
+    }
+    return size;
+  }
+  else if constexpr (pair_v<U>) {
+    // the keys of the numbers are quoted.
+    return json_size_hint(value.first) + json_size_hint(value.second) + 3;
+  }
+  else if constexpr (tuple_v<U>) {
+    size_t size = 2;
+    foreach_tuple(
+        [&size](auto &v, auto) IGUANA__INLINE_LAMBDA {
+          size += json_size_hint(v) + 1;
+        },
+        value);
+    return size;
+  }
+  else if constexpr (variant_v<U>) {
+    return std::visit(
+        [](const auto &v) {
+          return json_size_hint(v);
+        },
+        value);
+  }
+  else if constexpr (ylt_refletable_v<U>) {
+    size_t size = 2;
+    if constexpr (ylt::reflection::members_count_v<U> > 0) {
+      ylt::reflection::for_each(value, [&size](auto &field, auto name, auto) {
+        size += name.size() + 4 + json_size_hint(field);
+      });
+    }
+    return size;
+  }
+  else {
+    return 0;
+  }
+}
+
+template <typename Stream, typename = void>
+struct has_reserve : std::false_type {};
+
+template <typename Stream>
+struct has_reserve<Stream,
+                   std::void_t<decltype(std::declval<Stream &>().reserve(
+                                   std::declval<Stream &>().capacity()))>>
+    : std::true_type {};
+
+template <typename Stream, typename T>
+IGUANA_INLINE void reserve_json(Stream &s, const T &t) {
+  if constexpr (has_reserve<Stream>::value) {
+    auto size = s.size() + json_size_hint(t);
+    if (size > s.capacity()) {
+      // keep growing geometrically when a stream is written many times.
+      s.reserve((std::max)(size, s.capacity() * 2));
+    }
+  }
+}
+}  // namespace detail
+
+template <bool Is_writing_escape, typename Stream, typename T,
+          std::enable_if_t<ylt_refletable_v<T>, int>>
+IGUANA_INLINE void to_json(T &&t, Stream &s) {
+  detail::reserve_json(s, t);
+  detail::render_object<Is_writing_escape>(s, std::forward<T>(t));
+}
+
 template <bool Is_writing_escape = true, typename Stream, typename T,
           std::enable_if_t<non_ylt_refletable_v<T>, int> = 0>
 IGUANA_INLINE void to_json(T &&t, Stream &s) {
   using namespace detail;
+  reserve_json(s, t);
   to_json_impl<Is_writing_escape>(s, t);
 }
 
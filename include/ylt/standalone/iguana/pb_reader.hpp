@@ -41,6 +41,31 @@ IGUANA_INLINE void from_pb_impl(T& val, std::string_view& pb_str,
     from_pb(val, pb_str.substr(0, size));
     pb_str = pb_str.substr(size);
   }
+  else if constexpr (is_packed_span_v<T>) {
+    using item_type = typename T::value_type;
+    size_t pos;
+    uint32_t size = detail::decode_varint(pb_str, pos);
+    pb_str = pb_str.substr(pos);
+    if (pb_str.size() < size)
+      IGUANA_UNLIKELY {
+        throw std::invalid_argument("Invalid fixed int value: too few bytes.");
+      }
+    if (size % sizeof(item_type) != 0)
+      IGUANA_UNLIKELY {
+        throw std::invalid_argument(
+            "Invalid packed fixed value: incomplete item.");
+      }
+    // points into pb_str, a repeated field split in several parts can't be
+    // viewed at once.
+    if (!val.empty())
+      IGUANA_UNLIKELY {
+        throw std::invalid_argument(
+            "Invalid packed span value: the field is split in several parts.");
+      }
+    val = T(reinterpret_cast<const item_type*>(pb_str.data()),
+            size / sizeof(item_type));
+    pb_str = pb_str.substr(size);
+  }
   else if constexpr (is_sequence_container<T>::value) {
     using item_type = typename T::value_type;
     if constexpr (is_lenprefix_v<item_type>) {
@@ -72,25 +97,33 @@ IGUANA_INLINE void from_pb_impl(T& val, std::string_view& pb_str,
           throw std::invalid_argument(
               "Invalid fixed int value: too few bytes.");
         }
-      if constexpr (is_fixed_v<item_type>) {
-        int num = size / sizeof(item_type);
-        int old_size = val.size();
-        detail::resize(val, old_size + num);
-        std::memcpy(val.data() + old_size, pb_str.data(), size);
-        pb_str = pb_str.substr(size);
-      }
-      else {
-        size_t start = pb_str.size();
-
-        while (!pb_str.empty()) {
-          item_type item;
-          from_pb_impl(item, pb_str);
-          val.push_back(std::move(item));
-          if (start - pb_str.size() == size) {
-            break;
+      if constexpr (is_packed_fixed_v<item_type>) {
+        if (size % sizeof(item_type) != 0)
+          IGUANA_UNLIKELY {
+            throw std::invalid_argument(
+                "Invalid packed fixed value: incomplete item.");
           }
+        size_t num = size / sizeof(item_type);
+        if constexpr (detail::has_data<T>::value) {
+          size_t old_size = val.size();
+          // detail::resize only sizes the vectors of chars right.
+          val.resize(old_size + num);
+          std::memcpy(val.data() + old_size, pb_str.data(), size);
         }
+        else {
+          for (size_t i = 0; i < num; ++i) {
+            item_type item;
+            std::memcpy(&item, pb_str.data() + i * sizeof(item_type),
+                        sizeof(item_type));
+            val.push_back(item);
+          }
+        }
+      }
+      else {
+        detail::decode_packed_varints(val, pb_str.data(),
+                                      pb_str.data() + size);
       }
+      pb_str = pb_str.substr(size);
     }
   }
   else if constexpr (is_map_container<T>::value) {
@@ -42,6 +42,32 @@ template <typename T>
 constexpr bool is_signed_varint_v =
     std::is_same_v<T, sint32_t> || std::is_same_v<T, sint64_t>;
 
+// the packed repeated fields of these are arrays of the values as they are in
+// memory, little endian like the single values.
+template <typename T>
+constexpr bool is_packed_fixed_v = is_fixed_v<T> || std::is_same_v<T, float> ||
+                                   std::is_same_v<T, double>;
+
+// the packed fixed items of T are copied at once, not one by one, only when
+// they are contiguous in memory, e.g. not in std::deque or std::list.
+template <typename T, typename = void>
+struct has_data : std::false_type {};
+
+template <typename T>
+struct has_data<T, std::void_t<decltype(std::declval<T&>().data())>>
+    : std::true_type {};
+
+// std::span<const T> of the packed fixed T aliases the buffer passed to
+// from_pb like std::string_view, it's written like std::vector<T>.
+template <typename T>
+constexpr bool is_packed_span_v = false;
+#if __cplusplus > 201703L
+#if __has_include(<span>)
+template <typename T>
+constexpr bool is_packed_span_v<std::span<const T>> = is_packed_fixed_v<T>;
+#endif
+#endif
+
 template <typename T>
 constexpr inline WireType get_wire_type() {
   if constexpr (std::is_integral_v<T> || is_signed_varint_v<T> ||
@@ -61,7 +87,7 @@ constexpr inline WireType get_wire_type() {
   else if constexpr (std::is_same_v<T, std::string> ||
                      std::is_same_v<T, std::string_view> ||
                      ylt_refletable_v<T> || is_sequence_container<T>::value ||
-                     is_map_container<T>::value) {
+                     is_packed_span_v<T> || is_map_container<T>::value) {
     return WireType::LengthDelimeted;
   }
   else if constexpr (optional_v<T>) {
@@ -183,6 +209,115 @@ IGUANA_INLINE uint64_t decode_varint(T& data, size_t& pos) {
   return val;
 }
 
+// set t to the varint v of the wire, as from_pb_impl reads it.
+template <typename T>
+IGUANA_INLINE void set_varint_value(T& t, uint64_t v) {
+  if constexpr (is_signed_varint_v<T>) {
+    if constexpr (sizeof(typename T::value_type) == 8) {
+      t.val = decode_zigzag(v);
+    }
+    else {
+      t.val = static_cast<int32_t>(decode_zigzag(static_cast<uint32_t>(v)));
+    }
+  }
+  else if constexpr (std::is_enum_v<T>) {
+    t = static_cast<T>(static_cast<std::underlying_type_t<T>>(v));
+  }
+  else {
+    t = static_cast<T>(v);
+  }
+}
+
+// the varint of the wire for t, as to_pb_impl writes it.
+template <typename T>
+IGUANA_INLINE uint64_t get_varint_value(const T& t) {
+  if constexpr (is_signed_varint_v<T>) {
+    return encode_zigzag(t.val);
+  }
+  else if constexpr (std::is_enum_v<T>) {
+    return static_cast<uint64_t>(static_cast<std::underlying_type_t<T>>(t));
+  }
+  else {
+    // the negative int32 are sign extended to 10 bytes, like protobuf does.
+    return static_cast<uint64_t>(t);
+  }
+}
+
+// Decode the packed varints of [p, end) into val, by blocks of 64 bytes. The
+// continuation bits of a block are tested at once by json_block, a block of
+// one byte varints is copied by a plain loop, the others are decoded by
+// decode_varint. The items of a block are appended to val at once.
+template <typename T>
+IGUANA_INLINE void decode_packed_varints(T& val, const char* p,
+                                         const char* end) {
+  using item_type = typename T::value_type;
+  // a varint has one byte at least.
+  item_type items[json_block::size];
+  while (p < end) {
+    size_t n = 0;
+    if (static_cast<size_t>(end - p) >= json_block::size &&
+        json_block(p).high_bits() == 0) {
+      for (; n < json_block::size; ++n) {
+        set_varint_value(items[n], static_cast<uint8_t>(p[n]));
+      }
+      p += json_block::size;
+    }
+    else {
+      const char* block_end =
+          p + (std::min)(json_block::size, static_cast<size_t>(end - p));
+      while (p < block_end) {
+        if (static_cast<int8_t>(*p) >= 0) {
+          set_varint_value(items[n++], static_cast<uint8_t>(*p++));
+          continue;
+        }
+        std::string_view rest(p, static_cast<size_t>(end - p));
+        size_t pos;
+        set_varint_value(items[n++], decode_varint(rest, pos));
+        p += pos;
+      }
+    }
+    val.insert(val.end(), items, items + n);
+  }
+}
+
+// write v to p, which must have 10 bytes, returns the count of bytes written.
+IGUANA_INLINE size_t encode_varint_to(char* p, uint64_t v) {
+  size_t i = 0;
+  while (v >= 0x80) {
+    p[i++] = static_cast<char>(v | 0x80);
+    v >>= 7;
+  }
+  p[i++] = static_cast<char>(v);
+  return i;
+}
+
+// Write the items of t as packed varints. The memory writer is written in
+// place, the others get the bytes by blocks instead of byte by byte.
+template <typename T, typename Writer>
+IGUANA_INLINE void encode_packed_varints(const T& t, Writer& writer) {
+  if constexpr (std::is_same_v<Writer, memory_writer>) {
+    for (const auto& item : t) {
+      writer.buffer += encode_varint_to(writer.buffer, get_varint_value(item));
+    }
+  }
+  else {
+    constexpr size_t buf_size = 1024;
+    char buf[buf_size];
+    size_t pos = 0;
+    for (const auto& item : t) {
+      if (pos > buf_size - 10)
+        IGUANA_UNLIKELY {
+          writer.write(buf, pos);
+          pos = 0;
+        }
+      pos += encode_varint_to(buf + pos, get_varint_value(item));
+    }
+    if (pos) {
+      writer.write(buf, pos);
+    }
+  }
+}
+
 // value == 0 ? 1 : floor(log2(value)) / 7 + 1
 constexpr size_t variant_uint32_size_constexpr(uint32_t value) {
   if (value == 0) {
@@ -497,7 +632,7 @@ IGUANA_INLINE size_t pb_key_value_size(Type&& t, Arr& size_arr) {
       }
     }
   }
-  else if constexpr (is_sequence_container<T>::value) {
+  else if constexpr (is_sequence_container<T>::value || is_packed_span_v<T>) {
     using item_type = typename T::value_type;
     size_t len = 0;
     if constexpr (is_lenprefix_v<item_type>) {
@@ -507,16 +642,21 @@ IGUANA_INLINE size_t pb_key_value_size(Type&& t, Arr& size_arr) {
       return len;
     }
     else {
-      for (auto& item : t) {
-        // here 0 to get pakced size, and item must be numeric
-        len += str_numeric_size<0, false>(item);
-      }
-      if (len == 0) {
+      if (t.empty()) {
         return 0;
       }
+      if constexpr (is_packed_fixed_v<item_type>) {
+        len = t.size() * sizeof(item_type);
+      }
       else {
-        return key_size + variant_uint32_size(static_cast<uint32_t>(len)) + len;
+        for (const auto& item : t) {
+          // here 0 to get pakced size, and item must be numeric
+          len += str_numeric_size<0, false>(item);
+        }
+        // kept for the write pass, like the size of a nested message.
+        size_arr.push_back(static_cast<uint32_t>(len));
       }
+      return key_size + variant_uint32_size(static_cast<uint32_t>(len)) + len;
     }
   }
   else if constexpr (is_map_container<T>::value) {
@@ -559,14 +699,21 @@ IGUANA_INLINE size_t pb_value_size(Type&& t, uint32_t*& sz_ptr) {
       }
     }
   }
-  else if constexpr (is_sequence_container<T>::value) {
+  else if constexpr (is_sequence_container<T>::value || is_packed_span_v<T>) {
     using item_type = typename T::value_type;
-    size_t len = 0;
     if constexpr (!is_lenprefix_v<item_type>) {
-      for (auto& item : t) {
-        len += str_numeric_size<0, false>(item);
+      if (t.empty()) {
+        return 0;
+      }
+      if constexpr (is_packed_fixed_v<item_type>) {
+        return t.size() * sizeof(item_type);
+      }
+      else if constexpr (skip_next) {
+        return *(sz_ptr++);
+      }
+      else {
+        return *sz_ptr;
       }
-      return len;
     }
     else {
       static_assert(!sizeof(item_type), "the size of this type is meaningless");
@@ -137,7 +137,7 @@ IGUANA_INLINE void to_pb_impl(Type&& t, uint32_t*& sz_ptr, Writer& writer) {
         },
         std::make_index_sequence<SIZE>{});
   }
-  else if constexpr (is_sequence_container<T>::value) {
+  else if constexpr (is_sequence_container<T>::value || is_packed_span_v<T>) {
     // TODO support std::array
     // repeated values can't be omitted even if values are empty
     using item_type = typename T::value_type;
@@ -152,8 +152,18 @@ IGUANA_INLINE void to_pb_impl(Type&& t, uint32_t*& sz_ptr, Writer& writer) {
         IGUANA_UNLIKELY { return; }
       serialize_varint_u32<key>(writer);
       serialize_varint(pb_value_size(t, sz_ptr), writer);
-      for (auto& item : t) {
-        encode_numeric_field<false, 0>(item, writer);
+      if constexpr (is_packed_fixed_v<item_type>) {
+        if constexpr (has_data<T>::value) {
+          writer.write((const char*)t.data(), t.size() * sizeof(item_type));
+        }
+        else {
+          for (const auto& item : t) {
+            writer.write((const char*)&item, sizeof(item_type));
+          }
+        }
+      }
+      else {
+        encode_packed_varints(t, writer);
       }
     }
   }
@@ -375,7 +385,7 @@ IGUANA_INLINE void to_proto_impl(
         std::make_index_sequence<SIZE>{});
     out.append("}\r\n\r\n");
   }
-  else if constexpr (is_sequence_container<T>::value) {
+  else if constexpr (is_sequence_container<T>::value || is_packed_span_v<T>) {
     out.append("  repeated");
     using item_type = typename T::value_type;
 
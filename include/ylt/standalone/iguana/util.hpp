@@ -13,6 +13,7 @@
 
 #include "define.h"
 #include "detail/charconv.h"
+#include "detail/json_simd.hpp"
 #include "detail/pb_type.hpp"
 #include "detail/traits.hpp"
 #include "detail/utf.hpp"
@@ -231,6 +232,22 @@ IGUANA_INLINE void match(It&& it, It&& end) {
     }
 }
 
+// the same as match, but returns the error message instead of throwing it.
+template <char... C, typename It>
+IGUANA_INLINE const char* try_match(It&& it, It&& end) noexcept {
+  const auto n = static_cast<size_t>(std::distance(it, end));
+  if (n < sizeof...(C))
+    IGUANA_UNLIKELY { return "Unexpected end of buffer. Expected:"; }
+  if (((... || (*it++ != C))))
+    IGUANA_UNLIKELY {
+      static constexpr char error[] = {'E', 'x', 'p', 'e', 'c', 't', 'e', 'd',
+                                       ' ', 't', 'h', 'e', 's', 'e', ':', ' ',
+                                       C...,  '\0'};
+      return error;
+    }
+  return nullptr;
+}
+
 inline constexpr auto has_zero = [](uint64_t chunk) IGUANA__INLINE_LAMBDA {
   return (((chunk - 0x0101010101010101) & ~chunk) & 0x8080808080808080);
 };
@@ -290,6 +307,22 @@ IGUANA_INLINE void write_unicode_to_string(Ch& it, Stream& ss) {
   }
 }
 
+// the first character of [it, end) written escaped: the control characters,
+// '"', '\\' and the non ascii characters.
+IGUANA_INLINE const char* find_escape(const char* it, const char* end) {
+#if defined(IGUANA_SIMD_SCAN)
+  it = detail::simd_find_escape(it, end);
+#endif
+  while (it < end) {
+    auto c = static_cast<unsigned char>(*it);
+    if (c < 0x20 || c >= 0x80 || c == '"' || c == '\\') {
+      break;
+    }
+    ++it;
+  }
+  return it;
+}
+
 // https://github.com/Tencent/rapidjson/blob/master/include/rapidjson/writer.h
 template <typename Ch, typename SizeType, typename Stream>
 IGUANA_INLINE void write_string_with_escape(const Ch* it, SizeType length,
@@ -315,6 +348,15 @@ IGUANA_INLINE void write_string_with_escape(const Ch* it, SizeType length,
   auto end = it;
   std::advance(end, length);
   while (it < end) {
+    if constexpr (std::is_same_v<Ch, char>) {
+      // copy the run of the characters without escapes at once.
+      auto clean_end = find_escape(it, end);
+      ss.append(it, static_cast<size_t>(clean_end - it));
+      it = clean_end;
+      if (it == end) {
+        break;
+      }
+    }
     if (static_cast<unsigned>(*it) >= 0x80)
       IGUANA_UNLIKELY { write_unicode_to_string(it, ss); }
     else if (escape[static_cast<unsigned char>(*it)])
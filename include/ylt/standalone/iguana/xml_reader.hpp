@@ -2,6 +2,7 @@
 #include <charconv>
 
 #include "detail/charconv.h"
+#include "detail/member_matcher.hpp"
 #include "detail/utf.hpp"
 #include "xml_util.hpp"
 
@@ -446,26 +447,19 @@ IGUANA_INLINE void xml_parse_item(T &value, It &&it, It &&end,
       return;
     }
   // map parse
+  size_t expected = 0;
   while (true) {
-    static auto frozen_map = ylt::reflection::get_variant_map<U>();
-    const auto &member_it = frozen_map.find(key);
-    if (member_it != frozen_map.end())
-      IGUANA_LIKELY {
-        std::visit(
-            [&](auto offset) IGUANA__INLINE_LAMBDA {
-              using value_type = typename decltype(offset)::type;
-              if constexpr (!cdata_v<value_type>) {
-                auto member_ptr =
-                    (value_type *)((char *)(&value) + offset.value);
-                xml_parse_item(*member_ptr, it, end, key);
-                if constexpr (iguana::has_iguana_required_arr_v<U>) {
-                  key_set.append(key).append(", ");
-                }
-              }
-            },
-            member_it->second);
-      }
-    else
+    bool found = visit_member(
+        value, key, expected, [&](auto &member) IGUANA__INLINE_LAMBDA {
+          using value_type = std::remove_reference_t<decltype(member)>;
+          if constexpr (!cdata_v<value_type>) {
+            xml_parse_item(member, it, end, key);
+            if constexpr (iguana::has_iguana_required_arr_v<U>) {
+              key_set.append(key).append(", ");
+            }
+          }
+        });
+    if (!found)
       IGUANA_UNLIKELY {
 #ifdef THROW_UNKNOWN_KEY
         throw std::runtime_error("Unknown key: " + std::string(key));
@@ -0,0 +1,523 @@
+#pragma once
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+#include "xml_reader.hpp"
+
+namespace iguana {
+namespace detail {
+
+// the first of C... in [p, end), end if there is none.
+template <char... C>
+IGUANA_INLINE const char *xml_find(const char *p, const char *end) {
+#if defined(IGUANA_SIMD_SCAN)
+  p = simd_find<C...>(p, end);
+#endif
+  while (p != end && ((*p != C) && ...)) {
+    ++p;
+  }
+  return p;
+}
+
+template <char... C>
+IGUANA_INLINE char *xml_find(char *p, char *end) {
+  return const_cast<char *>(xml_find<C...>(static_cast<const char *>(p),
+                                          static_cast<const char *>(end)));
+}
+
+// Move it to the first Stop, or end, and unescape the entities before it in
+// place, an entity is never shorter than the characters it stands for.
+// Returns the end of the unescaped characters.
+template <char Stop>
+IGUANA_INLINE char *unescape_xml_till(char *&it, char *end) {
+  it = xml_find<Stop, '&'>(it, end);
+  if (it == end || *it == Stop)
+    IGUANA_LIKELY { return it; }
+  char *out = it;
+  std::string entity;  // at most 4 bytes, never allocates.
+  while (it != end && *it == '&') {
+    entity.clear();
+    char *entity_begin = it;
+    parse_escape_xml(entity, it, end);
+    if (it == entity_begin) {
+      // an unknown entity like "&ab;", kept as is.
+      entity.push_back(*it++);
+    }
+    std::memcpy(out, entity.data(), entity.size());
+    out += entity.size();
+    char *next = xml_find<Stop, '&'>(it, end);
+    std::memmove(out, it, static_cast<size_t>(next - it));
+    out += next - it;
+    it = next;
+  }
+  return out;
+}
+
+IGUANA_INLINE std::string_view trim_xml_text(char *begin, char *end) {
+  skip_sapces_and_newline(begin, end);
+  while (end != begin && static_cast<uint8_t>(end[-1]) < 33) {
+    --end;
+  }
+  return std::string_view(begin, static_cast<size_t>(end - begin));
+}
+
+template <typename Handler>
+IGUANA_INLINE void parse_start_tag(char *&it, char *end,
+                                   std::vector<std::string_view> &names,
+                                   Handler &handler) {
+  char *name_begin = it;
+  while (it != end && static_cast<uint8_t>(*it) > 32 && *it != '>' &&
+         *it != '/') {
+    ++it;
+  }
+  std::string_view name(name_begin, static_cast<size_t>(it - name_begin));
+  if (name.empty())
+    IGUANA_UNLIKELY { throw std::runtime_error("Expected element name"); }
+  handler.start_element(name);
+  while (true) {
+    skip_sapces_and_newline(it, end);
+    if (it == end)
+      IGUANA_UNLIKELY {
+        throw std::runtime_error("unclosed tag: " + std::string(name));
+      }
+    if (*it == '>') {
+      ++it;
+      names.push_back(name);
+      return;
+    }
+    if (*it == '/') {
+      ++it;
+      match<'>'>(it, end);
+      handler.end_element(name);
+      return;
+    }
+    char *key_begin = it;
+    while (it != end && static_cast<uint8_t>(*it) > 32 && *it != '=' &&
+           *it != '>' && *it != '/') {
+      ++it;
+    }
+    std::string_view key(key_begin, static_cast<size_t>(it - key_begin));
+    skip_sapces_and_newline(it, end);
+    match<'='>(it, end);
+    skip_sapces_and_newline(it, end);
+    if (it == end)
+      IGUANA_UNLIKELY { throw std::runtime_error("expected quote or apos"); }
+    char quote = *it++;
+    char *value_begin = it;
+    char *value_end;
+    if (quote == '"')
+      IGUANA_LIKELY { value_end = unescape_xml_till<'"'>(it, end); }
+    else if (quote == '\'') {
+      value_end = unescape_xml_till<'\''>(it, end);
+    }
+    else
+      IGUANA_UNLIKELY { throw std::runtime_error("expected quote or apos"); }
+    if (it == end)
+      IGUANA_UNLIKELY {
+        throw std::runtime_error("unclosed attribute: " + std::string(key));
+      }
+    ++it;
+    handler.attribute(
+        key, std::string_view(value_begin,
+                              static_cast<size_t>(value_end - value_begin)));
+  }
+}
+
+template <typename Handler>
+IGUANA_INLINE void parse_xml_sax(char *it, char *end, Handler &handler) {
+  std::vector<std::string_view> names;
+  while (true) {
+    char *text_begin = it;
+    char *text_end = unescape_xml_till<'<'>(it, end);
+    if (!names.empty()) {
+      auto text = trim_xml_text(text_begin, text_end);
+      if (!text.empty()) {
+        handler.text(text);
+      }
+    }
+    if (it == end) {
+      break;
+    }
+    ++it;
+    if (it == end)
+      IGUANA_UNLIKELY { throw std::runtime_error("Unexpected end of xml"); }
+    if (*it == '/') {
+      ++it;
+      char *name_begin = it;
+      skip_till<'>'>(it, end);
+      auto name = trim_xml_text(name_begin, it);
+      if (names.empty() || names.back() != name)
+        IGUANA_UNLIKELY {
+          throw std::runtime_error(
+              "unclosed tag: " +
+              std::string(names.empty() ? name : names.back()));
+        }
+      names.pop_back();
+      handler.end_element(name);
+      ++it;
+    }
+    else if (*it == '?') {
+      skip_instructions(it, end);
+    }
+    else if (*it == '!') {
+      ++it;
+      if (it != end && *it == '[') {
+        // <![CDATA[...]]>, the text as is.
+        ++it;
+        match<'C', 'D', 'A', 'T', 'A', '['>(it, end);
+        char *cdata_begin = it;
+        while (true) {
+          skip_till<']'>(it, end);
+          if (end - it >= 3 && it[1] == ']' && it[2] == '>') {
+            break;
+          }
+          ++it;
+        }
+        if (!names.empty() && it != cdata_begin) {
+          handler.text(std::string_view(
+              cdata_begin, static_cast<size_t>(it - cdata_begin)));
+        }
+        it += 3;
+      }
+      else if (it != end && *it == '-') {
+        skip_comment(it, end);
+      }
+      else {
+        // <!DOCTYPE ...>
+        skip_till<'>'>(it, end);
+        ++it;
+      }
+    }
+    else {
+      parse_start_tag(it, end, names, handler);
+    }
+  }
+  if (!names.empty())
+    IGUANA_UNLIKELY {
+      throw std::runtime_error("unclosed tag: " + std::string(names.back()));
+    }
+}
+}  // namespace detail
+
+// Parse xml in place and pass the events to handler, which has
+//
+//   void start_element(std::string_view name);
+//   void attribute(std::string_view name, std::string_view value);
+//   void text(std::string_view value);
+//   void end_element(std::string_view name);
+//
+// The entities are unescaped over the buffer, every string_view points into
+// xml and nothing is copied. A self-closing element has a start_element and
+// an end_element. The text is trimmed, the blank text isn't passed, and a
+// CDATA section is passed as a text on its own. The comments, the
+// instructions and the DOCTYPE are skipped.
+template <typename Handler>
+IGUANA_INLINE void parse_xml_sax(std::string &xml, Handler &&handler) {
+  // the terminating null lets the entities at the end be read safely.
+  detail::parse_xml_sax(xml.data(), xml.data() + xml.size(), handler);
+}
+
+template <typename Handler>
+IGUANA_INLINE void parse_xml_sax(std::string &xml, Handler &&handler,
+                                 std::error_code &ec) noexcept {
+  try {
+    parse_xml_sax(xml, handler);
+    ec = {};
+  } catch (std::exception &e) {
+    ec = iguana::make_error_code(e.what());
+  }
+}
+
+// Read the child elements of the root of an xml given in chunks of any size,
+// e.g. a feed of repeated <item> under a root element read from a file piece
+// by piece. Each child is parsed into a T by from_xml and passed to the
+// callback as soon as its closing tag is fed. Only the bytes of a child split
+// between chunks are copied, so the memory is bounded by the largest child.
+// The text, the comments and the instructions between the children are
+// skipped.
+//
+//   xml_element_reader<item> reader;
+//   reader.feed(chunk1, [](item &&i) { ... });
+//   reader.feed(chunk2, [](item &&i) { ... });
+//   reader.finish();
+template <typename T>
+class xml_element_reader {
+ public:
+  xml_element_reader() = default;
+
+  // true after the closing tag of the root.
+  bool done() const { return state_ == state::done; }
+
+  // the bytes of the unfinished child kept between the chunks.
+  size_t buffered_size() const { return buffer_.size(); }
+
+  // the name of the root, empty before its start tag is read.
+  std::string_view root_name() const { return root_name_; }
+
+  template <typename F>
+  void feed(std::string_view chunk, F &&on_element) {
+    if (failed_)
+      IGUANA_UNLIKELY { throw std::runtime_error("the xml is broken"); }
+    failed_ = true;
+    feed_impl(chunk.data(), chunk.data() + chunk.size(), on_element);
+    failed_ = false;
+  }
+
+  // doesn't throw, the error of the xml, or thrown by on_element, is set to
+  // ec and the reader stays failed.
+  template <typename F>
+  void feed(std::string_view chunk, F &&on_element,
+            std::error_code &ec) noexcept {
+    try {
+      feed(chunk, on_element);
+      ec = {};
+    } catch (std::exception &e) {
+      ec = iguana::make_error_code(e.what());
+    }
+  }
+
+  // call it after the last chunk, throws if the root isn't closed.
+  void finish() const {
+    if (!done())
+      IGUANA_UNLIKELY {
+        throw std::runtime_error("unclosed tag: " + root_name_);
+      }
+  }
+
+  void reset() {
+    buffer_.clear();
+    root_name_.clear();
+    state_ = state::before_root;
+    markup_ = markup::none;
+    depth_ = 0;
+    quote_ = 0;
+    prev_ = 0;
+    marks_ = 0;
+    is_close_ = false;
+    recording_ = false;
+    failed_ = false;
+  }
+
+ private:
+  enum class state : uint8_t { before_root, in_root, done };
+
+  // what the scanner is in, none is the text between the tags.
+  enum class markup : uint8_t {
+    none,
+    open,  // after '<'
+    tag,
+    bang,  // after "<!"
+    comment,
+    cdata,
+    declaration,
+    instruction
+  };
+
+  template <typename F>
+  void feed_impl(const char *p, const char *end, F &on_element) {
+    const char *begin = p;
+    const char *start = p;  // the start of the recorded bytes in the chunk.
+    while (p != end) {
+      if (markup_ == markup::none) {
+        const char *text = p;
+        p = detail::xml_find<'<'>(p, end);
+        if (depth_ == 0 && state_ != state::in_root) {
+          for (; text != p; ++text) {
+            if (static_cast<uint8_t>(*text) > 32)
+              IGUANA_UNLIKELY {
+                throw std::runtime_error(
+                    "Unexpected text outside the root element");
+              }
+          }
+        }
+        if (p == end) {
+          break;
+        }
+        if (!recording_) {
+          // a markup between the children, or a child, starts here.
+          start = p;
+          recording_ = true;
+        }
+        markup_ = markup::open;
+        ++p;
+        continue;
+      }
+      char c = *p;
+      switch (markup_) {
+        case markup::open:
+          is_close_ = c == '/';
+          marks_ = 0;
+          markup_ = c == '!'   ? markup::bang
+                    : c == '?' ? markup::instruction
+                               : markup::tag;
+          ++p;
+          break;
+        case markup::bang:
+          markup_ = c == '-'   ? markup::comment
+                    : c == '[' ? markup::cdata
+                               : markup::declaration;
+          ++p;
+          break;
+        case markup::tag:
+          if (quote_ == '"') {
+            p = detail::xml_find<'"'>(p, end);
+          }
+          else if (quote_ == '\'') {
+            p = detail::xml_find<'\''>(p, end);
+          }
+          else {
+            p = detail::xml_find<'>', '"', '\''>(p, end);
+          }
+          if (p == end) {
+            break;
+          }
+          if (*p != '>') {
+            quote_ = quote_ == 0 ? *p : 0;
+            ++p;
+            break;
+          }
+          ++p;
+          end_tag(start, p, p - begin >= 2 ? p[-2] : prev_, on_element);
+          break;
+        default:
+          // the comments end with "-->", the CDATA sections with "]]>" and
+          // the instructions with "?>".
+          if (c == '>' && (markup_ == markup::declaration ||
+                           (markup_ == markup::instruction &&
+                            (p != begin ? p[-1] : prev_) == '?') ||
+                           marks_ >= 2)) {
+            ++p;
+            markup_ = markup::none;
+            if (depth_ == 0) {
+              // not a child, dropped.
+              buffer_.clear();
+              recording_ = false;
+            }
+            break;
+          }
+          if ((markup_ == markup::comment && c == '-') ||
+              (markup_ == markup::cdata && c == ']')) {
+            ++marks_;
+          }
+          else {
+            marks_ = 0;
+          }
+          ++p;
+          break;
+      }
+    }
+    if (recording_) {
+      buffer_.append(start, static_cast<size_t>(end - start));
+    }
+    if (end != begin) {
+      prev_ = end[-1];
+    }
+  }
+
+  // a start tag or a closing tag ends at p, last is the byte before its
+  // '>'. The bytes from start are the rest of the recorded ones.
+  template <typename F>
+  void end_tag(const char *start, const char *p, char last, F &on_element) {
+    markup_ = markup::none;
+    bool self_closing = !is_close_ && last == '/';
+    if (state_ == state::done)
+      IGUANA_UNLIKELY {
+        throw std::runtime_error("Unexpected content after the root element");
+      }
+    if (depth_ > 0) {
+      if (is_close_) {
+        --depth_;
+      }
+      else if (!self_closing) {
+        ++depth_;
+      }
+      if (depth_ == 0) {
+        complete(start, p, on_element);
+      }
+      return;
+    }
+    if (state_ == state::in_root && !is_close_) {
+      if (self_closing) {
+        complete(start, p, on_element);
+      }
+      else {
+        depth_ = 1;
+      }
+      return;
+    }
+
+    // the start tag or the closing tag of the root.
+    std::string_view tag(start, static_cast<size_t>(p - start));
+    if (!buffer_.empty()) {
+      buffer_.append(tag);
+      tag = buffer_;
+    }
+    size_t name_begin = is_close_ ? 2 : 1;
+    size_t name_end = name_begin;
+    while (name_end < tag.size() &&
+           static_cast<uint8_t>(tag[name_end]) > 32 && tag[name_end] != '/' &&
+           tag[name_end] != '>') {
+      ++name_end;
+    }
+    auto name = tag.substr(name_begin, name_end - name_begin);
+    if (state_ == state::before_root) {
+      if (is_close_)
+        IGUANA_UNLIKELY {
+          throw std::runtime_error("Unexpected closing tag: " +
+                                   std::string(name));
+        }
+      root_name_ = name;
+      state_ = self_closing ? state::done : state::in_root;
+    }
+    else {
+      if (name != root_name_)
+        IGUANA_UNLIKELY {
+          throw std::runtime_error("unclosed tag: " + root_name_);
+        }
+      state_ = state::done;
+    }
+    buffer_.clear();
+    recording_ = false;
+  }
+
+  // the child ends at p.
+  template <typename F>
+  void complete(const char *start, const char *p, F &on_element) {
+    recording_ = false;
+    if (buffer_.empty()) {
+      // the whole child is in the chunk, parsed without a copy.
+      parse_element(start, p, on_element);
+    }
+    else {
+      buffer_.append(start, static_cast<size_t>(p - start));
+      parse_element(buffer_.data(), buffer_.data() + buffer_.size(),
+                    on_element);
+      buffer_.clear();
+    }
+  }
+
+  template <typename F>
+  static void parse_element(const char *begin, const char *end,
+                            F &on_element) {
+    T value{};
+    from_xml(value, begin, end);
+    on_element(std::move(value));
+  }
+
+  std::string buffer_;
+  std::string root_name_;
+  state state_ = state::before_root;
+  markup markup_ = markup::none;
+  size_t depth_ = 0;
+  char quote_ = 0;
+  char prev_ = 0;
+  uint8_t marks_ = 0;
+  bool is_close_ = false;
+  bool recording_ = false;
+  bool failed_ = false;
+};
+}  // namespace iguana
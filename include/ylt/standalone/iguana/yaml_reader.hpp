@@ -1,8 +1,11 @@
 #pragma once
 
 #include <charconv>
+#include <cstring>
+#include <vector>
 
 #include "detail/charconv.h"
+#include "detail/member_matcher.hpp"
 #include "detail/utf.hpp"
 #include "yaml_util.hpp"
 
@@ -544,6 +547,433 @@ IGUANA_INLINE void skip_object_value(It &&it, It &&end, size_t min_spaces) {
   }
 }
 
+// The fast path of from_yaml for the subset used by the configs and the data
+// files: block mappings and sequences, one line flow sequences of scalars,
+// plain and quoted scalars. The lines are indexed ahead of the parser a few
+// blocks at a time, their indentation and content without the comments, the
+// line breaks and the '#' of 64 bytes found at once by json_block. The members
+// are then assigned from the lines by reflection, the scalars parsed in place
+// by yaml_parse_value as the slow path does. On anything else, e.g. anchors,
+// tags, block scalars, flow mappings, multi-line scalars or unknown keys,
+// parse returns false and from_yaml starts over on the slow path.
+class yaml_fast_reader {
+ public:
+  template <typename T>
+  IGUANA_INLINE static bool parse(T &value, const char *data, size_t size) {
+    if (size > UINT32_MAX)
+      IGUANA_UNLIKELY { return false; }
+    yaml_fast_reader reader(data, data + size);
+    return reader.peek() != nullptr && reader.parse_block(value, 0) &&
+           reader.peek() == nullptr && !reader.unsupported_;
+  }
+
+ private:
+  yaml_fast_reader(const char *p, const char *end)
+      : p_(p), end_(end), line_begin_(p) {
+    lines_.reserve(line_count + json_block::size);
+  }
+
+  struct line_t {
+    const char *begin;  // nullptr for the "- " of a block sequence.
+    uint32_t size;
+    uint32_t indent;
+
+    bool dash() const { return begin == nullptr; }
+    std::string_view view() const { return std::string_view(begin, size); }
+  };
+
+  template <typename U>
+  static constexpr bool scalar_v = plain_v<U> || is_pb_type_v<U>;
+
+  // the lines indexed at once, they are reused by the next ones.
+  static constexpr size_t line_count = 256;
+
+  // the next line, nullptr after the last one or a construct not supported.
+  const line_t *peek() {
+    if (pos_ == lines_.size())
+      IGUANA_UNLIKELY {
+        if (!fill()) {
+          return nullptr;
+        }
+      }
+    return &lines_[pos_];
+  }
+
+  bool fill() {
+    lines_.clear();
+    pos_ = 0;
+    char tail[json_block::size];
+    while (lines_.size() < line_count && p_ < end_ && !unsupported_) {
+      const char *data = p_;
+      size_t len = json_block::size;
+      if (static_cast<size_t>(end_ - p_) < json_block::size) {
+        len = static_cast<size_t>(end_ - p_);
+        std::memset(tail, ' ', sizeof(tail));
+        std::memcpy(tail, p_, len);
+        data = tail;
+      }
+      json_block block(data);
+      uint64_t newlines = block.eq('\n');
+      uint64_t hashes = block.eq('#');
+      uint64_t marks = newlines | hashes;
+      while (marks) {
+        int i = countr_zero(marks);
+        if ((newlines >> i) & 1) {
+          add_line(p_ + i);
+          line_begin_ = p_ + i + 1;
+          hash_ = false;
+        }
+        else {
+          hash_ = true;
+        }
+        marks &= marks - 1;
+      }
+      p_ += len;
+      if (p_ == end_ && line_begin_ != end_) {
+        add_line(end_);
+        line_begin_ = end_;
+      }
+    }
+    return !unsupported_ && !lines_.empty();
+  }
+
+  // the line from line_begin_ to e.
+  void add_line(const char *e) {
+    const char *b = line_begin_;
+    while (b != e && *b == ' ') {
+      ++b;
+    }
+    if (b == e || *b == '#') {
+      return;
+    }
+    if (hash_)
+      IGUANA_UNLIKELY {
+        // cut the comment at " #" and the spaces before it, as
+        // skip_till_newline does.
+        for (const char *h = b + 1; h != e; ++h) {
+          if (*h == '#' && h[-1] == ' ') {
+            e = h;
+            break;
+          }
+        }
+      }
+    while (e[-1] == ' ') {
+      --e;
+    }
+    if (b == line_begin_ && e - b == 3 && std::memcmp(b, "---", 3) == 0) {
+      return;
+    }
+    // "- - a" is two items, the content after them is a line on its own.
+    while (*b == '-' && (b + 1 == e || b[1] == ' ')) {
+      lines_.push_back({nullptr, 0, static_cast<uint32_t>(b - line_begin_)});
+      ++b;
+      while (b != e && *b == ' ') {
+        ++b;
+      }
+      if (b == e) {
+        return;
+      }
+    }
+    switch (*b) {
+      case '\t':
+      case '&':
+      case '*':
+      case '!':
+      case '|':
+      case '>':
+      case '?':
+      case '%':
+      case '@':
+      case '`':
+      case '{':
+      case '[':
+        unsupported_ = true;
+        return;
+      default:
+        break;
+    }
+    lines_.push_back({b, static_cast<uint32_t>(e - b),
+                      static_cast<uint32_t>(b - line_begin_)});
+  }
+
+  // the next line belongs to the value of a key indented by indent.
+  bool deeper(size_t indent) {
+    auto line = peek();
+    return line != nullptr && line->indent > indent;
+  }
+
+  // the items of the sequence indented by indent in the lines indexed, all of
+  // them unless it goes on after the last line.
+  size_t count_items(size_t indent) const {
+    size_t count = 0;
+    for (size_t i = pos_; i < lines_.size() && lines_[i].indent >= indent;
+         ++i) {
+      count += lines_[i].dash() && lines_[i].indent == indent;
+    }
+    return count;
+  }
+
+  static bool split_key(std::string_view line, std::string_view &key,
+                        std::string_view &rest) {
+    auto colon = line.find(':');
+    if (colon == std::string_view::npos || colon == 0) {
+      return false;
+    }
+    key = line.substr(0, colon);
+    while (key.back() == ' ') {
+      key.remove_suffix(1);
+    }
+    rest = line.substr(colon + 1);
+    // the tabs too, as skip_space_and_lines does.
+    while (!rest.empty() && (rest.front() == ' ' || rest.front() == '\t')) {
+      rest.remove_prefix(1);
+    }
+    return true;
+  }
+
+  template <typename U>
+  static bool parse_scalar(U &&value, std::string_view str) {
+    using T = std::remove_cvref_t<U>;
+    if (str.empty()) {
+      // the value may be in the next lines.
+      return false;
+    }
+    if constexpr (optional_v<T>) {
+      if (str == "null") {
+        return true;
+      }
+      return parse_scalar(value.emplace(), str);
+    }
+    else {
+      switch (char c = str.front()) {
+        case '"':
+        case '\'':
+          if (str.size() < 2 || str.back() != c) {
+            return false;
+          }
+          break;
+        // anchors, aliases, tags, block scalars and flow collections.
+        case '&':
+        case '*':
+        case '!':
+        case '|':
+        case '>':
+        case '{':
+        case '[':
+          return false;
+        default:
+          break;
+      }
+      if constexpr (string_v<T>) {
+        if (str.front() != '"') {
+          // assigned without the temporary string of yaml_parse_value.
+          if (str.front() == '\'') {
+            str = str.substr(1, str.size() - 2);
+          }
+          if (str == "~" || str == "null") {
+            value.clear();
+          }
+          else {
+            value.assign(str.data(), str.size());
+          }
+          return true;
+        }
+      }
+      const char *begin = str.data();
+      const char *end = str.data() + str.size();
+      yaml_parse_value(value, begin, end);
+      return true;
+    }
+  }
+
+  // [a, b, c], the items are split as yaml_skip_till does.
+  template <typename U>
+  static bool parse_flow(U &value, std::string_view str) {
+    if (str.size() < 2 || str.front() != '[' || str.back() != ']') {
+      return false;
+    }
+    value.clear();
+    str = str.substr(1, str.size() - 2);
+    if (str.find_first_of("[]{}\"'") != std::string_view::npos) {
+      return false;
+    }
+    while (!str.empty() && str.front() == ' ') {
+      str.remove_prefix(1);
+    }
+    while (!str.empty()) {
+      auto comma = str.find(',');
+      auto item = str.substr(0, comma);
+      while (!item.empty() && item.back() == ' ') {
+        item.remove_suffix(1);
+      }
+      if (!parse_scalar(value.emplace_back(), item)) {
+        return false;
+      }
+      if (comma == std::string_view::npos) {
+        break;
+      }
+      str.remove_prefix(comma + 1);
+      while (!str.empty() && str.front() == ' ') {
+        str.remove_prefix(1);
+      }
+    }
+    return true;
+  }
+
+  // the value of a key indented by indent, rest is the content after ':'.
+  template <typename U>
+  bool parse_value(U &value, std::string_view rest, size_t indent) {
+    using T = std::remove_cvref_t<U>;
+    if constexpr (scalar_v<T>) {
+      return parse_scalar(value, rest) && !deeper(indent);
+    }
+    else if constexpr (optional_v<T>) {
+      if (rest == "null") {
+        return !deeper(indent);
+      }
+      if constexpr (scalar_v<typename T::value_type>) {
+        return parse_scalar(value, rest) && !deeper(indent);
+      }
+      else {
+        return parse_value(value.emplace(), rest, indent);
+      }
+    }
+    else if constexpr (sequence_container_v<T>) {
+      if (!rest.empty()) {
+        if (rest == "[]") {
+          value.clear();
+          return !deeper(indent);
+        }
+        if constexpr (scalar_v<typename T::value_type>) {
+          return parse_flow(value, rest) && !deeper(indent);
+        }
+        else {
+          return false;
+        }
+      }
+      // the items may be as indented as the key.
+      return parse_sequence(value, indent);
+    }
+    else {
+      return rest.empty() && parse_block(value, indent + 1);
+    }
+  }
+
+  // a mapping or a sequence from the next line, indented by min_indent at
+  // least.
+  template <typename U>
+  bool parse_block(U &value, size_t min_indent) {
+    using T = std::remove_cvref_t<U>;
+    auto line = peek();
+    if (line == nullptr || line->indent < min_indent) {
+      return false;
+    }
+    if constexpr (ylt_refletable_v<T> || map_container_v<T>) {
+      return parse_mapping(value);
+    }
+    else if constexpr (sequence_container_v<T>) {
+      return parse_sequence(value, min_indent);
+    }
+    else if constexpr (optional_v<T>) {
+      return parse_block(value.emplace(), min_indent);
+    }
+    else {
+      return false;
+    }
+  }
+
+  template <typename U>
+  bool parse_sequence(U &value, size_t min_indent) {
+    using value_type = typename std::remove_cvref_t<U>::value_type;
+    auto line = peek();
+    if (line == nullptr || !line->dash() || line->indent < min_indent) {
+      return false;
+    }
+    value.clear();
+    size_t indent = line->indent;
+    if constexpr (is_template_instant_of<std::vector,
+                                         std::remove_cvref_t<U>>::value) {
+      value.reserve(count_items(indent));
+    }
+    while ((line = peek()) != nullptr && line->dash() &&
+           line->indent == indent) {
+      ++pos_;
+      if constexpr (scalar_v<value_type>) {
+        line = peek();
+        if (line == nullptr || line->dash() || line->indent <= indent) {
+          return false;
+        }
+        ++pos_;
+        if (!parse_scalar(value.emplace_back(), line->view()) ||
+            deeper(indent)) {
+          return false;
+        }
+      }
+      else {
+        if (!parse_block(value.emplace_back(), indent + 1)) {
+          return false;
+        }
+      }
+    }
+    return true;
+  }
+
+  // the keys of a struct or a map, as indented as the next line.
+  template <typename U>
+  bool parse_mapping(U &value) {
+    using T = std::remove_cvref_t<U>;
+    auto line = peek();
+    if (line->dash()) {
+      return false;
+    }
+    size_t indent = line->indent;
+    [[maybe_unused]] size_t expected = 0;
+    while ((line = peek()) != nullptr && line->indent >= indent) {
+      std::string_view key, rest;
+      if (line->indent != indent || line->dash() ||
+          !split_key(line->view(), key, rest)) {
+        return false;
+      }
+      ++pos_;
+      bool ok = true;
+      if constexpr (map_container_v<T>) {
+        using key_type = typename T::key_type;
+        if constexpr (!scalar_v<key_type>) {
+          return false;
+        }
+        else {
+          key_type k{};
+          if (!parse_scalar(k, key)) {
+            return false;
+          }
+          ok = parse_value(value[k], rest, indent);
+        }
+      }
+      else {
+        // the unknown keys are left to the slow path, which skips or throws.
+        if (!visit_member(value, key, expected,
+                          [&](auto &member) IGUANA__INLINE_LAMBDA {
+                            ok = parse_value(member, rest, indent);
+                          })) {
+          return false;
+        }
+      }
+      if (!ok) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  const char *p_;
+  const char *end_;
+  const char *line_begin_;
+  bool hash_ = false;  // a '#' since line_begin_.
+  bool unsupported_ = false;
+  std::vector<line_t> lines_;
+  size_t pos_ = 0;
+};
+
 }  // namespace detail
 
 template <typename T, typename It, std::enable_if_t<ylt_refletable_v<T>, int>>
@@ -604,9 +1034,16 @@ IGUANA_INLINE void from_yaml(T &value, It &&it, It &&end,
   }
 }
 
+// tries the fast path first, see yaml_fast_reader.
 template <typename T, typename View,
           std::enable_if_t<string_container_v<View>, int> = 0>
 IGUANA_INLINE void from_yaml(T &value, const View &view) {
+  if constexpr (ylt_refletable_v<T> || sequence_container_v<T> ||
+                map_container_v<T>) {
+    if (detail::yaml_fast_reader::parse(value, view.data(), view.size())) {
+      return;
+    }
+  }
   from_yaml(value, std::begin(view), std::end(view));
 }
 
@@ -615,7 +1052,7 @@ template <typename T, typename View,
 IGUANA_INLINE void from_yaml(T &value, const View &view,
                              std::error_code &ec) noexcept {
   try {
-    from_yaml(value, std::begin(view), std::end(view));
+    from_yaml(value, view);
     ec = {};
   } catch (std::runtime_error &e) {
     ec = iguana::make_error_code(e.what());
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2023, Alibaba Group Holding Limited;
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <functional>
+#include <iguana/json_stream.hpp>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+#include "async_simple/coro/Lazy.h"
+
+namespace struct_json = iguana;
+
+namespace iguana {
+
+// Read a top level json array from a coro_io::coro_file, or any source with
+// async_read(char *, size_t) and eof(), chunk_size bytes at a time. Every
+// element is passed to on_element as soon as it's read.
+template <typename T, typename File, typename F>
+async_simple::coro::Lazy<std::error_code> async_read_json_array(
+    File &file, F on_element, size_t chunk_size = 64 * 1024) {
+  json_array_reader<T> reader;
+  std::string buf;
+  buf.resize(chunk_size);
+  std::error_code ec;
+  while (!reader.done()) {
+    auto [read_ec, size] = co_await file.async_read(buf.data(), buf.size());
+    if (read_ec) {
+      co_return read_ec;
+    }
+    reader.feed(std::string_view(buf.data(), size), on_element, ec);
+    if (ec) {
+      co_return ec;
+    }
+    if (size == 0 || file.eof()) {
+      break;
+    }
+  }
+  if (!reader.done()) {
+    co_return iguana::make_error_code("Unexpected end of array");
+  }
+  co_return ec;
+}
+
+// The chunked callback of coro_http_client, it feeds the chunks of the
+// response body to reader:
+//
+//   json_array_reader<person> reader;
+//   client.set_chunked_callback(
+//       struct_json::json_array_chunked_callback(reader, on_person, ec));
+//   co_await client.async_get(url);
+//   if (!ec && !reader.done()) { /* truncated */ }
+//
+// reader and ec must outlive the request. After an error the rest of the
+// response is dropped.
+template <typename T, typename F>
+std::function<async_simple::coro::Lazy<void>(std::string_view)>
+json_array_chunked_callback(json_array_reader<T> &reader, F on_element,
+                            std::error_code &ec) {
+  return [&reader, &ec, on_element = std::move(on_element)](
+             std::string_view chunk) mutable -> async_simple::coro::Lazy<void> {
+    if (!ec) {
+      reader.feed(chunk, on_element, ec);
+    }
+    co_return;
+  };
+}
+}  // namespace iguana
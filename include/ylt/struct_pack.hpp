@@ -17,6 +17,9 @@
 
 #include <cstdint>
 #include <memory>
+#if __has_include(<memory_resource>)
+#include <memory_resource>
+#endif
 #include <type_traits>
 #include <utility>
 
@@ -166,6 +169,50 @@ void serialize_to(char *buffer, serialize_buffer_size info,
   struct_pack::detail::serialize_to<conf>(writer, info, args...);
 }
 
+/*!
+ * Serialize with the size calculated before, e.g. a cached response which is
+ * serialized repeatedly. info must be get_needed_size<conf>(args...), and the
+ * objects mustn't be changed since then.
+ */
+template <uint64_t conf = sp_config::DEFAULT, typename Writer, typename... Args,
+          typename = std::enable_if_t<struct_pack::writer_t<Writer> ||
+                                      detail::struct_pack_buffer<Writer>>>
+void serialize_to(Writer &writer, const serialize_buffer_size &info,
+                  const Args &...args) {
+  static_assert(sizeof...(args) > 0);
+  if constexpr (struct_pack::writer_t<Writer>) {
+    struct_pack::detail::serialize_to<conf>(writer, info, args...);
+  }
+  else {
+    auto data_offset = writer.size();
+    detail::resize(writer, data_offset + info.size());
+    auto real_writer =
+        struct_pack::detail::memory_writer{(char *)writer.data() + data_offset};
+    struct_pack::detail::serialize_to<conf>(real_writer, info, args...);
+  }
+}
+
+/*!
+ * Serialize to the end of the buffer in one pass, without calculating the
+ * size of the objects first. The buffer grows on demand, so reuse it to avoid
+ * reallocation. The result is the same as serialize_to.
+ */
+template <uint64_t conf = sp_config::DEFAULT,
+#if __cpp_concepts >= 201907L
+          detail::struct_pack_buffer Buffer,
+#else
+          typename Buffer,
+#endif
+          typename... Args>
+void serialize_to_one_pass(Buffer &buffer, const Args &...args) {
+#if __cpp_concepts < 201907L
+  static_assert(detail::struct_pack_buffer<Buffer>,
+                "The buffer is not satisfied struct_pack_buffer requirement!");
+#endif
+  static_assert(sizeof...(args) > 0);
+  detail::serialize_to_one_pass<conf>(buffer, args...);
+}
+
 template <uint64_t conf = sp_config::DEFAULT,
 #if __cpp_concepts >= 201907L
           detail::struct_pack_buffer Buffer,
@@ -656,6 +703,52 @@ template <typename T, size_t I, uint64_t conf = sp_config::DEFAULT,
   }
   return ret;
 }
+#if __cpp_lib_memory_resource >= 201603L
+/*!
+ * \ingroup struct_pack
+ * Deserialize T whose memory is allocated from `resource`, such as a per
+ * request std::pmr::monotonic_buffer_resource. The std::pmr containers in T,
+ * including the fields of nested structs and the elements of containers, are
+ * constructed with the allocator of `resource`.
+ *
+ * The object with other allocator aware containers can be constructed by the
+ * user and deserialized by `deserialize_to`, the new elements are constructed
+ * with the allocator of the container which owns them.
+ */
+#if __cpp_concepts >= 201907L
+template <typename T, uint64_t conf = sp_config::DEFAULT,
+          struct_pack::detail::deserialize_view View>
+#else
+template <
+    typename T, uint64_t conf = sp_config::DEFAULT, typename View,
+    typename = std::enable_if_t<struct_pack::detail::deserialize_view<View>>>
+#endif
+[[nodiscard]] struct_pack::expected<T, struct_pack::err_code> deserialize(
+    const View &v, std::pmr::memory_resource *resource) {
+  struct_pack::expected<T, struct_pack::err_code> ret{
+      detail::make_with_allocator<T>(
+          std::pmr::polymorphic_allocator<std::byte>{resource})};
+  auto errc = deserialize_to<conf>(ret.value(), v);
+  if SP_UNLIKELY (errc) {
+    ret = unexpected<struct_pack::err_code>{errc};
+  }
+  return ret;
+}
+
+template <typename T, uint64_t conf = sp_config::DEFAULT>
+[[nodiscard]] struct_pack::expected<T, struct_pack::err_code> deserialize(
+    const char *data, size_t size, std::pmr::memory_resource *resource) {
+  struct_pack::expected<T, struct_pack::err_code> ret{
+      detail::make_with_allocator<T>(
+          std::pmr::polymorphic_allocator<std::byte>{resource})};
+  auto errc = deserialize_to<conf>(ret.value(), data, size);
+  if SP_UNLIKELY (errc) {
+    ret = unexpected<struct_pack::err_code>{errc};
+  }
+  return ret;
+}
+#endif
+
 #if __cpp_concepts >= 201907L
 template <typename BaseClass, typename... DerivedClasses,
           struct_pack::reader_t Reader>
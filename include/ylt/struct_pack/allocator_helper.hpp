@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2023, Alibaba Group Holding Limited;
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#include <cstddef>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "reflection.hpp"
+#include "type_id.hpp"
+
+// Construct the objects created while deserializing with the allocator of the
+// container which owns them, so an object built from an arena(for example a
+// std::pmr::monotonic_buffer_resource) keeps all of its memory in the arena.
+namespace struct_pack::detail {
+
+template <typename T, typename = void>
+struct has_get_allocator_impl : std::false_type {};
+
+template <typename T>
+struct has_get_allocator_impl<
+    T, std::void_t<decltype(std::declval<const T &>().get_allocator())>>
+    : std::true_type {};
+
+template <typename T>
+constexpr bool has_get_allocator = has_get_allocator_impl<T>::value;
+
+template <typename T, typename Tuple, typename = void>
+struct is_brace_constructible_impl : std::false_type {};
+
+template <typename T, typename... Fields>
+struct is_brace_constructible_impl<
+    T, std::tuple<Fields...>,
+    std::void_t<decltype(T{std::declval<Fields>()...})>> : std::true_type {};
+
+template <typename T, typename Alloc>
+constexpr bool allocator_aware();
+
+template <typename Alloc, typename... Fields>
+constexpr bool any_allocator_aware(std::tuple<Fields...> *) {
+  return (allocator_aware<Fields, Alloc>() || ...);
+}
+
+// The aggregate struct which could be constructed field by field.
+template <typename T>
+constexpr bool aggregate_struct() {
+  if constexpr (std::is_aggregate_v<T> && std::is_class_v<T> &&
+                get_type_id<T>() == type_id::struct_t && !tuple<T> &&
+                !pair<T>) {
+    return is_brace_constructible_impl<T, decltype(get_types<T>())>::value;
+  }
+  else {
+    return false;
+  }
+}
+
+// If the allocator should be passed to T or its members.
+template <typename T, typename Alloc>
+constexpr bool allocator_aware() {
+  if constexpr (std::uses_allocator_v<T, Alloc>) {
+    return true;
+  }
+  else if constexpr (pair<T>) {
+    return allocator_aware<typename T::first_type, Alloc>() ||
+           allocator_aware<typename T::second_type, Alloc>();
+  }
+  else if constexpr (aggregate_struct<T>()) {
+    return any_allocator_aware<Alloc>(
+        (decltype(get_types<T>()) *)nullptr);
+  }
+  else {
+    return false;
+  }
+}
+
+template <typename T, typename Alloc, std::size_t... I>
+T make_struct_with_allocator(const Alloc &alloc, std::index_sequence<I...>);
+
+/*
+ * Uses-allocator construction. Unlike std::make_obj_using_allocator, the
+ * allocator is also passed to the fields of an aggregate struct, so
+ * `struct A { std::pmr::string s; }` is built from the arena too.
+ */
+template <typename T, typename Alloc>
+T make_with_allocator(const Alloc &alloc) {
+  if constexpr (std::uses_allocator_v<T, Alloc>) {
+    if constexpr (std::is_constructible_v<T, std::allocator_arg_t,
+                                          const Alloc &>) {
+      return T(std::allocator_arg, alloc);
+    }
+    else {
+      return T(alloc);
+    }
+  }
+  else if constexpr (pair<T> && allocator_aware<T, Alloc>()) {
+    return T{make_with_allocator<typename T::first_type>(alloc),
+             make_with_allocator<typename T::second_type>(alloc)};
+  }
+  else if constexpr (aggregate_struct<T>() && allocator_aware<T, Alloc>()) {
+    return make_struct_with_allocator<T>(
+        alloc, std::make_index_sequence<
+                   std::tuple_size_v<decltype(get_types<T>())>>{});
+  }
+  else {
+    return T{};
+  }
+}
+
+template <typename T, typename Alloc, std::size_t... I>
+T make_struct_with_allocator(const Alloc &alloc, std::index_sequence<I...>) {
+  using types = decltype(get_types<T>());
+  return T{make_with_allocator<std::tuple_element_t<I, types>>(alloc)...};
+}
+
+// Create the temporary value, which will be moved into the container, with the
+// allocator of the container.
+template <typename T, typename Container>
+T make_element_of(const Container &container) {
+  if constexpr (has_get_allocator<Container>) {
+    return make_with_allocator<T>(container.get_allocator());
+  }
+  else {
+    return T{};
+  }
+}
+
+// Append a default element to the container. The allocator aware element is
+// constructed by the container itself, only the aggregate struct with
+// allocator aware fields need help.
+template <typename Container>
+void emplace_back_element(Container &container) {
+  using value_type = typename Container::value_type;
+  if constexpr (has_get_allocator<Container>) {
+    using allocator_type = decltype(container.get_allocator());
+    if constexpr (!std::uses_allocator_v<value_type, allocator_type> &&
+                  allocator_aware<value_type, allocator_type>()) {
+      container.emplace_back(
+          make_with_allocator<value_type>(container.get_allocator()));
+      return;
+    }
+  }
+  container.emplace_back();
+}
+}  // namespace struct_pack::detail
@@ -0,0 +1,116 @@
+/*
+ * Copyright (c) 2023, Alibaba Group Holding Limited;
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <utility>
+
+#include "async_simple/coro/Lazy.h"
+#include "error_code.hpp"
+#include "record_stream.hpp"
+
+// Read and write record streams with a coro_io::coro_file, or any file with
+// async_read(char *, size_t), async_write(std::string_view) and eof(), a chunk
+// at a time. The format is the one of record_writer and record_reader.
+namespace struct_pack {
+
+namespace detail {
+struct record_string_writer {
+  std::string &buffer;
+  void write(const char *data, std::size_t size) { buffer.append(data, size); }
+};
+
+inline std::error_code to_error_code(struct_pack::err_code ec) {
+  return std::error_code(ec.val(), struct_pack::detail::category());
+}
+}  // namespace detail
+
+/*!
+ * \ingroup struct_pack
+ * Read the records of a file, every record is deserialized into a T and passed
+ * to on_record(T &&) as soon as its chunk is read. errc::invalid_buffer is
+ * returned for a corrupted record, errc::no_buffer_space if the file ends
+ * inside a record.
+ */
+template <typename T, uint64_t conf = sp_config::DEFAULT, typename File,
+          typename F>
+async_simple::coro::Lazy<std::error_code> async_read_records(
+    File &file, F on_record, std::size_t chunk_size = 64 * 1024,
+    std::size_t max_record_size = STRUCT_PACK_MAX_RECORD_SIZE) {
+  record_decoder<conf> decoder(max_record_size);
+  std::string buf;
+  buf.resize(chunk_size);
+  while (true) {
+    auto [read_ec, size] = co_await file.async_read(buf.data(), buf.size());
+    if (read_ec) {
+      co_return read_ec;
+    }
+    decoder.feed(buf.data(), size);
+    while (true) {
+      T item{};
+      auto ec = decoder.next(item);
+      if (ec) {
+        if (!decoder.need_more()) {
+          co_return detail::to_error_code(ec);
+        }
+        break;
+      }
+      on_record(std::move(item));
+    }
+    if (size == 0 || file.eof()) {
+      break;
+    }
+  }
+  if (decoder.pending() != 0) {
+    co_return detail::to_error_code(struct_pack::errc::no_buffer_space);
+  }
+  co_return std::error_code{};
+}
+
+/*!
+ * \ingroup struct_pack
+ * Write the items of a range as records, they are buffered and written to the
+ * file chunk_size bytes a time.
+ */
+template <uint64_t conf = sp_config::DEFAULT, typename File, typename Range>
+async_simple::coro::Lazy<std::error_code> async_write_records(
+    File &file, const Range &items, std::size_t sync_interval = 1024,
+    std::size_t chunk_size = 64 * 1024) {
+  std::string buf;
+  detail::record_string_writer writer{buf};
+  record_writer<detail::record_string_writer, conf> out(writer, sync_interval);
+  for (const auto &item : items) {
+    out.write(item);
+    if (buf.size() >= chunk_size) {
+      auto [ec, size] = co_await file.async_write(buf);
+      if (ec) {
+        co_return ec;
+      }
+      buf.clear();
+    }
+  }
+  if (!buf.empty()) {
+    auto [ec, size] = co_await file.async_write(buf);
+    if (ec) {
+      co_return ec;
+    }
+  }
+  co_return std::error_code{};
+}
+}  // namespace struct_pack
@@ -385,8 +385,8 @@ calculate_fast_varint_size(const Args &...items) {
 }
 
 template <uint64_t conf, typename... Args>
-STRUCT_PACK_INLINE constexpr serialize_buffer_size get_serialize_runtime_info(
-    const Args &...args);
+STRUCT_PACK_INLINE constexpr serialize_buffer_size
+get_serialize_runtime_info_by_payload(const size_info &sz_info);
 }  // namespace detail
 struct serialize_buffer_size {
  private:
@@ -401,12 +401,14 @@ struct serialize_buffer_size {
 
   template <uint64_t conf, typename... Args>
   friend STRUCT_PACK_INLINE constexpr serialize_buffer_size
-  struct_pack::detail::get_serialize_runtime_info(const Args &...args);
+  struct_pack::detail::get_serialize_runtime_info_by_payload(
+      const size_info &sz_info);
 };
 namespace detail {
+// The payload size could be calculated in another way, e.g. in parallel.
 template <uint64_t conf, typename... Args>
 [[nodiscard]] STRUCT_PACK_INLINE constexpr serialize_buffer_size
-get_serialize_runtime_info(const Args &...args) {
+get_serialize_runtime_info_by_payload(const size_info &sz_info) {
   using Type = get_args_type<Args...>;
   constexpr bool has_compatible = serialize_static_config<Type>::has_compatible;
   constexpr bool has_type_literal = check_if_add_type_literal<conf, Type>();
@@ -415,7 +417,6 @@ get_serialize_runtime_info(const Args &...args) {
   constexpr bool has_compile_time_determined_meta_info =
       check_has_metainfo<conf, Type>();
   serialize_buffer_size ret;
-  auto sz_info = calculate_payload_size(args...);
   if constexpr (has_compile_time_determined_meta_info) {
     ret.len_ = sizeof(unsigned char);
   }
@@ -472,5 +473,12 @@ get_serialize_runtime_info(const Args &...args) {
   }
   return ret;
 }
+
+template <uint64_t conf, typename... Args>
+[[nodiscard]] STRUCT_PACK_INLINE constexpr serialize_buffer_size
+get_serialize_runtime_info(const Args &...args) {
+  return get_serialize_runtime_info_by_payload<conf, Args...>(
+      calculate_payload_size(args...));
+}
 }  // namespace detail
 }  // namespace struct_pack
\ No newline at end of file
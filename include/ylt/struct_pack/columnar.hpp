@@ -0,0 +1,542 @@
+/*
+ * Copyright (c) 2023, Alibaba Group Holding Limited;
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "error_code.hpp"
+#include "md5_constexpr.hpp"
+#include "reflection.hpp"
+#include "type_calculate.hpp"
+#include "user_helper.hpp"
+#include "varint.hpp"
+
+/*
+ * Columnar(struct of arrays) encoding of a sequence of structs. The rows are
+ * written member by member, each member of all the rows is a contiguous
+ * column:
+ *
+ * columnar := uint64(row count) column*
+ * column   := struct_pack::write(member) * row count
+ *           | varint(zigzag(delta)) * row count  // column_encoding::delta
+ *
+ * ```cpp
+ * struct trade {
+ *   int64_t id;
+ *   double price;
+ *   int32_t volume;
+ * };
+ * struct_pack::columnar<std::vector<trade>> trades = ...;
+ * auto buffer = struct_pack::serialize(trades);
+ * // read it as rows
+ * auto rows = struct_pack::deserialize<columnar<std::vector<trade>>>(buffer);
+ * // or read it as columns
+ * auto columns = struct_pack::deserialize<soa<trade>>(buffer);
+ * double p = columns->column<1>()[0];
+ * ```
+ *
+ * columnar<std::vector<T>, e> and soa<T, e> have the same format and type
+ * hash, so they could be read as each other. They are declared in
+ * ylt/struct_pack/columnar.hpp, which ylt/struct_pack.hpp doesn't include.
+ */
+namespace struct_pack {
+
+enum class column_encoding : uint8_t {
+  plain,
+  // the integral columns are written as the zigzag varint of the difference
+  // to the previous row, it's small for the sorted ids and the timestamps.
+  delta,
+};
+
+/*
+ * A sequence container of structs which is serialized in columns, e.g.
+ * columnar<std::vector<T>>. It could be used as the container.
+ */
+template <typename Container, column_encoding encoding = column_encoding::plain>
+struct columnar : public Container {
+  using Container::Container;
+  columnar() = default;
+  columnar(const Container &container) : Container(container) {}
+  columnar(Container &&container) : Container(std::move(container)) {}
+};
+
+namespace detail {
+
+template <typename T>
+using column_types = decltype(get_types<T>());
+
+template <typename T>
+constexpr std::size_t column_count = std::tuple_size_v<column_types<T>>;
+
+template <typename T, std::size_t I>
+using column_type = std::tuple_element_t<I, column_types<T>>;
+
+template <typename Tuple>
+struct soa_columns_impl;
+template <typename... Args>
+struct soa_columns_impl<std::tuple<Args...>> {
+  using type = std::tuple<std::vector<Args>...>;
+};
+
+template <typename M, column_encoding encoding>
+constexpr bool is_delta_column_v =
+    encoding == column_encoding::delta && std::is_integral_v<M> &&
+    !std::is_same_v<M, bool> && sizeof(M) <= sizeof(uint64_t);
+
+template <typename T, column_encoding encoding>
+constexpr auto get_columnar_type_name() {
+  static_assert(get_type_id<remove_cvref_t<T>>() == type_id::struct_t,
+                "The row type of columnar should be a struct.");
+  if constexpr (encoding == column_encoding::plain) {
+    return string_literal<char, 8>{"columnar"} + get_type_literal<T>();
+  }
+  else {
+    return string_literal<char, 14>{"columnar_delta"} + get_type_literal<T>();
+  }
+}
+
+template <typename T, column_encoding encoding>
+constexpr auto columnar_type_name = get_columnar_type_name<T, encoding>();
+
+template <std::size_t I, typename T>
+STRUCT_PACK_INLINE decltype(auto) get_column_member(T &row) {
+  return visit_members(row, [](auto &...members) -> decltype(auto) {
+    return std::get<I>(std::tie(members...));
+  });
+}
+
+// The row count isn't trusted before the data is read, the rows are allocated
+// by 1MB blocks when reading the first column.
+template <typename T>
+constexpr std::size_t columnar_block_size =
+    (std::max)(std::size_t{1024 * 1024} / sizeof(T), std::size_t{1});
+
+template <typename M, column_encoding encoding, typename Get>
+std::size_t get_column_size(std::size_t n, Get &&get) {
+  if constexpr (is_delta_column_v<M, encoding>) {
+    std::size_t ret = 0;
+    uint64_t prev = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      uint64_t now = static_cast<uint64_t>(get(i));
+      ret += get_write_size(var_int64_t{static_cast<int64_t>(now - prev)});
+      prev = now;
+    }
+    return ret;
+  }
+  else if constexpr (is_trivial_serializable<M>::value) {
+    return sizeof(M) * n;
+  }
+  else {
+    std::size_t ret = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+      ret += get_write_size(get(i));
+    }
+    return ret;
+  }
+}
+
+// The trivial columns and the deltas are copied through a small buffer, so
+// they are written/read in bulk instead of one by one.
+template <typename M>
+constexpr std::size_t column_chunk_size =
+    (std::max)(std::size_t{4096} / sizeof(M), std::size_t{1});
+
+template <typename M, column_encoding encoding, typename Writer, typename Get>
+void write_column(Writer &writer, std::size_t n, Get &&get) {
+  if constexpr (is_delta_column_v<M, encoding>) {
+    constexpr std::size_t chunk_size = column_chunk_size<var_int64_t>;
+    var_int64_t chunk[chunk_size];
+    uint64_t prev = 0;
+    for (std::size_t i = 0; i < n; i += chunk_size) {
+      std::size_t len = (std::min)(chunk_size, n - i);
+      for (std::size_t j = 0; j < len; ++j) {
+        uint64_t now = static_cast<uint64_t>(get(i + j));
+        chunk[j] = static_cast<int64_t>(now - prev);
+        prev = now;
+      }
+      serialize_varints(writer, chunk, len);
+    }
+  }
+  else if constexpr (is_trivial_serializable<M>::value) {
+    constexpr std::size_t chunk_size = column_chunk_size<M>;
+    M chunk[chunk_size];
+    for (std::size_t i = 0; i < n; i += chunk_size) {
+      std::size_t len = (std::min)(chunk_size, n - i);
+      for (std::size_t j = 0; j < len; ++j) {
+        chunk[j] = get(i + j);
+      }
+      struct_pack::write(writer, chunk, len);
+    }
+  }
+  else {
+    for (std::size_t i = 0; i < n; ++i) {
+      struct_pack::write(writer, get(i));
+    }
+  }
+}
+
+// read the column [begin, end) to get(begin) ... get(end - 1).
+template <typename M, column_encoding encoding, typename Reader, typename Get>
+struct_pack::err_code read_column(Reader &reader, std::size_t begin,
+                                  std::size_t end, uint64_t &prev, Get &&get) {
+  if constexpr (is_delta_column_v<M, encoding>) {
+    constexpr std::size_t chunk_size = column_chunk_size<var_int64_t>;
+    var_int64_t chunk[chunk_size];
+    for (std::size_t i = begin; i < end; i += chunk_size) {
+      std::size_t len = (std::min)(chunk_size, end - i);
+      if (auto ec = deserialize_varints(reader, chunk, len); ec) {
+        return ec;
+      }
+      for (std::size_t j = 0; j < len; ++j) {
+        prev += static_cast<uint64_t>(static_cast<int64_t>(chunk[j]));
+        get(i + j) = static_cast<M>(prev);
+      }
+    }
+  }
+  else if constexpr (is_trivial_serializable<M>::value) {
+    constexpr std::size_t chunk_size = column_chunk_size<M>;
+    M chunk[chunk_size];
+    for (std::size_t i = begin; i < end; i += chunk_size) {
+      std::size_t len = (std::min)(chunk_size, end - i);
+      if (auto ec = struct_pack::read(reader, chunk, len); ec) {
+        return ec;
+      }
+      for (std::size_t j = 0; j < len; ++j) {
+        get(i + j) = chunk[j];
+      }
+    }
+  }
+  else {
+    for (std::size_t i = begin; i < end; ++i) {
+      if (auto ec = struct_pack::read(reader, get(i)); ec) {
+        return ec;
+      }
+    }
+  }
+  return {};
+}
+
+template <typename T, column_encoding encoding, typename Writer,
+          typename Container, std::size_t... I>
+void write_row_columns(Writer &writer, const Container &rows,
+                       std::index_sequence<I...>) {
+  (write_column<column_type<T, I>, encoding>(
+       writer, rows.size(),
+       [&rows](std::size_t i) -> decltype(auto) {
+         return get_column_member<I>(rows[i]);
+       }),
+   ...);
+}
+
+template <typename T, column_encoding encoding, typename Container,
+          std::size_t... I>
+std::size_t get_row_columns_size(const Container &rows,
+                                 std::index_sequence<I...>) {
+  return (get_column_size<column_type<T, I>, encoding>(
+              rows.size(),
+              [&rows](std::size_t i) -> decltype(auto) {
+                return get_column_member<I>(rows[i]);
+              }) +
+          ...);
+}
+
+template <typename T, column_encoding encoding, typename Reader,
+          typename Container, std::size_t... I>
+struct_pack::err_code read_row_columns(Reader &reader, Container &rows,
+                                       std::size_t n,
+                                       std::index_sequence<I...>) {
+  struct_pack::err_code ec{};
+  auto read_one = [&](auto index) {
+    constexpr std::size_t column = decltype(index)::value;
+    auto get = [&rows](std::size_t i) -> decltype(auto) {
+      return get_column_member<column>(rows[i]);
+    };
+    uint64_t prev = 0;
+    if constexpr (column == 0) {
+      constexpr std::size_t block = columnar_block_size<T>;
+      for (std::size_t i = 0; i < n && !ec; i += block) {
+        std::size_t end = (std::min)(n, i + block);
+        rows.resize(end);
+        ec = read_column<column_type<T, column>, encoding>(reader, i, end,
+                                                           prev, get);
+      }
+    }
+    else {
+      ec = read_column<column_type<T, column>, encoding>(reader, 0, n, prev,
+                                                         get);
+    }
+    return !ec;
+  };
+  (read_one(std::integral_constant<std::size_t, I>{}) && ...);
+  return ec;
+}
+
+template <typename Reader>
+struct_pack::err_code read_row_count(Reader &reader, std::size_t &n) {
+  uint64_t size = 0;
+  if (auto ec = struct_pack::read(reader, size); ec) {
+    return ec;
+  }
+  if constexpr (sizeof(std::size_t) < sizeof(uint64_t)) {
+    if SP_UNLIKELY (size > SIZE_MAX) {
+      return struct_pack::errc::invalid_buffer;
+    }
+  }
+  n = static_cast<std::size_t>(size);
+  return {};
+}
+}  // namespace detail
+
+/*
+ * The columns of the structs T, column<I>() is the vector of the I-th member.
+ */
+template <typename T, column_encoding encoding = column_encoding::plain>
+class soa {
+  static_assert(detail::column_count<T> > 0,
+                "The row type of soa should have members.");
+  using columns_type =
+      typename detail::soa_columns_impl<detail::column_types<T>>::type;
+
+ public:
+  using value_type = T;
+
+  soa() = default;
+  template <typename Container>
+  explicit soa(const Container &rows) {
+    reserve(rows.size());
+    for (const auto &row : rows) {
+      push_back(row);
+    }
+  }
+
+  std::size_t size() const noexcept { return std::get<0>(columns_).size(); }
+  bool empty() const noexcept { return size() == 0; }
+
+  template <std::size_t I>
+  auto &column() noexcept {
+    return std::get<I>(columns_);
+  }
+  template <std::size_t I>
+  const auto &column() const noexcept {
+    return std::get<I>(columns_);
+  }
+
+  void reserve(std::size_t n) {
+    std::apply(
+        [n](auto &...columns) {
+          (columns.reserve(n), ...);
+        },
+        columns_);
+  }
+  void clear() noexcept {
+    std::apply(
+        [](auto &...columns) {
+          (columns.clear(), ...);
+        },
+        columns_);
+  }
+
+  void push_back(const T &row) {
+    push_back(row, std::make_index_sequence<detail::column_count<T>>{});
+  }
+
+  // assemble the i-th row.
+  T operator[](std::size_t i) const {
+    return get_row(i, std::make_index_sequence<detail::column_count<T>>{});
+  }
+
+  bool operator==(const soa &o) const { return columns_ == o.columns_; }
+  bool operator!=(const soa &o) const { return !(*this == o); }
+
+ private:
+  template <std::size_t... I>
+  void push_back(const T &row, std::index_sequence<I...>) {
+    (std::get<I>(columns_).push_back(
+         detail::get_column_member<I>(row)),
+     ...);
+  }
+  template <std::size_t... I>
+  T get_row(std::size_t i, std::index_sequence<I...>) const {
+    T row{};
+    detail::visit_members(row, [&](auto &...members) {
+      auto refs = std::tie(members...);
+      ((std::get<I>(refs) = std::get<I>(columns_)[i]), ...);
+    });
+    return row;
+  }
+
+  template <std::size_t I, typename Writer>
+  void write_column(Writer &writer) const {
+    using M = detail::column_type<T, I>;
+    auto &vec = std::get<I>(columns_);
+    if constexpr (!detail::is_delta_column_v<M, encoding> &&
+                  !std::is_same_v<M, bool> &&
+                  detail::is_trivial_serializable<M>::value) {
+      struct_pack::write(writer, vec.data(), vec.size());
+    }
+    else {
+      detail::write_column<M, encoding>(
+          writer, vec.size(), [&vec](std::size_t i) -> decltype(auto) {
+            return vec[i];
+          });
+    }
+  }
+  template <typename Writer, std::size_t... I>
+  void write_columns(Writer &writer, std::index_sequence<I...>) const {
+    (write_column<I>(writer), ...);
+  }
+  template <std::size_t... I>
+  std::size_t get_columns_size(std::index_sequence<I...>) const {
+    return (detail::get_column_size<detail::column_type<T, I>, encoding>(
+                size(),
+                [this](std::size_t i) -> decltype(auto) {
+                  return std::get<I>(columns_)[i];
+                }) +
+            ...);
+  }
+  template <typename Reader, std::size_t... I>
+  struct_pack::err_code read_columns(Reader &reader, std::size_t n,
+                                     std::index_sequence<I...>) {
+    clear();
+    struct_pack::err_code ec{};
+    auto read_one = [&](auto index) {
+      constexpr std::size_t column = decltype(index)::value;
+      using M = detail::column_type<T, column>;
+      auto &vec = std::get<column>(columns_);
+      auto get = [&vec](std::size_t i) -> decltype(auto) {
+        return vec[i];
+      };
+      // the first column is allocated by blocks, the others are sized after
+      // it's read.
+      std::size_t block = column == 0 ? detail::columnar_block_size<M> : n;
+      uint64_t prev = 0;
+      for (std::size_t i = 0; i < n && !ec; i += block) {
+        std::size_t end = (std::min)(n, i + block);
+        vec.resize(end);
+        if constexpr (!detail::is_delta_column_v<M, encoding> &&
+                      !std::is_same_v<M, bool> &&
+                      detail::is_trivial_serializable<M>::value) {
+          ec = struct_pack::read(reader, vec.data() + i, end - i);
+        }
+        else {
+          ec = detail::read_column<M, encoding>(reader, i, end, prev, get);
+        }
+      }
+      return !ec;
+    };
+    (read_one(std::integral_constant<std::size_t, I>{}) && ...);
+    return ec;
+  }
+
+  template <typename Writer, typename U, column_encoding e>
+  friend void sp_serialize_to(Writer &writer, const soa<U, e> &columns);
+  template <typename U, column_encoding e>
+  friend std::size_t sp_get_needed_size(const soa<U, e> &columns);
+  template <typename Reader, typename U, column_encoding e>
+  friend struct_pack::err_code sp_deserialize_to(Reader &reader,
+                                                 soa<U, e> &columns);
+
+  columns_type columns_;
+};
+
+template <typename Container, column_encoding encoding>
+constexpr std::string_view sp_set_type_name(columnar<Container, encoding> *) {
+  constexpr auto &name =
+      detail::columnar_type_name<typename Container::value_type, encoding>;
+  return {name.data(), name.size()};
+}
+
+template <typename Container, column_encoding encoding>
+std::size_t sp_get_needed_size(const columnar<Container, encoding> &rows) {
+  using T = typename Container::value_type;
+  return sizeof(uint64_t) +
+         detail::get_row_columns_size<T, encoding>(
+             rows, std::make_index_sequence<detail::column_count<T>>{});
+}
+
+template <typename Writer, typename Container, column_encoding encoding>
+void sp_serialize_to(Writer &writer,
+                     const columnar<Container, encoding> &rows) {
+  using T = typename Container::value_type;
+  struct_pack::write(writer, static_cast<uint64_t>(rows.size()));
+  detail::write_row_columns<T, encoding>(
+      writer, rows, std::make_index_sequence<detail::column_count<T>>{});
+}
+
+template <typename Reader, typename Container, column_encoding encoding>
+struct_pack::err_code sp_deserialize_to(Reader &reader,
+                                        columnar<Container, encoding> &rows) {
+  using T = typename Container::value_type;
+  std::size_t n = 0;
+  if (auto ec = detail::read_row_count(reader, n); ec) {
+    return ec;
+  }
+  rows.clear();
+  return detail::read_row_columns<T, encoding>(
+      reader, rows, n, std::make_index_sequence<detail::column_count<T>>{});
+}
+
+template <typename Reader, typename Container, column_encoding encoding>
+struct_pack::err_code sp_deserialize_to_with_skip(
+    Reader &reader, columnar<Container, encoding> &) {
+  columnar<Container, encoding> ignored;
+  return sp_deserialize_to(reader, ignored);
+}
+
+template <typename T, column_encoding encoding>
+constexpr std::string_view sp_set_type_name(soa<T, encoding> *) {
+  constexpr auto &name = detail::columnar_type_name<T, encoding>;
+  return {name.data(), name.size()};
+}
+
+template <typename T, column_encoding encoding>
+std::size_t sp_get_needed_size(const soa<T, encoding> &columns) {
+  return sizeof(uint64_t) +
+         columns.get_columns_size(
+             std::make_index_sequence<detail::column_count<T>>{});
+}
+
+template <typename Writer, typename T, column_encoding encoding>
+void sp_serialize_to(Writer &writer, const soa<T, encoding> &columns) {
+  struct_pack::write(writer, static_cast<uint64_t>(columns.size()));
+  columns.write_columns(writer,
+                        std::make_index_sequence<detail::column_count<T>>{});
+}
+
+template <typename Reader, typename T, column_encoding encoding>
+struct_pack::err_code sp_deserialize_to(Reader &reader,
+                                        soa<T, encoding> &columns) {
+  std::size_t n = 0;
+  if (auto ec = detail::read_row_count(reader, n); ec) {
+    return ec;
+  }
+  return columns.read_columns(
+      reader, n, std::make_index_sequence<detail::column_count<T>>{});
+}
+
+template <typename Reader, typename T, column_encoding encoding>
+struct_pack::err_code sp_deserialize_to_with_skip(Reader &reader,
+                                                  soa<T, encoding> &) {
+  soa<T, encoding> ignored;
+  return sp_deserialize_to(reader, ignored);
+}
+}  // namespace struct_pack
@@ -0,0 +1,297 @@
+/*
+ * Copyright (c) 2023, Alibaba Group Holding Limited;
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#endif
+
+namespace struct_pack {
+
+/*!
+ * \ingroup struct_pack
+ * The expected access pattern of a mapped_file, see mapped_file::advise.
+ */
+enum class access_hint {
+  normal,
+  sequential,  // read ahead aggressively, e.g. deserialize the whole file.
+  random,      // no read ahead, e.g. struct_pack::view over a lookup table.
+  will_need,   // load the pages in background now.
+};
+
+/*!
+ * \ingroup struct_pack
+ * \class mapped_file
+ * \brief
+ * A read-only memory mapping of a file, which could be deserialized without
+ * reading the file into memory first:
+ *
+ * ```cpp
+ * struct_pack::mapped_file file;
+ * if (auto ec = file.open("table.dat"); ec) { ... }
+ * file.advise(struct_pack::access_hint::random);
+ * auto table = struct_pack::get_view<lookup_table>(file);
+ * auto result = struct_pack::deserialize<snapshot>(file);
+ * ```
+ *
+ * The string_view, span and trivial_view fields of the deserialized object
+ * point into the mapping, so they are valid until the file is closed. The
+ * offset of the mapped range needn't be aligned, the mapping starts from the
+ * page which contains it.
+ */
+class mapped_file {
+ public:
+  static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+
+  mapped_file() = default;
+  mapped_file(const mapped_file &) = delete;
+  mapped_file &operator=(const mapped_file &) = delete;
+  mapped_file(mapped_file &&other) noexcept { swap(other); }
+  mapped_file &operator=(mapped_file &&other) noexcept {
+    if (this != &other) {
+      close();
+      swap(other);
+    }
+    return *this;
+  }
+  ~mapped_file() { close(); }
+
+  /*!
+   * Map [offset, offset + length) of the file, length is truncated to the end
+   * of the file.
+   */
+  std::error_code open(const std::string &path, std::size_t offset = 0,
+                       std::size_t length = npos) {
+    close();
+    std::size_t file_size = 0;
+    if (auto ec = open_file(path, file_size); ec) {
+      return ec;
+    }
+    if (offset > file_size) {
+      close();
+      return std::make_error_code(std::errc::invalid_argument);
+    }
+    length = (std::min)(length, file_size - offset);
+    if (length == 0) {
+      // an empty range can't be mapped.
+      return {};
+    }
+    std::size_t aligned_offset = offset - offset % allocation_granularity();
+    map_size_ = length + (offset - aligned_offset);
+    if (auto ec = map(aligned_offset); ec) {
+      close();
+      return ec;
+    }
+    data_ = map_base_ + (offset - aligned_offset);
+    size_ = length;
+    return {};
+  }
+
+  /*!
+   * Tell the OS how the range [offset, offset + length) of the mapping will be
+   * accessed. It's only a hint, false is returned if it's not supported.
+   */
+  bool advise(access_hint hint, std::size_t offset = 0,
+              std::size_t length = npos) const noexcept {
+    if (map_base_ == nullptr || offset >= size_) {
+      return false;
+    }
+    length = (std::min)(length, size_ - offset);
+#ifdef _WIN32
+#if _WIN32_WINNT >= 0x0602
+    if (hint == access_hint::will_need) {
+      WIN32_MEMORY_RANGE_ENTRY range{(PVOID)(data_ + offset), length};
+      return PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+    }
+#endif
+    return false;
+#else
+    int advice = MADV_NORMAL;
+    switch (hint) {
+      case access_hint::sequential:
+        advice = MADV_SEQUENTIAL;
+        break;
+      case access_hint::random:
+        advice = MADV_RANDOM;
+        break;
+      case access_hint::will_need:
+        advice = MADV_WILLNEED;
+        break;
+      default:
+        break;
+    }
+    // madvise requires the address aligned to the page.
+    const char *begin = data_ + offset;
+    const char *aligned_begin =
+        begin - (std::size_t)(begin - map_base_) % allocation_granularity();
+    return ::madvise((void *)aligned_begin, length + (begin - aligned_begin),
+                     advice) == 0;
+#endif
+  }
+
+  void close() noexcept {
+#ifdef _WIN32
+    if (map_base_ != nullptr) {
+      UnmapViewOfFile(map_base_);
+    }
+    if (mapping_ != nullptr) {
+      CloseHandle(mapping_);
+    }
+    if (file_ != INVALID_HANDLE_VALUE) {
+      CloseHandle(file_);
+    }
+    mapping_ = nullptr;
+    file_ = INVALID_HANDLE_VALUE;
+#else
+    if (map_base_ != nullptr) {
+      ::munmap((void *)map_base_, map_size_);
+    }
+    if (fd_ >= 0) {
+      ::close(fd_);
+    }
+    fd_ = -1;
+#endif
+    map_base_ = nullptr;
+    map_size_ = 0;
+    data_ = nullptr;
+    size_ = 0;
+  }
+
+  bool is_open() const noexcept {
+#ifdef _WIN32
+    return file_ != INVALID_HANDLE_VALUE;
+#else
+    return fd_ >= 0;
+#endif
+  }
+  const char *data() const noexcept { return data_; }
+  std::size_t size() const noexcept { return size_; }
+
+  // The offset of the mapping must be a multiple of it.
+  static std::size_t allocation_granularity() noexcept {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwAllocationGranularity;
+#else
+    static const std::size_t page_size = ::sysconf(_SC_PAGESIZE);
+    return page_size;
+#endif
+  }
+
+ private:
+  static std::error_code last_error() noexcept {
+#ifdef _WIN32
+    return std::error_code((int)GetLastError(), std::system_category());
+#else
+    return std::error_code(errno, std::system_category());
+#endif
+  }
+
+  std::error_code open_file(const std::string &path, std::size_t &file_size) {
+#ifdef _WIN32
+    file_ = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file_ == INVALID_HANDLE_VALUE) {
+      return last_error();
+    }
+    LARGE_INTEGER sz;
+    if (!GetFileSizeEx(file_, &sz)) {
+      auto ec = last_error();
+      close();
+      return ec;
+    }
+    file_size = (std::size_t)sz.QuadPart;
+#else
+    fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd_ < 0) {
+      return last_error();
+    }
+    struct stat st;
+    if (::fstat(fd_, &st) != 0) {
+      auto ec = last_error();
+      close();
+      return ec;
+    }
+    file_size = (std::size_t)st.st_size;
+#endif
+    return {};
+  }
+
+  std::error_code map(std::size_t aligned_offset) {
+#ifdef _WIN32
+    mapping_ = CreateFileMappingA(file_, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping_ == nullptr) {
+      return last_error();
+    }
+    map_base_ = (const char *)MapViewOfFile(
+        mapping_, FILE_MAP_READ, (DWORD)((uint64_t)aligned_offset >> 32),
+        (DWORD)(aligned_offset & 0xFFFFFFFF), map_size_);
+    if (map_base_ == nullptr) {
+      return last_error();
+    }
+#else
+    void *addr = ::mmap(nullptr, map_size_, PROT_READ, MAP_PRIVATE, fd_,
+                        (off_t)aligned_offset);
+    if (addr == MAP_FAILED) {
+      return last_error();
+    }
+    map_base_ = (const char *)addr;
+#endif
+    return {};
+  }
+
+  void swap(mapped_file &other) noexcept {
+#ifdef _WIN32
+    std::swap(file_, other.file_);
+    std::swap(mapping_, other.mapping_);
+#else
+    std::swap(fd_, other.fd_);
+#endif
+    std::swap(map_base_, other.map_base_);
+    std::swap(map_size_, other.map_size_);
+    std::swap(data_, other.data_);
+    std::swap(size_, other.size_);
+  }
+
+#ifdef _WIN32
+  HANDLE file_ = INVALID_HANDLE_VALUE;
+  HANDLE mapping_ = nullptr;
+#else
+  int fd_ = -1;
+#endif
+  const char *map_base_ = nullptr;
+  std::size_t map_size_ = 0;
+  const char *data_ = nullptr;
+  std::size_t size_ = 0;
+};
+}  // namespace struct_pack
@@ -0,0 +1,119 @@
+/*
+ * Copyright (c) 2023, Alibaba Group Holding Limited;
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <variant>
+
+#include "endian_wrapper.hpp"
+#include "marco.h"
+#include "reflection.hpp"
+
+// A struct which isn't trivially serializable, e.g. PODs with a std::string,
+// is serialized member by member. But the adjacent trivially serializable
+// members are written without padding in both memory and the buffer, so a run
+// of them could be copied by one memcpy.
+namespace struct_pack::detail {
+
+template <typename T, uint64_t parent_tag>
+constexpr bool is_memcpy_member_v =
+    !std::is_same_v<T, std::monostate> &&
+    is_trivial_serializable<T, false, parent_tag>::value &&
+    is_little_endian_copyable<sizeof(T)>;
+
+/*
+ * runs[i] is the count of members which are copied together from the i-th
+ * member, it's 0 if the i-th member is copied by the previous run. The layout
+ * is predicted by sizeof/alignof and the pack alignment of the struct, it's
+ * checked again by the address of the members when copying.
+ */
+template <typename P, uint64_t parent_tag, typename... Args>
+constexpr auto get_memcpy_runs() {
+  constexpr std::size_t n = sizeof...(Args);
+  std::array<std::size_t, n> runs{};
+#ifdef STRUCT_PACK_DISABLE_MEMCPY_RUN
+  for (auto &e : runs) {
+    e = 1;
+  }
+#else
+  constexpr std::array<bool, n> memcpy_able{
+      is_memcpy_member_v<Args, parent_tag>...};
+  constexpr std::array<std::size_t, n> sizes{sizeof(Args)...};
+  std::array<std::size_t, n> aligns{alignof(Args)...};
+  std::array<std::size_t, n> offsets{};
+  std::size_t offset = 0;
+  for (std::size_t i = 0; i < n; ++i) {
+    if constexpr (struct_pack::pack_alignment_v<P> != 0) {
+      aligns[i] = (std::min)(aligns[i], struct_pack::pack_alignment_v<P>);
+    }
+    offset = (offset + aligns[i] - 1) / aligns[i] * aligns[i];
+    offsets[i] = offset;
+    offset += sizes[i];
+  }
+  for (std::size_t i = 0; i < n;) {
+    std::size_t j = i + 1;
+    if (memcpy_able[i]) {
+      while (j < n && memcpy_able[j] &&
+             offsets[j] == offsets[j - 1] + sizes[j - 1]) {
+        ++j;
+      }
+    }
+    runs[i] = j - i;
+    i = j;
+  }
+#endif
+  return runs;
+}
+
+template <typename P, uint64_t parent_tag, typename... Args>
+constexpr auto memcpy_runs = get_memcpy_runs<P, parent_tag, Args...>();
+
+template <typename P, uint64_t parent_tag, typename... Args>
+constexpr bool has_memcpy_run() {
+  for (auto e : memcpy_runs<P, parent_tag, Args...>) {
+    if (e > 1) {
+      return true;
+    }
+  }
+  return false;
+}
+
+template <std::size_t begin, std::size_t len, typename... Args>
+constexpr std::size_t memcpy_run_size() {
+  constexpr std::array<std::size_t, sizeof...(Args)> sizes{sizeof(Args)...};
+  std::size_t ret = 0;
+  for (std::size_t i = begin; i < begin + len; ++i) {
+    ret += sizes[i];
+  }
+  return ret;
+}
+
+// The members of the run are laid out without padding, it's constant folded
+// when the function is inlined.
+template <std::size_t begin, std::size_t... I, typename Tuple>
+STRUCT_PACK_INLINE bool is_memcpy_run_continuous(const Tuple &refs,
+                                                 std::index_sequence<I...>) {
+  return (((const char *)std::addressof(std::get<begin + I>(refs)) +
+               sizeof(std::get<begin + I>(refs)) ==
+           (const char *)std::addressof(std::get<begin + I + 1>(refs))) &&
+          ...);
+}
+}  // namespace struct_pack::detail
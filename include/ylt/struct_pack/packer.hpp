@@ -14,18 +14,40 @@
  * limitations under the License.
  */
 #pragma once
+#include <algorithm>
 #include <bitset>
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <type_traits>
 
 #include "calculate_size.hpp"
 #include "endian_wrapper.hpp"
+#include "memcpy_run.hpp"
 #include "reflection.hpp"
 #include "ylt/struct_pack/type_id.hpp"
 #include "ylt/struct_pack/util.h"
 #include "ylt/struct_pack/varint.hpp"
 namespace struct_pack::detail {
+
+// A writer which records the size of containers, the packer reports them
+// before writing the length.
+#if __cpp_concepts >= 201907L
+template <typename T>
+concept size_recorder_t = requires(T t) { t.record_size(std::size_t{}); };
+#else
+template <typename T, typename = void>
+struct size_recorder_t_impl : std::false_type {};
+
+template <typename T>
+struct size_recorder_t_impl<
+    T, std::void_t<decltype(std::declval<T>().record_size(std::size_t{}))>>
+    : std::true_type {};
+
+template <typename T>
+constexpr bool size_recorder_t = size_recorder_t_impl<T>::value;
+#endif
+
 template <
 #if __cpp_concepts >= 201907L
     writer_t writer,
@@ -143,6 +165,57 @@ class packer {
   constexpr void STRUCT_PACK_INLINE serialize_many(const Args &...items) {
     (serialize_one<size_type, version, parent_tag>(items), ...);
   }
+  // Serialize the members of a struct, the runs of adjacent trivially
+  // serializable members are written by one memcpy.
+  template <std::size_t size_type, uint64_t version, uint64_t parent_tag,
+            typename P, typename... Args>
+  constexpr void STRUCT_PACK_INLINE serialize_members(const Args &...items) {
+    if constexpr (has_memcpy_run<P, parent_tag, Args...>()) {
+      serialize_member_runs<size_type, version, parent_tag, P, Args...>(
+          std::tie(items...), std::make_index_sequence<sizeof...(Args)>{});
+    }
+    else {
+      serialize_many<size_type, version, parent_tag>(items...);
+    }
+  }
+
+  template <std::size_t size_type, uint64_t version, uint64_t parent_tag,
+            typename P, typename... Args, std::size_t... I>
+  constexpr void STRUCT_PACK_INLINE serialize_member_runs(
+      const std::tuple<const Args &...> &refs, std::index_sequence<I...>) {
+    (serialize_member_run<size_type, version, parent_tag, P, I, Args...>(refs),
+     ...);
+  }
+
+  template <std::size_t size_type, uint64_t version, uint64_t parent_tag,
+            typename P, std::size_t begin, typename... Args>
+  constexpr void STRUCT_PACK_INLINE
+  serialize_member_run(const std::tuple<const Args &...> &refs) {
+    constexpr auto len = memcpy_runs<P, parent_tag, Args...>[begin];
+    if constexpr (len == 1) {
+      serialize_one<size_type, version, parent_tag>(std::get<begin>(refs));
+    }
+    else if constexpr (len > 1) {
+      if SP_LIKELY (is_memcpy_run_continuous<begin>(
+                        refs, std::make_index_sequence<len - 1>{})) {
+        write_bytes_array(writer_, (const char *)&std::get<begin>(refs),
+                          memcpy_run_size<begin, len, Args...>());
+      }
+      else {
+        serialize_member_run_one_by_one<size_type, version, parent_tag, begin>(
+            refs, std::make_index_sequence<len>{});
+      }
+    }
+  }
+
+  template <std::size_t size_type, uint64_t version, uint64_t parent_tag,
+            std::size_t begin, typename Tuple, std::size_t... I>
+  constexpr void STRUCT_PACK_INLINE serialize_member_run_one_by_one(
+      const Tuple &refs, std::index_sequence<I...>) {
+    (serialize_one<size_type, version, parent_tag>(std::get<begin + I>(refs)),
+     ...);
+  }
+
   constexpr void STRUCT_PACK_INLINE write_padding(std::size_t sz) {
     if (sz > 0) {
       constexpr char buf = 0;
@@ -303,6 +376,9 @@ class packer {
       }
       else if constexpr (map_container<type> || container<type>) {
         auto size = item.size();
+        if constexpr (size_recorder_t<writer>) {
+          writer_.record_size(size);
+        }
 
         if constexpr (size_type == 1) {
           low_bytes_write_wrapper<size_type>(writer_, size);
@@ -361,6 +437,10 @@ class packer {
                             item.size() * sizeof(typename type::value_type));
           return;
         }
+        else if constexpr (continuous_container<type> &&
+                           varint_t<typename type::value_type>) {
+          detail::serialize_varints(writer_, item.data(), item.size());
+        }
         else {
           for (const auto &i : item) {
             serialize_one<size_type, version>(i);
@@ -442,7 +522,7 @@ class packer {
           visit_members(item, [this](auto &&...items) CONSTEXPR_INLINE_LAMBDA {
             constexpr uint64_t tag =
                 get_parent_tag<type>();  // to pass msvc with c++17
-            this->serialize_many<size_type, version, tag>(items...);
+            this->serialize_members<size_type, version, tag, type>(items...);
           });
         }
       }
@@ -583,4 +663,53 @@ STRUCT_PACK_MAY_INLINE void serialize_to(Writer &writer,
     };
   }
 }
+
+// Write to the end of a struct_pack buffer, the buffer grows on demand.
+template <typename Buffer>
+struct growable_writer {
+  Buffer &buffer;
+  std::size_t pos;
+  std::size_t max_size = 0;
+  STRUCT_PACK_INLINE void write(const char *data, std::size_t len) {
+    if SP_UNLIKELY (pos + len > buffer.size()) {
+      detail::resize(buffer,
+                     (std::max)({pos + len, buffer.size() * 2, std::size_t{64}}));
+    }
+    memcpy((char *)buffer.data() + pos, data, len);
+    pos += len;
+  }
+  STRUCT_PACK_INLINE void record_size(std::size_t size) {
+    max_size = (std::max)(max_size, size);
+  }
+};
+
+// The width of the container length is guessed as 1 byte, the objects are
+// serialized again only if a container is too large for it.
+template <uint64_t conf, typename Buffer, typename... Args>
+void serialize_to_one_pass(Buffer &buffer, const Args &...args) {
+  auto offset = buffer.size();
+  if constexpr (serialize_static_config<
+                    get_args_type<Args...>>::has_compatible) {
+    // the total length is written before the objects.
+    auto info = get_serialize_runtime_info<conf>(args...);
+    detail::resize(buffer, offset + info.size());
+    memory_writer writer{(char *)buffer.data() + offset};
+    detail::serialize_to<conf>(writer, info, args...);
+  }
+  else {
+    size_info guess{0, 0, 0};
+    while (true) {
+      auto info = get_serialize_runtime_info_by_payload<conf, Args...>(guess);
+      growable_writer<Buffer> writer{buffer, offset};
+      detail::serialize_to<conf>(writer, info, args...);
+      guess.max_size = writer.max_size;
+      if SP_LIKELY ((get_serialize_runtime_info_by_payload<conf, Args...>(
+                         guess)
+                         .metainfo() == info.metainfo())) {
+        detail::resize(buffer, writer.pos);
+        return;
+      }
+    }
+  }
+}
 }  // namespace struct_pack::detail
\ No newline at end of file
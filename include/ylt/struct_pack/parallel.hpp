@@ -0,0 +1,380 @@
+/*
+ * Copyright (c) 2023, Alibaba Group Holding Limited;
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "calculate_size.hpp"
+#include "endian_wrapper.hpp"
+#include "error_code.hpp"
+#include "packer.hpp"
+#include "reflection.hpp"
+#include "unpacker.hpp"
+
+// Serialize/deserialize a large container, e.g. std::vector<big_struct>, with
+// the threads of an executor, such as coro_io::get_global_block_executor(). The
+// data format is the same as struct_pack::serialize, so the buffer can be read
+// by the single thread deserialize and vice versa. It's not included by
+// ylt/struct_pack.hpp, since it brings in the threading headers.
+namespace struct_pack {
+
+#ifndef STRUCT_PACK_PARALLEL_MIN_CHUNK_SIZE
+// The minimum count of elements handled by one thread.
+#define STRUCT_PACK_PARALLEL_MIN_CHUNK_SIZE 1024
+#endif
+
+namespace detail {
+
+// The elements of these containers are serialized one after another.
+template <typename T>
+constexpr bool parallel_container() {
+  using U = remove_cvref_t<T>;
+  if constexpr (continuous_container<U> && !string<U> && !span<U>) {
+    return !trivially_copyable_container<U> &&
+           !serialize_static_config<U>::has_compatible;
+  }
+  else {
+    return false;
+  }
+}
+
+inline std::size_t parallel_chunk_count(std::size_t size,
+                                        std::size_t thread_num) {
+  if (thread_num == 0) {
+    thread_num = (std::max)(std::thread::hardware_concurrency(), 1u);
+  }
+  std::size_t max_chunks = (size + STRUCT_PACK_PARALLEL_MIN_CHUNK_SIZE - 1) /
+                           STRUCT_PACK_PARALLEL_MIN_CHUNK_SIZE;
+  return (std::max<std::size_t>)((std::min)(thread_num, max_chunks), 1);
+}
+
+// Run f(0) ... f(n-1) in the executor, which has
+// `bool schedule(std::function<void()>)` like async_simple::Executor. The
+// caller thread runs the calls not yet started by the executor too, so it
+// doesn't deadlock when called in a thread of the executor. The first
+// exception is rethrown after all of them finished.
+template <typename Executor, typename F>
+void parallel_for(Executor *executor, std::size_t n, F &&f) {
+  struct state_t {
+    std::atomic<std::size_t> next{0};
+    std::size_t done = 0;
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::vector<std::exception_ptr> errors;
+  };
+  // the scheduled tasks may start after this returns, they hold the state
+  // but only touch f after claiming a call, which is waited for.
+  auto state = std::make_shared<state_t>();
+  state->errors.resize(n);
+  auto run = [state, n, func = &f] {
+    for (std::size_t i; (i = state->next.fetch_add(1)) < n;) {
+      try {
+        (*func)(i);
+      } catch (...) {
+        state->errors[i] = std::current_exception();
+      }
+      std::lock_guard lock(state->mtx);
+      if (++state->done == n) {
+        state->cv.notify_one();
+      }
+    }
+  };
+  for (std::size_t i = 0; i + 1 < n; ++i) {
+    executor->schedule(run);
+  }
+  run();
+  {
+    std::unique_lock lock(state->mtx);
+    state->cv.wait(lock, [&] {
+      return state->done == n;
+    });
+  }
+  for (auto &error : state->errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+}
+
+inline std::size_t chunk_begin(std::size_t size, std::size_t chunks,
+                               std::size_t i) {
+  return size / chunks * i + (std::min)(i, size % chunks);
+}
+
+template <typename Writer>
+void write_container_length(Writer &writer, unsigned char metainfo,
+                            std::size_t size) {
+  switch ((metainfo & 0b11000) >> 3) {
+    case 0:
+      low_bytes_write_wrapper<1>(writer, size);
+      break;
+    case 1:
+      low_bytes_write_wrapper<2>(writer, size);
+      break;
+    case 2:
+      low_bytes_write_wrapper<4>(writer, size);
+      break;
+    case 3:
+      if constexpr (sizeof(std::size_t) >= 8) {
+        low_bytes_write_wrapper<8>(writer, size);
+      }
+      else {
+        unreachable();
+      }
+      break;
+    default:
+      unreachable();
+  }
+}
+
+template <typename Reader>
+bool read_container_length(Reader &reader, unsigned char size_type,
+                           std::size_t &size) {
+  size = 0;
+  switch (size_type) {
+    case 0:
+      return low_bytes_read_wrapper<1>(reader, size);
+    case 1:
+      return low_bytes_read_wrapper<2>(reader, size);
+    case 2:
+      return low_bytes_read_wrapper<4>(reader, size);
+    case 3:
+      if constexpr (sizeof(std::size_t) >= 8) {
+        return low_bytes_read_wrapper<8>(reader, size);
+      }
+      else {
+        return false;
+      }
+    default:
+      unreachable();
+  }
+}
+}  // namespace detail
+
+/*!
+ * \ingroup struct_pack
+ * Serialize a large container in `thread_num` chunks(0 means
+ * std::thread::hardware_concurrency()) run by the executor and the caller
+ * thread, and append it to the buffer. The size of every element is
+ * calculated in parallel first, then each chunk is written into its own range
+ * of the buffer. The result is the same as
+ * `struct_pack::serialize_to(buffer, container)`.
+ *
+ * ```cpp
+ * struct_pack::serialize_to_parallel(buffer, records,
+ *                                    coro_io::get_global_block_executor());
+ * ```
+ *
+ * The executor is any type with `bool schedule(std::function<void()>)`, such
+ * as async_simple::Executor. The container must be a std::vector like
+ * container of the non trivially copyable elements(e.g. structs with
+ * strings), and the elements can't have compatible fields. A small container
+ * is serialized by the caller thread. The exception thrown while serializing
+ * is rethrown in the caller thread.
+ */
+template <uint64_t conf = sp_config::DEFAULT,
+#if __cpp_concepts >= 201907L
+          detail::struct_pack_buffer Buffer,
+#else
+          typename Buffer,
+#endif
+          typename Container, typename Executor>
+void serialize_to_parallel(Buffer &buffer, const Container &container,
+                           Executor *executor, std::size_t thread_num = 0) {
+  static_assert(detail::parallel_container<Container>(),
+                "serialize_to_parallel only supports a std::vector like "
+                "container of the non trivially copyable elements without "
+                "compatible fields.");
+  auto chunks = detail::parallel_chunk_count(container.size(), thread_num);
+  auto data_offset = buffer.size();
+  if (chunks == 1) {
+    auto info = detail::get_serialize_runtime_info<conf>(container);
+    detail::resize(buffer, data_offset + info.size());
+    detail::memory_writer writer{(char *)buffer.data() + data_offset};
+    return detail::serialize_to<conf>(writer, info, container);
+  }
+
+  // 1. calculate the size of each chunk.
+  std::vector<detail::size_info> sizes(chunks);
+  detail::parallel_for(executor, chunks, [&](std::size_t i) {
+    auto end = detail::chunk_begin(container.size(), chunks, i + 1);
+    detail::size_info info{};
+    for (auto j = detail::chunk_begin(container.size(), chunks, i); j < end;
+         ++j) {
+      info += detail::calculate_one_size(container[j]);
+    }
+    sizes[i] = info;
+  });
+  detail::size_info payload{0, 1, container.size()};
+  for (auto &size : sizes) {
+    payload += size;
+  }
+  auto info =
+      detail::get_serialize_runtime_info_by_payload<conf, Container>(payload);
+  constexpr std::size_t size_type_bytes[] = {1, 2, 4, 8};
+  auto length_width = size_type_bytes[(info.metainfo() & 0b11000) >> 3];
+
+  // 2. write the metainfo and the length of container.
+  detail::resize(buffer, data_offset + info.size());
+  char *data = (char *)buffer.data() + data_offset;
+  detail::memory_writer writer{data};
+  detail::packer<detail::memory_writer, Container> head(writer, info);
+  if ((info.metainfo() & 0b11000) == 0) {
+    head.template serialize_metainfo<conf, true, Container>();
+  }
+  else {
+    head.template serialize_metainfo<conf, false, Container>();
+  }
+  detail::write_container_length(writer, info.metainfo(), container.size());
+
+  // 3. write the elements of each chunk from its offset.
+  std::vector<char *> offsets(chunks);
+  offsets[0] = writer.buffer;
+  for (std::size_t i = 1; i < chunks; ++i) {
+    offsets[i] = offsets[i - 1] + sizes[i - 1].total +
+                 sizes[i - 1].size_cnt * length_width;
+  }
+  assert(offsets[chunks - 1] + sizes[chunks - 1].total +
+             sizes[chunks - 1].size_cnt * length_width ==
+         data + info.size());
+  detail::parallel_for(executor, chunks, [&](std::size_t i) {
+    detail::memory_writer chunk_writer{offsets[i]};
+    detail::packer<detail::memory_writer, Container> o(chunk_writer, info);
+    auto begin = detail::chunk_begin(container.size(), chunks, i);
+    auto end = detail::chunk_begin(container.size(), chunks, i + 1);
+    [[maybe_unused]] auto ec = detail::dispatch_size_type(
+        (info.metainfo() & 0b11000) >> 3, [&](auto size_type) {
+          for (auto j = begin; j < end; ++j) {
+            o.template serialize_one<decltype(size_type)::value, UINT64_MAX>(
+                container[j]);
+          }
+          return struct_pack::err_code{};
+        });
+  });
+}
+
+/*!
+ * \ingroup struct_pack
+ * Deserialize a large container serialized by `serialize_to_parallel` or
+ * `serialize`, in `thread_num` chunks(0 means
+ * std::thread::hardware_concurrency()) run by the executor and the caller
+ * thread. The buffer is validated and split into chunks by skipping the
+ * elements, which is much cheaper than constructing them, then each chunk is
+ * deserialized in place.
+ */
+template <uint64_t conf = sp_config::DEFAULT, typename Container,
+          typename Executor>
+[[nodiscard]] struct_pack::err_code deserialize_to_parallel(
+    Container &container, const char *data, std::size_t size,
+    Executor *executor, std::size_t thread_num = 0) {
+  static_assert(detail::parallel_container<Container>(),
+                "deserialize_to_parallel only supports a std::vector like "
+                "container of the non trivially copyable elements without "
+                "compatible fields.");
+  using value_type = typename Container::value_type;
+  detail::memory_reader reader{data, data + size};
+  detail::unpacker<detail::memory_reader, conf> in(reader);
+  auto ec = in.template deserialize_metainfo<Container>().first;
+  if SP_UNLIKELY (ec) {
+    return ec;
+  }
+  auto size_type = in.size_type();
+  std::size_t length;
+  if SP_UNLIKELY (!detail::read_container_length(reader, size_type, length)) {
+    return struct_pack::errc::no_buffer_space;
+  }
+  auto chunks = detail::parallel_chunk_count(length, thread_num);
+  if (chunks == 1) {
+    detail::memory_reader whole_reader{data, data + size};
+    detail::unpacker<detail::memory_reader, conf> whole_in(whole_reader);
+    return whole_in.deserialize(container);
+  }
+
+  // find the offset of each chunk, the length isn't trusted before that.
+  std::vector<const char *> offsets(chunks + 1);
+  ec = detail::dispatch_size_type(size_type, [&](auto size_type) {
+    value_type skipped{};
+    for (std::size_t i = 0; i < chunks; ++i) {
+      offsets[i] = reader.now;
+      auto end = detail::chunk_begin(length, chunks, i + 1);
+      for (auto j = detail::chunk_begin(length, chunks, i); j < end; ++j) {
+        auto ec = in.template deserialize_one<decltype(size_type)::value,
+                                              UINT64_MAX, false>(skipped);
+        if SP_UNLIKELY (ec) {
+          return ec;
+        }
+      }
+    }
+    offsets[chunks] = reader.now;
+    return struct_pack::err_code{};
+  });
+  if SP_UNLIKELY (ec) {
+    return ec;
+  }
+
+  container.resize(length);
+  std::vector<struct_pack::err_code> errors(chunks);
+  detail::parallel_for(executor, chunks, [&](std::size_t i) {
+    detail::memory_reader chunk_reader{offsets[i], offsets[i + 1]};
+    detail::unpacker<detail::memory_reader, conf> chunk_in(chunk_reader);
+    chunk_in.set_size_type(size_type);
+    auto begin = detail::chunk_begin(length, chunks, i);
+    auto end = detail::chunk_begin(length, chunks, i + 1);
+    errors[i] = detail::dispatch_size_type(size_type, [&](auto size_type) {
+      for (auto j = begin; j < end; ++j) {
+        auto ec = chunk_in.template deserialize_one<
+            decltype(size_type)::value, UINT64_MAX, true>(container[j]);
+        if SP_UNLIKELY (ec) {
+          return ec;
+        }
+      }
+      return struct_pack::err_code{};
+    });
+  });
+  for (auto &error : errors) {
+    if SP_UNLIKELY (error) {
+      return error;
+    }
+  }
+  return {};
+}
+
+#if __cpp_concepts >= 201907L
+template <uint64_t conf = sp_config::DEFAULT, typename Container,
+          detail::deserialize_view View, typename Executor>
+#else
+template <
+    uint64_t conf = sp_config::DEFAULT, typename Container, typename View,
+    typename Executor,
+    typename = std::enable_if_t<struct_pack::detail::deserialize_view<View>>>
+#endif
+[[nodiscard]] struct_pack::err_code deserialize_to_parallel(
+    Container &container, const View &v, Executor *executor,
+    std::size_t thread_num = 0) {
+  return deserialize_to_parallel<conf>(container, (const char *)v.data(),
+                                       v.size(), executor, thread_num);
+}
+}  // namespace struct_pack
@@ -0,0 +1,335 @@
+/*
+ * Copyright (c) 2023, Alibaba Group Holding Limited;
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#include "calculate_size.hpp"
+#include "error_code.hpp"
+#include "packer.hpp"
+#include "reflection.hpp"
+#include "unpacker.hpp"
+#include "varint.hpp"
+
+// A record stream is an unbounded sequence of struct_pack objects, which is
+// written and read one record a time:
+//
+// stream := frame*
+// frame  := record | sync
+// record := 0x01 varint(length) struct_pack::serialize(item)
+// sync   := sync_marker(16 bytes, begins with 0xFE)
+//
+// The sync marker is written before the first record and every
+// `sync_interval` records, a reader can skip a corrupted range by searching
+// the next marker. Include ylt/struct_pack/record_stream.hpp to use it.
+namespace struct_pack {
+
+#ifndef STRUCT_PACK_MAX_RECORD_SIZE
+// The reader refuses the larger record, so its memory is bounded.
+#define STRUCT_PACK_MAX_RECORD_SIZE (64 * 1024 * 1024)
+#endif
+
+namespace detail {
+inline constexpr char record_tag = 0x01;
+inline constexpr char sync_marker[16] = {
+    '\xFE', 's',    'p',    '_',    's',    'y',    'n',    'c',
+    '\x9C', '\x4B', '\x1F', '\x83', '\x2D', '\xE7', '\x60', '\x5A'};
+
+// Find the next sync marker in [data, data + size), return npos if not found.
+inline std::size_t find_sync_marker(const char *data, std::size_t size) {
+  return std::string_view{data, size}.find(
+      std::string_view{sync_marker, sizeof(sync_marker)});
+}
+}  // namespace detail
+
+/*!
+ * \ingroup struct_pack
+ * Write records to a struct_pack writer(e.g. std::ofstream, or a buffer
+ * writer which is flushed to coro_io::coro_file or sent as a coro_rpc
+ * attachment) one by one, nothing is buffered by the record_writer.
+ */
+template <typename Writer, uint64_t conf = sp_config::DEFAULT>
+class record_writer {
+#if __cpp_concepts < 201907L
+  static_assert(writer_t<Writer>,
+                "The writer type must satisfy requirements!");
+#endif
+ public:
+  explicit record_writer(Writer &writer, std::size_t sync_interval = 1024)
+      : writer_(writer),
+        sync_interval_(sync_interval == 0 ? 1 : sync_interval) {}
+
+  template <typename T>
+  void write(const T &item) {
+    if (count_ % sync_interval_ == 0) {
+      write_sync_marker();
+    }
+    auto info = detail::get_serialize_runtime_info<conf>(item);
+    writer_.write(&detail::record_tag, 1);
+    detail::serialize_varint(writer_, uint64_t{info.size()});
+    detail::serialize_to<conf>(writer_, info, item);
+    ++count_;
+  }
+
+  void write_sync_marker() {
+    writer_.write(detail::sync_marker, sizeof(detail::sync_marker));
+  }
+
+  std::size_t count() const noexcept { return count_; }
+
+ private:
+  Writer &writer_;
+  std::size_t sync_interval_;
+  std::size_t count_ = 0;
+};
+
+/*!
+ * \ingroup struct_pack
+ * Read records from a struct_pack reader one by one, only one record is held
+ * in memory. The string_view fields of the record point into the internal
+ * buffer, they are invalidated by the next read.
+ */
+template <typename Reader, uint64_t conf = sp_config::DEFAULT>
+class record_reader {
+#if __cpp_concepts < 201907L
+  static_assert(reader_t<Reader>,
+                "The reader type must satisfy requirements!");
+#endif
+ public:
+  explicit record_reader(Reader &reader,
+                         std::size_t max_record_size =
+                             STRUCT_PACK_MAX_RECORD_SIZE)
+      : reader_(reader), max_record_size_(max_record_size) {}
+
+  /*!
+   * Read the next record. errc::no_buffer_space is returned at the end of the
+   * stream: eof() is true if it ended at the boundary of a frame, truncated()
+   * if it ended inside one. After errc::invalid_buffer, call resync() to skip
+   * to the next sync marker.
+   */
+  template <typename T>
+  [[nodiscard]] struct_pack::err_code read(T &item) {
+    while (true) {
+      char tag;
+      if (!reader_.read(&tag, 1)) {
+        eof_ = true;
+        return struct_pack::errc::no_buffer_space;
+      }
+      if (tag == detail::sync_marker[0]) {
+        char marker[sizeof(detail::sync_marker) - 1];
+        if (!reader_.read(marker, sizeof(marker))) {
+          truncated_ = true;
+          return struct_pack::errc::no_buffer_space;
+        }
+        if (memcmp(marker, detail::sync_marker + 1, sizeof(marker)) != 0) {
+          return struct_pack::errc::invalid_buffer;
+        }
+        continue;
+      }
+      if SP_UNLIKELY (tag != detail::record_tag) {
+        return struct_pack::errc::invalid_buffer;
+      }
+      uint64_t length = 0;
+      if (auto ec = detail::deserialize_varint(reader_, length); ec) {
+        truncated_ = (ec == struct_pack::errc::no_buffer_space);
+        return ec;
+      }
+      if SP_UNLIKELY (length > max_record_size_) {
+        return struct_pack::errc::invalid_buffer;
+      }
+      buffer_.resize(length);
+      if (!reader_.read(buffer_.data(), length)) {
+        truncated_ = true;
+        return struct_pack::errc::no_buffer_space;
+      }
+      detail::memory_reader reader{buffer_.data(),
+                                   buffer_.data() + buffer_.size()};
+      detail::unpacker<detail::memory_reader, conf> in(reader);
+      return in.deserialize(item);
+    }
+  }
+
+  /*!
+   * Skip to the next sync marker, false is returned if there is no more.
+   */
+  bool resync() {
+    std::size_t matched = 0;
+    char ch;
+    while (reader_.read(&ch, 1)) {
+      if (ch == detail::sync_marker[matched]) {
+        if (++matched == sizeof(detail::sync_marker)) {
+          return true;
+        }
+      }
+      else {
+        // the first byte of the marker doesn't appear in the rest of it.
+        matched = (ch == detail::sync_marker[0]) ? 1 : 0;
+      }
+    }
+    eof_ = true;
+    return false;
+  }
+
+  // The stream ended at the boundary of a frame.
+  bool eof() const noexcept { return eof_; }
+  // The stream ended inside a frame, the last record is incomplete.
+  bool truncated() const noexcept { return truncated_; }
+
+ private:
+  Reader &reader_;
+  std::size_t max_record_size_;
+  std::string buffer_;
+  bool eof_ = false;
+  bool truncated_ = false;
+};
+
+/*!
+ * \ingroup struct_pack
+ * Decode records from the chunks of a stream, which are read asynchronously,
+ * e.g. by coro_io::coro_file::async_read or received as coro_rpc attachments:
+ *
+ * ```cpp
+ * struct_pack::record_decoder decoder;
+ * char buf[64 * 1024];
+ * while (true) {
+ *   auto [ec, size] = co_await file.async_read(buf, sizeof(buf));
+ *   if (ec || size == 0) break;
+ *   decoder.feed(buf, size);
+ *   item_t item;
+ *   while (!decoder.next(item)) { handle(item); }
+ *   if (!decoder.need_more()) { ... }  // invalid data
+ * }
+ * ```
+ *
+ * Only the unfinished record is kept between the chunks. For a coro_file,
+ * async_read_records in ylt/struct_pack/async_record_stream.hpp does this.
+ */
+template <uint64_t conf = sp_config::DEFAULT>
+class record_decoder {
+ public:
+  explicit record_decoder(
+      std::size_t max_record_size = STRUCT_PACK_MAX_RECORD_SIZE)
+      : max_record_size_(max_record_size) {}
+
+  void feed(const char *data, std::size_t size) {
+    if (pos_ > 0 && pos_ >= buffer_.size() / 2) {
+      buffer_.erase(0, pos_);
+      pos_ = 0;
+    }
+    buffer_.append(data, size);
+  }
+  void feed(std::string_view data) { feed(data.data(), data.size()); }
+
+  /*!
+   * Decode the next record. errc::no_buffer_space is returned if more data
+   * should be fed, need_more() is true in that case. After
+   * errc::invalid_buffer, call resync() to skip to the next sync marker.
+   */
+  template <typename T>
+  [[nodiscard]] struct_pack::err_code next(T &item) {
+    need_more_ = false;
+    if (resyncing_ && !resync()) {
+      need_more_ = true;
+      return struct_pack::errc::no_buffer_space;
+    }
+    while (true) {
+      const char *begin = buffer_.data() + pos_;
+      const char *end = buffer_.data() + buffer_.size();
+      if (begin == end) {
+        need_more_ = true;
+        return struct_pack::errc::no_buffer_space;
+      }
+      if (*begin == detail::sync_marker[0]) {
+        if (end - begin < (std::ptrdiff_t)sizeof(detail::sync_marker)) {
+          need_more_ = true;
+          return struct_pack::errc::no_buffer_space;
+        }
+        if (memcmp(begin, detail::sync_marker, sizeof(detail::sync_marker)) !=
+            0) {
+          skip_ = 1;
+          return struct_pack::errc::invalid_buffer;
+        }
+        pos_ += sizeof(detail::sync_marker);
+        continue;
+      }
+      if SP_UNLIKELY (*begin != detail::record_tag) {
+        skip_ = 1;
+        return struct_pack::errc::invalid_buffer;
+      }
+      detail::memory_reader reader{begin + 1, end};
+      uint64_t length = 0;
+      if (auto ec = detail::deserialize_varint(reader, length); ec) {
+        need_more_ = (ec == struct_pack::errc::no_buffer_space);
+        skip_ = 1;
+        return ec;
+      }
+      if SP_UNLIKELY (length > max_record_size_) {
+        skip_ = 1;
+        return struct_pack::errc::invalid_buffer;
+      }
+      if ((uint64_t)(end - reader.now) < length) {
+        need_more_ = true;
+        return struct_pack::errc::no_buffer_space;
+      }
+      detail::memory_reader record{reader.now, reader.now + length};
+      detail::unpacker<detail::memory_reader, conf> in(record);
+      // the frame is intact even if the record is broken.
+      pos_ = reader.now + length - buffer_.data();
+      skip_ = 0;
+      return in.deserialize(item);
+    }
+  }
+
+  /*!
+   * Skip to the next sync marker. If it isn't fed yet, false is returned and
+   * the decoder keeps searching it in the data fed later.
+   */
+  bool resync() {
+    resyncing_ = true;
+    auto from = (std::min)(pos_ + skip_, buffer_.size());
+    auto offset =
+        detail::find_sync_marker(buffer_.data() + from, buffer_.size() - from);
+    if (offset == std::string_view::npos) {
+      // keep the tail, which may be the beginning of a marker.
+      pos_ = buffer_.size() - (std::min)(buffer_.size() - from,
+                                         sizeof(detail::sync_marker) - 1);
+      skip_ = 0;
+      return false;
+    }
+    pos_ = from + offset;
+    skip_ = 0;
+    resyncing_ = false;
+    return true;
+  }
+
+  bool need_more() const noexcept { return need_more_; }
+  // The bytes fed but not decoded yet.
+  std::size_t pending() const noexcept { return buffer_.size() - pos_; }
+
+ private:
+  std::string buffer_;
+  std::size_t pos_ = 0;
+  // the bytes of the broken frame at pos_, which are skipped by resync().
+  std::size_t skip_ = 0;
+  std::size_t max_record_size_;
+  bool need_more_ = false;
+  bool resyncing_ = false;
+};
+}  // namespace struct_pack
@@ -56,7 +56,10 @@ enum sp_config : uint64_t {
   ENABLE_TYPE_INFO = 0b10,
   DISABLE_ALL_META_INFO = 0b11,
   ENCODING_WITH_VARINT = 0b100,
-  USE_FAST_VARINT = 0b1000
+  USE_FAST_VARINT = 0b1000,
+  // deserialize_to reuses the memory of the old object: the elements of
+  // vectors, the payload of optional/unique_ptr.
+  REUSE_OBJECT = 0b10000
 };
 
 namespace detail {
@@ -27,10 +27,12 @@
 #include <variant>
 
 #include "alignment.hpp"
+#include "allocator_helper.hpp"
 #include "calculate_size.hpp"
 #include "derived_helper.hpp"
 #include "endian_wrapper.hpp"
 #include "error_code.hpp"
+#include "memcpy_run.hpp"
 #include "reflection.hpp"
 #include "type_calculate.hpp"
 #include "type_id.hpp"
@@ -98,6 +100,9 @@ class unpacker {
   template <std::size_t size_width, typename R, typename T>
   friend STRUCT_PACK_INLINE struct_pack::err_code read(Reader &reader, T &t);
 
+  // overwrite the old object in place, see sp_config::REUSE_OBJECT.
+  static constexpr bool reuse_object = (conf & sp_config::REUSE_OBJECT) != 0;
+
   template <typename T, typename... Args>
   STRUCT_PACK_MAY_INLINE struct_pack::err_code deserialize(T &t,
                                                            Args &...args) {
@@ -113,7 +118,6 @@ class unpacker {
     }
     if constexpr (has_compatible) {
       data_len_ += buffer_len;
-      get_compatible_member_order_in_hash_map().clear();
     }
     switch (size_type_) {
       case 0:
@@ -177,7 +181,6 @@ class unpacker {
     }
     if constexpr (has_compatible) {
       data_len_ += buffer_len;
-      get_compatible_member_order_in_hash_map().clear();
     }
     switch (size_type_) {
       case 0:
@@ -242,7 +245,6 @@ class unpacker {
     }
     if constexpr (has_compatible) {
       data_len_ += buffer_len;
-      get_compatible_member_order_in_hash_map().clear();
     }
     switch (size_type_) {
       case 0:
@@ -281,9 +283,14 @@ class unpacker {
         clear_compatible_member_order_record();
         return err_code;
       }
-      constexpr std::size_t sz = compatible_version_number<Type>.size();
-      err_code = deserialize_compatible_fields<U, I>(
-          field, std::make_index_sequence<sz>{});
+      // the field is complete if it has no compatible member, the compatible
+      // fields of the others needn't be parsed.
+      if constexpr (check_if_compatible_element_exist<std::tuple<
+                        std::tuple_element_t<I, decltype(get_types<U>())>>>()) {
+        constexpr std::size_t sz = compatible_version_number<Type>.size();
+        err_code = deserialize_compatible_fields<U, I>(
+            field, std::make_index_sequence<sz>{});
+      }
       clear_compatible_member_order_record();
     }
     return err_code;
@@ -629,6 +636,82 @@ class unpacker {
     return code;
   }
 
+  // Deserialize the members of a struct, the runs of adjacent trivially
+  // serializable members are read by one memcpy.
+  template <size_t size_type, uint64_t version, bool NotSkip,
+            uint64_t parent_tag, typename P, typename... Args>
+  constexpr struct_pack::err_code STRUCT_PACK_INLINE
+  deserialize_members(Args &...items) {
+    if constexpr (has_memcpy_run<P, parent_tag, Args...>()) {
+      return deserialize_member_runs<size_type, version, NotSkip, parent_tag, P,
+                                     Args...>(
+          std::tie(items...), std::make_index_sequence<sizeof...(Args)>{});
+    }
+    else {
+      return deserialize_many<size_type, version, NotSkip, parent_tag>(
+          items...);
+    }
+  }
+
+  template <size_t size_type, uint64_t version, bool NotSkip,
+            uint64_t parent_tag, typename P, typename... Args,
+            std::size_t... I>
+  constexpr struct_pack::err_code STRUCT_PACK_INLINE deserialize_member_runs(
+      const std::tuple<Args &...> &refs, std::index_sequence<I...>) {
+    struct_pack::err_code code;
+    ((code = deserialize_member_run<size_type, version, NotSkip, parent_tag, P,
+                                    I, Args...>(refs)) ||
+     ...);
+    return code;
+  }
+
+  template <size_t size_type, uint64_t version, bool NotSkip,
+            uint64_t parent_tag, typename P, std::size_t begin,
+            typename... Args>
+  constexpr struct_pack::err_code STRUCT_PACK_INLINE
+  deserialize_member_run(const std::tuple<Args &...> &refs) {
+    constexpr auto len = memcpy_runs<P, parent_tag, Args...>[begin];
+    if constexpr (len == 1) {
+      return deserialize_one<size_type, version, NotSkip, parent_tag>(
+          std::get<begin>(refs));
+    }
+    else if constexpr (len > 1) {
+      constexpr auto size = memcpy_run_size<begin, len, Args...>();
+      if SP_LIKELY (is_memcpy_run_continuous<begin>(
+                        refs, std::make_index_sequence<len - 1>{})) {
+        if constexpr (NotSkip) {
+          return read_bytes_array(reader_, (char *)&std::get<begin>(refs), size)
+                     ? errc{}
+                     : errc::no_buffer_space;
+        }
+        else {
+          return reader_.ignore(size) ? errc{} : errc::no_buffer_space;
+        }
+      }
+      else {
+        return deserialize_member_run_one_by_one<size_type, version, NotSkip,
+                                                 parent_tag, begin>(
+            refs, std::make_index_sequence<len>{});
+      }
+    }
+    else {
+      return errc{};
+    }
+  }
+
+  template <size_t size_type, uint64_t version, bool NotSkip,
+            uint64_t parent_tag, std::size_t begin, typename Tuple,
+            std::size_t... I>
+  constexpr struct_pack::err_code STRUCT_PACK_INLINE
+  deserialize_member_run_one_by_one(const Tuple &refs,
+                                    std::index_sequence<I...>) {
+    struct_pack::err_code code;
+    ((code = deserialize_one<size_type, version, NotSkip, parent_tag>(
+          std::get<begin + I>(refs))) ||
+     ...);
+    return code;
+  }
+
   constexpr struct_pack::err_code STRUCT_PACK_INLINE
   ignore_padding(std::size_t sz) {
     if (sz > 0) {
@@ -746,16 +829,25 @@ class unpacker {
     }
   }
 
-  static std::unordered_map<void *, std::vector<void *>> &
+  // The order of the map elements is recorded only if the mapped type has
+  // compatible members, most types never touch the thread local map.
+  std::unordered_map<void *, std::vector<void *>> &
   get_compatible_member_order_in_hash_map() {
     static thread_local std::unordered_map<void *, std::vector<void *>>
         compatible_order_queue;
+    if (!compatible_order_recorded_) {
+      compatible_order_queue.clear();
+      compatible_order_recorded_ = true;
+    }
     return compatible_order_queue;
   }
-  static void clear_compatible_member_order_record() {
-    auto &map = get_compatible_member_order_in_hash_map();
-    map.clear();
-    map = {};
+  void clear_compatible_member_order_record() {
+    if (compatible_order_recorded_) {
+      auto &map = get_compatible_member_order_in_hash_map();
+      map.clear();
+      map = {};
+      compatible_order_recorded_ = false;
+    }
   }
 
   template <size_t size_type, uint64_t version, bool NotSkip, typename T>
@@ -853,6 +945,9 @@ class unpacker {
           return struct_pack::errc::no_buffer_space;
         }
         if (!has_value) {
+          if constexpr (NotSkip) {
+            item = nullptr;
+          }
           return {};
         }
         if constexpr (is_base_class<typename type::element_type>) {
@@ -874,7 +969,9 @@ class unpacker {
           }
         }
         else {
-          item = std::make_unique<typename type::element_type>();
+          if (!reuse_object || item == nullptr) {
+            item = std::make_unique<typename type::element_type>();
+          }
           deserialize_one<size_type, version, NotSkip>(*item);
         }
       }
@@ -978,6 +1075,14 @@ class unpacker {
           }
         }
         if (size == 0) {
+          if constexpr (NotSkip) {
+            if constexpr (string_view<type> || dynamic_span<type>) {
+              item = type{};
+            }
+            else if constexpr (!span<type>) {
+              item.clear();
+            }
+          }
           return {};
         }
         if constexpr (map_container<type>) {
@@ -996,7 +1101,10 @@ class unpacker {
           else {
             constexpr bool has_compatible = check_if_compatible_element_exist<
                 decltype(get_types<type>())>();
-            pair_type value;
+            auto value = make_element_of<pair_type>(item);
+            if constexpr (NotSkip) {
+              item.clear();
+            }
             if constexpr (!NotSkip) {
               for (uint64_t i = 0; i < size; ++i) {
                 code = deserialize_one<size_type, version, NotSkip>(value);
@@ -1095,7 +1203,7 @@ class unpacker {
           }
         }
         else if constexpr (set_container<type>) {
-          typename type::value_type value{};
+          auto value = make_element_of<typename type::value_type>(item);
           if constexpr (is_trivial_serializable<decltype(value)>::value &&
                         !NotSkip) {
             if constexpr (sizeof(value) > 1) {
@@ -1205,13 +1313,47 @@ class unpacker {
                             "It's illegal to deserialize a span<T> which T "
                             "is a non-trival-serializable type.");
             }
+            else if constexpr (NotSkip && continuous_container<type> &&
+                               !span<type> && varint_t<value_type>) {
+              // resize by blocks, the size isn't trusted before the data is
+              // read.
+              for (size_t i = 0, len = block_lim_cnt; i < size;
+                   i += block_lim_cnt) {
+                if (i + block_lim_cnt >= size) {
+                  len = size - i;
+                }
+                item.resize(i + len);
+                code = detail::deserialize_varints(reader_, item.data() + i,
+                                                   len);
+                if SP_UNLIKELY (code) {
+                  return code;
+                }
+              }
+            }
             else if constexpr (NotSkip) {
-              item.clear();
+              size_t i = 0;
+              if constexpr (reuse_object && continuous_container<type> &&
+                            !exist_compatible_member<value_type>) {
+                // deserialize into the old elements, so their memory(e.g. the
+                // capacity of a string) is reused.
+                if (item.size() > size) {
+                  item.erase(item.begin() + size, item.end());
+                }
+                for (; i < item.size(); ++i) {
+                  code = deserialize_one<size_type, version, NotSkip>(item[i]);
+                  if SP_UNLIKELY (code) {
+                    return code;
+                  }
+                }
+              }
+              else {
+                item.clear();
+              }
               if constexpr (can_reserve<type>) {
-                item.reserve((std::min)(size, block_lim_cnt));
+                item.reserve((std::min)(size, i + block_lim_cnt));
               }
-              for (size_t i = 0; i < size; ++i) {
-                item.emplace_back();
+              for (; i < size; ++i) {
+                emplace_back_element(item);
                 code =
                     deserialize_one<size_type, version, NotSkip>(item.back());
                 if SP_UNLIKELY (code) {
@@ -1261,6 +1403,9 @@ class unpacker {
             deserialize_one<size_type, version, NotSkip>(item.error());
           }
           else {
+            if constexpr (NotSkip) {
+              item = type{};
+            }
             return {};
           }
         }
@@ -1270,7 +1415,9 @@ class unpacker {
               deserialize_one<size_type, version, NotSkip>(item.value());
           }
           else {
-            item = type{std::in_place_t{}};
+            if (!reuse_object || !item.has_value()) {
+              item = type{std::in_place_t{}};
+            }
             deserialize_one<size_type, version, NotSkip>(*item);
           }
         }
@@ -1342,8 +1489,9 @@ class unpacker {
               item, [this](auto &&...items) CONSTEXPR_INLINE_LAMBDA {
                 constexpr uint64_t tag =
                     get_parent_tag<type>();  // to pass msvc with c++17
-                return this->deserialize_many<size_type, version, NotSkip, tag>(
-                    items...);
+                return this
+                    ->deserialize_members<size_type, version, NotSkip, tag,
+                                          type>(items...);
               });
         }
       }
@@ -1593,13 +1741,56 @@ class unpacker {
   }
 
  public:
+  // struct_pack::view parses the metainfo once, then resumes an unpacker at any
+  // field with the size_type of the buffer.
+  unsigned char size_type() const noexcept { return size_type_; }
+  void set_size_type(unsigned char size_type) noexcept {
+    size_type_ = size_type;
+  }
+
   std::size_t data_len_;
 
  private:
   Reader &reader_;
   unsigned char size_type_;
+  bool compatible_order_recorded_ = false;
 };
 
+// Call f with the template size_type of the unpacker which resumes reading
+// in the middle of a buffer, see unpacker::set_size_type.
+template <typename F>
+STRUCT_PACK_INLINE struct_pack::err_code dispatch_size_type(
+    unsigned char size_type, F &&f) {
+  switch (size_type) {
+    case 0:
+      return f(std::integral_constant<std::size_t, 1>{});
+#ifdef STRUCT_PACK_OPTIMIZE
+    case 1:
+      return f(std::integral_constant<std::size_t, 2>{});
+    case 2:
+      return f(std::integral_constant<std::size_t, 4>{});
+    case 3:
+      if constexpr (sizeof(std::size_t) >= 8) {
+        return f(std::integral_constant<std::size_t, 8>{});
+      }
+      else {
+        return struct_pack::errc::invalid_width_of_container_length;
+      }
+#else
+    case 3:
+      if constexpr (sizeof(std::size_t) < 8) {
+        return struct_pack::errc::invalid_width_of_container_length;
+      }
+    case 2:
+    case 1:
+      return f(std::integral_constant<std::size_t, 2>{});
+#endif
+    default:
+      unreachable();
+  }
+  return {};
+}
+
 template <typename Reader>
 struct MD5_reader_wrapper : public Reader {
   MD5_reader_wrapper(Reader &&reader) : Reader(std::move(reader)) {
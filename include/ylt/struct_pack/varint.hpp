@@ -15,12 +15,19 @@
  */
 #pragma once
 #include <cstdint>
+#include <cstring>
 #include <ostream>
 #include <system_error>
 #include <type_traits>
 
 #include "endian_wrapper.hpp"
 #include "reflection.hpp"
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#endif
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
 namespace struct_pack {
 
 namespace detail {
@@ -348,6 +355,183 @@ auto& get_varint_value(T& v) {
   }
 }
 
+// The bulk codec of a contiguous run of varints, used for containers whose
+// value_type is a varint. The wire format is the same as serialize_varint.
+
+constexpr inline std::size_t max_varint_bytes = 10;
+
+// write at most max_varint_bytes to p, return the count of bytes written.
+STRUCT_PACK_INLINE std::size_t encode_varint_to(char* p, uint64_t v) {
+  std::size_t i = 0;
+  while (v >= 0x80) {
+    p[i++] = static_cast<char>(v | 0x80u);
+    v >>= 7;
+  }
+  p[i++] = static_cast<char>(v);
+  return i;
+}
+
+template <
+#if __cpp_concepts >= 201907L
+    writer_t writer,
+#else
+    typename writer,
+#endif
+    typename T>
+STRUCT_PACK_INLINE void serialize_varints(writer& writer_, const T* data,
+                                          std::size_t size) {
+  if constexpr (std::is_same_v<writer, memory_writer>) {
+    // the buffer is already sized by calculate_payload_size, the plain loop
+    // is as fast as it gets.
+    for (std::size_t i = 0; i < size; ++i) {
+      serialize_varint(writer_, data[i]);
+    }
+  }
+  else {
+    // encode into a stack buffer and flush it by one write, so the writer
+    // isn't called for every byte.
+    constexpr std::size_t buf_size = 1024;
+    char buf[buf_size];
+    std::size_t pos = 0;
+    for (std::size_t i = 0; i < size; ++i) {
+      if SP_UNLIKELY (pos > buf_size - max_varint_bytes) {
+        writer_.write(buf, pos);
+        pos = 0;
+      }
+      if constexpr (sintable_t<T>) {
+        pos += encode_varint_to(buf + pos, encode_zigzag(data[i].get()));
+      }
+      else {
+        pos += encode_varint_to(
+            buf + pos, static_cast<uint64_t>(get_varint_value(data[i])));
+      }
+    }
+    if (pos) {
+      writer_.write(buf, pos);
+    }
+  }
+}
+
+STRUCT_PACK_INLINE unsigned countr_zero64(uint64_t v) {
+#if defined(_MSC_VER) && !defined(__clang__) && defined(_M_X64)
+  unsigned long index;
+  _BitScanForward64(&index, v);
+  return index;
+#elif defined(__GNUC__) || defined(__clang__)
+  return __builtin_ctzll(v);
+#else
+  unsigned n = 0;
+  while ((v & 1) == 0) {
+    v >>= 1;
+    ++n;
+  }
+  return n;
+#endif
+}
+
+// keep the low 7 bits of every byte and pack them together.
+STRUCT_PACK_INLINE uint64_t compact_varint_bytes(uint64_t w) {
+#if defined(__BMI2__)
+  return _pext_u64(w, 0x7f7f7f7f7f7f7f7full);
+#else
+  w &= 0x7f7f7f7f7f7f7f7full;
+  w = ((w & 0x7f007f007f007f00ull) >> 1) | (w & 0x007f007f007f007full);
+  w = ((w & 0x3fff00003fff0000ull) >> 2) | (w & 0x00003fff00003fffull);
+  w = ((w & 0x0fffffff00000000ull) >> 4) | (w & 0x000000000fffffffull);
+  return w;
+#endif
+}
+
+// decode one varint from p, there must be at least max_varint_bytes readable
+// from p. Reads 8 bytes at once and finds the last byte of the varint by the
+// continuation bits, instead of testing byte by byte.
+STRUCT_PACK_INLINE bool decode_varint_unchecked(const char*& p, uint64_t& v) {
+  uint64_t w;
+  memcpy(&w, p, sizeof(w));
+  // the short lengths advance p by a constant, so a well predicted branch
+  // doesn't wait for the length to be computed.
+  if ((w & 0x80) == 0) {
+    v = w & 0x7f;
+    p += 1;
+    return true;
+  }
+  if ((w & 0x8000) == 0) {
+    v = (w & 0x7f) | ((w >> 1) & 0x3f80);
+    p += 2;
+    return true;
+  }
+  uint64_t stop = ~w & 0x8080808080808080ull;
+  if SP_LIKELY (stop) {
+    unsigned bits = countr_zero64(stop) + 1;
+    if (bits < 64) {
+      w &= (1ull << bits) - 1;
+    }
+    v = compact_varint_bytes(w);
+    p += bits / 8;
+    return true;
+  }
+  // 9 or 10 bytes
+  v = compact_varint_bytes(w);
+  uint8_t b8 = static_cast<uint8_t>(p[8]);
+  v |= static_cast<uint64_t>(b8 & 0x7fu) << 56;
+  if ((b8 & 0x80u) == 0) {
+    p += 9;
+    return true;
+  }
+  uint8_t b9 = static_cast<uint8_t>(p[9]);
+  if SP_UNLIKELY (b9 & 0x80u) {
+    return false;
+  }
+  v |= static_cast<uint64_t>(b9) << 63;
+  p += 10;
+  return true;
+}
+
+template <typename T>
+STRUCT_PACK_INLINE void set_varint_value(T& t, uint64_t v) {
+  if constexpr (sintable_t<T>) {
+    t = decode_zigzag<int64_t>(v);
+  }
+  else {
+    t = v;
+  }
+}
+
+#if __cpp_concepts >= 201907L
+template <reader_t Reader, typename T>
+#else
+template <typename Reader, typename T>
+#endif
+[[nodiscard]] STRUCT_PACK_INLINE struct_pack::err_code deserialize_varints(
+    Reader& reader, T* data, std::size_t size) {
+  std::size_t i = 0;
+  if constexpr (std::is_same_v<Reader, memory_reader> &&
+                is_system_little_endian) {
+    // decode straight from the buffer while a whole varint surely fits, the
+    // tail goes through the checked path below.
+    const char* p = reader.now;
+    for (; i < size && reader.end - p >= (std::ptrdiff_t)max_varint_bytes;
+         ++i) {
+      uint64_t v;
+      if SP_UNLIKELY (!decode_varint_unchecked(p, v)) {
+        reader.now = p;
+        return struct_pack::errc::invalid_buffer;
+      }
+      set_varint_value(data[i], v);
+    }
+    reader.now = p;
+  }
+  for (; i < size; ++i) {
+    uint64_t v = 0;
+    auto ec = deserialize_varint_impl(reader, v);
+    if SP_UNLIKELY (ec) {
+      return ec;
+    }
+    set_varint_value(data[i], v);
+  }
+  return {};
+}
+
 }  // namespace detail
 using var_int32_t = detail::sint<int32_t>;
 using var_int64_t = detail::sint<int64_t>;
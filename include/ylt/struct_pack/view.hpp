@@ -0,0 +1,315 @@
+/*
+ * Copyright (c) 2023, Alibaba Group Holding Limited;
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "../util/expected.hpp"
+#include "error_code.hpp"
+#include "reflection.hpp"
+#include "type_calculate.hpp"
+#include "type_id.hpp"
+#include "unpacker.hpp"
+
+namespace struct_pack {
+
+template <typename T, uint64_t conf = sp_config::DEFAULT>
+class view;
+
+namespace detail {
+// The fields of these structs are serialized one after another, so the offset
+// of every field can be found by skipping the fields before it.
+template <typename T>
+constexpr bool viewable_struct() {
+  using U = remove_cvref_t<T>;
+  if constexpr (get_type_id<U>() != type_id::struct_t || tuple<U> ||
+                pair<U> || user_defined_serialization<U>) {
+    return false;
+  }
+  else {
+    return !is_trivial_serializable<U>::value &&
+           !is_trivial_serializable<U, true>::value &&
+           !is_enable_fast_varint_coding(get_parent_tag<U>()) &&
+           !exist_compatible_member<U>;
+  }
+}
+
+template <typename T, std::size_t I>
+using view_field_t = std::tuple_element_t<I, decltype(get_types<T>())>;
+
+// get<I>() returns a view for the nested struct, a string_view for the
+// string, and the value for other fields.
+template <typename Field, uint64_t conf>
+constexpr auto view_get_type() {
+  if constexpr (viewable_struct<Field>()) {
+    return view<Field, conf>{};
+  }
+  else if constexpr (string<Field> && !string_view<Field>) {
+    return std::basic_string_view<typename Field::value_type>{};
+  }
+  else {
+    return Field{};
+  }
+}
+}  // namespace detail
+
+/*!
+ * \ingroup struct_pack
+ * \class view
+ * \brief
+ * view<T> gives random access to the fields of a serialized T without
+ * deserializing the whole object. The buffer is validated once when the view
+ * is created by `struct_pack::get_view`, the offsets of the top level fields
+ * are recorded at the same time. Then `get<I>()` reads only the Ith field:
+ * a nested struct is returned as another view(whose offsets are indexed on
+ * first access), a string as string_view into the buffer, others by value.
+ * `raw<I>()` returns the serialized bytes of a field, which can be forwarded
+ * by memcpy. Both return an expected, the error of a truncated or corrupt
+ * nested field is found only when it's accessed.
+ *
+ * ```cpp
+ * struct person { int64_t id; std::string name; int age; };
+ * struct order { int64_t id; person buyer; std::vector<int> items; };
+ *
+ * auto buffer = struct_pack::serialize(order{...});
+ * auto v = struct_pack::get_view<order>(buffer);
+ * assert(v.has_value());
+ * int64_t id = v->get<0>().value();
+ * std::string_view name = v->get<1>()->get<1>().value();
+ * std::string_view items = v->raw<2>().value();  // forward as is
+ * ```
+ *
+ * T and the nested structs which are returned as view must be serialized
+ * field by field: trivially copyable structs (one memcpy is enough), structs
+ * with compatible fields and structs with USE_FAST_VARINT are not supported.
+ * The view doesn't own the buffer. The lazy index isn't thread safe, copy the
+ * view for each thread. Include ylt/struct_pack/view.hpp to use it.
+ */
+template <typename T, uint64_t conf>
+class view {
+  static_assert(detail::viewable_struct<T>(),
+                "struct_pack::view only supports structs serialized field by "
+                "field, it can't be trivially copyable or has compatible "
+                "fields or USE_FAST_VARINT.");
+
+  static constexpr std::size_t field_count =
+      std::tuple_size_v<decltype(detail::get_types<T>())>;
+
+  template <typename, uint64_t>
+  friend class view;
+
+ public:
+  view() = default;
+
+  /*!
+   * Validate the buffer and build the index of the top level fields, len is
+   * set to the length of the serialized object. Usually called by get_view.
+   */
+  struct_pack::err_code init(std::string_view buffer, std::size_t &len) {
+    detail::memory_reader reader{buffer.data(),
+                                 buffer.data() + buffer.size()};
+    detail::unpacker<detail::memory_reader, conf> in(reader);
+    auto ec = in.template deserialize_metainfo<T>().first;
+    if SP_UNLIKELY (ec) {
+      return ec;
+    }
+    size_type_ = in.size_type();
+    std::size_t head_len = reader.now - buffer.data();
+    data_ = buffer.substr(head_len);
+    ec = index_fields(std::make_index_sequence<field_count>{});
+    if SP_UNLIKELY (ec) {
+      return ec;
+    }
+    data_ = data_.substr(0, offsets_[field_count]);
+    buffer_ = buffer.substr(0, head_len + data_.size());
+    len = buffer_.size();
+    return {};
+  }
+
+  /*!
+   * Get the Ith field.
+   */
+  template <std::size_t I>
+  auto get() const {
+    static_assert(I < field_count, "out of range");
+    using Field = detail::view_field_t<T, I>;
+    using R = decltype(detail::view_get_type<Field, conf>());
+    struct_pack::expected<R, struct_pack::err_code> ret;
+    struct_pack::err_code ec;
+    if constexpr (detail::viewable_struct<Field>()) {
+      std::string_view bytes;
+      ec = raw_to<I>(bytes);
+      ret.value().data_ = bytes;
+      ret.value().buffer_ = bytes;
+      ret.value().size_type_ = size_type_;
+    }
+    else {
+      ec = read_field<I>(ret.value());
+    }
+    if SP_UNLIKELY (ec) {
+      ret = unexpected<struct_pack::err_code>{ec};
+    }
+    return ret;
+  }
+
+  /*!
+   * Deserialize the Ith field to dst.
+   */
+  template <std::size_t I>
+  struct_pack::err_code get_to(detail::view_field_t<T, I> &dst) const {
+    static_assert(I < field_count, "out of range");
+    return read_field<I>(dst);
+  }
+
+  /*!
+   * The serialized bytes of the Ith field.
+   */
+  template <std::size_t I>
+  struct_pack::expected<std::string_view, struct_pack::err_code> raw() const {
+    static_assert(I < field_count, "out of range");
+    struct_pack::expected<std::string_view, struct_pack::err_code> ret;
+    auto ec = raw_to<I>(ret.value());
+    if SP_UNLIKELY (ec) {
+      ret = unexpected<struct_pack::err_code>{ec};
+    }
+    return ret;
+  }
+
+  /*!
+   * The serialized bytes of the whole object. For the top level view it
+   * includes the metainfo, so it can be deserialized or forwarded as is.
+   */
+  std::string_view raw() const { return buffer_; }
+
+  /*!
+   * Deserialize the whole object.
+   */
+  struct_pack::err_code deserialize_to(T &t) const {
+    detail::memory_reader reader{data_.data(), data_.data() + data_.size()};
+    detail::unpacker<detail::memory_reader, conf> in(reader);
+    in.set_size_type(size_type_);
+    return detail::dispatch_size_type(size_type_, [&](auto size_type) {
+      return in.template deserialize_one<decltype(size_type)::value,
+                                         UINT64_MAX, true>(t);
+    });
+  }
+
+ private:
+  // Skip(NotSkip=false) or read the field starting from offset, len is set to
+  // the length of it.
+  template <bool NotSkip, typename Field>
+  struct_pack::err_code one_field(std::size_t offset, Field &field,
+                                  std::size_t &len) const {
+    constexpr uint64_t tag = detail::get_parent_tag<T>();
+    detail::memory_reader reader{data_.data() + offset,
+                                 data_.data() + data_.size()};
+    detail::unpacker<detail::memory_reader, conf> in(reader);
+    in.set_size_type(size_type_);
+    auto ec = detail::dispatch_size_type(size_type_, [&](auto size_type) {
+      return in.template deserialize_one<decltype(size_type)::value,
+                                         UINT64_MAX, NotSkip, tag>(field);
+    });
+    len = reader.now - (data_.data() + offset);
+    return ec;
+  }
+
+  template <std::size_t I>
+  struct_pack::err_code raw_to(std::string_view &bytes) const {
+    if (indexed_ <= I + 1) {
+      auto ec = index_fields(std::make_index_sequence<I + 1>{});
+      if SP_UNLIKELY (ec) {
+        return ec;
+      }
+    }
+    bytes = data_.substr(offsets_[I], offsets_[I + 1] - offsets_[I]);
+    return {};
+  }
+
+  template <std::size_t I, typename Field>
+  struct_pack::err_code read_field(Field &field) const {
+    std::string_view bytes;
+    auto ec = raw_to<I>(bytes);
+    if SP_UNLIKELY (ec) {
+      return ec;
+    }
+    std::size_t len;
+    return one_field<true>(bytes.data() - data_.data(), field, len);
+  }
+
+  template <std::size_t... Is>
+  struct_pack::err_code index_fields(std::index_sequence<Is...>) const {
+    struct_pack::err_code ec{};
+    [[maybe_unused]] bool ok = ([&] {
+      if (Is + 1 < indexed_) {
+        return true;
+      }
+      detail::view_field_t<T, Is> field{};
+      std::size_t len;
+      ec = one_field<false>(offsets_[Is], field, len);
+      if SP_UNLIKELY (ec) {
+        return false;
+      }
+      offsets_[Is + 1] = offsets_[Is] + len;
+      indexed_ = Is + 2;
+      return true;
+    }() && ...);
+    return ec;
+  }
+
+  std::string_view buffer_;
+  std::string_view data_;
+  unsigned char size_type_ = 0;
+  // offsets_[i] is the offset of the ith field in data_, offsets_[i] is known
+  // if i < indexed_.
+  mutable std::array<std::size_t, field_count + 1> offsets_{};
+  mutable std::size_t indexed_ = 1;
+};
+
+/*!
+ * \ingroup struct_pack
+ * Validate the buffer once and return a view for random access to the fields
+ * of T, see struct_pack::view.
+ */
+template <typename T, uint64_t conf = sp_config::DEFAULT>
+[[nodiscard]] struct_pack::expected<view<T, conf>, struct_pack::err_code>
+get_view(const char *data, size_t size) {
+  struct_pack::expected<view<T, conf>, struct_pack::err_code> ret;
+  size_t len;
+  auto ec = ret.value().init(std::string_view{data, size}, len);
+  if SP_UNLIKELY (ec) {
+    ret = unexpected<struct_pack::err_code>{ec};
+  }
+  return ret;
+}
+
+#if __cpp_concepts >= 201907L
+template <typename T, uint64_t conf = sp_config::DEFAULT,
+          struct_pack::detail::deserialize_view View>
+#else
+template <
+    typename T, uint64_t conf = sp_config::DEFAULT, typename View,
+    typename = std::enable_if_t<struct_pack::detail::deserialize_view<View>>>
+#endif
+[[nodiscard]] auto get_view(const View &v) {
+  return get_view<T, conf>((const char *)v.data(), v.size());
+}
+}  // namespace struct_pack
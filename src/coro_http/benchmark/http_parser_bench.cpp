@@ -0,0 +1,175 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <string_view>
+
+#include "asio/buffers_iterator.hpp"
+#include "asio/streambuf.hpp"
+#include "cinatra/define.h"
+#include "cinatra/http_parser.hpp"
+
+using namespace cinatra;
+
+/*
+microbenchmark of the request head parsing, with the header mixes seen by
+a real server. Run the _sse42/_avx2 variants to compare the simd scanners:
+./coro_http_parser_benchmark
+./coro_http_parser_benchmark_avx2
+*/
+
+struct request_mix {
+  std::string_view name;
+  std::string_view head;
+};
+
+constexpr request_mix mixes[] = {
+    {"curl",
+     "GET /index.html HTTP/1.1\r\n"
+     "Host: www.example.com\r\n"
+     "User-Agent: curl/8.4.0\r\n"
+     "Accept: */*\r\n"
+     "\r\n"},
+    {"browser",
+     "GET /wp-content/uploads/2010/03/hello-kitty-darth-vader-pink.jpg "
+     "HTTP/1.1\r\n"
+     "Host: www.kittyhell.com\r\n"
+     "Connection: keep-alive\r\n"
+     "sec-ch-ua: \"Chromium\";v=\"122\", \"Not(A:Brand\";v=\"24\", "
+     "\"Google Chrome\";v=\"122\"\r\n"
+     "sec-ch-ua-mobile: ?0\r\n"
+     "sec-ch-ua-platform: \"macOS\"\r\n"
+     "Upgrade-Insecure-Requests: 1\r\n"
+     "User-Agent: Mozilla/5.0 (Macintosh; Intel Mac OS X 10_15_7) "
+     "AppleWebKit/537.36 (KHTML, like Gecko) Chrome/122.0.0.0 "
+     "Safari/537.36\r\n"
+     "Accept: text/html,application/xhtml+xml,application/xml;q=0.9,image/"
+     "avif,image/webp,image/apng,*/*;q=0.8\r\n"
+     "Sec-Fetch-Site: same-origin\r\n"
+     "Sec-Fetch-Mode: navigate\r\n"
+     "Sec-Fetch-User: ?1\r\n"
+     "Sec-Fetch-Dest: document\r\n"
+     "Referer: https://www.kittyhell.com/\r\n"
+     "Accept-Encoding: gzip, deflate, br, zstd\r\n"
+     "Accept-Language: ja,en-US;q=0.9,en;q=0.8\r\n"
+     "Cookie: wp_ozh_wsa_visits=2; wp_ozh_wsa_visit_lasttime=1709251200; "
+     "__utma=123456789.1234567890.1234567890.1234567890.1234567890.1; "
+     "__utmz=123456789.1234567890.1.1.utmccn=(referral)|utmcsr=reader."
+     "livedoor.com|utmcct=/reader/|utmcmd=referral\r\n"
+     "\r\n"},
+    {"api_post",
+     "POST /api/v1/orders?client=ios&version=7.3.1 HTTP/1.1\r\n"
+     "Host: api.example.com\r\n"
+     "Authorization: Bearer "
+     "eyJhbGciOiJIUzI1NiIsInR5cCI6IkpXVCJ9.eyJzdWIiOiIxMjM0NTY3ODkwIiwibmFtZSI6"
+     "IkpvaG4gRG9lIiwiaWF0IjoxNTE2MjM5MDIyfQ.SflKxwRJSMeKKF2QT4fwpMeJf36POk6y"
+     "JV_adQssw5c\r\n"
+     "Content-Type: application/json; charset=utf-8\r\n"
+     "Content-Length: 512\r\n"
+     "Accept: application/json\r\n"
+     "Accept-Encoding: gzip\r\n"
+     "User-Agent: okhttp/4.12.0\r\n"
+     "X-Request-Id: 3f2c9a7e-5b1d-4c8e-9f0a-1b2c3d4e5f60\r\n"
+     "\r\n"},
+    {"proxied",
+     "GET /static/js/app.3f2c9a7e.js HTTP/1.1\r\n"
+     "Host: cdn.example.com\r\n"
+     "X-Forwarded-For: 203.0.113.195, 70.41.3.18, 150.172.238.178\r\n"
+     "X-Forwarded-Proto: https\r\n"
+     "X-Real-IP: 203.0.113.195\r\n"
+     "Via: 1.1 varnish (Varnish/7.4), 1.1 cache-edge-01\r\n"
+     "traceparent: 00-0af7651916cd43dd8448eb211c80319c-b7ad6b7169203331-01\r\n"
+     "If-None-Match: W/\"5e15153d-120f\"\r\n"
+     "If-Modified-Since: Wed, 21 Oct 2015 07:28:00 GMT\r\n"
+     "Cache-Control: max-age=0\r\n"
+     "Connection: keep-alive\r\n"
+     "\r\n"},
+    {"websocket",
+     "GET /chat HTTP/1.1\r\n"
+     "Host: server.example.com\r\n"
+     "Upgrade: websocket\r\n"
+     "Connection: Upgrade\r\n"
+     "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+     "Sec-WebSocket-Version: 13\r\n"
+     "Sec-WebSocket-Extensions: permessage-deflate; client_max_window_bits\r\n"
+     "Origin: http://example.com\r\n"
+     "\r\n"},
+};
+
+const char *simd_name() {
+#if defined(CINATRA_AVX2)
+  return "avx2";
+#elif defined(CINATRA_SSE)
+  return "sse4.2";
+#elif defined(CINATRA_ARM_OPT)
+  return "neon";
+#else
+  return "scalar";
+#endif
+}
+
+// the lookups every request does after parsing.
+size_t common_lookups(http_parser &parser) {
+  return parser.body_len() + parser.is_chunked() + parser.keep_alive() +
+         parser.is_websocket();
+}
+
+template <typename F>
+double bench(size_t iterations, F &&f) {
+  size_t sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < iterations; ++i) {
+    sink += f();
+  }
+  auto end = std::chrono::steady_clock::now();
+  static volatile size_t keep;
+  keep = sink;
+  return std::chrono::duration<double, std::nano>(end - start).count() /
+         iterations;
+}
+
+int main(int argc, char **argv) {
+  size_t iterations = 500000;
+  if (argc > 1) {
+    iterations = std::stoul(argv[1]);
+  }
+
+  std::printf("simd: %s, iterations: %zu\n", simd_name(), iterations);
+  std::printf("%-10s %6s %16s %16s %10s %10s\n", "mix", "bytes",
+              "two_pass(ns)", "one_pass(ns)", "speedup", "MB/s");
+
+  for (auto &[name, head] : mixes) {
+    // the head is in a streambuf like the data read from the socket.
+    asio::streambuf buf;
+    buf.sputn(head.data(), head.size());
+    const char *data = asio::buffer_cast<const char *>(buf.data());
+    size_t size = buf.size();
+    http_parser parser;
+
+    // read_until(TWO_CRCF) searches the end of head, then the head is parsed
+    // and the common headers are looked up by name.
+    double two_pass = bench(iterations, [&] {
+      auto begin = asio::buffers_begin(buf.data());
+      auto end = asio::buffers_end(buf.data());
+      auto it = std::search(begin, end, TWO_CRCF.begin(), TWO_CRCF.end());
+      size_t len = (it - begin) + TWO_CRCF.size();
+      int ret = parser.parse_request(data, len, 0);
+      return ret + parser.get_header_value("content-length").size() +
+             parser.get_header_value("transfer-encoding").size() +
+             parser.get_header_value("connection").size() +
+             parser.get_header_value("upgrade").size();
+    });
+
+    // the parser finds the end of head itself, and the common headers are
+    // recognized while tokenizing.
+    double one_pass = bench(iterations, [&] {
+      int ret = parser.parse_request(data, size, 0);
+      return ret + common_lookups(parser);
+    });
+
+    std::printf("%-10.*s %6zu %16.1f %16.1f %9.2fx %10.1f\n",
+                (int)name.size(), name.data(), head.size(), two_pass, one_pass,
+                two_pass / one_pass, head.size() * 1000.0 / one_pass);
+  }
+  return 0;
+}
@@ -444,3 +444,120 @@ TEST_CASE("test websocket permessage defalte") {
   client.close();
 }
 #endif
+
+TEST_CASE("test websocket mask") {
+  uint8_t key[4] = {0x12, 0x34, 0x56, 0x78};
+  for (size_t len : {0, 1, 3, 4, 7, 8, 15, 16, 17, 31, 33, 100, 1027}) {
+    std::string data(len, '\0');
+    for (size_t i = 0; i < len; i++) {
+      data[i] = char(i * 7 + 3);
+    }
+    std::string expect = data;
+    for (size_t i = 0; i < len; i++) {
+      expect[i] ^= key[i % 4];
+    }
+
+    ws_mask(data.data(), data.size(), key);
+    CHECK(data == expect);
+  }
+
+  auto frame = websocket::encode_server_frame("hello", opcode::text);
+  CHECK(*frame == std::string("\x81\x05hello", 7));
+}
+
+TEST_CASE("test websocket broadcast") {
+  coro_http_server server(1, 8090);
+  std::mutex mtx;
+  std::vector<std::shared_ptr<coro_http_connection>> conns;
+  server.set_http_handler<cinatra::GET>(
+      "/ws",
+      [&](coro_http_request &req,
+          coro_http_response &resp) -> async_simple::coro::Lazy<void> {
+        {
+          std::lock_guard lock(mtx);
+          conns.push_back(req.get_conn()->shared_from_this());
+        }
+        while (true) {
+          auto result = co_await req.get_conn()->read_websocket();
+          if (result.ec || result.type == ws_frame_type::WS_CLOSE_FRAME) {
+            break;
+          }
+        }
+      });
+  server.async_start();
+  std::this_thread::sleep_for(200ms);
+
+  std::vector<std::unique_ptr<coro_http_client>> clients;
+  for (int i = 0; i < 3; i++) {
+    auto client = std::make_unique<coro_http_client>();
+    auto r = async_simple::coro::syncAwait(
+        client->connect("ws://localhost:8090/ws"));
+    REQUIRE(r.status == 101);
+    clients.push_back(std::move(client));
+  }
+
+  for (int i = 0; i < 100; i++) {
+    {
+      std::lock_guard lock(mtx);
+      if (conns.size() == clients.size()) {
+        break;
+      }
+    }
+    std::this_thread::sleep_for(10ms);
+  }
+
+  std::vector<std::shared_ptr<coro_http_connection>> targets;
+  {
+    std::lock_guard lock(mtx);
+    targets = conns;
+  }
+  REQUIRE(targets.size() == clients.size());
+
+  std::string msg(1000, 'a');
+  auto ecs = async_simple::coro::syncAwait(
+      broadcast_websocket(targets, msg, opcode::binary));
+  CHECK(ecs.size() == clients.size());
+  for (auto &ec : ecs) {
+    CHECK(!ec);
+  }
+  for (auto &client : clients) {
+    auto data = async_simple::coro::syncAwait(client->read_websocket());
+    CHECK(data.resp_body == msg);
+  }
+
+  // the broadcast frames don't interleave with the other writes.
+  auto conn = targets[0];
+  std::string msg2(100000, 'b');
+  auto write = async_simple::coro::syncAwait(async_simple::coro::collectAll(
+      [&]() -> async_simple::coro::Lazy<std::error_code> {
+        co_return co_await conn->write_websocket(msg2, opcode::binary);
+      }()
+                   .via(conn->get_executor()),
+      broadcast_websocket(targets, msg, opcode::binary)
+          .via(conn->get_executor())));
+  CHECK(!std::get<0>(write).value());
+
+  for (size_t i = 1; i < clients.size(); i++) {
+    auto data = async_simple::coro::syncAwait(clients[i]->read_websocket());
+    CHECK(data.resp_body == msg);
+  }
+  // resp_body refers to the buffer of the client, it's copied before the
+  // next read.
+  std::string first(
+      async_simple::coro::syncAwait(clients[0]->read_websocket()).resp_body);
+  std::string second(
+      async_simple::coro::syncAwait(clients[0]->read_websocket()).resp_body);
+  CHECK(first.size() + second.size() == msg.size() + msg2.size());
+  CHECK((first == msg || first == msg2));
+  CHECK((second == msg || second == msg2));
+  for (auto &client : clients) {
+    client->close();
+  }
+  targets.clear();
+  {
+    std::lock_guard lock(mtx);
+    conns.clear();
+  }
+
+  server.stop();
+}
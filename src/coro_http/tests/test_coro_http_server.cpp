@@ -1002,6 +1002,111 @@ TEST_CASE("chunked request") {
   CHECK(result.resp_body == "hello world ok");
 }
 
+TEST_CASE("stream request body") {
+  cinatra::coro_http_server server(1, 9001);
+  server.set_max_http_body_size(1024);
+  auto read_all = [](coro_http_request& req,
+                     coro_http_response& resp) -> async_simple::coro::Lazy<void> {
+    CHECK(req.is_stream_body());
+    std::string content;
+    char buf[1000];
+    while (true) {
+      auto [ec, size] = co_await req.read_body_some(buf);
+      if (ec) {
+        co_return;
+      }
+      if (size == 0) {
+        break;
+      }
+      CHECK(size <= sizeof(buf));
+      content.append(buf, size);
+    }
+    resp.set_status_and_content(status_type::ok, std::move(content));
+  };
+  server.set_http_stream_handler<cinatra::POST, cinatra::PUT>("/upload",
+                                                             read_all);
+  server.set_http_stream_handler<cinatra::POST>("/upload/:name", read_all);
+  server.set_http_stream_handler<cinatra::POST>(
+      "/reject",
+      [](coro_http_request& req,
+         coro_http_response& resp) -> async_simple::coro::Lazy<void> {
+        resp.set_status_and_content(status_type::forbidden, "rejected");
+        co_return;
+      });
+  server.set_http_handler<cinatra::POST>(
+      "/buffered",
+      [](coro_http_request& req,
+         coro_http_response& resp) -> async_simple::coro::Lazy<void> {
+        CHECK(!req.is_stream_body());
+        char buf[4];
+        std::string content;
+        while (true) {
+          auto [ec, size] = co_await req.read_body_some(buf);
+          if (size == 0) {
+            break;
+          }
+          content.append(buf, size);
+        }
+        resp.set_status_and_content(status_type::ok, std::move(content));
+      });
+  server.async_start();
+
+  std::string big(1024 * 1024, 'a');
+  for (size_t i = 0; i < big.size(); i += 7) {
+    big[i] = 'a' + i % 26;
+  }
+
+  coro_http_client client{};
+  auto result = async_simple::coro::syncAwait(client.async_post(
+      "http://127.0.0.1:9001/upload", big, req_content_type::text));
+  CHECK(result.status == 200);
+  CHECK(result.resp_body == big);
+
+  result = async_simple::coro::syncAwait(client.async_post(
+      "http://127.0.0.1:9001/upload/test", big, req_content_type::text));
+  CHECK(result.status == 200);
+  CHECK(result.resp_body == big);
+
+  auto ss = std::make_shared<std::stringstream>();
+  *ss << big;
+  result = async_simple::coro::syncAwait(client.async_upload_chunked(
+      "http://127.0.0.1:9001/upload"sv, http_method::PUT, ss));
+  CHECK(result.status == 200);
+  CHECK(result.resp_body == big);
+
+  result = async_simple::coro::syncAwait(client.async_post(
+      "http://127.0.0.1:9001/buffered", "hello world", req_content_type::text));
+  CHECK(result.status == 200);
+  CHECK(result.resp_body == "hello world");
+
+  coro_http_client client1{};
+  client1.add_str_part("part", "multipart content");
+  result = async_simple::coro::syncAwait(
+      client1.async_upload_multipart("http://127.0.0.1:9001/upload"));
+  CHECK(result.status == 200);
+  CHECK(result.resp_body.find("multipart content") != std::string::npos);
+
+  // the unread body is not limited by max_http_body_size, but the connection
+  // is closed after the response.
+  coro_http_client client2{};
+  result = async_simple::coro::syncAwait(client2.async_post(
+      "http://127.0.0.1:9001/reject", std::string(2048, 'a'),
+      req_content_type::text));
+  CHECK(result.status == 403);
+  bool has_close = false;
+  for (auto& [k, v] : result.resp_headers) {
+    if (k == "Connection" && v == "close") {
+      has_close = true;
+    }
+  }
+  CHECK(has_close);
+
+  coro_http_client client3{};
+  result = async_simple::coro::syncAwait(client3.async_post(
+      "http://127.0.0.1:9001/buffered", big, req_content_type::text));
+  CHECK(result.status == 400);
+}
+
 TEST_CASE("test websocket with chunked") {
   int ws_chunk_size = 100;
   cinatra::coro_http_server server(1, 9001);
@@ -1517,7 +1622,63 @@ TEST_CASE("test response standalone") {
   std::vector<asio::const_buffer> buffers;
   resp.set_content_type<4>();
   resp.build_resp_head(buffers);
-  CHECK(buffers.size() == 13);
+  CHECK(buffers.size() == 1);
+  resp.clear();
+  str.clear();
+
+  // common status and content type use the precompiled head.
+  coro_http_response resp2(nullptr);
+  resp2.need_date_head(false);
+  resp2.set_content_type<resp_content_type::json>();
+  resp2.set_keepalive(true);
+  resp2.add_header("X-Id", "1");
+  resp2.set_status_and_content(status_type::ok, R"({"a":1})");
+  resp2.build_resp_str(str);
+  CHECK(str ==
+        "HTTP/1.1 200 OK\r\nServer: cinatra\r\nContent-Type: "
+        "application/json\r\nContent-Length: 7\r\nConnection: "
+        "keep-alive\r\nX-Id: 1\r\n\r\n{\"a\":1}");
+  CHECK(get_resp_head_template(status_type::ok, resp_content_type::json) ==
+        "HTTP/1.1 200 OK\r\nServer: cinatra\r\nContent-Type: "
+        "application/json\r\n");
+  CHECK(get_resp_head_template(status_type::not_found, -1) ==
+        "HTTP/1.1 404 Not Found\r\nServer: cinatra\r\n");
+  CHECK(get_resp_head_template(status_type::ok, resp_content_type::wasm)
+            .empty());
+
+  // the head is one buffer and the content isn't copied.
+  buffers.clear();
+  std::string chunk_size;
+  resp2.to_buffers(buffers, chunk_size);
+  CHECK(buffers.size() == 2);
+  CHECK(std::string_view((const char *)buffers[1].data(), buffers[1].size())
+            .data() == resp2.content().data());
+  resp2.clear();
+  str.clear();
+
+  // a reused response doesn't keep the content type of the last one.
+  resp2.need_date_head(false);
+  resp2.set_status_and_content(status_type::ok, "a");
+  resp2.build_resp_str(str);
+  CHECK(str ==
+        "HTTP/1.1 200 OK\r\nServer: cinatra\r\nContent-Length: 1\r\n\r\na");
+  resp2.clear();
+  str.clear();
+
+  // a user defined Server header disables the template, the status is
+  // uncommon.
+  coro_http_response resp3(nullptr);
+  resp3.add_header("Server", "test");
+  resp3.set_status(status_type::conflict);
+  resp3.build_resp_str(str);
+  CHECK(str.starts_with("HTTP/1.1 409 Conflict\r\nContent-Length: "));
+  CHECK(str.find("Server: cinatra") == std::string::npos);
+  CHECK(str.find("Server: test\r\n") != std::string::npos);
+
+  auto date = get_date_header_str();
+  CHECK(date.starts_with("Date: "));
+  CHECK(date.ends_with(" GMT\r\n"));
+  CHECK(date.size() == 37);
 }
 
 TEST_CASE("test radix tree restful api") {
@@ -0,0 +1,442 @@
+#include <map>
+#include <string>
+#include <vector>
+
+#include "asio/io_context.hpp"
+#include "asio/read.hpp"
+#ifdef CINATRA_ENABLE_SSL
+#include "asio/ssl.hpp"
+#endif
+#include "asio/write.hpp"
+#include "cinatra/hpack.hpp"
+#include "cinatra/http2.hpp"
+#include "doctest.h"
+#include "ylt/coro_http/coro_http_client.hpp"
+#include "ylt/coro_http/coro_http_server.hpp"
+
+using namespace cinatra;
+
+namespace {
+std::string from_hex(std::string_view hex) {
+  std::string out;
+  for (size_t i = 0; i + 1 < hex.size(); i += 2) {
+    out.push_back(static_cast<char>(
+        std::stoi(std::string(hex.substr(i, 2)), nullptr, 16)));
+  }
+  return out;
+}
+
+std::string to_hex(std::string_view str) {
+  static constexpr char digits[] = "0123456789abcdef";
+  std::string out;
+  for (unsigned char c : str) {
+    out.push_back(digits[c >> 4]);
+    out.push_back(digits[c & 0xf]);
+  }
+  return out;
+}
+
+class h2_test_client {
+ public:
+  explicit h2_test_client(uint16_t port) : socket_(ctx_) {
+    socket_.connect({asio::ip::address::from_string("127.0.0.1"), port});
+    std::string data(HTTP2_PREFACE);
+    append_http2_frame_header(data, 0, http2_frame_type::settings, 0, 0);
+    write(data);
+  }
+
+  void write(std::string_view data) {
+    asio::write(socket_, asio::buffer(data.data(), data.size()));
+  }
+
+  void request(uint32_t id, std::string_view method, std::string_view path,
+               std::string_view body = "") {
+    std::string block;
+    encoder_.encode(":method", method, block);
+    encoder_.encode(":scheme", "http", block);
+    encoder_.encode(":path", path, block);
+    encoder_.encode(":authority", "127.0.0.1", block);
+    encoder_.encode("User-Agent", "h2_test_client", block);
+
+    std::string data;
+    uint8_t flags = http2_flags::end_headers;
+    if (body.empty()) {
+      flags |= http2_flags::end_stream;
+    }
+    append_http2_frame_header(data, block.size(), http2_frame_type::headers,
+                              flags, id);
+    data.append(block);
+    if (!body.empty()) {
+      append_http2_frame_header(data, body.size(), http2_frame_type::data,
+                                http2_flags::end_stream, id);
+      data.append(body);
+    }
+    write(data);
+  }
+
+  http2_frame_header read_frame(std::string &payload) {
+    char buf[HTTP2_FRAME_HEADER_LEN];
+    asio::read(socket_, asio::buffer(buf, sizeof(buf)));
+    auto header = parse_http2_frame_header(buf);
+    payload.resize(header.length);
+    asio::read(socket_, asio::buffer(payload.data(), payload.size()));
+    return header;
+  }
+
+  struct response {
+    std::vector<hpack_header> headers;
+    std::string body;
+    bool finished = false;
+  };
+
+  // Read until all the streams finished, consumed DATA is acknowledged by
+  // WINDOW_UPDATE.
+  std::map<uint32_t, response> read_responses(size_t count) {
+    std::map<uint32_t, response> responses;
+    size_t finished = 0;
+    std::string payload;
+    while (finished < count) {
+      auto header = read_frame(payload);
+      if (header.type == http2_frame_type::headers) {
+        REQUIRE(header.has_flag(http2_flags::end_headers));
+        REQUIRE(decoder_.decode(payload, responses[header.stream_id].headers));
+      }
+      else if (header.type == http2_frame_type::data) {
+        responses[header.stream_id].body.append(payload);
+        if (!payload.empty()) {
+          std::string update;
+          for (uint32_t id : {uint32_t(0), header.stream_id}) {
+            append_http2_frame_header(update, 4,
+                                      http2_frame_type::window_update, 0, id);
+            append_http2_uint32(update, payload.size());
+          }
+          write(update);
+        }
+      }
+      else {
+        continue;
+      }
+
+      if (header.has_flag(http2_flags::end_stream)) {
+        responses[header.stream_id].finished = true;
+        finished++;
+      }
+    }
+    return responses;
+  }
+
+ private:
+  asio::io_context ctx_;
+  asio::ip::tcp::socket socket_;
+  hpack_encoder encoder_;
+  hpack_decoder decoder_;
+};
+
+// A literal field inserted into the dynamic table, then referenced count
+// times by its 1 byte index.
+std::string make_hpack_bomb(size_t value_size, size_t count) {
+  std::string block;
+  block.push_back(0x40);
+  hpack_encode_integer(block, 6, 7, 0x00);
+  block.append("x-bomb");
+  hpack_encode_integer(block, value_size, 7, 0x00);
+  block.append(value_size, 'a');
+  // the newest dynamic table entry is index 62.
+  block.append(count, static_cast<char>(0x80 | 62));
+  return block;
+}
+
+std::string_view find_header(const std::vector<hpack_header> &headers,
+                             std::string_view name) {
+  for (auto &[k, v] : headers) {
+    if (k == name) {
+      return v;
+    }
+  }
+  return {};
+}
+}  // namespace
+
+TEST_CASE("test hpack huffman") {
+  std::string out;
+  hpack_huffman_encode("www.example.com", out);
+  CHECK(to_hex(out) == "f1e3c2e5f23a6ba0ab90f4ff");
+  std::string decoded;
+  CHECK(hpack_huffman_decode(out, decoded));
+  CHECK(decoded == "www.example.com");
+
+  out.clear();
+  hpack_huffman_encode("custom-value", out);
+  CHECK(to_hex(out) == "25a849e95bb8e8b4bf");
+  CHECK(hpack_huffman_encoded_size("custom-value") == out.size());
+
+  std::string all;
+  for (int i = 0; i < 256; ++i) {
+    all.push_back(static_cast<char>(i));
+  }
+  out.clear();
+  decoded.clear();
+  hpack_huffman_encode(all, out);
+  CHECK(hpack_huffman_decode(out, decoded));
+  CHECK(decoded == all);
+
+  // padding longer than 7 bits or not filled by ones is invalid.
+  decoded.clear();
+  CHECK(!hpack_huffman_decode(from_hex("f1e3c2e5f23a6ba0ab90f4ffff"),
+                              decoded));
+  decoded.clear();
+  CHECK(!hpack_huffman_decode(from_hex("00"), decoded));
+}
+
+TEST_CASE("test hpack decode rfc7541 examples") {
+  hpack_decoder decoder;
+  std::vector<hpack_header> headers;
+
+  // C.4.1
+  CHECK(decoder.decode(from_hex("828684418cf1e3c2e5f23a6ba0ab90f4ff"),
+                       headers));
+  REQUIRE(headers.size() == 4);
+  CHECK(headers[0].name == ":method");
+  CHECK(headers[0].value == "GET");
+  CHECK(headers[3].name == ":authority");
+  CHECK(headers[3].value == "www.example.com");
+  CHECK(decoder.table().size() == 57);
+
+  // C.4.2
+  headers.clear();
+  CHECK(decoder.decode(from_hex("828684be5886a8eb10649cbf"), headers));
+  REQUIRE(headers.size() == 5);
+  CHECK(headers[3].value == "www.example.com");
+  CHECK(headers[4].name == "cache-control");
+  CHECK(headers[4].value == "no-cache");
+  CHECK(decoder.table().size() == 110);
+
+  // C.4.3
+  headers.clear();
+  CHECK(decoder.decode(
+      from_hex("828785bf408825a849e95ba97d7f8925a849e95bb8e8b4bf"), headers));
+  REQUIRE(headers.size() == 5);
+  CHECK(headers[1].value == "https");
+  CHECK(headers[2].value == "/index.html");
+  CHECK(headers[4].name == "custom-key");
+  CHECK(headers[4].value == "custom-value");
+  CHECK(decoder.table().size() == 164);
+
+  // C.3.1, literal strings without huffman.
+  hpack_decoder plain_decoder;
+  headers.clear();
+  CHECK(plain_decoder.decode(
+      from_hex("828684410f7777772e6578616d706c652e636f6d"), headers));
+  REQUIRE(headers.size() == 4);
+  CHECK(headers[3].value == "www.example.com");
+
+  // index 0 and out of range indexes are invalid.
+  headers.clear();
+  CHECK(!plain_decoder.decode(from_hex("80"), headers));
+  headers.clear();
+  CHECK(!plain_decoder.decode(from_hex("ff00"), headers));
+}
+
+TEST_CASE("test hpack decode header list bound") {
+  auto block = make_hpack_bomb(4000, 1000);
+  hpack_decoder unbounded;
+  std::vector<hpack_header> headers;
+  CHECK(unbounded.decode(block, headers));
+  CHECK(headers.size() == 1001);
+
+  hpack_decoder decoder;
+  decoder.set_max_header_list(64 * 1024, 100);
+  headers.clear();
+  CHECK(!decoder.decode(block, headers));
+  CHECK(decoder.too_large());
+  // stopped once the bound is exceeded, 4038 bytes a field.
+  CHECK(headers.size() == 17);
+
+  hpack_decoder count_decoder;
+  count_decoder.set_max_header_list(SIZE_MAX, 10);
+  headers.clear();
+  CHECK(!count_decoder.decode(make_hpack_bomb(1, 20), headers));
+  CHECK(count_decoder.too_large());
+  CHECK(headers.size() == 10);
+
+  // a malformed block isn't too large.
+  headers.clear();
+  CHECK(!decoder.decode(from_hex("80"), headers));
+  CHECK(!decoder.too_large());
+}
+
+TEST_CASE("test hpack encoder") {
+  hpack_encoder encoder;
+  std::string block;
+  encoder.encode(":status", "200", block);
+  CHECK(block == "\x88");
+
+  encoder.encode(":status", "503", block);
+  encoder.encode("Content-Type", "application/json", block);
+  encoder.encode("X-Custom-Header", "Value", block);
+
+  hpack_decoder decoder;
+  std::vector<hpack_header> headers;
+  REQUIRE(decoder.decode(block, headers));
+  REQUIRE(headers.size() == 4);
+  CHECK(headers[0].value == "200");
+  CHECK(headers[1].value == "503");
+  CHECK(headers[2].name == "content-type");
+  CHECK(headers[2].value == "application/json");
+  CHECK(headers[3].name == "x-custom-header");
+  CHECK(headers[3].value == "Value");
+  // the encoder never inserts into the dynamic table.
+  CHECK(decoder.table().count() == 0);
+}
+
+TEST_CASE("test http2 h2c prior knowledge") {
+  coro_http_server server(1, 0);
+  server.enable_http2();
+  server.set_http_handler<GET>(
+      "/get", [](coro_http_request &req, coro_http_response &resp) {
+        resp.add_header("X-Agent",
+                        std::string(req.get_header_value("user-agent")));
+        resp.set_status_and_content(status_type::ok, "get ok");
+      });
+  server.set_http_handler<POST>(
+      "/post",
+      [](coro_http_request &req,
+         coro_http_response &resp) -> async_simple::coro::Lazy<void> {
+        resp.set_status_and_content(status_type::ok,
+                                    std::string(req.get_body()));
+        co_return;
+      });
+  server.set_http_handler<GET>(
+      "/big", [](coro_http_request &req, coro_http_response &resp) {
+        resp.set_status_and_content(status_type::ok,
+                                    std::string(200 * 1024, 'a'));
+      });
+  server.async_start();
+
+  h2_test_client client(server.port());
+  client.request(1, "GET", "/get");
+  client.request(3, "POST", "/post", "hello http2");
+  client.request(5, "GET", "/big");
+  client.request(7, "GET", "/not_exist");
+  auto responses = client.read_responses(4);
+
+  CHECK(find_header(responses[1].headers, ":status") == "200");
+  CHECK(find_header(responses[1].headers, "x-agent") == "h2_test_client");
+  CHECK(responses[1].body == "get ok");
+  CHECK(find_header(responses[3].headers, ":status") == "200");
+  CHECK(responses[3].body == "hello http2");
+  CHECK(responses[5].body.size() == 200 * 1024);
+  CHECK(find_header(responses[5].headers, "content-length") == "204800");
+  CHECK(find_header(responses[7].headers, ":status") == "404");
+
+  // ping
+  std::string ping;
+  append_http2_frame_header(ping, 8, http2_frame_type::ping, 0, 0);
+  ping.append("12345678");
+  client.write(ping);
+  std::string payload;
+  http2_frame_header header;
+  do {
+    header = client.read_frame(payload);
+  } while (header.type != http2_frame_type::ping);
+  CHECK(header.has_flag(http2_flags::ack));
+  CHECK(payload == "12345678");
+
+  // a DATA frame on stream 0 is a connection error.
+  std::string bad;
+  append_http2_frame_header(bad, 0, http2_frame_type::data, 0, 0);
+  client.write(bad);
+  do {
+    header = client.read_frame(payload);
+  } while (header.type != http2_frame_type::goaway);
+  CHECK(read_http2_uint32(payload.data() + 4) ==
+        static_cast<uint32_t>(http2_error_code::protocol_error));
+}
+
+TEST_CASE("test http2 header list bound") {
+  coro_http_server server(1, 0);
+  server.enable_http2();
+  server.set_http_handler<GET>(
+      "/get", [](coro_http_request &req, coro_http_response &resp) {
+        resp.set_status_and_content(status_type::ok, "get ok");
+      });
+  server.async_start();
+
+  h2_test_client client(server.port());
+  std::string payload;
+  http2_frame_header header;
+  // the bound is advertised.
+  do {
+    header = client.read_frame(payload);
+  } while (header.type != http2_frame_type::settings);
+  bool advertised = false;
+  for (size_t i = 0; i + 6 <= payload.size(); i += 6) {
+    if (payload[i + 1] ==
+        static_cast<char>(http2_settings_id::max_header_list_size)) {
+      advertised = read_http2_uint32(payload.data() + i + 2) ==
+                   CINATRA_HTTP2_MAX_HEADER_LIST_SIZE;
+    }
+  }
+  CHECK(advertised);
+
+  // 5 KB of header block which decodes to 4 MB.
+  std::string block;
+  hpack_encoder encoder;
+  encoder.encode(":method", "GET", block);
+  encoder.encode(":scheme", "http", block);
+  encoder.encode(":path", "/get", block);
+  block.append(make_hpack_bomb(4000, 1000));
+  std::string data;
+  append_http2_frame_header(data, block.size(), http2_frame_type::headers,
+                            http2_flags::end_headers | http2_flags::end_stream,
+                            1);
+  data.append(block);
+  client.write(data);
+  do {
+    header = client.read_frame(payload);
+  } while (header.type != http2_frame_type::goaway);
+  CHECK(read_http2_uint32(payload.data() + 4) ==
+        static_cast<uint32_t>(http2_error_code::enhance_your_calm));
+}
+
+#ifdef CINATRA_ENABLE_SSL
+TEST_CASE("test http2 alpn on a shared ssl context") {
+  coro_http_server server(1, 0);
+  server.enable_http2();
+  server.init_ssl("../openssl_files/server.crt", "../openssl_files/server.key",
+                  "test");
+  server.set_http_handler<GET>(
+      "/get", [](coro_http_request &req, coro_http_response &resp) {
+        resp.set_status_and_content(status_type::ok, "get ok");
+      });
+  server.async_start();
+
+  auto negotiate = [&](std::string_view protos) {
+    asio::io_context ctx;
+    asio::ssl::context ssl_ctx(asio::ssl::context::sslv23);
+    SSL_CTX_set_alpn_protos(
+        ssl_ctx.native_handle(),
+        reinterpret_cast<const unsigned char *>(protos.data()),
+        static_cast<unsigned int>(protos.size()));
+    asio::ssl::stream<asio::ip::tcp::socket> stream(ctx, ssl_ctx);
+    stream.next_layer().connect(
+        {asio::ip::make_address("127.0.0.1"), server.port()});
+    stream.handshake(asio::ssl::stream_base::client);
+    const unsigned char *proto = nullptr;
+    unsigned int len = 0;
+    SSL_get0_alpn_selected(stream.native_handle(), &proto, &len);
+    return std::string(reinterpret_cast<const char *>(proto), len);
+  };
+  // every connection uses the context set up for the first one.
+  CHECK(negotiate(std::string_view("\x02h2\x08http/1.1", 12)) == "h2");
+  CHECK(negotiate(std::string_view("\x02h2", 3)) == "h2");
+  CHECK(negotiate(std::string_view("\x08http/1.1", 9)) == "http/1.1");
+
+  coro_http_client client{};
+  [[maybe_unused]] auto r = client.init_ssl();
+  auto result =
+      client.get("https://127.0.0.1:" + std::to_string(server.port()) + "/get");
+  CHECK(result.status == 200);
+  CHECK(result.resp_body == "get ok");
+}
+#endif
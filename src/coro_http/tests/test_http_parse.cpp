@@ -100,6 +100,89 @@ TEST_CASE("http_parser test") {
   CHECK(ret < 0);
 }
 
+TEST_CASE("http_parser known headers") {
+  std::string_view req =
+      "POST /upload HTTP/1.1\r\n"
+      "Host: cinatra\r\n"
+      "content-LENGTH: 42\r\n"
+      "TRANSFER-ENCODING: Chunked\r\n"
+      "connection: Upgrade\r\n"
+      "upgrade: websocket\r\n"
+      "\r\n";
+  http_parser parser{};
+  int ret = parser.parse_request(req.data(), req.size(), 0);
+  CHECK(ret == (int)req.size());
+  CHECK(parser.body_len() == 42);
+  CHECK(parser.is_chunked());
+  CHECK(parser.has_connection());
+  CHECK(parser.has_upgrade());
+  CHECK(!parser.has_close());
+  CHECK(parser.is_websocket());
+
+  std::string_view req1 =
+      "GET / HTTP/1.1\r\nConnection: close\r\nX-Content-Length: 1\r\n\r\n";
+  ret = parser.parse_request(req1.data(), req1.size(), 0);
+  CHECK(ret == (int)req1.size());
+  CHECK(parser.has_close());
+  CHECK(!parser.has_upgrade());
+  CHECK(!parser.is_chunked());
+  CHECK(!parser.keep_alive());
+}
+
+TEST_CASE("http_parser incremental parse") {
+  std::string_view req =
+      "GET /index.html?a=1 HTTP/1.1\r\n"
+      "Host: www.example.com\r\n"
+      "User-Agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36 (KHTML, "
+      "like Gecko) Chrome/120.0.0.0 Safari/537.36\r\n"
+      "Accept-Encoding: gzip, deflate, br\r\n"
+      "Connection: keep-alive\r\n"
+      "\r\n"
+      "GET /next HTTP/1.1\r\n";
+  size_t head_len = req.find("\r\n\r\n") + 4;
+
+  for (size_t split = 1; split < head_len; ++split) {
+    http_parser parser{};
+    CHECK(parser.parse_request(req.data(), split, 0) == -2);
+    int ret = parser.parse_request(req.data(), req.size(), split);
+    CHECK(ret == (int)head_len);
+    CHECK(parser.url() == "/index.html");
+    CHECK(parser.get_query_value("a") == "1");
+    CHECK(parser.get_header_value("accept-encoding") == "gzip, deflate, br");
+  }
+}
+
+TEST_CASE("http_parser rejects control chars at any offset") {
+  // long enough to go through the simd loops, every position is checked.
+  std::string value(100, 'v');
+  for (size_t i = 0; i < value.size(); ++i) {
+    std::string bad_value = value;
+    bad_value[i] = '\x01';
+    std::string req = "GET / HTTP/1.1\r\nX-Long-Header: " + bad_value +
+                      "\r\nHost: cinatra\r\n\r\n";
+    http_parser parser{};
+    CHECK(parser.parse_request(req.data(), req.size(), 0) == -1);
+
+    // a leading tab is whitespace before the value.
+    std::string tab_value = value;
+    tab_value[i == 0 ? 1 : i] = '\t';
+    req = "GET / HTTP/1.1\r\nX-Long-Header: " + tab_value +
+          "\r\nHost: cinatra\r\n\r\n";
+    CHECK(parser.parse_request(req.data(), req.size(), 0) == (int)req.size());
+    CHECK(parser.get_header_value("x-long-header") == tab_value);
+
+    std::string name(60, 'n');
+    name[i % name.size()] = '@';
+    req = "GET / HTTP/1.1\r\n" + name + ": v\r\n\r\n";
+    CHECK(parser.parse_request(req.data(), req.size(), 0) == -1);
+
+    std::string path = "/" + value;
+    path[i] = '\x7f';
+    req = "GET " + path + " HTTP/1.1\r\nHost: cinatra\r\n\r\n";
+    CHECK(parser.parse_request(req.data(), req.size(), 0) == -1);
+  }
+}
+
 std::string_view req_str =
     "R(GET /wp-content/uploads/2010/03/hello-kitty-darth-vader-pink.jpg "
     "HTTP/1.1\r\n"
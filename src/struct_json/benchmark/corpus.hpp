@@ -0,0 +1,90 @@
+#pragma once
+#include <string>
+
+// synthetic documents shaped like the twitter, citm_catalog and canada
+// corpora, shared by the benchmarks.
+namespace bench {
+// pretty printed statuses with long texts and a lot of unknown metadata.
+inline std::string make_twitter(int n) {
+  std::string json = "{\n  \"statuses\": [\n";
+  for (int i = 0; i < n; ++i) {
+    json += i ? ",\n" : "";
+    json += "    {\n      \"metadata\": {\"result_type\": \"recent\", "
+            "\"iso_language_code\": \"ja\"},\n";
+    json += "      \"created_at\": \"Sun Aug 31 00:29:15 +0000 2014\",\n";
+    json += "      \"id\": " + std::to_string(505874924095815681 + i) + ",\n";
+    json += "      \"text\": \"@aym0566x \\n\\u540d\\u524d:\\u524d\\u7530 "
+            "RT \\\"quoted\\\" " +
+            std::string(80 + i % 40, 'x') + "\",\n";
+    json += "      \"source\": \"<a href=\\\"http://twitter.com/download/"
+            "iphone\\\" rel=\\\"nofollow\\\">Twitter for iPhone</a>\",\n";
+    json += "      \"entities\": {\"hashtags\": [], \"urls\": [{\"url\": "
+            "\"http://t.co/x\", \"indices\": [0, 22]}], \"user_mentions\": "
+            "[{\"screen_name\": \"aym0566x\", \"indices\": [0, 9]}]},\n";
+    json += "      \"user\": {\n        \"id\": " + std::to_string(1186275104 + i) +
+            ",\n        \"screen_name\": \"ayuu0123\",\n";
+    json += "        \"description\": \"" + std::string(120, 'd') +
+            " {not json} [either]\",\n";
+    json += "        \"profile_background_color\": \"C0DEED\",\n"
+            "        \"followers_count\": 262,\n"
+            "        \"protected\": false\n      },\n";
+    json += "      \"retweet_count\": 0,\n      \"favorited\": false,\n"
+            "      \"lang\": \"ja\"\n    }";
+  }
+  json += "\n  ]\n}";
+  return json;
+}
+
+// unknown maps of events and topics before the performances.
+inline std::string make_citm(int n) {
+  std::string json = "{\"events\": {";
+  for (int i = 0; i < n; ++i) {
+    json += i ? "," : "";
+    json += "\"" + std::to_string(138586341 + i) +
+            "\": {\"description\": null, \"id\": " +
+            std::to_string(138586341 + i) +
+            ", \"logo\": \"/images/UE0AAAAACEKo6QAAAAVDSVRN\", \"name\": "
+            "\"30th Anniversary Tour\", \"subTopicIds\": [337184269, "
+            "337184283], \"subjectCode\": null, \"subtitle\": null, "
+            "\"topicIds\": [324846099, 107888604]}";
+  }
+  json += "}, \"topicNames\": {";
+  for (int i = 0; i < n; ++i) {
+    json += i ? "," : "";
+    json += "\"" + std::to_string(107888604 + i) + "\": \"Jazz " +
+            std::to_string(i) + "\"";
+  }
+  json += "}, \"performances\": [";
+  for (int i = 0; i < n; ++i) {
+    json += i ? "," : "";
+    json += "{\"eventId\": 138586341, \"id\": " + std::to_string(339887544 + i) +
+            ", \"logo\": null, \"name\": null, \"prices\": [{\"amount\": "
+            "90250, \"audienceSubCategoryId\": 337100890, \"seatCategoryId\": "
+            "338937295}], \"seatCategories\": [{\"areas\": [{\"areaId\": "
+            "205705999, \"blockIds\": []}], \"seatCategoryId\": 338937295}], "
+            "\"start\": " +
+            std::to_string(1372701600000 + i) + ", \"venueCode\": \"PLEYEL\"}";
+  }
+  json += "]}";
+  return json;
+}
+
+// mostly numbers, every feature with unknown properties.
+inline std::string make_canada(int n) {
+  std::string json = "{\"type\": \"FeatureCollection\", \"features\": [";
+  for (int i = 0; i < n; ++i) {
+    json += i ? "," : "";
+    json += "{\"type\": \"Feature\", \"properties\": {\"name\": \"Canada\", "
+            "\"bbox\": [-141.0, 41.67, -52.62, 83.11]}, \"geometry\": "
+            "{\"type\": \"Polygon\", \"coordinates\": [[";
+    for (int j = 0; j < 200; ++j) {
+      json += j ? "," : "";
+      json += "[-" + std::to_string(65.613616999999977 + j * 0.001) + "," +
+              std::to_string(43.420273000000009 + i * 0.001) + "]";
+    }
+    json += "]]}}";
+  }
+  json += "]}";
+  return json;
+}
+}  // namespace bench
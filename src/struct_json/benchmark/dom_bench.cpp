@@ -0,0 +1,102 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include "corpus.hpp"
+#include "ylt/struct_json/json_reader.h"
+
+/*
+parse the whole documents into the jvalue dom and into the json_document,
+then sum the numbers and the lengths of the strings by walking the dom:
+./struct_json_dom_benchmark [rounds]
+*/
+
+using namespace bench;
+
+double walk(const iguana::jvalue &value) {
+  if (value.is_array()) {
+    double sum = 0;
+    for (auto &v : std::get<iguana::jarray>(value)) {
+      sum += walk(v);
+    }
+    return sum;
+  }
+  if (value.is_object()) {
+    double sum = 0;
+    for (auto &[k, v] : std::get<iguana::jobject>(value)) {
+      sum += k.size() + walk(v);
+    }
+    return sum;
+  }
+  if (value.is_string()) {
+    return std::get<std::string>(value).size();
+  }
+  if (value.is_int()) {
+    return value.get<int>();
+  }
+  if (value.is_double()) {
+    return value.get<double>();
+  }
+  return 0;
+}
+
+double walk(const iguana::json_element &value) {
+  if (value.is_array() || value.is_object()) {
+    double sum = 0;
+    for (auto v : value) {
+      sum += (value.is_object() ? v.key().size() : 0) + walk(v);
+    }
+    return sum;
+  }
+  if (value.is_string()) {
+    return value.size();
+  }
+  if (value.is_number()) {
+    return value.get<double>();
+  }
+  return 0;
+}
+
+template <typename F>
+void run(const char *name, const std::string &json, size_t rounds, F &&f) {
+  double sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < rounds; ++i) {
+    sink += f();
+  }
+  auto end = std::chrono::steady_clock::now();
+  static volatile double keep;
+  keep = sink;
+  auto us =
+      std::chrono::duration<double, std::micro>(end - start).count() / rounds;
+  std::printf("%-18s %10zu bytes %10.1f us %8.1f MB/s\n", name, json.size(),
+              us, json.size() / us);
+}
+
+void run(const char *name, const std::string &json, size_t rounds) {
+  std::string jvalue_name = std::string(name) + " jvalue";
+  run(jvalue_name.data(), json, rounds, [&] {
+    iguana::jvalue value;
+    iguana::parse(value, json.begin(), json.end());
+    return walk(value);
+  });
+  // reused between the rounds, as a server parsing the requests would.
+  iguana::json_document doc;
+  std::string document_name = std::string(name) + " document";
+  run(document_name.data(), json, rounds, [&] {
+    iguana::parse(doc, json);
+    return walk(doc.root());
+  });
+}
+
+int main(int argc, char **argv) {
+  size_t rounds = 100;
+  if (argc > 1) {
+    rounds = std::stoul(argv[1]);
+  }
+  run("twitter", make_twitter(1000), rounds);
+  run("citm", make_citm(2000), rounds);
+  run("canada", make_canada(100), rounds);
+  return 0;
+}
@@ -0,0 +1,97 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "corpus.hpp"
+#include "ylt/struct_json/json_reader.h"
+#include "ylt/struct_json/json_writer.h"
+
+/*
+parse synthetic documents shaped like the twitter, citm_catalog and canada
+corpora. The structs only declare a part of the fields, the rest are unknown
+values to skip. Compare with the baseline built without the simd scanners:
+./struct_json_benchmark [rounds]
+./struct_json_benchmark_baseline [rounds]
+*/
+
+namespace bench {
+struct user_t {
+  int64_t id;
+  std::string screen_name;
+};
+YLT_REFL(user_t, id, screen_name);
+
+struct status_t {
+  int64_t id;
+  std::string text;
+  user_t user;
+};
+YLT_REFL(status_t, id, text, user);
+
+struct twitter_t {
+  std::vector<status_t> statuses;
+};
+YLT_REFL(twitter_t, statuses);
+
+struct performance_t {
+  int64_t id;
+  int64_t start;
+};
+YLT_REFL(performance_t, id, start);
+
+struct citm_t {
+  std::vector<performance_t> performances;
+};
+YLT_REFL(citm_t, performances);
+
+struct geometry_t {
+  std::string type;
+  std::vector<std::vector<std::vector<double>>> coordinates;
+};
+YLT_REFL(geometry_t, type, coordinates);
+
+struct feature_t {
+  std::string type;
+  geometry_t geometry;
+};
+YLT_REFL(feature_t, type, geometry);
+
+struct canada_t {
+  std::string type;
+  std::vector<feature_t> features;
+};
+YLT_REFL(canada_t, type, features);
+}  // namespace bench
+
+using namespace bench;
+
+template <typename T>
+void run(const char *name, const std::string &json, size_t rounds) {
+  size_t sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < rounds; ++i) {
+    T t{};
+    iguana::from_json(t, json);
+    sink += sizeof(t);
+  }
+  auto end = std::chrono::steady_clock::now();
+  static volatile size_t keep;
+  keep = sink;
+  auto us =
+      std::chrono::duration<double, std::micro>(end - start).count() / rounds;
+  std::printf("%-8s %10zu bytes %10.1f us %8.1f MB/s\n", name, json.size(), us,
+              json.size() / us);
+}
+
+int main(int argc, char **argv) {
+  size_t rounds = 200;
+  if (argc > 1) {
+    rounds = std::stoul(argv[1]);
+  }
+  run<twitter_t>("twitter", make_twitter(1000), rounds);
+  run<citm_t>("citm", make_citm(2000), rounds);
+  run<canada_t>("canada", make_canada(100), rounds);
+  return 0;
+}
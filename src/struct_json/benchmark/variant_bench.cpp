@@ -0,0 +1,175 @@
+#define THROW_UNKNOWN_KEY
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "ylt/struct_json/json_reader.h"
+#include "ylt/struct_json/json_writer.h"
+
+/*
+parse polymorphic event payloads into std::variant members, by throwing
+from_json and by from_json with std::error_code, with and without a
+variant_tag on the event structs. The unknown keys are errors, so an event
+only matches its own alternative:
+./struct_json_variant_benchmark [rounds]
+*/
+
+namespace bench {
+struct click_t {
+  std::string type;
+  int64_t ts;
+  int x;
+  int y;
+};
+YLT_REFL(click_t, type, ts, x, y);
+
+struct key_press_t {
+  std::string type;
+  int64_t ts;
+  std::string key;
+};
+YLT_REFL(key_press_t, type, ts, key);
+
+struct scroll_t {
+  std::string type;
+  int64_t ts;
+  double delta;
+};
+YLT_REFL(scroll_t, type, ts, delta);
+
+struct resize_t {
+  std::string type;
+  int64_t ts;
+  int width;
+  int height;
+};
+YLT_REFL(resize_t, type, ts, width, height);
+
+// the same events, picked by their tags.
+struct tagged_click_t : click_t {};
+YLT_REFL(tagged_click_t, type, ts, x, y);
+struct tagged_key_press_t : key_press_t {};
+YLT_REFL(tagged_key_press_t, type, ts, key);
+struct tagged_scroll_t : scroll_t {};
+YLT_REFL(tagged_scroll_t, type, ts, delta);
+struct tagged_resize_t : resize_t {};
+YLT_REFL(tagged_resize_t, type, ts, width, height);
+
+using value_t = std::variant<int64_t, double, std::string, bool>;
+
+struct event_log_t {
+  std::vector<std::variant<click_t, key_press_t, scroll_t, resize_t>> events;
+  std::vector<value_t> values;
+};
+YLT_REFL(event_log_t, events, values);
+
+struct tagged_event_log_t {
+  std::vector<std::variant<tagged_click_t, tagged_key_press_t, tagged_scroll_t,
+                           tagged_resize_t>>
+      events;
+  std::vector<value_t> values;
+};
+YLT_REFL(tagged_event_log_t, events, values);
+}  // namespace bench
+
+#define BENCH_TAG(T, name)                          \
+  template <>                                       \
+  struct iguana::variant_tag<bench::T> {            \
+    static constexpr std::string_view key = "type"; \
+    static constexpr std::string_view value = name; \
+  };
+BENCH_TAG(tagged_click_t, "click")
+BENCH_TAG(tagged_key_press_t, "key")
+BENCH_TAG(tagged_scroll_t, "scroll")
+BENCH_TAG(tagged_resize_t, "resize")
+
+using namespace bench;
+
+// the events are mixed evenly, so the last alternative is as common as the
+// first one. Every event fails the earlier alternatives only by its members,
+// which is the worst case of trying them in order.
+std::string make_events(int n) {
+  std::string json = R"({"events": [)";
+  for (int i = 0; i < n; ++i) {
+    json += i ? "," : "";
+    auto ts = std::to_string(1700000000000 + i);
+    switch (i % 4) {
+      case 0:
+        json += R"({"type": "click", "ts": )" + ts + R"(, "x": 10, "y": 20})";
+        break;
+      case 1:
+        json += R"({"type": "key", "ts": )" + ts + R"(, "key": "enter"})";
+        break;
+      case 2:
+        json += R"({"type": "scroll", "ts": )" + ts + R"(, "delta": -1.5})";
+        break;
+      case 3:
+        json += R"({"type": "resize", "ts": )" + ts +
+                R"(, "width": 1920, "height": 1080})";
+        break;
+    }
+  }
+  json += R"(], "values": [)";
+  for (int i = 0; i < n; ++i) {
+    json += i ? "," : "";
+    switch (i % 4) {
+      case 0:
+        json += std::to_string(i);
+        break;
+      case 1:
+        json += std::to_string(i) + ".25";
+        break;
+      case 2:
+        json += R"("value)" + std::to_string(i) + R"(")";
+        break;
+      case 3:
+        json += i % 8 == 3 ? "true" : "false";
+        break;
+    }
+  }
+  json += "]}";
+  return json;
+}
+
+template <typename T, bool error_code>
+void run(const char *name, const std::string &json, size_t rounds) {
+  size_t sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < rounds; ++i) {
+    T t{};
+    if constexpr (error_code) {
+      std::error_code ec;
+      iguana::from_json(t, json, ec);
+      if (ec) {
+        std::abort();
+      }
+    }
+    else {
+      iguana::from_json(t, json);
+    }
+    sink += t.events.size() + t.values.size();
+  }
+  auto end = std::chrono::steady_clock::now();
+  static volatile size_t keep;
+  keep = sink;
+  auto us =
+      std::chrono::duration<double, std::micro>(end - start).count() / rounds;
+  std::printf("%-20s %10zu bytes %10.1f us %8.1f MB/s\n", name, json.size(),
+              us, json.size() / us);
+}
+
+int main(int argc, char **argv) {
+  size_t rounds = 100;
+  if (argc > 1) {
+    rounds = std::stoul(argv[1]);
+  }
+  auto json = make_events(10000);
+  run<event_log_t, false>("untagged", json, rounds);
+  run<event_log_t, true>("untagged error_code", json, rounds);
+  run<tagged_event_log_t, false>("tagged", json, rounds);
+  run<tagged_event_log_t, true>("tagged error_code", json, rounds);
+  return 0;
+}
@@ -0,0 +1,98 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "ylt/struct_json/json_writer.h"
+
+/*
+serialize api responses: mostly ascii strings without escapes, 64 bits
+integers and doubles. Written into a new string and into a reused one:
+./struct_json_writer_benchmark [rounds]
+*/
+
+namespace bench {
+struct account_t {
+  int64_t id;
+  std::string name;
+  std::string email;
+  std::string bio;
+  int64_t created_at;
+  double balance;
+  bool verified;
+  std::vector<std::string> tags;
+  std::vector<int64_t> follower_ids;
+};
+YLT_REFL(account_t, id, name, email, bio, created_at, balance, verified, tags,
+         follower_ids);
+
+struct response_t {
+  int code;
+  std::string message;
+  std::vector<account_t> accounts;
+};
+YLT_REFL(response_t, code, message, accounts);
+}  // namespace bench
+
+using namespace bench;
+
+response_t make_response(int n) {
+  response_t r{200, "ok", {}};
+  for (int i = 0; i < n; ++i) {
+    account_t a;
+    a.id = 1186275104000 + i;
+    a.name = "user_" + std::to_string(i);
+    a.email = a.name + "@example.com";
+    a.bio = std::string(60 + i % 80, 'b');
+    // one account in 16 has a line break in its bio.
+    if (i % 16 == 0) {
+      a.bio.insert(a.bio.size() / 2, "\n");
+    }
+    a.created_at = 1700000000000 + i * 1000;
+    a.balance = i * 10.25;
+    a.verified = i % 3 == 0;
+    a.tags = {"rust", "c++", "json"};
+    for (int j = 0; j < 8; ++j) {
+      a.follower_ids.push_back(900000000000 + i * 8 + j);
+    }
+    r.accounts.push_back(std::move(a));
+  }
+  return r;
+}
+
+template <typename F>
+void run(const char *name, size_t rounds, F &&f) {
+  size_t sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < rounds; ++i) {
+    sink += f();
+  }
+  auto end = std::chrono::steady_clock::now();
+  static volatile size_t keep;
+  keep = sink;
+  auto us =
+      std::chrono::duration<double, std::micro>(end - start).count() / rounds;
+  std::printf("%-14s %10zu bytes %10.1f us %8.1f MB/s\n", name, sink / rounds,
+              us, sink / rounds / us);
+}
+
+int main(int argc, char **argv) {
+  size_t rounds = 200;
+  if (argc > 1) {
+    rounds = std::stoul(argv[1]);
+  }
+  auto response = make_response(2000);
+  run("new string", rounds, [&] {
+    std::string json;
+    iguana::to_json(response, json);
+    return json.size();
+  });
+  std::string buffer;
+  run("reused string", rounds, [&] {
+    buffer.clear();
+    iguana::to_json(response, buffer);
+    return buffer.size();
+  });
+  return 0;
+}
@@ -12,7 +12,6 @@
 #define THROW_UNKNOWN_KEY
 #endif
 
-// #define SEQUENTIAL_PARSE
 #include <iostream>
 #include <optional>
 
@@ -0,0 +1,95 @@
+#include <string>
+#include <vector>
+
+#include "doctest.h"
+#include "ylt/struct_json/json_reader.h"
+
+TEST_CASE("test json document") {
+  std::string json = R"( {"name": "tom", "age": 20, "height": 1.75,
+      "tags": ["a", "b\nä", 3, null, true, false, [], {}],
+      "big": 18446744073709551615, "neg": -3, "exp": 1e3,
+      "child": {"name": "jerry", "empty": ""}} )";
+  iguana::json_document doc;
+  iguana::parse(doc, json);
+  auto root = doc.root();
+  CHECK(root.is_object());
+  CHECK(root.size() == 8);
+  CHECK(root.at("name").get<std::string_view>() == "tom");
+  CHECK(root["age"].get<int>() == 20);
+  CHECK(root["age"].get<double>() == 20);
+  CHECK(root["height"].is_double());
+  CHECK(root["height"].get<double>() == 1.75);
+  CHECK(root["big"].is_double());
+  CHECK(root["neg"].get<int8_t>() == -3);
+  CHECK(root["exp"].get<double>() == 1000);
+  CHECK(root["child"]["name"].get<std::string>() == "jerry");
+  CHECK(root["child"]["empty"].get<std::string_view>().empty());
+
+  auto tags = root["tags"];
+  REQUIRE(tags.is_array());
+  CHECK(tags.size() == 8);
+  CHECK(tags[1].get<std::string_view>() == "b\n\xc3\xa4");
+  CHECK(tags[2].get<int>() == 3);
+  CHECK(tags[3].is_null());
+  CHECK(tags[4].get<bool>());
+  CHECK(!tags[5].get<bool>());
+  CHECK(tags[6].size() == 0);
+  CHECK(tags[7].is_object());
+  CHECK(tags[7].begin() == tags[7].end());
+  CHECK_THROWS_AS(tags.at(8), std::out_of_range);
+
+  // the members in the order of the document.
+  std::vector<std::string_view> keys;
+  for (auto value : root) {
+    keys.push_back(value.key());
+  }
+  CHECK(keys == std::vector<std::string_view>{"name", "age", "height", "tags",
+                                              "big", "neg", "exp", "child"});
+  size_t count = 0;
+  for (auto value : tags) {
+    CHECK_THROWS(value.key());
+    ++count;
+  }
+  CHECK(count == 8);
+
+  // the strings without escapes are views of the buffer.
+  auto name = root["name"].get<std::string_view>();
+  CHECK(name.data() > json.data());
+  CHECK(name.data() < json.data() + json.size());
+
+  CHECK(!root.find("unknown"));
+  CHECK(root.contains("age"));
+  CHECK_THROWS_AS(root.at("unknown"), std::invalid_argument);
+  CHECK_THROWS_AS(root["age"].get<std::string>(), std::invalid_argument);
+  CHECK_THROWS_AS(root["neg"].get<unsigned>(), std::invalid_argument);
+  std::error_code ec;
+  root["name"].get<int>(ec);
+  CHECK(ec);
+  int age = 0;
+  CHECK(!root["age"].get_to(age));
+  CHECK(age == 20);
+
+  iguana::parse(doc, std::string_view("[1, 2]"), true);
+  CHECK(doc.root()[0].is_double());
+
+  iguana::json_document moved(std::move(doc));
+  CHECK(moved.root()[1].get<double>() == 2);
+}
+
+TEST_CASE("test json document errors") {
+  iguana::json_document doc;
+  std::error_code ec;
+  for (std::string_view json :
+       {"", "[1, 2", R"({"a" 1})", R"({"a": 1,})", "[1 2]", "tru", "1.5x",
+        R"("\u12g4")", R"("abc)", "[1] 2", "{1: 2}"}) {
+    iguana::parse(doc, json, ec);
+    CHECK_MESSAGE(ec, json);
+    CHECK(doc.empty());
+    CHECK_THROWS(iguana::parse(doc, json));
+  }
+  std::string json = R"([{"a": "\"x\""}, "\t"])";
+  iguana::parse(doc, json.begin(), json.end(), ec);
+  CHECK(!ec);
+  CHECK(doc.root()[0]["a"].get<std::string_view>() == "\"x\"");
+  CHECK(doc.root()[1].get<std::string_view>() == "\t");
+}
@@ -0,0 +1,266 @@
+#include <list>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "doctest.h"
+#include "ylt/struct_json/json_reader.h"
+#include "ylt/struct_json/json_writer.h"
+
+namespace test_json_error_code {
+enum class color { red, green };
+
+struct point_t {
+  int x;
+  int y;
+  bool operator==(const point_t &) const = default;
+};
+YLT_REFL(point_t, x, y);
+
+struct record_t {
+  std::string name;
+  std::vector<point_t> points;
+  std::map<std::string, double> scores;
+  std::optional<int> age;
+  std::unique_ptr<point_t> origin;
+  std::tuple<int, std::string> pair;
+  std::array<int, 3> triple;
+  char flag;
+  bool ok;
+  color c;
+};
+YLT_REFL(record_t, name, points, scores, age, origin, pair, triple, flag, ok,
+         c);
+
+struct click_event {
+  std::string type;
+  int x;
+  int y;
+  bool operator==(const click_event &) const = default;
+};
+YLT_REFL(click_event, type, x, y);
+
+struct key_event {
+  std::string type;
+  int x;
+  std::string key;
+  bool operator==(const key_event &) const = default;
+};
+YLT_REFL(key_event, type, x, key);
+
+struct custom_t {
+  int a, b;
+  bool operator==(const custom_t &) const = default;
+};
+void ylt_custom_reflect(custom_t *) {}
+
+template <typename It>
+IGUANA_INLINE void from_json_impl(custom_t &value, It &&it, It &&end) {
+  iguana::from_json(*(int(*)[2]) & value, it, end);
+}
+
+using event_t = std::variant<click_event, key_event>;
+
+// the names of the same length share characters.
+struct keys_t {
+  int ab;
+  int ac;
+  int bb;
+  int abc;
+  int b;
+  std::string name;
+  int identifier_1;
+  int identifier_2;
+  bool operator==(const keys_t &) const = default;
+};
+YLT_REFL(keys_t, ab, ac, bb, abc, b, name, identifier_1, identifier_2);
+}  // namespace test_json_error_code
+
+template <>
+struct iguana::variant_tag<test_json_error_code::click_event> {
+  static constexpr std::string_view key = "type";
+  static constexpr std::string_view value = "click";
+};
+
+template <>
+struct iguana::variant_tag<test_json_error_code::key_event> {
+  static constexpr std::string_view key = "type";
+  static constexpr std::string_view value = "key";
+};
+
+using namespace test_json_error_code;
+
+template <typename T>
+void check_same_error(std::string_view json) {
+  std::string thrown;
+  try {
+    T t{};
+    iguana::from_json(t, json);
+  } catch (std::exception &e) {
+    thrown = e.what();
+  }
+  T t{};
+  std::error_code ec;
+  iguana::from_json(t, json, ec);
+  CHECK(!thrown.empty());
+  CHECK(ec);
+  CHECK(ec.message() == thrown);
+}
+
+TEST_CASE("test json error code") {
+  std::string json =
+      R"({"name": "tom\nä", "points": [{"x": 1, "y": 2}], "scores":
+      {"a": 1.5}, "age": null, "origin": {"x": 3, "y": 4}, "pair": [1, "b"],
+      "triple": [1, 2, 3], "flag": "f", "ok": true, "c": 1, "more": [{}]})";
+  record_t r;
+  std::error_code ec;
+  iguana::from_json(r, json, ec);
+  CHECK(!ec);
+  CHECK(r.name == "tom\n\xc3\xa4");
+  CHECK(r.points == std::vector<point_t>{{1, 2}});
+  CHECK(r.scores["a"] == 1.5);
+  CHECK(!r.age.has_value());
+  CHECK(*r.origin == point_t{3, 4});
+  CHECK(std::get<1>(r.pair) == "b");
+  CHECK(r.triple[2] == 3);
+  CHECK(r.flag == 'f');
+  CHECK(r.ok);
+  CHECK(r.c == color::green);
+
+  std::string points = R"([{"x": 1, "y": 2}, {"y": 4, "x": 3}])";
+  std::list<char> list(points.begin(), points.end());
+  std::vector<std::map<std::string, int>> v;
+  iguana::from_json(v, list.begin(), list.end(), ec);
+  CHECK(!ec);
+  REQUIRE(v.size() == 2);
+  CHECK(v[1]["x"] == 3);
+  list.pop_back();
+  iguana::from_json(v, list.begin(), list.end(), ec);
+  CHECK(ec);
+
+  check_same_error<record_t>(R"({"name": "tom)");
+  check_same_error<record_t>(R"({"name": "tom", "points": [{"x": 1.5}]})");
+  check_same_error<record_t>(R"({"name": "\u12g4"})");
+  check_same_error<record_t>(R"({"ok": tru})");
+  check_same_error<record_t>(R"({"points": [{"x": 1} {"x": 2}]})");
+  check_same_error<record_t>(R"({"scores": {"a" 1}})");
+  check_same_error<record_t>(R"({"triple": [1, 2; 3]})");
+  check_same_error<record_t>(R"({"name": "tom" /x })");
+  check_same_error<point_t>(R"({"x": 1, "y": 2)");
+  check_same_error<std::vector<int>>("[0,1.0]");
+  check_same_error<int>("1A");
+}
+
+TEST_CASE("test json variant by the first character") {
+  using var_t = std::variant<int, double, std::string, bool, point_t,
+                             std::vector<int>, std::optional<color>>;
+  auto read = [](std::string_view json) {
+    var_t v;
+    std::error_code ec;
+    iguana::from_json(v, json, ec);
+    REQUIRE(!ec);
+    var_t v2;
+    iguana::from_json(v2, json);
+    CHECK(v == v2);
+    return v;
+  };
+  CHECK(std::get<int>(read("42")) == 42);
+  CHECK(std::get<double>(read("-4.5")) == -4.5);
+  CHECK(std::get<double>(read("1e3")) == 1000);
+  CHECK(std::get<std::string>(read(R"("hi")")) == "hi");
+  CHECK(std::get<bool>(read("false")) == false);
+  CHECK(std::get<point_t>(read(R"({"x": 1, "y": 2})")) == point_t{1, 2});
+  CHECK(std::get<std::vector<int>>(read("[1, 2]")) == std::vector<int>{1, 2});
+  CHECK(!std::get<std::optional<color>>(read("null")).has_value());
+
+  // the values in a struct, the candidates are tried in order.
+  std::vector<std::variant<uint8_t, int64_t, double>> numbers;
+  iguana::from_json(numbers, std::string_view("[1, 300, -1, 0.5]"));
+  REQUIRE(numbers.size() == 4);
+  CHECK(numbers[0].index() == 0);
+  CHECK(numbers[1].index() == 1);
+  CHECK(numbers[2].index() == 1);
+  CHECK(numbers[3].index() == 2);
+
+  std::variant<int, point_t> v;
+  std::error_code ec;
+  iguana::from_json(v, std::string_view(R"("text")"), ec);
+  CHECK(ec);
+  CHECK_THROWS(iguana::from_json(v, std::string_view(R"("text")")));
+  iguana::from_json(v, std::string_view(R"({"x": "y"})"), ec);
+  CHECK(ec);
+
+  std::variant<int, custom_t> custom;
+  iguana::from_json(custom, std::string_view("[1, 2]"), ec);
+  CHECK(!ec);
+  CHECK(std::get<custom_t>(custom) == custom_t{1, 2});
+}
+
+TEST_CASE("test json variant by tag") {
+  std::vector<event_t> events{click_event{"click", 1, 2},
+                              key_event{"key", 3, "enter"}};
+  std::string json;
+  iguana::to_json(events, json);
+  std::vector<event_t> events2;
+  std::error_code ec;
+  iguana::from_json(events2, json, ec);
+  CHECK(!ec);
+  CHECK(events2 == events);
+
+  // the tag isn't the first member.
+  event_t event;
+  iguana::from_json(
+      event,
+      std::string_view(R"({"x": 5, "key": "a", "sub": {"type": "click"},
+      "type": "key"})"));
+  CHECK(std::get<key_event>(event) == key_event{"key", 5, "a"});
+
+  // an unknown tag, tried in order.
+  iguana::from_json(event, std::string_view(R"({"type": "drag", "x": 1})"));
+  CHECK(std::get<click_event>(event) == click_event{"drag", 1, 0});
+
+  // the tagged alternative is the only one tried.
+  iguana::from_json(event, std::string_view(R"({"type": "click", "x": "a"})"),
+                    ec);
+  CHECK(ec);
+}
+
+TEST_CASE("test json member matcher") {
+  using matcher = iguana::detail::member_matcher<keys_t>;
+  CHECK(matcher::find("ab", 0) == 0);
+  CHECK(matcher::find("ac", 0) == 1);
+  CHECK(matcher::find("bb", 1) == 2);
+  CHECK(matcher::find("abc", 5) == 3);
+  CHECK(matcher::find("b", 0) == 4);
+  CHECK(matcher::find("name", 5) == 5);
+  CHECK(matcher::find("identifier_2", 6) == 7);
+  CHECK(matcher::find("identifier_3", 6) == matcher::count);
+  CHECK(matcher::find("ba", 0) == matcher::count);
+  CHECK(matcher::find("nam", 0) == matcher::count);
+  CHECK(matcher::find("", 0) == matcher::count);
+  // "ab" has no character which no other name of length 2 has.
+  CHECK(matcher::positions[0] == matcher::npos);
+  CHECK(matcher::positions[1] == 1);
+  CHECK(matcher::positions[3] == 0);
+
+  keys_t expected{1, 2, 3, 4, 5, "x", 6, 7};
+  for (std::string_view json :
+       {R"({"ab": 1, "ac": 2, "bb": 3, "abc": 4, "b": 5, "name": "x",
+            "identifier_1": 6, "identifier_2": 7})",
+        R"({"identifier_2": 7, "identifier_1": 6, "name": "x", "b": 5,
+            "abc": 4, "bb": 3, "ac": 2, "ab": 1})",
+        R"({"bb": 3, "ab": 1, "x": [], "name": "x", "ac": 2, "b": 5,
+            "identifier_1": 6, "abc": 4, "ba": 0, "identifier_2": 7})"}) {
+    keys_t k{};
+    iguana::from_json(k, json);
+    CHECK(k == expected);
+    keys_t k2{};
+    std::error_code ec;
+    iguana::from_json(k2, json, ec);
+    CHECK(!ec);
+    CHECK(k2 == expected);
+  }
+}
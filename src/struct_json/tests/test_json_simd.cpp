@@ -0,0 +1,163 @@
+#include <random>
+#include <string>
+#include <vector>
+
+#include "doctest.h"
+#include "ylt/struct_json/json_reader.h"
+#include "ylt/struct_json/json_writer.h"
+
+namespace test_json_simd {
+struct known_t {
+  int id;
+  std::string name;
+  bool operator==(const known_t &) const = default;
+};
+YLT_REFL(known_t, id, name);
+
+struct nested_t {
+  std::vector<known_t> items;
+  std::string_view tag;
+};
+YLT_REFL(nested_t, items, tag);
+
+// the reference of find_escaped: a backslash escapes the next character
+// unless it's escaped itself.
+uint64_t escaped_by_bytes(const std::string &s, bool &carry) {
+  uint64_t ret = 0;
+  for (std::size_t i = 0; i < s.size(); ++i) {
+    if (carry) {
+      ret |= uint64_t{1} << i;
+      carry = false;
+    }
+    else if (s[i] == '\\') {
+      carry = true;
+    }
+  }
+  return ret;
+}
+}  // namespace test_json_simd
+
+using namespace test_json_simd;
+
+TEST_CASE("test json block masks") {
+  std::mt19937 gen(42);
+  const char chars[] = {'\\', '"', 'a', '{', '}', ' ', '\n', '/', (char)0xe4};
+  uint64_t prev_escaped = 0;
+  bool carry = false;
+  for (int round = 0; round < 1000; ++round) {
+    std::string s(64, ' ');
+    for (auto &c : s) {
+      c = chars[gen() % sizeof(chars)];
+    }
+    iguana::detail::json_block block(s.data());
+    uint64_t quote = 0;
+    for (std::size_t i = 0; i < s.size(); ++i) {
+      quote |= uint64_t(s[i] == '"') << i;
+    }
+    CHECK(block.eq('"') == quote);
+    CHECK(iguana::detail::find_escaped(block.eq('\\'), prev_escaped) ==
+          escaped_by_bytes(s, carry));
+    CHECK(prev_escaped == carry);
+  }
+  CHECK(iguana::detail::prefix_xor(0b1001000) == 0b0111000);
+}
+
+TEST_CASE("test skip unknown values by blocks") {
+  std::string values[] = {
+      R"({"a": {"b": [1, 2, {"c": "}}]]"}], "d": "\\"}, "e": {}})",
+      R"([[1, 2], ["]", "\"]"], {"x": [3, "[[["]}, "\\\\"])",
+      R"({"s": "\\\"}\\", "t": [/* } ] */ 1, // }
+      2], "u": {"v": "/*"}})",
+      R"("a string with } and ] and \" inside")",
+      R"(12345)",
+      R"({"long": ")" + std::string(200, 'x') + R"(\"}", "more": [)" +
+          std::string(130, ' ') + R"(]})",
+  };
+  for (auto &value : values) {
+    // move the value across the 64 bytes blocks.
+    for (std::size_t pad = 0; pad < 70; pad += 3) {
+      std::string json = R"({"unknown": )" + std::string(pad, ' ') + value +
+                         R"(, "id": 42, "other": )" + value +
+                         R"(, "name": "tom"})";
+      known_t t{};
+      iguana::from_json(t, json);
+      CHECK(t == known_t{42, "tom"});
+    }
+  }
+}
+
+TEST_CASE("test json strings by vectors") {
+  for (std::size_t len = 0; len < 100; ++len) {
+    for (std::size_t pos = 0; pos <= len; pos += 7) {
+      std::string s(len, 'x');
+      s.insert(pos, "\"\\\n");
+      known_t t{1, s};
+      std::string json;
+      iguana::to_json(t, json);
+      known_t t2{};
+      iguana::from_json(t2, json);
+      CHECK(t2 == t);
+    }
+  }
+
+  // pretty printed, the indentation is skipped by vectors.
+  std::string json = "{\n" + std::string(40, ' ') + "\"items\": [\n" +
+                     std::string(80, ' ') + "{\"id\": 1,\n" +
+                     std::string(17, '\t') + "\"name\": \"a\"}\n" +
+                     std::string(33, ' ') + "],\n \"tag\": \"" +
+                     std::string(50, 'v') + "\"}";
+  nested_t n{};
+  iguana::from_json(n, json);
+  REQUIRE(n.items.size() == 1);
+  CHECK(n.items[0] == known_t{1, "a"});
+  CHECK(n.tag == std::string(50, 'v'));
+}
+
+TEST_CASE("test json writer by vectors") {
+  const std::string specials[] = {"\"", "\\", "\n", "\x01", "\x1f", "\xc3\xa4",
+                                  "\xe4\xb8\xad"};
+  const std::string escaped[] = {R"(\")",     R"(\\)",     R"(\n)",
+                                 R"(\u0001)", R"(\u001F)", R"(\u00E4)",
+                                 R"(\u4E2D)"};
+  for (std::size_t len = 0; len < 100; ++len) {
+    for (std::size_t pos = 0; pos <= len; pos += 5) {
+      for (std::size_t i = 0; i < std::size(specials); ++i) {
+        std::string s(len, 'x');
+        s.insert(pos, specials[i]);
+        std::string json;
+        iguana::to_json(s, json);
+        std::string expected = "\"" + std::string(pos, 'x') + escaped[i] +
+                               std::string(len - pos, 'x') + "\"";
+        CHECK(json == expected);
+      }
+    }
+  }
+
+  std::vector<int64_t> ints{0,
+                            -1,
+                            9,
+                            -99999999,
+                            100000000,
+                            4294967295,
+                            4294967296,
+                            (std::numeric_limits<int64_t>::max)(),
+                            (std::numeric_limits<int64_t>::min)()};
+  std::string json;
+  iguana::to_json(ints, json);
+  CHECK(json ==
+        "[0,-1,9,-99999999,100000000,4294967295,4294967296,"
+        "9223372036854775807,-9223372036854775808]");
+  json.clear();
+  iguana::to_json((std::numeric_limits<uint64_t>::max)(), json);
+  CHECK(json == "18446744073709551615");
+
+  // the size hint is an upper bound when nothing is escaped.
+  nested_t n{{{-1, "a"}, {(std::numeric_limits<int>::min)(), "bcd"}}, "tag"};
+  json.clear();
+  iguana::to_json(n, json);
+  CHECK(iguana::detail::json_size_hint(n) >= json.size());
+  // appended to the existing content.
+  std::string prefix = "prefix";
+  iguana::to_json(n, prefix);
+  CHECK(prefix == "prefix" + json);
+}
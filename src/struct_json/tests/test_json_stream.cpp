@@ -0,0 +1,160 @@
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "async_simple/coro/SyncAwait.h"
+#include "doctest.h"
+#include "ylt/coro_io/coro_file.hpp"
+#include "ylt/struct_json/json_stream.h"
+#include "ylt/struct_json/json_writer.h"
+
+namespace test_json_stream {
+struct record_t {
+  int id;
+  std::string name;
+  std::vector<int> values;
+  bool operator==(const record_t &) const = default;
+};
+YLT_REFL(record_t, id, name, values);
+
+std::vector<record_t> make_records(int n) {
+  std::vector<record_t> records;
+  for (int i = 0; i < n; ++i) {
+    records.push_back(
+        {i, "name \"" + std::to_string(i) + "\" ]}\\", {i, i + 1, i + 2}});
+  }
+  return records;
+}
+
+// read json split into the chunks of chunk_size bytes.
+template <typename T>
+std::vector<T> read_by_chunks(std::string_view json, size_t chunk_size) {
+  std::vector<T> result;
+  iguana::json_array_reader<T> reader;
+  for (size_t pos = 0; pos < json.size(); pos += chunk_size) {
+    reader.feed(json.substr(pos, chunk_size), [&](T &&t) {
+      result.push_back(std::move(t));
+    });
+  }
+  reader.finish();
+  return result;
+}
+}  // namespace test_json_stream
+
+using namespace test_json_stream;
+
+TEST_CASE("test json array reader") {
+  auto records = make_records(5);
+  std::string json;
+  iguana::to_json(records, json);
+  json = " \n" + json + " ";
+  for (size_t chunk_size = 1; chunk_size <= json.size(); ++chunk_size) {
+    CHECK(read_by_chunks<record_t>(json, chunk_size) == records);
+  }
+
+  for (size_t chunk_size = 1; chunk_size <= 24; ++chunk_size) {
+    auto values = read_by_chunks<std::string>(
+        R"(["a", "b\"", "", "中"])", chunk_size);
+    CHECK(values == std::vector<std::string>{"a", "b\"", "", "\xe4\xb8\xad"});
+    CHECK(read_by_chunks<double>("[1, -2.5e3,3 ]", chunk_size) ==
+          std::vector<double>{1, -2500, 3});
+    CHECK(read_by_chunks<std::vector<int>>("[[1], [], [2,3]]", chunk_size) ==
+          std::vector<std::vector<int>>{{1}, {}, {2, 3}});
+  }
+  CHECK(read_by_chunks<int>("[]", 1).empty());
+
+  // only the element split between the chunks is kept.
+  iguana::json_array_reader<record_t> reader;
+  size_t count = 0;
+  auto on_record = [&count](record_t &&) {
+    ++count;
+  };
+  reader.feed(json.substr(0, json.size() / 2), on_record);
+  CHECK(reader.buffered_size() < json.size() / 4);
+  CHECK_THROWS(reader.finish());
+  reader.feed(json.substr(json.size() / 2), on_record);
+  CHECK(reader.done());
+  CHECK(count == records.size());
+}
+
+TEST_CASE("test json array reader errors") {
+  for (std::string_view json :
+       {"{}", "[1 2]", "[1,, 2]", "[1] 2", "[1]]", "[{\"id\": \"x\"}]"}) {
+    iguana::json_array_reader<record_t> reader;
+    std::error_code ec;
+    reader.feed(json, [](record_t &&) {}, ec);
+    CHECK_MESSAGE(ec, json);
+    // the reader stays failed.
+    reader.feed("[]", [](record_t &&) {}, ec);
+    CHECK(ec);
+  }
+  iguana::json_array_reader<int> reader;
+  reader.feed("[1, 2", [](int) {});
+  CHECK_THROWS(reader.finish());
+  reader.reset();
+  reader.feed("[3]", [](int i) {
+    CHECK(i == 3);
+  });
+  CHECK(reader.done());
+}
+
+TEST_CASE("test json array from coro_file") {
+  auto records = make_records(1000);
+  std::string json;
+  iguana::to_json(records, json);
+  std::string filename = "test_json_stream.data";
+  {
+    std::ofstream out(filename, std::ios::binary);
+    out << json;
+  }
+
+  coro_io::coro_file file;
+  file.open(filename, std::ios::in);
+  REQUIRE(file.is_open());
+  std::vector<record_t> result;
+  auto ec = async_simple::coro::syncAwait(
+      struct_json::async_read_json_array<record_t>(
+          file,
+          [&result](record_t &&r) {
+            result.push_back(std::move(r));
+          },
+          1000));
+  CHECK(!ec);
+  CHECK(result == records);
+
+  // a truncated file.
+  {
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    out << json.substr(0, json.size() - 10);
+  }
+  coro_io::coro_file truncated;
+  truncated.open(filename, std::ios::in);
+  ec = async_simple::coro::syncAwait(
+      struct_json::async_read_json_array<record_t>(truncated,
+                                                   [](record_t &&) {}));
+  CHECK(ec);
+  std::remove(filename.c_str());
+}
+
+TEST_CASE("test json array chunked callback") {
+  auto records = make_records(10);
+  std::string json;
+  iguana::to_json(records, json);
+  iguana::json_array_reader<record_t> reader;
+  std::vector<record_t> result;
+  std::error_code ec;
+  auto callback = struct_json::json_array_chunked_callback(
+      reader,
+      [&result](record_t &&r) {
+        result.push_back(std::move(r));
+      },
+      ec);
+  for (size_t pos = 0; pos < json.size(); pos += 7) {
+    async_simple::coro::syncAwait(
+        callback(std::string_view(json).substr(pos, 7)));
+  }
+  CHECK(!ec);
+  CHECK(reader.done());
+  CHECK(result == records);
+}
@@ -0,0 +1,133 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory_resource>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "ylt/struct_pack.hpp"
+
+/*
+allocations per message of deserializing a message with many strings and
+vectors: into a fresh object, into a reused object, and into std::pmr
+containers backed by a per message monotonic arena:
+./struct_pack_alloc_benchmark [rounds]
+*/
+
+static size_t g_allocations = 0;
+
+void *operator new(std::size_t size) {
+  ++g_allocations;
+  if (void *p = std::malloc(size == 0 ? 1 : size)) {
+    return p;
+  }
+  throw std::bad_alloc{};
+}
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+
+struct item {
+  int64_t id;
+  std::string name;
+  std::vector<std::string> labels;
+  std::vector<int> values;
+};
+
+struct message {
+  std::string trace_id;
+  std::string user;
+  std::map<std::string, std::string> headers;
+  std::vector<item> items;
+  std::string body;
+};
+
+struct pmr_item {
+  int64_t id;
+  std::pmr::string name;
+  std::pmr::vector<std::pmr::string> labels;
+  std::pmr::vector<int> values;
+};
+
+struct pmr_message {
+  std::pmr::string trace_id;
+  std::pmr::string user;
+  std::pmr::map<std::pmr::string, std::pmr::string> headers;
+  std::pmr::vector<pmr_item> items;
+  std::pmr::string body;
+};
+
+message make_message() {
+  message msg{std::string(32, 't'), "struct_pack user name", {}, {},
+              std::string(512, 'b')};
+  for (int i = 0; i < 8; ++i) {
+    msg.headers.emplace("header-name-" + std::to_string(i),
+                        std::string(40, 'v'));
+  }
+  for (int i = 0; i < 16; ++i) {
+    msg.items.push_back(item{i,
+                             "item name long enough for heap " +
+                                 std::to_string(i),
+                             {std::string(24, 'l'), std::string(24, 'm')},
+                             {1, 2, 3, 4, 5, 6, 7, 8}});
+  }
+  return msg;
+}
+
+template <typename F>
+void bench(const char *name, size_t rounds, F &&f) {
+  size_t sink = 0;
+  auto allocations = g_allocations;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < rounds; ++i) {
+    sink += f();
+  }
+  auto end = std::chrono::steady_clock::now();
+  allocations = g_allocations - allocations;
+  static volatile size_t keep;
+  keep = sink;
+  std::printf("%-12s %14.1f %12.0f\n", name, allocations * 1.0 / rounds,
+              std::chrono::duration<double, std::nano>(end - start).count() /
+                  rounds);
+}
+
+int main(int argc, char **argv) {
+  size_t rounds = 100000;
+  if (argc > 1) {
+    rounds = std::stoul(argv[1]);
+  }
+  auto buffer = struct_pack::serialize<std::string>(make_message());
+  std::printf("message: %zu bytes, rounds: %zu\n", buffer.size(), rounds);
+  std::printf("%-12s %14s %12s\n", "mode", "allocs/msg", "ns/msg");
+
+  bench("fresh", rounds, [&] {
+    auto msg = struct_pack::deserialize<message>(buffer);
+    return msg->items.size();
+  });
+
+  message reused;
+  bench("reused", rounds, [&] {
+    if (struct_pack::deserialize_to<struct_pack::sp_config::REUSE_OBJECT>(
+            reused, buffer)) {
+      std::abort();
+    }
+    return reused.items.size();
+  });
+
+  // the arena reuses its initial buffer after release().
+  std::vector<std::byte> arena_buffer(64 * 1024);
+  std::pmr::monotonic_buffer_resource arena(arena_buffer.data(),
+                                            arena_buffer.size());
+  bench("pmr_arena", rounds, [&] {
+    size_t ret;
+    {
+      auto msg = struct_pack::deserialize<pmr_message>(buffer, &arena);
+      ret = msg->items.size();
+    }
+    arena.release();
+    return ret;
+  });
+  return 0;
+}
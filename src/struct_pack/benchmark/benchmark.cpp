@@ -1,6 +1,7 @@
 #include <map>
 #include <memory>
 #include <stdexcept>
+// the members of struct_pb messages are matched in order.
 #define SEQUENTIAL_PARSE
 #include "struct_pack_sample.hpp"
 
@@ -106,6 +107,8 @@ void run_benchmark(const T& map, LibType base_line_type) {
   calculate_ser_rate(map, base_line_type, SampleType::ZC_MONSTERS,
                      SampleType::MONSTERS);
 #endif
+  calculate_ser_rate(map, base_line_type, SampleType::PACKED,
+                     SampleType::PACKED);
 }
 
 int main(int argc, char** argv) {
@@ -0,0 +1,116 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "ylt/struct_pack.hpp"
+#include "ylt/struct_pack/columnar.hpp"
+
+/*
+serialize/deserialize 10000 trades with 20 numeric fields, row by row,
+in columns, in delta encoded columns, and deserialize the columns to a soa:
+./struct_pack_columnar_benchmark [rounds]
+*/
+
+struct trade {
+  int64_t id;
+  int64_t timestamp;
+  int64_t order_id;
+  int32_t account;
+  int32_t venue;
+  double price;
+  double quantity;
+  double fee;
+  double bid;
+  double ask;
+  int32_t side;
+  int32_t flags;
+  int64_t sequence;
+  int64_t settle_time;
+  double notional;
+  double vwap;
+  int32_t trader;
+  int32_t book;
+  int64_t parent_id;
+  double pnl;
+};
+
+std::vector<trade> make_trades(int n) {
+  std::vector<trade> trades;
+  for (int i = 0; i < n; ++i) {
+    trade t{};
+    t.id = 100000 + i;
+    t.timestamp = 1700000000000 + i * 7;
+    t.order_id = 500000 + i / 3;
+    t.account = i % 50;
+    t.venue = i % 4;
+    t.price = 100 + (i % 100) * 0.01;
+    t.quantity = i % 1000;
+    t.side = i % 2;
+    t.sequence = i;
+    t.settle_time = t.timestamp + 86400000;
+    t.notional = t.price * t.quantity;
+    t.trader = i % 20;
+    t.parent_id = t.order_id;
+    trades.push_back(t);
+  }
+  return trades;
+}
+
+template <typename F>
+double bench(size_t rounds, F &&f) {
+  size_t sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < rounds; ++i) {
+    sink += f();
+  }
+  auto end = std::chrono::steady_clock::now();
+  static volatile size_t keep;
+  keep = sink;
+  return std::chrono::duration<double, std::micro>(end - start).count() /
+         rounds;
+}
+
+template <typename Serialized, typename Deserialized = Serialized>
+void run(const char *name, const std::vector<trade> &trades, size_t rounds) {
+  Serialized data{trades};
+  std::string buffer;
+  auto serialize_us = bench(rounds, [&] {
+    buffer.clear();
+    struct_pack::serialize_to(buffer, data);
+    return buffer.size();
+  });
+  Deserialized out;
+  auto deserialize_us = bench(rounds, [&] {
+    if (struct_pack::deserialize_to(out, buffer)) {
+      std::abort();
+    }
+    return out.size();
+  });
+  std::printf("%-14s %10zu bytes %10.1f us %10.1f us\n", name, buffer.size(),
+              serialize_us, deserialize_us);
+}
+
+int main(int argc, char **argv) {
+  size_t rounds = 200;
+  if (argc > 1) {
+    rounds = std::stoul(argv[1]);
+  }
+  using struct_pack::column_encoding;
+  auto trades = make_trades(10000);
+  std::printf("%-14s %16s %13s %13s\n", "", "size", "serialize",
+              "deserialize");
+  run<std::vector<trade>>("rows", trades, rounds);
+  run<struct_pack::columnar<std::vector<trade>>>("columnar", trades, rounds);
+  run<struct_pack::columnar<std::vector<trade>>, struct_pack::soa<trade>>(
+      "columnar->soa", trades, rounds);
+  run<struct_pack::columnar<std::vector<trade>, column_encoding::delta>>(
+      "delta", trades, rounds);
+  run<struct_pack::columnar<std::vector<trade>, column_encoding::delta>,
+      struct_pack::soa<trade, column_encoding::delta>>("delta->soa", trades,
+                                                        rounds);
+  return 0;
+}
@@ -7,6 +7,7 @@
 #include <vector>
 inline constexpr int OBJECT_COUNT = 20;
 inline constexpr int ITERATIONS = 1000000;
+inline constexpr int PACKED_COUNT = 1000;
 
 enum class LibType {
   STRUCT_PACK,
@@ -27,6 +28,7 @@ enum class SampleType {
   MONSTER,
   MONSTERS,
   ZC_MONSTERS,
+  PACKED,
 };
 
 inline const std::unordered_map<SampleType, std::string> g_sample_name_map = {
@@ -44,7 +46,9 @@ inline const std::unordered_map<SampleType, std::string> g_sample_name_map = {
     {SampleType::MONSTER, "1 monster"},
     {SampleType::MONSTERS, std::to_string(OBJECT_COUNT) + " monsters"},
     {SampleType::ZC_MONSTERS,
-     std::to_string(OBJECT_COUNT) + " monsters(with zero-copy deserialize)"}};
+     std::to_string(OBJECT_COUNT) + " monsters(with zero-copy deserialize)"},
+    {SampleType::PACKED,
+     std::to_string(PACKED_COUNT) + " packed int64 and float"}};
 
 inline const std::unordered_map<LibType, std::string> g_lib_name_map = {
     {LibType::STRUCT_PACK, "struct_pack"},
@@ -0,0 +1,125 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "ylt/struct_pack.hpp"
+
+/*
+serialize/deserialize a struct with 40 fields, most of them are trivially
+serializable and a few are strings. The adjacent trivial fields are copied by
+one memcpy, compare it with the baseline built with
+STRUCT_PACK_DISABLE_MEMCPY_RUN:
+./struct_pack_memcpy_run_benchmark [rounds]
+./struct_pack_memcpy_run_benchmark_baseline [rounds]
+*/
+
+struct mixed_struct {
+  int64_t id;
+  int32_t version;
+  int32_t flags;
+  double price;
+  double amount;
+  float ratio;
+  float score;
+  int64_t create_time;
+  int64_t update_time;
+  std::string name;
+  int32_t a0;
+  int32_t a1;
+  int32_t a2;
+  int32_t a3;
+  int64_t b0;
+  int64_t b1;
+  int64_t b2;
+  int64_t b3;
+  double c0;
+  double c1;
+  std::string description;
+  uint16_t d0;
+  uint16_t d1;
+  uint32_t d2;
+  uint64_t d3;
+  int32_t e0;
+  int32_t e1;
+  int32_t e2;
+  int32_t e3;
+  std::string tag;
+  double f0;
+  double f1;
+  double f2;
+  double f3;
+  int64_t g0;
+  int64_t g1;
+  int32_t g2;
+  int32_t g3;
+  uint64_t checksum;
+  std::string comment;
+};
+
+mixed_struct make_struct(int i) {
+  mixed_struct s{};
+  s.id = i;
+  s.version = 3;
+  s.price = 1.5 * i;
+  s.name = "mixed struct name";
+  s.description = "a description of the mixed struct";
+  s.tag = "tag";
+  s.comment = "comment";
+  s.b2 = i * 7;
+  s.f3 = i * 0.25;
+  s.checksum = 0xdeadbeef;
+  return s;
+}
+
+template <typename F>
+double bench(size_t rounds, F &&f) {
+  size_t sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < rounds; ++i) {
+    sink += f();
+  }
+  auto end = std::chrono::steady_clock::now();
+  static volatile size_t keep;
+  keep = sink;
+  return std::chrono::duration<double, std::nano>(end - start).count() /
+         rounds;
+}
+
+int main(int argc, char **argv) {
+  size_t rounds = 100000;
+  if (argc > 1) {
+    rounds = std::stoul(argv[1]);
+  }
+  std::vector<mixed_struct> vec;
+  for (int i = 0; i < 100; ++i) {
+    vec.push_back(make_struct(i));
+  }
+  std::string buffer;
+  struct_pack::serialize_to(buffer, vec);
+#ifdef STRUCT_PACK_DISABLE_MEMCPY_RUN
+  std::printf("memcpy run: disabled\n");
+#else
+  std::printf("memcpy run: enabled\n");
+#endif
+  std::printf("100 structs: %zu bytes, rounds: %zu\n", buffer.size(), rounds);
+
+  auto serialize_ns = bench(rounds, [&] {
+    buffer.clear();
+    struct_pack::serialize_to(buffer, vec);
+    return buffer.size();
+  });
+  std::vector<mixed_struct> out;
+  auto deserialize_ns = bench(rounds, [&] {
+    if (struct_pack::deserialize_to(out, buffer)) {
+      std::abort();
+    }
+    return out.size();
+  });
+  std::printf("%-12s %12.0f ns\n", "serialize", serialize_ns);
+  std::printf("%-12s %12.0f ns\n", "deserialize", deserialize_ns);
+  return 0;
+}
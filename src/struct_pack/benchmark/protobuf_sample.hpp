@@ -148,6 +148,15 @@ inline mygame::Monsters create_monsters(size_t object_count) {
   }
   return Monsters;
 }
+
+inline mygame::packed create_packed(size_t count) {
+  mygame::packed pk;
+  for (int i = 0; i < count; i++) {
+    pk.add_ids(int64_t(i) * i * 97 - 5000);
+    pk.add_values(i * 0.5f);
+  }
+  return pk;
+}
 }  // namespace protobuf_sample
 
 struct protobuf_sample_t : public base_sample {
@@ -158,6 +167,7 @@ struct protobuf_sample_t : public base_sample {
     rects_ = protobuf_sample::create_rects(OBJECT_COUNT);
     persons_ = protobuf_sample::create_persons(OBJECT_COUNT);
     monsters_ = protobuf_sample::create_monsters(OBJECT_COUNT);
+    packed_ = protobuf_sample::create_packed(PACKED_COUNT);
   }
 
   void do_serialization() override {
@@ -167,6 +177,7 @@ struct protobuf_sample_t : public base_sample {
     serialize(SampleType::PERSONS, persons_);
     serialize(SampleType::MONSTER, *((*monsters_.mutable_monsters()).begin()));
     serialize(SampleType::MONSTERS, monsters_);
+    serialize(SampleType::PACKED, packed_);
   }
 
   void do_deserialization() override {
@@ -178,6 +189,7 @@ struct protobuf_sample_t : public base_sample {
     deserialize(SampleType::MONSTER,
                 *((*monsters_.mutable_monsters()).begin()));
     deserialize(SampleType::MONSTERS, monsters_);
+    deserialize(SampleType::PACKED, packed_);
   }
 
  private:
@@ -230,5 +242,6 @@ struct protobuf_sample_t : public base_sample {
   mygame::rect32s rects_;
   mygame::persons persons_;
   mygame::Monsters monsters_;
+  mygame::packed packed_;
   std::string buffer_;
 };
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ylt/struct_pack.hpp"
+
+/*
+serialize a deep object with many strings into a reused buffer:
+two_pass: calculate the size, then write(struct_pack::serialize_to).
+one_pass: write to the growable buffer directly.
+cached_size: reuse the size calculated before, e.g. for a cached response.
+./struct_pack_size_benchmark [rounds]
+*/
+
+struct node {
+  int64_t id;
+  std::string name;
+  std::vector<std::string> tags;
+  std::map<std::string, std::string> attrs;
+  std::vector<node> children;
+};
+
+node make_tree(int depth) {
+  node n{depth, "node name " + std::to_string(depth), {}, {}, {}};
+  for (int i = 0; i < 4; ++i) {
+    n.tags.push_back("tag-" + std::to_string(i));
+    n.attrs.emplace("key-" + std::to_string(i), "value-" + std::to_string(i));
+  }
+  if (depth > 0) {
+    for (int i = 0; i < 4; ++i) {
+      n.children.push_back(make_tree(depth - 1));
+    }
+  }
+  return n;
+}
+
+template <typename F>
+void bench(const char *name, size_t rounds, F &&f) {
+  size_t sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < rounds; ++i) {
+    sink += f();
+  }
+  auto end = std::chrono::steady_clock::now();
+  static volatile size_t keep;
+  keep = sink;
+  std::printf("%-12s %12.0f ns\n", name,
+              std::chrono::duration<double, std::nano>(end - start).count() /
+                  rounds);
+}
+
+int main(int argc, char **argv) {
+  size_t rounds = 10000;
+  if (argc > 1) {
+    rounds = std::stoul(argv[1]);
+  }
+  auto tree = make_tree(4);
+  std::string buffer;
+  std::printf("tree: %zu bytes, rounds: %zu\n",
+              struct_pack::get_needed_size(tree).size(), rounds);
+
+  bench("two_pass", rounds, [&] {
+    buffer.clear();
+    struct_pack::serialize_to(buffer, tree);
+    return buffer.size();
+  });
+  bench("one_pass", rounds, [&] {
+    buffer.clear();
+    struct_pack::serialize_to_one_pass(buffer, tree);
+    return buffer.size();
+  });
+  auto info = struct_pack::get_needed_size(tree);
+  bench("cached_size", rounds, [&] {
+    buffer.clear();
+    struct_pack::serialize_to(buffer, info, tree);
+    return buffer.size();
+  });
+  return 0;
+}
@@ -86,6 +86,14 @@ struct Monsters : public iguana::base_impl<Monsters> {
 };
 YLT_REFL(Monsters, list);
 
+// the repeated scalars are written packed.
+struct packed : public iguana::base_impl<packed> {
+  packed() = default;
+  std::vector<int64_t> ids;
+  std::vector<float> values;
+};
+YLT_REFL(packed, ids, values);
+
 inline auto create_rects(size_t object_count) {
   rect rc{1, 0, 11, 1};
   std::vector<rect> v{};
@@ -142,6 +150,15 @@ inline std::vector<Monster> create_monsters(size_t object_count) {
 
   return v;
 }
+
+inline packed create_packed(size_t count) {
+  packed pk;
+  for (std::size_t i = 0; i < count; i++) {
+    pk.ids.push_back(int64_t(i) * i * 97 - 5000);
+    pk.values.push_back(i * 0.5f);
+  }
+  return pk;
+}
 }  // namespace pb_sample
 
 struct struct_pb_sample : public base_sample {
@@ -152,6 +169,7 @@ struct struct_pb_sample : public base_sample {
     rects_.list = {pb_sample::create_rects(OBJECT_COUNT)};
     persons_.list = {pb_sample::create_persons(OBJECT_COUNT)};
     monsters_.list = {pb_sample::create_monsters(OBJECT_COUNT)};
+    packed_ = pb_sample::create_packed(PACKED_COUNT);
   }
 
   void do_serialization() override {
@@ -165,6 +183,7 @@ struct struct_pb_sample : public base_sample {
     serialize(SampleType::PERSONS, persons_);
     serialize(SampleType::MONSTER, monsters_.list[0]);
     serialize(SampleType::MONSTERS, monsters_);
+    serialize(SampleType::PACKED, packed_);
   }
 
   void do_deserialization() override {
@@ -174,6 +193,7 @@ struct struct_pb_sample : public base_sample {
     deserialize(SampleType::PERSONS, persons_);
     deserialize(SampleType::MONSTER, monsters_.list[0]);
     deserialize(SampleType::MONSTERS, monsters_);
+    deserialize(SampleType::PACKED, packed_);
   }
 
  private:
@@ -223,5 +243,6 @@ struct struct_pb_sample : public base_sample {
   pb_sample::rects rects_;
   pb_sample::persons persons_;
   pb_sample::Monsters monsters_;
+  pb_sample::packed packed_;
   std::string buffer_;
 };
@@ -0,0 +1,146 @@
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "ylt/struct_pack.hpp"
+
+using namespace struct_pack;
+
+/*
+microbenchmark of the varint codec for containers of varints, compares the
+element by element path with the bulk one, by value distribution. Encoding
+goes to an appending writer(like a stream), decoding reads from memory:
+./struct_pack_varint_benchmark [count] [rounds]
+*/
+
+struct string_writer {
+  std::string &buffer;
+  void write(const char *data, std::size_t len) { buffer.append(data, len); }
+};
+
+struct distribution {
+  std::string_view name;
+  std::vector<var_int64_t> values;
+};
+
+std::vector<distribution> make_distributions(size_t count) {
+  std::mt19937_64 gen(42);
+  std::vector<distribution> ret;
+  auto make = [&](std::string_view name, auto &&f) {
+    distribution d{name, {}};
+    d.values.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+      d.values.push_back(f());
+    }
+    ret.push_back(std::move(d));
+  };
+  // zigzag encoded, so |v| < 64 is 1 byte.
+  make("1byte", [&] { return int64_t(gen() % 128) - 64; });
+  make("2byte", [&] { return int64_t(gen() % 16384) - 8192; });
+  // feature ids and counters, mostly small with a long tail.
+  make("mixed", [&] {
+    auto r = gen();
+    switch (r % 8) {
+      case 0:
+      case 1:
+      case 2:
+      case 3:
+        return int64_t(r >> 58);
+      case 4:
+      case 5:
+        return -int64_t(r >> 50);
+      case 6:
+        return int64_t(r >> 36);
+      default:
+        return int64_t(r >> 4);
+    }
+  });
+  make("random64", [&] { return int64_t(gen()); });
+  return ret;
+}
+
+template <typename F>
+double bench(size_t rounds, F &&f) {
+  size_t sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < rounds; ++i) {
+    sink += f();
+  }
+  auto end = std::chrono::steady_clock::now();
+  static volatile size_t keep;
+  keep = sink;
+  return std::chrono::duration<double, std::nano>(end - start).count() /
+         rounds;
+}
+
+int main(int argc, char **argv) {
+  size_t count = 100000;
+  size_t rounds = 200;
+  if (argc > 1) {
+    count = std::stoul(argv[1]);
+  }
+  if (argc > 2) {
+    rounds = std::stoul(argv[2]);
+  }
+
+  std::printf("values: %zu, rounds: %zu\n", count, rounds);
+  std::printf("%-10s %8s %12s %12s %10s %12s %12s %10s\n", "dist", "bytes",
+              "enc_one(ns)", "enc_bulk(ns)", "MB/s", "dec_one(ns)",
+              "dec_bulk(ns)", "MB/s");
+
+  for (auto &[name, values] : make_distributions(count)) {
+    size_t size = 0;
+    for (auto &v : values) {
+      size += detail::calculate_varint_size(v);
+    }
+    std::string buffer(size, '\0');
+    std::vector<var_int64_t> out(values.size());
+
+    double enc_one = bench(rounds, [&] {
+      buffer.clear();
+      string_writer writer{buffer};
+      for (auto &v : values) {
+        detail::serialize_varint(writer, v);
+      }
+      return buffer.size();
+    });
+    double enc_bulk = bench(rounds, [&] {
+      buffer.clear();
+      string_writer writer{buffer};
+      detail::serialize_varints(writer, values.data(), values.size());
+      return buffer.size();
+    });
+
+    double dec_one = bench(rounds, [&] {
+      detail::memory_reader reader{buffer.data(),
+                                   buffer.data() + buffer.size()};
+      for (auto &v : out) {
+        auto ec = detail::deserialize_varint(reader, v);
+        if (ec) {
+          return size_t(0);
+        }
+      }
+      return size_t(out.back().get());
+    });
+    double dec_bulk = bench(rounds, [&] {
+      detail::memory_reader reader{buffer.data(),
+                                   buffer.data() + buffer.size()};
+      auto ec = detail::deserialize_varints(reader, out.data(), out.size());
+      return ec ? size_t(0) : size_t(out.back().get());
+    });
+    if (out != values) {
+      std::printf("%.*s: decode mismatch\n", (int)name.size(), name.data());
+      return 1;
+    }
+
+    std::printf("%-10.*s %8zu %12.0f %12.0f %10.1f %12.0f %12.0f %10.1f\n",
+                (int)name.size(), name.data(), size, enc_one, enc_bulk,
+                size * 1000.0 / enc_bulk, dec_one, dec_bulk,
+                size * 1000.0 / dec_bulk);
+  }
+  return 0;
+}
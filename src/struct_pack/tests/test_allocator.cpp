@@ -0,0 +1,156 @@
+#include <map>
+#include <memory>
+#include <memory_resource>
+#include <optional>
+#include <string>
+#include <vector>
+#include <ylt/struct_pack.hpp>
+
+#include "doctest.h"
+
+namespace test_allocator {
+struct item_t {
+  int id;
+  std::string name;
+  std::vector<int> values;
+  std::optional<std::string> comment;
+  std::unique_ptr<std::string> extra;
+};
+
+struct message_t {
+  std::vector<item_t> items;
+  std::vector<std::string> tags;
+  std::string body;
+};
+
+struct pmr_item_t {
+  int id;
+  std::pmr::string name;
+  std::pmr::vector<int> values;
+};
+
+struct pmr_message_t {
+  std::pmr::string body;
+  std::pmr::vector<std::pmr::string> tags;
+  std::pmr::map<std::pmr::string, std::pmr::string> attrs;
+  pmr_item_t head;
+  std::pmr::vector<pmr_item_t> items;
+  std::tuple<int, std::pmr::string> pair;
+};
+
+// forbid the allocation from the default resource.
+struct forbid_default_resource {
+  forbid_default_resource()
+      : old(std::pmr::set_default_resource(std::pmr::null_memory_resource())) {
+  }
+  ~forbid_default_resource() { std::pmr::set_default_resource(old); }
+  std::pmr::memory_resource *old;
+};
+}  // namespace test_allocator
+
+using namespace test_allocator;
+
+TEST_CASE("test deserialize to the object reused") {
+  auto make_item = [](int id, std::string name, std::vector<int> values,
+                      std::optional<std::string> comment,
+                      std::unique_ptr<std::string> extra) {
+    return item_t{id, std::move(name), std::move(values), std::move(comment),
+                  std::move(extra)};
+  };
+  message_t big;
+  big.items.push_back(make_item(1, std::string(100, 'a'), {1, 2, 3}, "x",
+                                std::make_unique<std::string>("e")));
+  big.items.push_back(
+      make_item(2, std::string(100, 'b'), {4, 5}, std::nullopt, nullptr));
+  big.items.push_back(make_item(3, "c", {}, std::nullopt, nullptr));
+  big.tags = {std::string(100, 't'), std::string(100, 'u')};
+  big.body = std::string(1000, 'z');
+  message_t small;
+  small.items.push_back(make_item(4, "d", {6}, std::nullopt, nullptr));
+  small.items.push_back(
+      make_item(5, "e", {}, "y", std::make_unique<std::string>("f")));
+  small.body = "body";
+  auto big_buffer = struct_pack::serialize(big);
+  auto small_buffer = struct_pack::serialize(small);
+
+  message_t msg;
+  REQUIRE(!struct_pack::deserialize_to<struct_pack::sp_config::REUSE_OBJECT>(
+      msg, big_buffer));
+  auto name_data = msg.items[0].name.data();
+  auto body_data = msg.body.data();
+
+  REQUIRE(!struct_pack::deserialize_to<struct_pack::sp_config::REUSE_OBJECT>(
+      msg, small_buffer));
+  CHECK(msg.items.size() == 2);
+  CHECK(msg.items[0].id == 4);
+  CHECK(msg.items[0].name == "d");
+  CHECK(msg.items[0].values == std::vector<int>{6});
+  CHECK(!msg.items[0].comment.has_value());
+  CHECK(msg.items[0].extra == nullptr);
+  CHECK(msg.items[1].id == 5);
+  CHECK(msg.items[1].values.empty());
+  CHECK(msg.items[1].comment == "y");
+  REQUIRE(msg.items[1].extra != nullptr);
+  CHECK(*msg.items[1].extra == "f");
+  CHECK(msg.tags.empty());
+  CHECK(msg.body == "body");
+  // the memory of the old object is reused.
+  CHECK(msg.items[0].name.data() == name_data);
+  CHECK(msg.body.data() == body_data);
+
+  REQUIRE(!struct_pack::deserialize_to<struct_pack::sp_config::REUSE_OBJECT>(
+      msg, big_buffer));
+  CHECK(msg.items.size() == 3);
+  CHECK(msg.items[0].extra != nullptr);
+  CHECK(msg.items[1].comment == std::nullopt);
+  CHECK(msg.items[2].name == "c");
+  CHECK(struct_pack::serialize(msg) == big_buffer);
+
+  // without REUSE_OBJECT the fields are deserialized into new objects.
+  msg.items[0].name.reserve(1000);
+  REQUIRE(!struct_pack::deserialize_to<struct_pack::sp_config::REUSE_OBJECT>(
+      msg, big_buffer));
+  CHECK(msg.items[0].name.capacity() >= 1000);
+  REQUIRE(!struct_pack::deserialize_to(msg, big_buffer));
+  CHECK(msg.items[0].name.capacity() < 1000);
+  CHECK(struct_pack::serialize(msg) == big_buffer);
+}
+
+TEST_CASE("test deserialize with memory resource") {
+  pmr_message_t msg{{"body"},
+                    {{"a"}, {std::pmr::string(100, 'b')}},
+                    {{{"k"}, {std::pmr::string(100, 'v')}}},
+                    {1, {std::pmr::string(100, 'n')}, {1, 2, 3}},
+                    {},
+                    {7, {std::pmr::string(100, 'p')}}};
+  msg.items.push_back({2, {std::pmr::string(100, 'x')}, {4, 5}});
+  msg.items.push_back({3, {"y"}, {}});
+  auto buffer = struct_pack::serialize(msg);
+
+  std::pmr::monotonic_buffer_resource arena;
+  forbid_default_resource guard;
+  auto result = struct_pack::deserialize<pmr_message_t>(buffer, &arena);
+  REQUIRE(result.has_value());
+  auto &ret = result.value();
+  CHECK(std::string_view(ret.body) == "body");
+  CHECK(ret.tags.size() == 2);
+  CHECK(std::string_view(ret.tags[1]) == std::string(100, 'b'));
+  CHECK(std::string_view(ret.attrs.begin()->second) == std::string(100, 'v'));
+  CHECK(std::string_view(ret.head.name) == std::string(100, 'n'));
+  CHECK(ret.items.size() == 2);
+  CHECK(std::string_view(ret.items[0].name) == std::string(100, 'x'));
+  CHECK(ret.items[0].values.size() == 2);
+  CHECK(std::string_view(std::get<1>(ret.pair)) == std::string(100, 'p'));
+
+  CHECK(ret.body.get_allocator().resource() == &arena);
+  CHECK(ret.tags[1].get_allocator().resource() == &arena);
+  CHECK(ret.attrs.begin()->first.get_allocator().resource() == &arena);
+  CHECK(ret.head.values.get_allocator().resource() == &arena);
+  CHECK(ret.items[0].name.get_allocator().resource() == &arena);
+  CHECK(std::get<1>(ret.pair).get_allocator().resource() == &arena);
+
+  auto err = struct_pack::deserialize<pmr_message_t>(
+      buffer.data(), buffer.size() - 1, &arena);
+  REQUIRE(!err.has_value());
+  CHECK(err.error() == struct_pack::errc::no_buffer_space);
+}
@@ -0,0 +1,152 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <string>
+#include <vector>
+#include <ylt/struct_pack.hpp>
+#include <ylt/struct_pack/columnar.hpp>
+
+#include "doctest.h"
+
+namespace test_columnar {
+enum class side : uint8_t { buy, sell };
+
+struct trade {
+  int64_t id;
+  int64_t timestamp;
+  double price;
+  int32_t volume;
+  side s;
+  bool cancelled;
+  std::string symbol;
+  bool operator==(const trade &) const = default;
+};
+
+struct report {
+  std::string name;
+  struct_pack::columnar<std::vector<trade>> trades;
+  int tail;
+  bool operator==(const report &) const = default;
+};
+
+std::vector<trade> make_trades(int n) {
+  std::vector<trade> trades;
+  for (int i = 0; i < n; ++i) {
+    trades.push_back(trade{1000 + i, 1700000000000 + i * 13, 1.5 * i,
+                           i % 7 - 3, i % 2 ? side::sell : side::buy,
+                           i % 3 == 0, "sym" + std::to_string(i % 4)});
+  }
+  return trades;
+}
+
+template <typename T>
+void check_roundtrip(const T &t) {
+  auto buffer = struct_pack::serialize(t);
+  CHECK(struct_pack::get_needed_size(t).size() == buffer.size());
+  auto result = struct_pack::deserialize<T>(buffer);
+  REQUIRE(result.has_value());
+  CHECK(result.value() == t);
+}
+}  // namespace test_columnar
+
+using namespace test_columnar;
+
+TEST_CASE("test columnar roundtrip") {
+  using struct_pack::column_encoding;
+  struct_pack::columnar<std::vector<trade>> trades = make_trades(100);
+  check_roundtrip(trades);
+  check_roundtrip(struct_pack::columnar<std::vector<trade>>{});
+  check_roundtrip(
+      struct_pack::columnar<std::vector<trade>, column_encoding::delta>{
+          make_trades(100)});
+  auto rows = make_trades(10);
+  check_roundtrip(
+      struct_pack::columnar<std::deque<trade>>{rows.begin(), rows.end()});
+  check_roundtrip(report{"report", make_trades(20), 42});
+  check_roundtrip(std::vector<struct_pack::columnar<std::vector<trade>>>{
+      make_trades(3), make_trades(5)});
+
+  // the columns of the same member are contiguous.
+  auto buffer = struct_pack::serialize(trades);
+  std::vector<int64_t> ids;
+  for (auto &trade : trades) {
+    ids.push_back(trade.id);
+  }
+  auto id_column = std::search(buffer.begin(), buffer.end(), (char *)ids.data(),
+                               (char *)(ids.data() + ids.size()));
+  CHECK(id_column != buffer.end());
+}
+
+TEST_CASE("test columnar delta encoding") {
+  using struct_pack::column_encoding;
+  auto trades = make_trades(1000);
+  auto plain = struct_pack::serialize(
+      struct_pack::columnar<std::vector<trade>>{trades});
+  auto delta = struct_pack::serialize(
+      struct_pack::columnar<std::vector<trade>, column_encoding::delta>{
+          trades});
+  CHECK(delta.size() < plain.size());
+  // the encoding is a part of the type.
+  CHECK(struct_pack::deserialize<struct_pack::columnar<std::vector<trade>>>(
+            delta)
+            .error() == struct_pack::errc::invalid_buffer);
+
+  std::vector<int64_t> ids{INT64_MIN, INT64_MAX, 0, -1, INT64_MAX};
+  struct_pack::columnar<std::vector<trade>, column_encoding::delta> extremes;
+  for (auto id : ids) {
+    extremes.push_back(trade{id, -id, 0, INT32_MIN, side::buy, true, ""});
+  }
+  check_roundtrip(extremes);
+}
+
+TEST_CASE("test columnar to soa") {
+  using struct_pack::column_encoding;
+  auto trades = make_trades(100);
+  auto buffer = struct_pack::serialize(
+      struct_pack::columnar<std::vector<trade>>{trades});
+  auto columns = struct_pack::deserialize<struct_pack::soa<trade>>(buffer);
+  REQUIRE(columns.has_value());
+  REQUIRE(columns->size() == 100);
+  for (std::size_t i = 0; i < trades.size(); ++i) {
+    CHECK(columns->column<0>()[i] == trades[i].id);
+    CHECK(columns->column<2>()[i] == trades[i].price);
+    CHECK(columns->column<5>()[i] == trades[i].cancelled);
+    CHECK(columns->column<6>()[i] == trades[i].symbol);
+    CHECK((*columns)[i] == trades[i]);
+  }
+
+  // and vice versa.
+  struct_pack::soa<trade, column_encoding::delta> soa{trades};
+  auto rows = struct_pack::deserialize<
+      struct_pack::columnar<std::vector<trade>, column_encoding::delta>>(
+      struct_pack::serialize(soa));
+  REQUIRE(rows.has_value());
+  CHECK(rows.value() == trades);
+  check_roundtrip(soa);
+}
+
+TEST_CASE("test columnar error") {
+  auto buffer = struct_pack::serialize(report{"report", make_trades(20), 42});
+  auto tail = struct_pack::get_field<report, 2>(buffer);
+  REQUIRE(tail.has_value());
+  CHECK(tail.value() == 42);
+
+  buffer.resize(buffer.size() - 10);
+  CHECK(struct_pack::deserialize<report>(buffer).error() ==
+        struct_pack::errc::no_buffer_space);
+  auto columns = struct_pack::serialize(struct_pack::soa<trade>{make_trades(5)});
+  columns.pop_back();
+  CHECK(struct_pack::deserialize<struct_pack::soa<trade>>(columns).error() ==
+        struct_pack::errc::no_buffer_space);
+
+  // a huge row count without the data.
+  std::vector<char> fake = struct_pack::serialize(struct_pack::soa<trade>{});
+  uint64_t size = UINT64_MAX / 2;
+  memcpy(fake.data() + fake.size() - 8, &size, 8);
+  CHECK(struct_pack::deserialize<struct_pack::soa<trade>>(fake).error() ==
+        struct_pack::errc::no_buffer_space);
+  CHECK(struct_pack::deserialize<struct_pack::columnar<std::vector<trade>>>(
+            fake)
+            .error() == struct_pack::errc::no_buffer_space);
+}
@@ -0,0 +1,118 @@
+#include <cstdint>
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <ylt/struct_pack.hpp>
+
+#include "doctest.h"
+
+namespace test_compatible_fast_path {
+struct item_v1 {
+  int id;
+  std::string name;
+  bool operator==(const item_v1 &) const = default;
+};
+
+struct item_v2 {
+  int id;
+  std::string name;
+  struct_pack::compatible<std::string, 20230101> note;
+  bool operator==(const item_v2 &) const = default;
+};
+
+struct item_v3 {
+  int id;
+  std::string name;
+  struct_pack::compatible<std::string, 20230101> note;
+  struct_pack::compatible<std::vector<int>, 20230202> values;
+  bool operator==(const item_v3 &) const = default;
+};
+
+struct catalog_v3 {
+  std::string title;
+  std::unordered_map<int, item_v3> items;
+  std::map<std::string, item_v3> sorted_items;
+  std::vector<int> ids;
+  bool operator==(const catalog_v3 &) const = default;
+};
+
+struct catalog_v1 {
+  std::string title;
+  std::unordered_map<int, item_v1> items;
+  std::map<std::string, item_v1> sorted_items;
+  std::vector<int> ids;
+};
+
+struct plain {
+  std::string title;
+  std::unordered_map<int, std::string> items;
+  bool operator==(const plain &) const = default;
+};
+}  // namespace test_compatible_fast_path
+
+using namespace test_compatible_fast_path;
+
+TEST_CASE("test compatible fields of same version") {
+  item_v3 v3{1, "a", "note", std::vector<int>{1, 2, 3}};
+  auto result = struct_pack::deserialize<item_v3>(struct_pack::serialize(v3));
+  REQUIRE(result.has_value());
+  CHECK(result.value() == v3);
+}
+
+TEST_CASE("test compatible fields of other versions") {
+  item_v3 v3{1, "a", "note", std::vector<int>{1, 2, 3}};
+  // the newer fields are skipped by their length.
+  auto v1 = struct_pack::deserialize<item_v1>(struct_pack::serialize(v3));
+  REQUIRE(v1.has_value());
+  CHECK(v1.value() == item_v1{1, "a"});
+  auto v2 = struct_pack::deserialize<item_v2>(struct_pack::serialize(v3));
+  REQUIRE(v2.has_value());
+  CHECK(v2.value() == item_v2{1, "a", "note"});
+
+  auto old = struct_pack::deserialize<item_v3>(
+      struct_pack::serialize(item_v2{1, "a", "note"}));
+  REQUIRE(old.has_value());
+  CHECK(old.value().note == "note");
+  CHECK(!old.value().values.has_value());
+}
+
+TEST_CASE("test compatible fields in maps") {
+  catalog_v3 catalog{"title", {}, {}, {1, 2}};
+  for (int i = 0; i < 50; ++i) {
+    catalog.items[i] = item_v3{i, std::to_string(i), std::to_string(i * 2),
+                               std::vector<int>(i % 5, i)};
+    catalog.sorted_items[std::to_string(i)] = item_v3{i, "", std::nullopt, {}};
+  }
+  auto buffer = struct_pack::serialize(catalog);
+  for (int i = 0; i < 2; ++i) {
+    auto result = struct_pack::deserialize<catalog_v3>(buffer);
+    REQUIRE(result.has_value());
+    CHECK(result.value() == catalog);
+  }
+  auto v1 = struct_pack::deserialize<catalog_v1>(buffer);
+  REQUIRE(v1.has_value());
+  CHECK(v1.value().items.size() == 50);
+  CHECK(v1.value().items[7].name == "7");
+
+  // the types without compatible fields don't record the order of the maps.
+  plain p{"title", {{1, "a"}, {2, "b"}}};
+  auto result = struct_pack::deserialize<plain>(struct_pack::serialize(p));
+  REQUIRE(result.has_value());
+  CHECK(result.value() == p);
+}
+
+TEST_CASE("test get field of struct with compatible fields") {
+  item_v3 v3{1, "a", "note", std::vector<int>{1, 2, 3}};
+  auto buffer = struct_pack::serialize(v3);
+  auto name = struct_pack::get_field<item_v3, 1>(buffer);
+  REQUIRE(name.has_value());
+  CHECK(name.value() == "a");
+  auto values = struct_pack::get_field<item_v3, 3>(buffer);
+  REQUIRE(values.has_value());
+  CHECK(values.value() == std::vector<int>{1, 2, 3});
+
+  buffer.resize(8);
+  CHECK(struct_pack::get_field<item_v3, 1>(buffer).error() ==
+        struct_pack::errc::no_buffer_space);
+}
@@ -0,0 +1,119 @@
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <ylt/struct_pack.hpp>
+#include <ylt/struct_pack/mapped_file.hpp>
+#include <ylt/struct_pack/view.hpp>
+
+#include "doctest.h"
+
+namespace test_mapped_file {
+struct point {
+  int x;
+  int y;
+};
+
+struct table {
+  int64_t id;
+  std::string name;
+  std::vector<point> points;
+  std::vector<std::string> keys;
+};
+
+struct table_view {
+  int64_t id;
+  std::string_view name;
+  std::span<const point> points;
+  std::vector<std::string_view> keys;
+};
+
+void write_file(const std::string &path, std::string_view head,
+                const std::vector<char> &data) {
+  std::ofstream ofs(path, std::ios::binary | std::ios::trunc);
+  ofs.write(head.data(), head.size());
+  ofs.write(data.data(), data.size());
+}
+}  // namespace test_mapped_file
+
+using namespace test_mapped_file;
+
+TEST_CASE("test mapped file") {
+  table t{42, "lookup", {}, {"a", "b", "c"}};
+  for (int i = 0; i < 10000; ++i) {
+    t.points.push_back({i, -i});
+  }
+  auto buffer = struct_pack::serialize(t);
+  std::string path = "test_mapped_file.data";
+  write_file(path, "", buffer);
+
+  {
+    struct_pack::mapped_file file;
+    REQUIRE(!file.open(path));
+    CHECK(file.is_open());
+    CHECK(file.size() == buffer.size());
+    CHECK(file.advise(struct_pack::access_hint::sequential));
+
+    auto result = struct_pack::deserialize<table>(file);
+    REQUIRE(result.has_value());
+    CHECK(result->points.size() == 10000);
+    CHECK(result->points[9999].y == -9999);
+
+    // zero copy, the fields point into the mapping.
+    auto view = struct_pack::deserialize<table_view>(file);
+    REQUIRE(view.has_value());
+    CHECK(view->name == "lookup");
+    CHECK(view->name.data() >= file.data());
+    CHECK(view->name.data() < file.data() + file.size());
+    CHECK(view->points.size() == 10000);
+    CHECK(view->keys[2] == "c");
+
+    auto lazy = struct_pack::get_view<table>(file);
+    REQUIRE(lazy.has_value());
+    CHECK(file.advise(struct_pack::access_hint::random));
+    CHECK(lazy->get<0>() == 42);
+    CHECK(lazy->get<1>() == "lookup");
+
+    auto moved = std::move(file);
+    CHECK(!file.is_open());
+    CHECK(moved.is_open());
+    CHECK(struct_pack::deserialize<table>(moved).has_value());
+  }
+  std::filesystem::remove(path);
+}
+
+TEST_CASE("test mapped file with offset") {
+  table t{7, "offset", {{1, 2}}, {}};
+  auto buffer = struct_pack::serialize(t);
+  std::string path = "test_mapped_file_offset.data";
+  // the offset isn't aligned to the page.
+  std::string head(5000, 'h');
+  write_file(path, head, buffer);
+
+  {
+    struct_pack::mapped_file file;
+    REQUIRE(!file.open(path, head.size()));
+    CHECK(file.size() == buffer.size());
+    CHECK(file.advise(struct_pack::access_hint::will_need));
+    auto result = struct_pack::deserialize<table>(file);
+    REQUIRE(result.has_value());
+    CHECK(result->name == "offset");
+
+    REQUIRE(!file.open(path, 4090, 10));
+    CHECK(file.size() == 10);
+    CHECK(std::string_view(file.data(), file.size()) == "hhhhhhhhhh");
+
+    CHECK(file.open(path, 100000) == std::errc::invalid_argument);
+    CHECK(!file.is_open());
+  }
+  std::filesystem::remove(path);
+
+  struct_pack::mapped_file file;
+  CHECK(file.open("not_exist_file.data") ==
+        std::errc::no_such_file_or_directory);
+  CHECK(!file.is_open());
+  CHECK(!file.advise(struct_pack::access_hint::random));
+}
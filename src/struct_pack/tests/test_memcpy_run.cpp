@@ -0,0 +1,152 @@
+#include <array>
+#include <cstdint>
+#include <string>
+#include <tuple>
+#include <vector>
+#include <ylt/struct_pack.hpp>
+
+#include "doctest.h"
+
+namespace test_memcpy_run {
+enum class color : uint8_t { red, green };
+
+struct point {
+  int x;
+  int y;
+  bool operator==(const point &) const = default;
+};
+
+struct mixed {
+  int64_t id;
+  int32_t a;
+  int32_t b;
+  double c;
+  std::string name;
+  char ch;
+  int32_t d;  // padding before it
+  color e;
+  point p;
+  std::array<int32_t, 3> arr;
+  std::vector<int> vec;
+  bool flag;
+  bool operator==(const mixed &) const = default;
+};
+
+struct outer {
+  mixed m;
+  int tail;
+};
+
+struct with_varint {
+  int32_t a;
+  int32_t b;
+  struct_pack::var_int32_t c;
+  int32_t d;
+  int32_t e;
+  std::string s;
+  bool operator==(const with_varint &) const = default;
+};
+
+struct with_aligned_member {
+  int32_t a;
+  alignas(16) int32_t b;
+  int32_t c;
+  std::string s;
+  bool operator==(const with_aligned_member &) const = default;
+};
+
+#pragma pack(1)
+struct packed {
+  char a;
+  int32_t b;
+  int64_t c;
+  std::string s;
+  bool operator==(const packed &) const = default;
+};
+#pragma pack()
+
+struct fast_varint {
+  int32_t a;
+  int32_t b;
+  struct_pack::var_int64_t c;
+  int32_t d;
+  std::string s;
+  bool operator==(const fast_varint &) const = default;
+  static constexpr auto struct_pack_config =
+      struct_pack::USE_FAST_VARINT | struct_pack::DISABLE_ALL_META_INFO;
+};
+
+template <typename T>
+auto to_tuple(const T &t) {
+  return struct_pack::detail::visit_members(
+      t, [](auto &&...items) { return std::tuple(items...); });
+}
+
+template <typename T>
+void check_same_as_member_by_member(const T &t) {
+  constexpr auto conf = struct_pack::sp_config::DISABLE_ALL_META_INFO;
+  auto buffer = struct_pack::serialize<conf>(t);
+  CHECK(buffer == struct_pack::serialize<conf>(to_tuple(t)));
+  auto result = struct_pack::deserialize<conf, T>(buffer);
+  REQUIRE(result.has_value());
+  CHECK(result.value() == t);
+  buffer.pop_back();
+  CHECK(struct_pack::deserialize<conf, T>(buffer).error() ==
+        struct_pack::errc::no_buffer_space);
+}
+}  // namespace test_memcpy_run
+
+template <>
+constexpr std::size_t struct_pack::pack_alignment_v<test_memcpy_run::packed> =
+    1;
+
+using namespace test_memcpy_run;
+
+TEST_CASE("test memcpy runs") {
+  using namespace struct_pack::detail;
+  constexpr auto runs =
+      memcpy_runs<mixed, 0, int64_t, int32_t, int32_t, double, std::string,
+                  char, int32_t, color, point, std::array<int32_t, 3>,
+                  std::vector<int>, bool>;
+#ifdef STRUCT_PACK_DISABLE_MEMCPY_RUN
+  static_assert(runs[0] == 1);
+#else
+  static_assert(runs == std::array<std::size_t, 12>{4, 0, 0, 0, 1, 1, 2, 0, 2,
+                                                    0, 1, 1});
+  static_assert(memcpy_runs<packed, 0, char, int32_t, int64_t,
+                            std::string>[0] == 3);
+  static_assert(memcpy_runs<with_varint, 0, int32_t, int32_t,
+                            struct_pack::var_int32_t, int32_t, int32_t,
+                            std::string> ==
+                std::array<std::size_t, 6>{2, 0, 1, 2, 0, 1});
+#endif
+}
+
+TEST_CASE("test serialize with memcpy runs") {
+  mixed m{1, 2, 3, 4.5, "name", 'c', 6, color::green, {7, 8}, {9, 10, 11},
+          {12, 13}, true};
+  check_same_as_member_by_member(m);
+  check_same_as_member_by_member(with_varint{1, 2, 3, 4, 5, "s"});
+  check_same_as_member_by_member(with_aligned_member{1, 2, 3, "s"});
+  check_same_as_member_by_member(packed{'a', 2, 3, "s"});
+
+  std::vector<mixed> vec(100, m);
+  auto buffer = struct_pack::serialize(vec);
+  auto result = struct_pack::deserialize<std::vector<mixed>>(buffer);
+  REQUIRE(result.has_value());
+  CHECK(result.value() == vec);
+
+  // the runs are skipped as a whole.
+  auto tail =
+      struct_pack::get_field<outer, 1>(struct_pack::serialize(outer{m, 42}));
+  REQUIRE(tail.has_value());
+  CHECK(tail.value() == 42);
+}
+
+TEST_CASE("test fast varint with memcpy runs") {
+  fast_varint v{1, 2, 3, 4, "s"};
+  auto buffer = struct_pack::serialize(v);
+  auto result = struct_pack::deserialize<fast_varint>(buffer);
+  REQUIRE(result.has_value());
+  CHECK(result.value() == v);
+}
@@ -0,0 +1,91 @@
+#include <cstdint>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <ylt/struct_pack.hpp>
+
+#include "doctest.h"
+
+namespace test_one_pass {
+struct node {
+  int64_t id;
+  std::string name;
+  std::vector<std::string> tags;
+  std::map<std::string, int> attrs;
+  std::vector<node> children;
+  bool operator==(const node &) const = default;
+};
+
+struct compatible_node {
+  int64_t id;
+  std::string name;
+  struct_pack::compatible<std::vector<int>> values;
+  bool operator==(const compatible_node &) const = default;
+};
+
+node make_tree(int depth, std::size_t name_len) {
+  node n{depth, std::string(name_len, 'n'), {"a", "bb", "ccc"}, {}, {}};
+  n.attrs["depth"] = depth;
+  if (depth > 0) {
+    for (int i = 0; i < 3; ++i) {
+      n.children.push_back(make_tree(depth - 1, name_len));
+    }
+  }
+  return n;
+}
+
+template <typename Buffer, typename T>
+void check_one_pass(const T &t) {
+  auto expect = struct_pack::serialize<Buffer>(t);
+  Buffer buffer;
+  struct_pack::serialize_to_one_pass(buffer, t);
+  CHECK(buffer == expect);
+
+  // append to the buffer.
+  struct_pack::serialize_to_one_pass(buffer, t);
+  CHECK(buffer.size() == expect.size() * 2);
+  auto result = struct_pack::deserialize<T>(buffer.data() + expect.size(),
+                                            expect.size());
+  REQUIRE(result.has_value());
+  CHECK(result.value() == t);
+}
+}  // namespace test_one_pass
+
+using namespace test_one_pass;
+
+TEST_CASE("test serialize in one pass") {
+  check_one_pass<std::vector<char>>(make_tree(3, 10));
+  check_one_pass<std::string>(make_tree(3, 10));
+  // the length of the containers needs 2 bytes and 4 bytes.
+  check_one_pass<std::vector<char>>(make_tree(2, 300));
+  check_one_pass<std::string>(make_tree(1, 70000));
+  check_one_pass<std::vector<char>>(
+      compatible_node{1, std::string(300, 'c'), std::vector<int>{1, 2, 3}});
+  check_one_pass<std::vector<char>>(std::string(500, 'x'));
+  check_one_pass<std::vector<char>>(int64_t{42});
+
+  std::vector<char> buffer;
+  struct_pack::serialize_to_one_pass(buffer, 1, std::string("hello"), 2.5);
+  auto result = struct_pack::deserialize<int, std::string, double>(buffer);
+  REQUIRE(result.has_value());
+  CHECK(std::get<1>(result.value()) == "hello");
+}
+
+TEST_CASE("test serialize with cached size") {
+  auto tree = make_tree(3, 300);
+  auto expect = struct_pack::serialize(tree);
+  auto info = struct_pack::get_needed_size(tree);
+  CHECK(info.size() == expect.size());
+
+  for (int i = 0; i < 3; ++i) {
+    std::vector<char> buffer = {'h'};
+    struct_pack::serialize_to(buffer, info, tree);
+    REQUIRE(buffer.size() == expect.size() + 1);
+    CHECK(std::equal(expect.begin(), expect.end(), buffer.begin() + 1));
+  }
+
+  std::ostringstream os;
+  struct_pack::serialize_to(os, info, tree);
+  CHECK(os.str() == std::string(expect.data(), expect.size()));
+}
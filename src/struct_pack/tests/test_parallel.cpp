@@ -0,0 +1,108 @@
+#include <cstdint>
+#include <future>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+#include <ylt/coro_io/io_context_pool.hpp>
+#include <ylt/struct_pack.hpp>
+#include <ylt/struct_pack/parallel.hpp>
+
+#include "doctest.h"
+
+namespace test_parallel {
+struct record {
+  int64_t id;
+  std::string name;
+  std::vector<int> values;
+  std::optional<std::map<std::string, int>> attrs;
+  bool operator==(const record &) const = default;
+};
+
+std::vector<record> make_records(std::size_t n, std::size_t name_len = 8) {
+  std::vector<record> ret;
+  ret.reserve(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    record r{(int64_t)i, std::string(name_len + i % 7, 'a' + i % 26), {}, {}};
+    r.values.resize(i % 5, (int)i);
+    if (i % 3 == 0) {
+      r.attrs = std::map<std::string, int>{{std::to_string(i), (int)i}};
+    }
+    ret.push_back(std::move(r));
+  }
+  return ret;
+}
+}  // namespace test_parallel
+
+using namespace test_parallel;
+
+TEST_CASE("test parallel serialize") {
+  for (std::size_t n : {0, 10, 5000, 10007}) {
+    auto records = make_records(n);
+    auto expect = struct_pack::serialize(records);
+    for (std::size_t threads : {1, 2, 3, 8}) {
+      std::vector<char> buffer;
+      struct_pack::serialize_to_parallel(
+          buffer, records, coro_io::get_global_block_executor(), threads);
+      CHECK(buffer == expect);
+
+      std::vector<record> out;
+      auto ec = struct_pack::deserialize_to_parallel(
+          out, buffer, coro_io::get_global_block_executor(), threads);
+      CHECK(!ec);
+      CHECK(out == records);
+    }
+  }
+}
+
+TEST_CASE("test parallel serialize with offset and wide length") {
+  // the length of name needs 2 bytes, so the size_type isn't the default.
+  auto records = make_records(4000, 300);
+  std::string buffer = "head";
+  auto executor = coro_io::get_global_block_executor();
+  struct_pack::serialize_to_parallel(buffer, records, executor, 4);
+  std::string expect = "head";
+  struct_pack::serialize_to(expect, records);
+  CHECK(buffer == expect);
+
+  std::vector<record> out = make_records(10);
+  auto ec = struct_pack::deserialize_to_parallel(
+      out, buffer.data() + 4, buffer.size() - 4, executor, 4);
+  CHECK(!ec);
+  CHECK(out == records);
+}
+
+TEST_CASE("test parallel deserialize error") {
+  auto records = make_records(5000);
+  auto buffer = struct_pack::serialize(records);
+  auto executor = coro_io::get_global_block_executor();
+  std::vector<record> out;
+  buffer.pop_back();
+  CHECK(struct_pack::deserialize_to_parallel(out, buffer, executor, 4) ==
+        struct_pack::errc::no_buffer_space);
+
+  auto other = struct_pack::serialize(std::vector<std::string>{"hello"});
+  CHECK(struct_pack::deserialize_to_parallel(out, other, executor, 4) ==
+        struct_pack::errc::invalid_buffer);
+}
+
+TEST_CASE("test parallel serialize in the thread of the executor") {
+  // the caller runs the chunks itself when the executor is busy, e.g. it's
+  // the only thread of the executor.
+  coro_io::io_context_pool pool(1);
+  std::thread thd([&] {
+    pool.run();
+  });
+  auto records = make_records(5000);
+  auto expect = struct_pack::serialize(records);
+  std::promise<std::vector<char>> promise;
+  auto executor = pool.get_executor();
+  executor->schedule([&] {
+    std::vector<char> buffer;
+    struct_pack::serialize_to_parallel(buffer, records, executor, 4);
+    promise.set_value(std::move(buffer));
+  });
+  CHECK(promise.get_future().get() == expect);
+  pool.stop();
+  thd.join();
+}
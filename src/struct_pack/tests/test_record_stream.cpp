@@ -0,0 +1,249 @@
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <ylt/coro_io/coro_file.hpp>
+#include <ylt/struct_pack.hpp>
+#include <ylt/struct_pack/async_record_stream.hpp>
+#include <ylt/struct_pack/record_stream.hpp>
+
+#include "doctest.h"
+
+namespace test_record_stream {
+struct event {
+  int64_t id;
+  std::string name;
+  std::vector<int> values;
+  bool operator==(const event &) const = default;
+};
+
+event make_event(int i) {
+  return {i, std::string(i % 13, 'a' + i % 26), std::vector<int>(i % 4, i)};
+}
+
+struct string_writer {
+  std::string &buffer;
+  void write(const char *data, std::size_t size) { buffer.append(data, size); }
+};
+
+std::string write_events(int n, std::size_t sync_interval) {
+  std::string buffer;
+  string_writer writer{buffer};
+  struct_pack::record_writer out(writer, sync_interval);
+  for (int i = 0; i < n; ++i) {
+    out.write(make_event(i));
+  }
+  CHECK(out.count() == n);
+  return buffer;
+}
+}  // namespace test_record_stream
+
+using namespace test_record_stream;
+
+TEST_CASE("test record stream") {
+  std::stringstream ss;
+  {
+    struct_pack::record_writer out(ss, 10);
+    for (int i = 0; i < 1000; ++i) {
+      out.write(make_event(i));
+    }
+  }
+
+  struct_pack::record_reader in(ss);
+  event e;
+  int i = 0;
+  while (!in.read(e)) {
+    CHECK(e == make_event(i));
+    ++i;
+  }
+  CHECK(i == 1000);
+  CHECK(in.eof());
+}
+
+TEST_CASE("test record decoder with chunks") {
+  auto buffer = write_events(500, 7);
+  for (std::size_t chunk : {1, 7, 64, 100000}) {
+    struct_pack::record_decoder decoder;
+    event e;
+    int i = 0;
+    for (std::size_t pos = 0; pos < buffer.size(); pos += chunk) {
+      decoder.feed(std::string_view{buffer}.substr(pos, chunk));
+      struct_pack::err_code ec;
+      while (!(ec = decoder.next(e))) {
+        CHECK(e == make_event(i));
+        ++i;
+      }
+      CHECK(ec == struct_pack::errc::no_buffer_space);
+      CHECK(decoder.need_more());
+    }
+    CHECK(i == 500);
+    CHECK(decoder.pending() == 0);
+  }
+}
+
+TEST_CASE("test record stream resync") {
+  auto buffer = write_events(100, 10);
+  // break a record in the second group, [10, 20) are lost.
+  auto pos = buffer.find(std::string_view{struct_pack::detail::sync_marker,
+                                          sizeof(struct_pack::detail::sync_marker)},
+                         1);
+  REQUIRE(pos != std::string::npos);
+  buffer[pos + sizeof(struct_pack::detail::sync_marker)] = 'x';
+
+  SUBCASE("reader") {
+    std::stringstream ss(buffer);
+    struct_pack::record_reader in(ss);
+    event e;
+    std::vector<int64_t> ids;
+    while (true) {
+      auto ec = in.read(e);
+      if (ec == struct_pack::errc::invalid_buffer) {
+        if (!in.resync()) {
+          break;
+        }
+        continue;
+      }
+      if (ec) {
+        break;
+      }
+      ids.push_back(e.id);
+    }
+    CHECK(in.eof());
+    REQUIRE(ids.size() == 90);
+    CHECK(ids[9] == 9);
+    CHECK(ids[10] == 20);
+  }
+
+  SUBCASE("decoder") {
+    struct_pack::record_decoder decoder;
+    event e;
+    std::vector<int64_t> ids;
+    for (std::size_t i = 0; i < buffer.size(); i += 5) {
+      decoder.feed(std::string_view{buffer}.substr(i, 5));
+      while (true) {
+        auto ec = decoder.next(e);
+        if (ec == struct_pack::errc::invalid_buffer) {
+          if (!decoder.resync()) {
+            break;
+          }
+          continue;
+        }
+        if (ec) {
+          break;
+        }
+        ids.push_back(e.id);
+      }
+    }
+    REQUIRE(ids.size() == 90);
+    CHECK(ids[9] == 9);
+    CHECK(ids[10] == 20);
+  }
+}
+
+TEST_CASE("test record stream max record size") {
+  std::stringstream ss;
+  struct_pack::record_writer out(ss);
+  out.write(std::string(1000, 'a'));
+
+  std::string result;
+  {
+    std::stringstream in_ss(ss.str());
+    struct_pack::record_reader in(in_ss, 100);
+    CHECK(in.read(result) == struct_pack::errc::invalid_buffer);
+  }
+  {
+    std::stringstream in_ss(ss.str());
+    struct_pack::record_reader in(in_ss, 2000);
+    CHECK(!in.read(result));
+    CHECK(result == std::string(1000, 'a'));
+  }
+
+  struct_pack::record_decoder decoder(100);
+  decoder.feed(ss.str());
+  CHECK(decoder.next(result) == struct_pack::errc::invalid_buffer);
+  CHECK(!decoder.need_more());
+}
+
+TEST_CASE("test record stream truncated") {
+  auto buffer = write_events(3, 2);
+  auto marker_pos = buffer.rfind(std::string_view{
+      struct_pack::detail::sync_marker, sizeof(struct_pack::detail::sync_marker)});
+  REQUIRE(marker_pos != std::string::npos);
+  // inside the second sync marker, in the length of the last record and in
+  // its body.
+  for (std::size_t size :
+       {marker_pos + 3, buffer.size() - make_event(2).name.size() - 10,
+        buffer.size() - 1}) {
+    std::stringstream ss(buffer.substr(0, size));
+    struct_pack::record_reader in(ss);
+    event e;
+    struct_pack::err_code ec;
+    while (!(ec = in.read(e))) {
+    }
+    CHECK(ec == struct_pack::errc::no_buffer_space);
+    CHECK(!in.eof());
+    CHECK(in.truncated());
+  }
+
+  std::stringstream ss(buffer);
+  struct_pack::record_reader in(ss);
+  event e;
+  while (!in.read(e)) {
+  }
+  CHECK(in.eof());
+  CHECK(!in.truncated());
+}
+
+TEST_CASE("test record stream with coro_file") {
+  std::string filename = "test_record_stream.data";
+  std::vector<event> events;
+  for (int i = 0; i < 1000; ++i) {
+    events.push_back(make_event(i));
+  }
+  {
+    coro_io::coro_file file;
+    file.open(filename, std::ios::out | std::ios::trunc);
+    REQUIRE(file.is_open());
+    auto ec = async_simple::coro::syncAwait(
+        struct_pack::async_write_records(file, events, 100, 1000));
+    CHECK(!ec);
+  }
+
+  coro_io::coro_file file;
+  file.open(filename, std::ios::in);
+  REQUIRE(file.is_open());
+  std::vector<event> result;
+  auto ec = async_simple::coro::syncAwait(
+      struct_pack::async_read_records<event>(
+          file,
+          [&result](event &&e) {
+            result.push_back(std::move(e));
+          },
+          1000));
+  CHECK(!ec);
+  CHECK(result == events);
+
+  // a truncated file.
+  std::string buffer;
+  {
+    std::ifstream in(filename, std::ios::binary);
+    buffer.assign(std::istreambuf_iterator<char>(in), {});
+  }
+  {
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    out << buffer.substr(0, buffer.size() - 1);
+  }
+  coro_io::coro_file truncated;
+  truncated.open(filename, std::ios::in);
+  std::size_t count = 0;
+  ec = async_simple::coro::syncAwait(struct_pack::async_read_records<event>(
+      truncated, [&count](event &&) {
+        ++count;
+      }));
+  CHECK(ec == struct_pack::make_error_code(struct_pack::errc::no_buffer_space));
+  CHECK(count == 999);
+  std::remove(filename.c_str());
+}
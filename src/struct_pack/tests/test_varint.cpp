@@ -1,4 +1,5 @@
 #include <cstdint>
+#include <sstream>
 #include <ylt/struct_pack.hpp>
 
 #include "doctest.h"
@@ -865,4 +866,63 @@ TEST_CASE("test varint by normal int") {
   REQUIRE(result.has_value());
   CHECK(result == v);
   CHECK(buffer.size() == 4);
-}
\ No newline at end of file
+}
+TEST_CASE("test varint container") {
+  std::vector<var_int64_t> vec;
+  std::vector<var_uint64_t> uvec;
+  std::vector<var_int32_t> vec32;
+  for (int shift = 0; shift < 64; ++shift) {
+    int64_t v = (int64_t)(1ull << shift);
+    vec.push_back(v - 1);
+    vec.push_back(v);
+    vec.push_back(-v);
+    uvec.push_back((1ull << shift) - 1);
+    uvec.push_back(1ull << shift);
+    vec32.push_back((int32_t)(v >> 32));
+  }
+  vec.push_back(INT64_MIN);
+  vec.push_back(INT64_MAX);
+  uvec.push_back(UINT64_MAX);
+
+  // the bulk path writes the same bytes as the element by element one.
+  std::list<var_int64_t> lst(vec.begin(), vec.end());
+  auto buffer = serialize<sp_config::DISABLE_ALL_META_INFO>(vec);
+  CHECK(buffer == serialize<sp_config::DISABLE_ALL_META_INFO>(lst));
+  auto result =
+      deserialize<sp_config::DISABLE_ALL_META_INFO, std::vector<var_int64_t>>(
+          buffer);
+  REQUIRE(result.has_value());
+  CHECK(result.value() == vec);
+
+  auto ubuffer = serialize(uvec);
+  auto uresult = deserialize<std::vector<var_uint64_t>>(ubuffer);
+  REQUIRE(uresult.has_value());
+  CHECK(uresult.value() == uvec);
+
+  auto buffer32 = serialize(vec32);
+  auto result32 = deserialize<std::vector<var_int32_t>>(buffer32);
+  REQUIRE(result32.has_value());
+  CHECK(result32.value() == vec32);
+
+  // stream reader goes through the checked path.
+  std::stringstream ss;
+  serialize_to(ss, uvec);
+  std::vector<var_uint64_t> from_stream;
+  CHECK(!deserialize_to(from_stream, ss));
+  CHECK(from_stream == uvec);
+
+  std::vector<var_uint64_t> truncated;
+  CHECK(deserialize_to(truncated, ubuffer.data(), ubuffer.size() - 1) ==
+        struct_pack::errc::no_buffer_space);
+
+  // a varint longer than 10 bytes is invalid.
+  auto bad = serialize<sp_config::DISABLE_ALL_META_INFO>(
+      std::vector<var_uint64_t>{0});
+  bad.pop_back();
+  bad.insert(bad.end(), 11, (char)0x80);
+  bad.insert(bad.end(), 10, 0);
+  std::vector<var_uint64_t> invalid;
+  CHECK(deserialize_to<sp_config::DISABLE_ALL_META_INFO>(invalid, bad.data(),
+                                                         bad.size()) ==
+        struct_pack::errc::invalid_buffer);
+}
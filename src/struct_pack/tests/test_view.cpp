@@ -0,0 +1,144 @@
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <ylt/struct_pack.hpp>
+#include <ylt/struct_pack/view.hpp>
+
+#include "doctest.h"
+
+namespace test_view {
+struct person {
+  int64_t id;
+  std::string name;
+  int age;
+  bool operator==(const person&) const = default;
+};
+
+struct order {
+  int64_t id;
+  person buyer;
+  std::vector<int> items;
+  std::map<std::string, std::string> tags;
+  std::optional<person> seller;
+  std::vector<person> history;
+  bool operator==(const order&) const = default;
+};
+
+struct varint_message {
+  int32_t a;
+  std::string b;
+  int64_t c;
+  bool operator==(const varint_message&) const = default;
+};
+constexpr struct_pack::sp_config set_sp_config(varint_message*) {
+  return struct_pack::ENCODING_WITH_VARINT;
+}
+
+order make_order() {
+  return order{42,
+               person{1, "tom", 20},
+               {1, 2, 3},
+               {{"k", "v"}, {"hello", "world"}},
+               person{2, "jerry", 30},
+               {person{3, "a", 1}, person{4, "b", 2}}};
+}
+}  // namespace test_view
+
+using namespace test_view;
+
+TEST_CASE("test view") {
+  auto o = make_order();
+  auto buffer = struct_pack::serialize(o);
+
+  auto v = struct_pack::get_view<order>(buffer);
+  REQUIRE(v.has_value());
+  CHECK(v->raw() == std::string_view(buffer.data(), buffer.size()));
+
+  // out of order access
+  CHECK(v->get<5>()->size() == 2);
+  CHECK(v->get<0>().value() == 42);
+  CHECK(v->get<2>().value() == o.items);
+  CHECK(v->get<3>().value() == o.tags);
+  CHECK(v->get<4>().value() == o.seller);
+
+  auto buyer = v->get<1>().value();
+  static_assert(std::is_same_v<decltype(buyer), struct_pack::view<person>>);
+  CHECK(buyer.get<2>().value() == 20);
+  std::string_view name = buyer.get<1>().value();
+  CHECK(name == "tom");
+  // zero copy, the name points into the buffer.
+  CHECK(name.data() > buffer.data());
+  CHECK(name.data() < buffer.data() + buffer.size());
+  CHECK(buyer.get<0>().value() == 1);
+
+  person p;
+  CHECK(!buyer.deserialize_to(p));
+  CHECK(p == o.buyer);
+
+  std::vector<int> items;
+  CHECK(!v->get_to<2>(items));
+  CHECK(items == o.items);
+
+  order all;
+  CHECK(!v->deserialize_to(all));
+  CHECK(all == o);
+}
+
+TEST_CASE("test view raw") {
+  auto o = make_order();
+  auto buffer = struct_pack::serialize(o);
+  auto v = struct_pack::get_view<order>(buffer);
+  REQUIRE(v.has_value());
+
+  // the serialized fields can be copied into another message as is.
+  std::string forwarded;
+  for (auto field : {v->raw<0>(), v->raw<1>(), v->raw<2>(), v->raw<3>(),
+                     v->raw<4>(), v->raw<5>()}) {
+    forwarded.append(field.value());
+  }
+  CHECK(std::string_view(buffer.data(), buffer.size()).ends_with(forwarded));
+  CHECK(v->raw<0>()->data() + forwarded.size() ==
+        buffer.data() + buffer.size());
+
+  auto buyer = v->get<1>().value();
+  CHECK(v->raw<1>() == buyer.raw());
+  CHECK(buyer.raw<1>()->size() == 1 + 3);
+
+  // trailing data isn't part of the view.
+  auto longer = buffer;
+  longer.push_back('x');
+  auto v2 = struct_pack::get_view<order>(longer);
+  REQUIRE(v2.has_value());
+  CHECK(v2->raw().size() == buffer.size());
+}
+
+TEST_CASE("test view varint and errors") {
+  varint_message m{-1, "hello", 1LL << 40};
+  auto buffer = struct_pack::serialize(m);
+  auto v = struct_pack::get_view<varint_message>(buffer);
+  REQUIRE(v.has_value());
+  CHECK(v->get<0>().value() == -1);
+  CHECK(v->get<1>().value() == "hello");
+  CHECK(v->get<2>().value() == (1LL << 40));
+
+  buffer.pop_back();
+  auto v2 = struct_pack::get_view<varint_message>(buffer);
+  REQUIRE(!v2.has_value());
+  CHECK(v2.error() == struct_pack::errc::no_buffer_space);
+
+  auto o = struct_pack::serialize(make_order());
+  auto v3 = struct_pack::get_view<person>(o);
+  REQUIRE(!v3.has_value());
+  CHECK(v3.error() == struct_pack::errc::invalid_buffer);
+
+  auto o2 = struct_pack::serialize<struct_pack::sp_config::DISABLE_ALL_META_INFO>(
+      make_order());
+  auto v4 =
+      struct_pack::get_view<order, struct_pack::sp_config::DISABLE_ALL_META_INFO>(
+          o2);
+  REQUIRE(v4.has_value());
+  CHECK(v4->get<1>()->get<1>() == "tom");
+}
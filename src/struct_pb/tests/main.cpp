@@ -1,5 +1,7 @@
 #define DOCTEST_CONFIG_IMPLEMENT
+#include <deque>
 #include <iostream>
+#include <list>
 
 #include "doctest.h"
 #include "unittest_proto3.h"
@@ -1136,6 +1138,181 @@ TEST_CASE("test variant") {
   }
 }
 
+struct packed_t {
+  std::vector<int32_t> i32;
+  std::vector<int64_t> i64;
+  std::vector<uint64_t> u64;
+  std::vector<iguana::sint32_t> s32;
+  std::vector<iguana::sint64_t> s64;
+  std::vector<bool> flags;
+  std::vector<float> f;
+  std::vector<double> d;
+  std::vector<iguana::fixed32_t> fx32;
+  std::vector<iguana::sfixed64_t> sfx64;
+};
+YLT_REFL(packed_t, i32, i64, u64, s32, s64, flags, f, d, fx32, sfx64);
+
+TEST_CASE("test packed repeated fields") {
+  {
+    packed_t st;
+    st.i32 = {1, 150, -1};
+    std::string str;
+    iguana::to_pb(st, str);
+    // the negative int32 takes 10 bytes, like protobuf writes it.
+    CHECK(str == std::string("\x0a\x0d\x01\x96\x01\xff\xff\xff\xff\xff\xff"
+                             "\xff\xff\xff\x01",
+                             15));
+  }
+
+  packed_t st;
+  // runs of one byte varints and varints crossing the blocks of 64 bytes.
+  for (int i = 0; i < 1000; ++i) {
+    st.i32.push_back(i % 300 < 200 ? i % 100 : -i * 1000);
+    st.i64.push_back(int64_t(i) << (i % 60));
+    st.u64.push_back(i % 3 == 0 ? uint64_t(-1) - i : uint64_t(i));
+    st.s32.push_back({i % 2 ? -i : i});
+    st.s64.push_back({-(int64_t(i) << 40)});
+    st.flags.push_back(i % 3 == 0);
+    st.f.push_back(i * 0.5f);
+    st.d.push_back(i * 0.25);
+    st.fx32.push_back({uint32_t(i * 7)});
+    st.sfx64.push_back({-i});
+  }
+  std::string str;
+  iguana::to_pb(st, str);
+
+  packed_t st1;
+  iguana::from_pb(st1, str);
+  CHECK(st1.i32 == st.i32);
+  CHECK(st1.i64 == st.i64);
+  CHECK(st1.u64 == st.u64);
+  CHECK(st1.s32 == st.s32);
+  CHECK(st1.s64 == st.s64);
+  CHECK(st1.flags == st.flags);
+  CHECK(st1.f == st.f);
+  CHECK(st1.d == st.d);
+  CHECK(st1.fx32 == st.fx32);
+  CHECK(st1.sfx64 == st.sfx64);
+
+  std::stringstream ss;
+  iguana::to_pb(st, ss);
+  CHECK(ss.str() == str);
+
+  {
+    // a truncated packed varint.
+    packed_t st2;
+    std::string bad("\x0a\x02\x96\x96", 4);
+    CHECK_THROWS_AS(iguana::from_pb(st2, bad), std::invalid_argument);
+  }
+  {
+    // a packed float with 3 bytes.
+    packed_t st2;
+    std::string bad("\x3a\x03\x00\x00\x00", 5);
+    CHECK_THROWS_AS(iguana::from_pb(st2, bad), std::invalid_argument);
+  }
+}
+
+struct packed_list_t {
+  std::deque<double> d;
+  std::list<float> f;
+  std::deque<iguana::fixed32_t> fx32;
+  std::list<int64_t> i64;
+};
+YLT_REFL(packed_list_t, d, f, fx32, i64);
+
+struct packed_vector_t {
+  std::vector<double> d;
+  std::vector<float> f;
+  std::vector<iguana::fixed32_t> fx32;
+  std::vector<int64_t> i64;
+};
+YLT_REFL(packed_vector_t, d, f, fx32, i64);
+
+TEST_CASE("test packed fields of deque and list") {
+  packed_list_t st;
+  packed_vector_t expected;
+  for (int i = 0; i < 100; ++i) {
+    st.d.push_back(i * 0.25);
+    st.f.push_back(i * 0.5f);
+    st.fx32.push_back({uint32_t(i * 7)});
+    st.i64.push_back(-i);
+    expected.d.push_back(i * 0.25);
+    expected.f.push_back(i * 0.5f);
+    expected.fx32.push_back({uint32_t(i * 7)});
+    expected.i64.push_back(-i);
+  }
+  std::string str;
+  iguana::to_pb(st, str);
+  // written like the vectors.
+  std::string expected_str;
+  iguana::to_pb(expected, expected_str);
+  CHECK(str == expected_str);
+
+  packed_list_t st2;
+  iguana::from_pb(st2, str);
+  CHECK(st2.d == st.d);
+  CHECK(st2.f == st.f);
+  CHECK(st2.fx32 == st.fx32);
+  CHECK(st2.i64 == st.i64);
+}
+
+#if __cplusplus > 201703L
+struct blob_t {
+  int32_t id;
+  std::string name;
+  std::vector<double> values;
+  std::string data;
+};
+YLT_REFL(blob_t, id, name, values, data);
+
+struct blob_view_t {
+  int32_t id;
+  std::string_view name;
+  std::span<const double> values;
+  std::string_view data;
+};
+YLT_REFL(blob_view_t, id, name, values, data);
+
+TEST_CASE("test string_view and span fields") {
+  blob_t st{42, "blob", {0.5, 1.5, 2.5}, std::string(1 << 20, 'x')};
+  std::string str;
+  iguana::to_pb(st, str);
+
+  blob_view_t v;
+  iguana::from_pb(v, str);
+  CHECK(v.id == 42);
+  CHECK(v.name == "blob");
+  CHECK(std::vector<double>(v.values.begin(), v.values.end()) == st.values);
+  CHECK(v.data == st.data);
+  // the fields point into the buffer.
+  CHECK(v.name.data() > str.data());
+  CHECK((const char *)v.values.data() > v.name.data());
+  CHECK(v.data.data() + v.data.size() == str.data() + str.size());
+
+  // written like the owning types.
+  std::string str1;
+  iguana::to_pb(v, str1);
+  CHECK(str1 == str);
+
+  {
+    // a packed double with 12 bytes.
+    blob_view_t v1;
+    std::string bad("\x1a\x0c\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00",
+                    14);
+    CHECK_THROWS_AS(iguana::from_pb(v1, bad), std::invalid_argument);
+  }
+  {
+    // the packed doubles in two parts, as merged messages have them.
+    std::string parts("\x1a\x08\x00\x00\x00\x00\x00\x00\xe0\x3f", 10);
+    blob_t merged;
+    iguana::from_pb(merged, parts + parts);
+    CHECK(merged.values == std::vector<double>{0.5, 0.5});
+    blob_view_t v1;
+    CHECK_THROWS_AS(iguana::from_pb(v1, parts + parts), std::invalid_argument);
+  }
+}
+#endif
+
 #if defined(__clang__) || defined(_MSC_VER) || \
     (defined(__GNUC__) && __GNUC__ > 8)
 struct person PUBLIC(person) {
@@ -1228,6 +1405,15 @@ TEST_CASE("struct to proto") {
     std::cout << str;
     CHECK(str.find("int32 age = 3;") != std::string::npos);
   }
+#if __cplusplus > 201703L
+  {
+    std::string str;
+    iguana::to_proto<blob_view_t>(str);
+    std::cout << str;
+    CHECK(str.find("string  name = 2;") != std::string::npos);
+    CHECK(str.find("repeated  double values = 3;") != std::string::npos);
+  }
+#endif
 }
 #endif
 
@@ -8,6 +8,7 @@
 #include <fstream>
 #include <iostream>
 #include <memory>
+#include <set>
 
 #include "struct_code_generator.hpp"
 #include "struct_token.hpp"
@@ -37,6 +38,37 @@ bool write_to_output(google::protobuf::io::ZeroCopyOutputStream* output,
   }
 }
 
+// the field named "message.field" of the messages and their nested messages,
+// which can be a view.
+bool find_view_field(const google::protobuf::FileDescriptor* file,
+                     const std::string& name) {
+  size_t dot = name.find('.');
+  if (dot == std::string::npos) {
+    return false;
+  }
+  std::string message_name = name.substr(0, dot);
+  std::string field_name = name.substr(dot + 1);
+  auto match = [&](const google::protobuf::Descriptor* descriptor) {
+    if (descriptor->name() != message_name) {
+      return false;
+    }
+    auto field = descriptor->FindFieldByName(field_name);
+    return field != nullptr && can_be_view(field);
+  };
+  for (int i = 0; i < file->message_type_count(); ++i) {
+    const google::protobuf::Descriptor* descriptor = file->message_type(i);
+    if (match(descriptor)) {
+      return true;
+    }
+    for (int k = 0; k < descriptor->nested_type_count(); ++k) {
+      if (match(descriptor->nested_type(k))) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
 class struct_code_generator : public google::protobuf::compiler::CodeGenerator {
  public:
   virtual ~struct_code_generator() {}
@@ -62,6 +94,22 @@ class struct_code_generator : public google::protobuf::compiler::CodeGenerator {
       enable_inherit = true;
     }
 
+    // view=message.field, the field aliases the parsed buffer.
+    std::set<std::string> view_fields;
+    for (size_t pos = parameter.find("view="); pos != std::string::npos;
+         pos = parameter.find("view=", pos)) {
+      pos += 5;
+      size_t end = parameter.find_first_of("+,", pos);
+      view_fields.insert(parameter.substr(pos, end - pos));
+    }
+    for (auto& name : view_fields) {
+      if (!find_view_field(file, name)) {
+        *error = "view=" + name +
+                 ": not a string, bytes or packed fixed-width repeated field";
+        return false;
+      }
+    }
+
     // Use ZeroCopyOutputStream
     google::protobuf::io::ZeroCopyOutputStream* zero_copy_output = output;
 
@@ -78,7 +126,7 @@ class struct_code_generator : public google::protobuf::compiler::CodeGenerator {
 
         const google::protobuf::Descriptor* nested_type =
             descriptor->nested_type(k);
-        tokenizer_nested.tokenizer(nested_type);
+        tokenizer_nested.tokenizer(nested_type, view_fields);
         proto_module_info.emplace_back(tokenizer_nested);
       }
 
@@ -89,11 +137,18 @@ class struct_code_generator : public google::protobuf::compiler::CodeGenerator {
 
       struct_tokenizer tokenizer;
       tokenizer.clear();
-      tokenizer.tokenizer(descriptor);
+      tokenizer.tokenizer(descriptor, view_fields);
       proto_module_info.emplace_back(tokenizer);
     }
 
-    std::string struct_header = code_generate_header(package_name);
+    bool has_span = false;
+    for (auto& single_struct : proto_module_info) {
+      for (auto& token : single_struct.get_tokens()) {
+        has_span |= token.view && token.lable == lable_type::lable_repeated;
+      }
+    }
+
+    std::string struct_header = code_generate_header(package_name, has_span);
     write_to_output(zero_copy_output, (const void*)struct_header.c_str(),
                     struct_header.size());
 
@@ -5,8 +5,13 @@
 
 char parameter_value[27] = "abcdefghijklmnopqrstuvwxyz";
 
-std::string code_generate_header(const std::string &package_name) {
-  std::string result = "#pragma once\n#include <ylt/struct_pb.hpp>\n\n";
+std::string code_generate_header(const std::string &package_name,
+                                 bool has_span = false) {
+  std::string result = "#pragma once\n";
+  if (has_span) {
+    result.append("#include <span>\n");
+  }
+  result.append("#include <ylt/struct_pb.hpp>\n\n");
 
   result.append("namespace ");
   result.append(package_name);
@@ -44,7 +49,7 @@ std::string code_generate_struct_constructor(
   for (auto it = lists.begin(); it != lists.end(); it++) {
     if (it->type == struct_token_type::pod) {
       if (it->lable == lable_type::lable_repeated) {
-        result.append("std::vector<");
+        result.append(it->view ? "std::span<const " : "std::vector<");
         result.append(it->type_name);
         result.append("> ");
         result += parameter_value[i];
@@ -76,6 +81,9 @@ std::string code_generate_struct_constructor(
 
         result.append("std::");
         result.append(it->type_name);
+        if (it->view) {
+          result.append("_view");
+        }
         if (add_optional) {
           result.append(">");
         }
@@ -193,7 +201,7 @@ std::string code_generate_body(const std::vector<struct_token> &lists,
         if (ll.type == struct_token_type::message && add_optional) {
           result.append("std::optional<");
         }
-        result.append("std::vector<");
+        result.append(ll.view ? "std::span<const " : "std::vector<");
         result.append(ll.type_name);
         result.append(">");
         if (ll.type == struct_token_type::message && add_optional) {
@@ -212,6 +220,8 @@ std::string code_generate_body(const std::vector<struct_token> &lists,
       if (ll.type == struct_token_type::proto_string)
         result.append("std::");
       result.append(ll.type_name);
+      if (ll.view)
+        result.append("_view");
       if (ll.type != struct_token_type::pod &&
           ll.type != struct_token_type::enum_type && add_optional) {
         result.append(">");
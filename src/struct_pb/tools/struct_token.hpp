@@ -1,6 +1,7 @@
 #pragma once
 #include <google/protobuf/descriptor.h>
 
+#include <set>
 #include <string>
 #include <vector>
 
@@ -25,6 +26,7 @@ struct struct_token {
     this->type_name = "";
     this->type = struct_token_type::null_type;
     this->lable = lable_type::lable_null;
+    this->view = false;
   }
 
   void clear();
@@ -32,19 +34,48 @@ struct struct_token {
   std::string type_name;
   struct_token_type type;
   lable_type lable;
+  // std::string_view or std::span<const T> pointing into the parsed buffer.
+  bool view;
 };
 
+// string/bytes and packed repeated fixed-width fields can be views.
+inline bool can_be_view(const google::protobuf::FieldDescriptor* field) {
+  using field_descriptor = google::protobuf::FieldDescriptor;
+  if (field->is_repeated()) {
+    if (!field->is_packed()) {
+      return false;
+    }
+    switch (field->type()) {
+      case field_descriptor::TYPE_FIXED32:
+      case field_descriptor::TYPE_FIXED64:
+      case field_descriptor::TYPE_SFIXED32:
+      case field_descriptor::TYPE_SFIXED64:
+      case field_descriptor::TYPE_FLOAT:
+      case field_descriptor::TYPE_DOUBLE:
+        return true;
+      default:
+        return false;
+    }
+  }
+  return field->type() == field_descriptor::TYPE_STRING ||
+         field->type() == field_descriptor::TYPE_BYTES;
+}
+
 class struct_tokenizer {
  public:
   struct_tokenizer() { clear(); }
 
-  void tokenizer(const google::protobuf::Descriptor* descriptor) {
+  // view_fields are the "message.field" to be views, see can_be_view.
+  void tokenizer(const google::protobuf::Descriptor* descriptor,
+                 const std::set<std::string>& view_fields = {}) {
     struct_name_ = descriptor->name();
     for (int j = 0; j < descriptor->field_count(); ++j) {
       struct_token token = {};
       const google::protobuf::FieldDescriptor* field = descriptor->field(j);
 
       token.var_name = field->name();
+      token.view = can_be_view(field) &&
+                   view_fields.count(struct_name_ + "." + field->name()) > 0;
       if (field->type() == google::protobuf::FieldDescriptor::TYPE_MESSAGE) {
         token.type_name = field->message_type()->name();
         token.type = struct_token_type::message;
@@ -69,7 +100,10 @@ class struct_tokenizer {
         }
         else {
           token.type = struct_token_type::pod;
-          if (token.type_name.find("int") != std::string::npos)
+          if (token.type_name.find("sint") == 0 ||
+              token.type_name.find("fixed") != std::string::npos)
+            token.type_name = "iguana::" + token.type_name + "_t";
+          else if (token.type_name.find("int") != std::string::npos)
             token.type_name += "_t";
         }
       }
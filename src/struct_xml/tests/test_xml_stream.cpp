@@ -0,0 +1,212 @@
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "async_simple/coro/SyncAwait.h"
+#include "doctest.h"
+#include "ylt/coro_io/coro_file.hpp"
+#include "ylt/struct_xml/xml_stream.h"
+
+namespace test_xml_stream {
+struct item_t {
+  int id;
+  std::string name;
+  std::vector<int> values;
+  bool operator==(const item_t &) const = default;
+};
+YLT_REFL(item_t, id, name, values);
+
+std::vector<item_t> make_items(int n) {
+  std::vector<item_t> items;
+  for (int i = 0; i < n; ++i) {
+    items.push_back({i, "name <" + std::to_string(i) + "> & \"/\"", {i, i + 1}});
+  }
+  return items;
+}
+
+std::string make_feed(const std::vector<item_t> &items) {
+  std::string xml =
+      "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<!-- a <feed> -->\n"
+      "<feed version='2' note=\"a > b\">\n";
+  for (auto &item : items) {
+    xml.append("  <item><id>").append(std::to_string(item.id));
+    xml.append("</id><name>");
+    for (char c : item.name) {
+      if (c == '<')
+        xml.append("&lt;");
+      else if (c == '>')
+        xml.append("&gt;");
+      else if (c == '&')
+        xml.append("&amp;");
+      else if (c == '"')
+        xml.append("&quot;");
+      else
+        xml.push_back(c);
+    }
+    xml.append("</name>");
+    for (int v : item.values) {
+      xml.append("<values>").append(std::to_string(v)).append("</values>");
+    }
+    xml.append("</item>\n  <!-- </item> -->\n");
+  }
+  xml.append("</feed>\n");
+  return xml;
+}
+
+// read xml split into the chunks of chunk_size bytes.
+template <typename T>
+std::vector<T> read_by_chunks(std::string_view xml, size_t chunk_size) {
+  std::vector<T> result;
+  iguana::xml_element_reader<T> reader;
+  for (size_t pos = 0; pos < xml.size(); pos += chunk_size) {
+    reader.feed(xml.substr(pos, chunk_size), [&](T &&t) {
+      result.push_back(std::move(t));
+    });
+  }
+  reader.finish();
+  return result;
+}
+
+struct event_log {
+  std::string log;
+  void start_element(std::string_view name) {
+    log.append("<").append(name).append(">");
+  }
+  void attribute(std::string_view name, std::string_view value) {
+    log.append("@").append(name).append("=").append(value).append(";");
+  }
+  void text(std::string_view value) {
+    log.append("[").append(value).append("]");
+  }
+  void end_element(std::string_view name) {
+    log.append("</").append(name).append(">");
+  }
+};
+}  // namespace test_xml_stream
+
+using namespace test_xml_stream;
+
+TEST_CASE("test xml sax") {
+  std::string xml = R"(<?xml version="1.0"?>
+<!DOCTYPE root>
+<root a="1 &amp; 2" b = 'x&quot;y'>
+  <!-- skipped -->
+  <child>  text &lt;&#x4e2d;&#65;&gt; end </child>
+  <empty flag="&#65;"/>
+  <![CDATA[<raw> &amp;]]>
+  <unknown>&foo; &quux; &</unknown>
+</root>
+)";
+  const char *begin = xml.data();
+  std::vector<std::string_view> views;
+  struct view_handler : event_log {
+    std::vector<std::string_view> *views;
+    void text(std::string_view value) {
+      event_log::text(value);
+      views->push_back(value);
+    }
+  } handler;
+  handler.views = &views;
+  iguana::parse_xml_sax(xml, handler);
+  CHECK(handler.log ==
+        "<root>@a=1 & 2;@b=x\"y;<child>[text <\xe4\xb8\xad"
+        "A> end]</child><empty>@flag=A;</empty>[<raw> &amp;]"
+        "<unknown>[&foo; &quux; &]</unknown></root>");
+  // the text is unescaped in place.
+  for (auto view : views) {
+    CHECK(view.data() >= begin);
+    CHECK(view.data() + view.size() <= begin + xml.size());
+  }
+
+  for (std::string bad : {"<a><b></a>", "<a>", "<a b=c></a>", "</a>",
+                          "<a><![CDATA[x</a>", "<a b=\"1></a>"}) {
+    std::error_code ec;
+    event_log log;
+    iguana::parse_xml_sax(bad, log, ec);
+    CHECK_MESSAGE(ec, bad);
+  }
+}
+
+TEST_CASE("test xml element reader") {
+  auto items = make_items(5);
+  auto xml = make_feed(items);
+  for (size_t chunk_size = 1; chunk_size <= xml.size(); ++chunk_size) {
+    CHECK(read_by_chunks<item_t>(xml, chunk_size) == items);
+  }
+  CHECK(read_by_chunks<item_t>("<feed/>", 1).empty());
+  CHECK(read_by_chunks<item_t>("<feed>text</feed>", 3).empty());
+
+  // only the child split between the chunks is kept.
+  iguana::xml_element_reader<item_t> reader;
+  size_t count = 0;
+  auto on_item = [&count](item_t &&) {
+    ++count;
+  };
+  reader.feed(std::string_view(xml).substr(0, xml.size() / 2), on_item);
+  CHECK(reader.root_name() == "feed");
+  CHECK(reader.buffered_size() < xml.size() / 4);
+  CHECK_THROWS(reader.finish());
+  reader.feed(std::string_view(xml).substr(xml.size() / 2), on_item);
+  CHECK(reader.done());
+  CHECK(count == items.size());
+}
+
+TEST_CASE("test xml element reader errors") {
+  for (std::string_view xml :
+       {"text<feed></feed>", "</feed>", "<feed></other>", "<feed/><feed/>",
+        "<feed></feed>text", "<feed><item><id>x</id></item></feed>"}) {
+    iguana::xml_element_reader<item_t> reader;
+    std::error_code ec;
+    reader.feed(xml, [](item_t &&) {}, ec);
+    CHECK_MESSAGE(ec, xml);
+    // the reader stays failed.
+    reader.feed("<feed/>", [](item_t &&) {}, ec);
+    CHECK(ec);
+  }
+  iguana::xml_element_reader<item_t> reader;
+  reader.feed("<feed><item><id>1</id>", [](item_t &&) {});
+  CHECK_THROWS(reader.finish());
+  reader.reset();
+  reader.feed("<feed><item><id>3</id></item></feed>", [](item_t &&item) {
+    CHECK(item.id == 3);
+  });
+  CHECK(reader.done());
+}
+
+TEST_CASE("test xml elements from coro_file") {
+  auto items = make_items(1000);
+  auto xml = make_feed(items);
+  std::string filename = "test_xml_stream.data";
+  {
+    std::ofstream out(filename, std::ios::binary);
+    out << xml;
+  }
+
+  coro_io::coro_file file;
+  file.open(filename, std::ios::in);
+  REQUIRE(file.is_open());
+  std::vector<item_t> result;
+  auto ec = async_simple::coro::syncAwait(
+      struct_xml::async_read_xml_elements<item_t>(
+          file,
+          [&result](item_t &&item) {
+            result.push_back(std::move(item));
+          },
+          1000));
+  CHECK(!ec);
+  CHECK(result == items);
+
+  // a truncated file.
+  {
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    out << xml.substr(0, xml.size() - 10);
+  }
+  coro_io::coro_file truncated;
+  truncated.open(filename, std::ios::in);
+  ec = async_simple::coro::syncAwait(
+      struct_xml::async_read_xml_elements<item_t>(truncated,
+                                                  [](item_t &&) {}));
+  CHECK(ec);
+  std::remove(filename.c_str());
+}
@@ -0,0 +1,117 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "ylt/struct_yaml/yaml_reader.h"
+#include "ylt/struct_yaml/yaml_writer.h"
+
+/*
+load a data set snapshot: a sequence of records with nested mappings and
+sequences, as written by to_yaml. The slow path is from_yaml on iterators, the
+fast path is from_yaml on the string:
+./struct_yaml_benchmark [records] [rounds]
+*/
+
+namespace bench {
+struct location_t {
+  std::string region;
+  std::string zone;
+  double latitude;
+  double longitude;
+};
+YLT_REFL(location_t, region, zone, latitude, longitude);
+
+struct record_t {
+  int64_t id;
+  std::string name;
+  std::string description;
+  bool enabled;
+  double weight;
+  std::optional<int> priority;
+  std::vector<std::string> tags;
+  std::vector<int64_t> samples;
+  location_t location;
+  std::map<std::string, int> limits;
+};
+YLT_REFL(record_t, id, name, description, enabled, weight, priority, tags,
+         samples, location, limits);
+
+struct snapshot_t {
+  std::string version;
+  int64_t created_at;
+  std::vector<record_t> records;
+};
+YLT_REFL(snapshot_t, version, created_at, records);
+}  // namespace bench
+
+using namespace bench;
+
+snapshot_t make_snapshot(int n) {
+  snapshot_t s{"2.3.1", 1700000000000, {}};
+  for (int i = 0; i < n; ++i) {
+    record_t r;
+    r.id = 1186275104000 + i;
+    r.name = "record_" + std::to_string(i);
+    r.description = std::string(40 + i % 60, 'd');
+    r.enabled = i % 3 == 0;
+    r.weight = i * 0.25;
+    if (i % 2 == 0) {
+      r.priority = i % 10;
+    }
+    r.tags = {"alpha", "beta", "gamma"};
+    for (int j = 0; j < 6; ++j) {
+      r.samples.push_back(900000 + i * 6 + j);
+    }
+    r.location = {"us-east", "zone-" + std::to_string(i % 4), 40.5 + i % 10,
+                  -73.25 - i % 7};
+    r.limits = {{"cpu", 4 + i % 4}, {"memory", 1024}, {"disk", 20 + i % 30}};
+    s.records.push_back(std::move(r));
+  }
+  return s;
+}
+
+template <typename F>
+void run(const char *name, size_t bytes, size_t rounds, F &&f) {
+  size_t sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t i = 0; i < rounds; ++i) {
+    sink += f();
+  }
+  auto end = std::chrono::steady_clock::now();
+  static volatile size_t keep;
+  keep = sink;
+  auto us =
+      std::chrono::duration<double, std::micro>(end - start).count() / rounds;
+  std::printf("%-10s %10zu bytes %12.1f us %8.1f MB/s\n", name, bytes, us,
+              bytes / us);
+}
+
+int main(int argc, char **argv) {
+  int records = 20000;
+  size_t rounds = 10;
+  if (argc > 1) {
+    records = std::stoi(argv[1]);
+  }
+  if (argc > 2) {
+    rounds = std::stoul(argv[2]);
+  }
+  auto snapshot = make_snapshot(records);
+  std::string yaml;
+  iguana::to_yaml(snapshot, yaml);
+
+  run("slow path", yaml.size(), rounds, [&] {
+    snapshot_t s;
+    iguana::from_yaml(s, yaml.begin(), yaml.end());
+    return s.records.size();
+  });
+  run("fast path", yaml.size(), rounds, [&] {
+    snapshot_t s;
+    iguana::from_yaml(s, yaml);
+    return s.records.size();
+  });
+  return 0;
+}
@@ -1,6 +1,7 @@
 #include <deque>
 #include <iterator>
 #include <list>
+#include <map>
 #include <vector>
 #define DOCTEST_CONFIG_IMPLEMENT
 #include <iostream>
@@ -1058,6 +1059,140 @@ TEST_CASE("test string with default value") {
   std::cout << cfg.cert_file << std::endl;
 }
 
+struct fast_item_t {
+  int id;
+  std::string name;
+  std::vector<int> values;
+  std::optional<double> weight;
+};
+YLT_REFL(fast_item_t, id, name, values, weight);
+struct fast_config_t {
+  std::string version;
+  bool enabled;
+  enum_status status;
+  std::vector<std::string> hosts;
+  std::map<std::string, int> limits;
+  std::vector<fast_item_t> items;
+  std::vector<std::vector<int>> grid;
+  std::optional<fast_item_t> extra;
+};
+YLT_REFL(fast_config_t, version, enabled, status, hosts, limits, items, grid,
+         extra);
+
+TEST_CASE("test yaml fast path") {
+  // the fast path gives what the slow path gives.
+  auto check_same = [](std::string_view yaml, bool fast) {
+    fast_config_t by_fast{};
+    CHECK(iguana::detail::yaml_fast_reader::parse(by_fast, yaml.data(),
+                                                  yaml.size()) == fast);
+    fast_config_t by_view{}, by_slow{};
+    iguana::from_yaml(by_view, yaml);
+    iguana::from_yaml(by_slow, yaml.begin(), yaml.end());
+    std::string s1, s2;
+    iguana::to_yaml(by_view, s1);
+    iguana::to_yaml(by_slow, s2);
+    CHECK_MESSAGE(s1 == s2, yaml);
+    return by_view;
+  };
+  std::string yaml = R"(# a comment
+version: "1.2: beta" # the version
+enabled: true
+status: 1
+hosts:
+  - a.example.com
+  - 'b.example.com'
+  -   c
+limits:
+  cpu: 4
+  memory : 1024
+items:
+  - id: 1
+    name: first # trailing
+    values: [1, 2 ,3]
+    weight: 0.5
+  -
+    id: 2
+    name: ~
+    values:
+      - 4
+      - 5
+    weight: null
+grid:
+  - - 1
+    - 2
+  - - 3
+extra:
+  id: 3
+  name: 'x: y'
+  values: []
+)";
+  auto config = check_same(yaml, true);
+  CHECK(config.version == "1.2: beta");
+  CHECK(config.status == enum_status::stop);
+  CHECK(config.hosts ==
+        std::vector<std::string>{"a.example.com", "b.example.com", "c"});
+  CHECK(config.limits ==
+        std::map<std::string, int>{{"cpu", 4}, {"memory", 1024}});
+  REQUIRE(config.items.size() == 2);
+  CHECK(config.items[0].name == "first");
+  CHECK(config.items[0].values == std::vector<int>{1, 2, 3});
+  CHECK(*config.items[0].weight == 0.5);
+  CHECK(config.items[1].name.empty());
+  CHECK(!config.items[1].weight);
+  CHECK(config.grid == std::vector<std::vector<int>>{{1, 2}, {3}});
+  CHECK(config.extra->name == "x: y");
+  CHECK(config.extra->values.empty());
+
+  // a document marker and a sequence as deep as its key are read by the fast
+  // path only.
+  std::string_view marked = "---\nhosts:\n- a\n- b\nenabled: true\n";
+  fast_config_t by_fast{};
+  CHECK(iguana::detail::yaml_fast_reader::parse(by_fast, marked.data(),
+                                                marked.size()));
+  CHECK(by_fast.hosts == std::vector<std::string>{"a", "b"});
+  CHECK(by_fast.enabled);
+
+  // written by to_yaml, the lines are indexed a few at a time.
+  fast_config_t many{};
+  many.limits["cpu"] = 1;
+  for (int i = 0; i < 300; ++i) {
+    many.items.push_back(
+        {i, "item " + std::to_string(i), {i, i + 1}, i * 0.25});
+  }
+  std::string written;
+  iguana::to_yaml(many, written);
+  auto read = check_same(written, true);
+  CHECK(read.items.size() == 300);
+  CHECK(read.items[299].values == std::vector<int>{299, 300});
+
+  // the spaces after ':' may be tabs.
+  auto tabbed = check_same(
+      "version:\t1.2\nlimits:\n  cpu:\t1\nextra:\n  id: \t2\n  name:\ttom\n",
+      true);
+  CHECK(tabbed.version == "1.2");
+  CHECK(tabbed.limits["cpu"] == 1);
+  CHECK(tabbed.extra->id == 2);
+  CHECK(tabbed.extra->name == "tom");
+
+  // left to the slow path.
+  for (std::string_view slow : {
+           "version: &v 1\n",
+           "version: |\n  a\n  b\n",
+           "limits: {cpu: 1}\n",
+           "version:\n  a\n",
+           "unknown: 1\nversion: a\n",
+           "hosts:\n\t- a\n",
+       }) {
+    check_same(slow, false);
+  }
+  // the errors are those of the slow path.
+  std::string_view multiline = "version: a\n  b\n";
+  fast_config_t thrown{};
+  CHECK(!iguana::detail::yaml_fast_reader::parse(thrown, multiline.data(),
+                                                 multiline.size()));
+  CHECK_THROWS(iguana::from_yaml(thrown, multiline));
+}
+
 // doctest comments
 // 'function' : must be 'attribute' - see issue #182
 DOCTEST_MSVC_SUPPRESS_WARNING_WITH_PUSH(4007)